@@ -41,6 +41,7 @@ HEADERS += src/addrdb.h \
            src/core_memusage.h \
            src/cuckoocache.h \
            src/dbwrapper.h \
+           src/flatmap.h \
            src/fs.h \
            src/hash.h \
            src/httprpc.h \
@@ -59,6 +60,7 @@ HEADERS += src/addrdb.h \
            src/netbase.h \
            src/netmessagemaker.h \
            src/noui.h \
+           src/opreturnindex.h \
            src/pow.h \
            src/prevector.h \
            src/protocol.h \
@@ -106,6 +108,7 @@ HEADERS += src/addrdb.h \
            src/crypto/common.h \
            src/crypto/hmac_sha256.h \
            src/crypto/hmac_sha512.h \
+           src/crypto/muhash.h \
            src/crypto/ripemd160.h \
            src/crypto/sha1.h \
            src/crypto/sha256.h \
@@ -123,6 +126,7 @@ HEADERS += src/addrdb.h \
            src/qt/blockexplorer.h \
            src/qt/blockexplorertablemodel.h \
            src/qt/blockindexdetailsdialog.h \
+           src/qt/blocksummarycache.h \
            src/qt/callback.h \
            src/qt/clientmodel.h \
            src/qt/coincontroldialog.h \
@@ -152,6 +156,7 @@ HEADERS += src/addrdb.h \
            src/qt/newstypestablemodel.h \
            src/qt/notificator.h \
            src/qt/openuridialog.h \
+           src/qt/opreturnfeed.h \
            src/qt/optionsdialog.h \
            src/qt/optionsmodel.h \
            src/qt/overviewpage.h \
@@ -198,11 +203,13 @@ HEADERS += src/addrdb.h \
            src/qt/wtprimevotetablemodel.h \
            src/rpc/blockchain.h \
            src/rpc/client.h \
+           src/rpc/jsonstream.h \
            src/rpc/mining.h \
            src/rpc/protocol.h \
            src/rpc/register.h \
            src/rpc/safemode.h \
            src/rpc/server.h \
+           src/rpc/stats.h \
            src/rpc/util.h \
            src/script/drivenetconsensus.h \
            src/script/interpreter.h \
@@ -418,6 +425,7 @@ SOURCES += src/addrdb.cpp \
            src/netaddress.cpp \
            src/netbase.cpp \
            src/noui.cpp \
+           src/opreturnindex.cpp \
            src/pow.cpp \
            src/protocol.cpp \
            src/pubkey.cpp \
@@ -452,6 +460,7 @@ SOURCES += src/addrdb.cpp \
            src/bench/crypto_hash.cpp \
            src/bench/Examples.cpp \
            src/bench/lockedpool.cpp \
+           src/bench/merkle_root.cpp \
            src/bench/mempool_eviction.cpp \
            src/bench/perf.cpp \
            src/bench/prevector_destructor.cpp \
@@ -467,10 +476,14 @@ SOURCES += src/addrdb.cpp \
            src/crypto/chacha20.cpp \
            src/crypto/hmac_sha256.cpp \
            src/crypto/hmac_sha512.cpp \
+           src/crypto/muhash.cpp \
            src/crypto/ripemd160.cpp \
            src/crypto/sha1.cpp \
            src/crypto/sha256.cpp \
+           src/crypto/sha256_avx2.cpp \
+           src/crypto/sha256_shani.cpp \
            src/crypto/sha256_sse4.cpp \
+           src/crypto/sha256_sse41.cpp \
            src/crypto/sha512.cpp \
            src/policy/feerate.cpp \
            src/policy/fees.cpp \
@@ -485,6 +498,7 @@ SOURCES += src/addrdb.cpp \
            src/qt/blockexplorer.cpp \
            src/qt/blockexplorertablemodel.cpp \
            src/qt/blockindexdetailsdialog.cpp \
+           src/qt/blocksummarycache.cpp \
            src/qt/clientmodel.cpp \
            src/qt/coincontroldialog.cpp \
            src/qt/coincontroltreewidget.cpp \
@@ -512,6 +526,7 @@ SOURCES += src/addrdb.cpp \
            src/qt/newstypestablemodel.cpp \
            src/qt/notificator.cpp \
            src/qt/openuridialog.cpp \
+           src/qt/opreturnfeed.cpp \
            src/qt/optionsdialog.cpp \
            src/qt/optionsmodel.cpp \
            src/qt/overviewpage.cpp \
@@ -558,6 +573,7 @@ SOURCES += src/addrdb.cpp \
            src/qt/wtprimevotetablemodel.cpp \
            src/rpc/blockchain.cpp \
            src/rpc/client.cpp \
+           src/rpc/jsonstream.cpp \
            src/rpc/mining.cpp \
            src/rpc/misc.cpp \
            src/rpc/net.cpp \
@@ -565,6 +581,7 @@ SOURCES += src/addrdb.cpp \
            src/rpc/rawtransaction.cpp \
            src/rpc/safemode.cpp \
            src/rpc/server.cpp \
+           src/rpc/stats.cpp \
            src/rpc/util.cpp \
            src/script/drivenetconsensus.cpp \
            src/script/interpreter.cpp \
@@ -597,6 +614,7 @@ SOURCES += src/addrdb.cpp \
            src/test/cuckoocache_tests.cpp \
            src/test/dbwrapper_tests.cpp \
            src/test/DoS_tests.cpp \
+           src/test/flatmap_tests.cpp \
            src/test/getarg_tests.cpp \
            src/test/hash_tests.cpp \
            src/test/key_tests.cpp \
@@ -609,6 +627,7 @@ SOURCES += src/addrdb.cpp \
            src/test/multisig_tests.cpp \
            src/test/net_tests.cpp \
            src/test/netbase_tests.cpp \
+           src/test/opreturnindex_tests.cpp \
            src/test/pmt_tests.cpp \
            src/test/policyestimator_tests.cpp \
            src/test/pow_tests.cpp \
@@ -4,9 +4,13 @@
 
 #include <bench/bench.h>
 #include <coins.h>
+#include <memusage.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <wallet/crypter.h>
 
+#include <stdio.h>
+#include <unordered_map>
 #include <vector>
 
 // FIXME: Dedup with SetupDummyInputs in test/transaction_tests.cpp.
@@ -85,3 +89,65 @@ static void CCoinsCaching(benchmark::State& state)
 }
 
 BENCHMARK(CCoinsCaching, 170 * 1000);
+
+//! Number of coins in the maps of the lookup benchmarks
+static const int LOOKUP_COINS = 200000;
+//! Number of outpoints looked up that are not in the maps
+static const int LOOKUP_MISSES = 4096;
+
+//! The map CCoinsMap replaced, one node per coin
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsNodeMap;
+
+// Compare lookups in a coins cache sized map, half of them for outpoints
+// the map does not have. The memory per coin is printed once, as the
+// benchmark results only have timings.
+template <typename Map>
+static void CoinsMapLookup(benchmark::State& state, const char* name)
+{
+    FastRandomContext rng(true);
+    Map map;
+    std::vector<COutPoint> vOutPoint;
+    for (int i = 0; i < LOOKUP_COINS; i++) {
+        CCoinsCacheEntry entry;
+        entry.coin.out.nValue = rng.randrange(MAX_MONEY);
+        // Mostly scripts short enough to be held in the entry
+        entry.coin.out.scriptPubKey.resize(rng.randrange(8) ? 25 : 71);
+        entry.coin.nHeight = 1;
+        vOutPoint.emplace_back(rng.rand256(), rng.randrange(4));
+        map.emplace(vOutPoint.back(), std::move(entry));
+    }
+    std::vector<COutPoint> vMiss;
+    for (int i = 0; i < LOOKUP_MISSES; i++)
+        vMiss.emplace_back(rng.rand256(), 0);
+
+    static bool fReported = false;
+    if (!fReported) {
+        size_t nUsage = memusage::DynamicUsage(map);
+        for (const auto& entry : map)
+            nUsage += entry.second.coin.DynamicMemoryUsage();
+        fprintf(stderr, "%s: %.1f bytes per coin\n", name, (double)nUsage / map.size());
+        fReported = true;
+    }
+
+    size_t i = 0;
+    uint64_t nFound = 0;
+    while (state.KeepRunning()) {
+        nFound += map.find(vOutPoint[(i * 7919) % vOutPoint.size()]) != map.end();
+        nFound += map.find(vMiss[i % vMiss.size()]) != map.end();
+        i++;
+    }
+    assert(nFound == i);
+}
+
+static void CCoinsMapLookup(benchmark::State& state)
+{
+    CoinsMapLookup<CCoinsMap>(state, "CCoinsMapLookup");
+}
+
+static void CCoinsNodeMapLookup(benchmark::State& state)
+{
+    CoinsMapLookup<CCoinsNodeMap>(state, "CCoinsNodeMapLookup");
+}
+
+BENCHMARK(CCoinsMapLookup, 5 * 1000 * 1000);
+BENCHMARK(CCoinsNodeMapLookup, 5 * 1000 * 1000);
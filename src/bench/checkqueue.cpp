@@ -6,6 +6,7 @@
 #include <util.h>
 #include <validation.h>
 #include <checkqueue.h>
+#include <crypto/sha256.h>
 #include <prevector.h>
 #include <vector>
 #include <boost/thread/thread.hpp>
@@ -60,3 +61,61 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::State& state)
     tg.join_all();
 }
 BENCHMARK(CCheckQueueSpeedPrevectorJob, 1400);
+
+// This Benchmark shows how the CheckQueue scales with the number of threads
+// (counting the master, like -par), with checks that each take a few
+// microseconds.
+static void CCheckQueueScaling(benchmark::State& state, int nThreads)
+{
+    struct HashJob {
+        unsigned char data[CSHA256::OUTPUT_SIZE] = {};
+        HashJob(){
+        }
+        explicit HashJob(FastRandomContext& insecure_rand){
+            uint256 seed = insecure_rand.rand256();
+            std::copy(seed.begin(), seed.end(), data);
+        }
+        bool operator()()
+        {
+            for (int i = 0; i < 16; i++)
+                CSHA256().Write(data, sizeof(data)).Finalize(data);
+            return true;
+        }
+        void swap(HashJob& x){std::swap(data, x.data);};
+    };
+    CCheckQueue<HashJob> queue {QUEUE_BATCH_SIZE};
+    boost::thread_group tg;
+    for (auto x = 0; x < nThreads - 1; ++x) {
+       tg.create_thread([&]{queue.Thread();});
+    }
+    while (state.KeepRunning()) {
+        FastRandomContext insecure_rand(true);
+        CCheckQueueControl<HashJob> control(&queue);
+        std::vector<std::vector<HashJob>> vBatches(BATCHES);
+        for (auto& vChecks : vBatches) {
+            vChecks.reserve(BATCH_SIZE);
+            for (size_t x = 0; x < BATCH_SIZE; ++x)
+                vChecks.emplace_back(insecure_rand);
+            control.Add(vChecks);
+        }
+        control.Wait();
+    }
+    tg.interrupt_all();
+    tg.join_all();
+}
+
+static void CCheckQueueScaling_1(benchmark::State& state) { CCheckQueueScaling(state, 1); }
+static void CCheckQueueScaling_2(benchmark::State& state) { CCheckQueueScaling(state, 2); }
+static void CCheckQueueScaling_4(benchmark::State& state) { CCheckQueueScaling(state, 4); }
+static void CCheckQueueScaling_8(benchmark::State& state) { CCheckQueueScaling(state, 8); }
+static void CCheckQueueScaling_16(benchmark::State& state) { CCheckQueueScaling(state, 16); }
+static void CCheckQueueScaling_32(benchmark::State& state) { CCheckQueueScaling(state, 32); }
+static void CCheckQueueScaling_64(benchmark::State& state) { CCheckQueueScaling(state, 64); }
+
+BENCHMARK(CCheckQueueScaling_1, 100);
+BENCHMARK(CCheckQueueScaling_2, 100);
+BENCHMARK(CCheckQueueScaling_4, 100);
+BENCHMARK(CCheckQueueScaling_8, 100);
+BENCHMARK(CCheckQueueScaling_16, 100);
+BENCHMARK(CCheckQueueScaling_32, 100);
+BENCHMARK(CCheckQueueScaling_64, 100);
@@ -162,6 +162,10 @@ enum BlockStatus: uint32_t {
     BLOCK_FAILED_MASK        =   BLOCK_FAILED_VALID | BLOCK_FAILED_CHILD,
 
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
+
+    //! block data indexed from its header by ReindexBlockFiles, CheckBlock and
+    //! ContextualCheckBlock still have to run when it is connected
+    BLOCK_UNCHECKED         =   256,
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -25,6 +25,9 @@ struct CCheckpointData {
     MapCheckpoints mapCheckpoints;
 };
 
+/** Hashes of the UTXO snapshots loadtxoutset trusts, by base block height */
+typedef std::map<int, uint256> MapAssumeutxo;
+
 struct ChainTxData {
     int64_t nTime;
     int64_t nTxCount;
@@ -74,6 +77,7 @@ public:
     const std::vector<SeedSpec6>& FixedSeeds() const { return vFixedSeeds; }
     const CCheckpointData& Checkpoints() const { return checkpointData; }
     const ChainTxData& TxData() const { return chainTxData; }
+    const MapAssumeutxo& Assumeutxo() const { return mapAssumeutxo; }
     void UpdateVersionBitsParameters(Consensus::DeploymentPos d, int64_t nStartTime, int64_t nTimeout);
 protected:
     CChainParams() {}
@@ -93,6 +97,7 @@ protected:
     bool fMineBlocksOnDemand;
     CCheckpointData checkpointData;
     ChainTxData chainTxData;
+    MapAssumeutxo mapAssumeutxo;
 };
 
 /**
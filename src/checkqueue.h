@@ -8,6 +8,9 @@
 #include <sync.h>
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <vector>
 
 #include <boost/thread/condition_variable.hpp>
@@ -16,7 +19,128 @@
 template <typename T>
 class CCheckQueueControl;
 
-/** 
+//! Maximum number of threads, including the master, that get a deque of their own
+static const int MAX_CHECKQUEUE_WORKERS = 128;
+
+//! Rounds of looking for work an idle thread makes before it goes to sleep
+static const int CHECKQUEUE_SPIN_ROUNDS = 1000;
+
+/**
+ * Work-stealing deque of pointers (Chase and Lev, "Dynamic Circular
+ * Work-Stealing Deque", with the memory orders of Le et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models").
+ *
+ * Only the owning thread may Push and Pop, at the bottom. Any thread may
+ * Steal from the top. Buffers that were grown out of are kept until the
+ * deque is destroyed, as thieves may still be reading from them.
+ */
+template <typename P>
+class CWorkStealingDeque
+{
+private:
+    struct Buffer {
+        const int64_t nMask;
+        std::unique_ptr<std::atomic<P*>[]> items;
+
+        explicit Buffer(int64_t nSize) : nMask(nSize - 1), items(new std::atomic<P*>[nSize]()) {}
+        int64_t Size() const { return nMask + 1; }
+        P* Get(int64_t i) const { return items[i & nMask].load(std::memory_order_relaxed); }
+        void Put(int64_t i, P* p) { items[i & nMask].store(p, std::memory_order_relaxed); }
+    };
+
+    //! Next index to steal; only ever increases
+    std::atomic<int64_t> nTop;
+
+    //! Keep the index thieves race on away from the one the owner writes
+    char padding[64];
+
+    //! Next index to push
+    std::atomic<int64_t> nBottom;
+
+    std::atomic<Buffer*> pbuffer;
+
+    //! Every buffer used so far, the last one is current
+    std::vector<std::unique_ptr<Buffer>> vBuffers;
+
+    Buffer* Grow(Buffer* pold, int64_t nTopNow, int64_t nBottomNow)
+    {
+        vBuffers.emplace_back(new Buffer(pold->Size() * 2));
+        Buffer* pnew = vBuffers.back().get();
+        for (int64_t i = nTopNow; i < nBottomNow; i++)
+            pnew->Put(i, pold->Get(i));
+        pbuffer.store(pnew, std::memory_order_release);
+        return pnew;
+    }
+
+public:
+    CWorkStealingDeque() : nTop(0), nBottom(0)
+    {
+        vBuffers.emplace_back(new Buffer(64));
+        pbuffer.store(vBuffers.back().get(), std::memory_order_relaxed);
+    }
+
+    CWorkStealingDeque(const CWorkStealingDeque&) = delete;
+    CWorkStealingDeque& operator=(const CWorkStealingDeque&) = delete;
+
+    //! Add an item at the bottom (owner only)
+    void Push(P* p)
+    {
+        int64_t b = nBottom.load(std::memory_order_relaxed);
+        int64_t t = nTop.load(std::memory_order_acquire);
+        Buffer* buffer = pbuffer.load(std::memory_order_relaxed);
+        if (b - t >= buffer->Size())
+            buffer = Grow(buffer, t, b);
+        buffer->Put(b, p);
+        std::atomic_thread_fence(std::memory_order_release);
+        nBottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    //! Take the item at the bottom, or nullptr when empty (owner only)
+    P* Pop()
+    {
+        int64_t b = nBottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = pbuffer.load(std::memory_order_relaxed);
+        nBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = nTop.load(std::memory_order_relaxed);
+        if (t > b) {
+            // Empty
+            nBottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        P* p = buffer->Get(b);
+        if (t == b) {
+            // The last item, race the thieves for it
+            if (!nTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                p = nullptr;
+            nBottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return p;
+    }
+
+    //! Take the item at the top, or nullptr when empty or lost to another thread
+    P* Steal()
+    {
+        int64_t t = nTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = nBottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        P* p = pbuffer.load(std::memory_order_acquire)->Get(t);
+        if (!nTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return p;
+    }
+
+    bool Empty() const
+    {
+        int64_t t = nTop.load(std::memory_order_acquire);
+        int64_t b = nBottom.load(std::memory_order_acquire);
+        return t >= b;
+    }
+};
+
+/**
  * Queue for verifications that have to be performed.
   * The verifications are represented by a type T, which must provide an
   * operator(), returning a bool.
@@ -25,12 +149,63 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Every thread has a deque of ranges of checks. The master pushes each
+  * batch onto its own deque, and threads out of work steal ranges from the
+  * others. A thread whose deque is empty splits half of the range it is
+  * working on off onto it, so big batches spread over idle threads. The
+  * mutex is only taken by threads going to sleep and to wake them up.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    //! The checks of one call to Add
+    struct Batch {
+        std::vector<T> vChecks;
+    };
+
+    //! A range of the checks of a batch, which is what threads steal
+    struct Task {
+        Batch* pbatch;
+        size_t nBegin;
+        size_t nEnd;
+    };
+
+    //! A thread taking part in the verification
+    struct Worker {
+        CWorkStealingDeque<Task> deque;
+
+        //! Tasks created by this thread, reused for every round
+        std::vector<std::unique_ptr<Task>> vTasks;
+        size_t nTasksUsed;
+
+        //! State for picking the first thread to steal from
+        uint32_t nRand;
+
+        explicit Worker(uint32_t nSeed) : nTasksUsed(0), nRand(nSeed * 2654435761U | 1) {}
+
+        Task* NewTask(Batch* pbatch, size_t nBegin, size_t nEnd)
+        {
+            if (nTasksUsed == vTasks.size())
+                vTasks.emplace_back(new Task);
+            Task* ptask = vTasks[nTasksUsed++].get();
+            ptask->pbatch = pbatch;
+            ptask->nBegin = nBegin;
+            ptask->nEnd = nEnd;
+            return ptask;
+        }
+
+        uint32_t Rand()
+        {
+            nRand ^= nRand << 13;
+            nRand ^= nRand >> 17;
+            nRand ^= nRand << 5;
+            return nRand;
+        }
+    };
+
+    //! Mutex for sleeping and waking up threads
     boost::mutex mutex;
 
     //! Worker threads block on this when out of work
@@ -39,88 +214,128 @@ private:
     //! Master thread blocks on this when out of work
     boost::condition_variable condMaster;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue;
+    //! Incremented (under mutex) to wake up the sleeping workers
+    uint64_t nWakeups;
+
+    //! The number of workers blocked on condWorker
+    std::atomic<int> nSleeping;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle;
+    //! Whether the master is blocked on condMaster
+    std::atomic<bool> fMasterSleeping;
 
-    //! The total number of workers (including the master).
-    int nTotal;
+    //! The threads with a deque; the master is the first
+    std::atomic<Worker*> vpWorker[MAX_CHECKQUEUE_WORKERS];
+    std::atomic<int> nWorkers;
+    std::vector<std::unique_ptr<Worker>> vWorkerOwned;
 
-    //! The temporary evaluation result.
-    bool fAllOk;
+    //! The temporary evaluation result. Once false, the remaining checks are skipped.
+    std::atomic<bool> fAllOk;
 
     /**
      * Number of verifications that haven't completed yet.
-     * This includes elements that are no longer queued, but still in the
-     * worker's own batches.
+     * This includes elements that are no longer queued, but still being
+     * worked on.
      */
-    unsigned int nTodo;
+    std::atomic<int64_t> nTodo;
+
+    //! The batches of this round (master only)
+    std::vector<std::unique_ptr<Batch>> vBatches;
+    size_t nBatchesUsed;
+
+    //! The maximum number of elements in one task pushed by Add
+    size_t nBatchSize;
+
+    //! Wake up the sleeping workers, after new tasks were pushed
+    void WakeWorkers()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (nSleeping.load(std::memory_order_relaxed) == 0)
+            return;
+        boost::unique_lock<boost::mutex> lock(mutex);
+        nWakeups++;
+        condWorker.notify_all();
+    }
 
-    //! The maximum number of elements to be processed in one batch
-    unsigned int nBatchSize;
+    //! Whether any deque has a task left
+    bool HaveWork()
+    {
+        int n = std::min(nWorkers.load(std::memory_order_acquire), MAX_CHECKQUEUE_WORKERS);
+        for (int i = 0; i < n; i++) {
+            Worker* pworker = vpWorker[i].load(std::memory_order_acquire);
+            if (pworker && !pworker->deque.Empty())
+                return true;
+        }
+        return false;
+    }
+
+    //! Find a task: from the own deque first, then from the others
+    Task* Find(Worker* pself)
+    {
+        if (pself) {
+            Task* ptask = pself->deque.Pop();
+            if (ptask)
+                return ptask;
+        }
+        int n = std::min(nWorkers.load(std::memory_order_acquire), MAX_CHECKQUEUE_WORKERS);
+        int nStart = pself ? pself->Rand() % n : 0;
+        for (int i = 0; i < n; i++) {
+            Worker* pvictim = vpWorker[(nStart + i) % n].load(std::memory_order_acquire);
+            if (!pvictim || pvictim == pself)
+                continue;
+            Task* ptask = pvictim->deque.Steal();
+            if (ptask)
+                return ptask;
+        }
+        return nullptr;
+    }
 
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    void Run(Worker* pself, Task* ptask)
     {
-        boost::condition_variable& cond = fMaster ? condMaster : condWorker;
-        std::vector<T> vChecks;
-        vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do {
-            {
+        Batch* pbatch = ptask->pbatch;
+        size_t nBegin = ptask->nBegin;
+        size_t nEnd = ptask->nEnd;
+        int64_t nDone = 0;
+        for (; nBegin < nEnd; nBegin++) {
+            // Make half of what is left available for stealing when
+            // everything that was is gone
+            if (pself && nEnd - nBegin > 1 && pself->deque.Empty()) {
+                size_t nSplit = nBegin + (nEnd - nBegin + 1) / 2;
+                pself->deque.Push(pself->NewTask(pbatch, nSplit, nEnd));
+                nEnd = nSplit;
+                WakeWorkers();
+            }
+            T& check = pbatch->vChecks[nBegin];
+            if (fAllOk.load(std::memory_order_relaxed) && !check())
+                fAllOk.store(false, std::memory_order_relaxed);
+            // Release what the check holds right away, leaving an empty
+            // check for the master to clear
+            T().swap(check);
+            nDone++;
+        }
+        if (nTodo.fetch_sub(nDone, std::memory_order_acq_rel) == nDone) {
+            // We processed the last element; inform the master it can exit and return the result
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (fMasterSleeping.load(std::memory_order_relaxed)) {
                 boost::unique_lock<boost::mutex> lock(mutex);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        condMaster.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty()) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        if (fMaster)
-                            fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
-                }
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the mutex to be as short as possible, so swap jobs from the global
-                    // queue to the local batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
-                }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+                condMaster.notify_one();
             }
-            // execute work
-            for (T& check : vChecks)
-                if (fOk)
-                    fOk = check();
-            vChecks.clear();
-        } while (true);
+        }
+    }
+
+    //! Get a deque for the calling thread, or nullptr when there are too many
+    Worker* Register()
+    {
+        int nId = nWorkers.fetch_add(1, std::memory_order_relaxed);
+        if (nId >= MAX_CHECKQUEUE_WORKERS)
+            return nullptr;
+        Worker* pworker = new Worker(nId);
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            vWorkerOwned.emplace_back(pworker);
+        }
+        vpWorker[nId].store(pworker, std::memory_order_release);
+        return pworker;
     }
 
 public:
@@ -128,33 +343,110 @@ public:
     boost::mutex ControlMutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn) : nWakeups(0), nSleeping(0), fMasterSleeping(false), nWorkers(0), fAllOk(true), nTodo(0), nBatchesUsed(0), nBatchSize(std::max(1U, nBatchSizeIn))
+    {
+        for (int i = 0; i < MAX_CHECKQUEUE_WORKERS; i++)
+            vpWorker[i].store(nullptr, std::memory_order_relaxed);
+        // The master's deque
+        Register();
+    }
 
     //! Worker thread
     void Thread()
     {
-        Loop();
+        Worker* pself = Register();
+        int nIdle = 0;
+        while (true) {
+            Task* ptask = Find(pself);
+            if (ptask) {
+                Run(pself, ptask);
+                nIdle = 0;
+                continue;
+            }
+            if (++nIdle < CHECKQUEUE_SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            nIdle = 0;
+
+            boost::unique_lock<boost::mutex> lock(mutex);
+            nSleeping.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t nWakeupsNow = nWakeups;
+            try {
+                if (!HaveWork()) {
+                    while (nWakeups == nWakeupsNow)
+                        condWorker.wait(lock); // wait
+                }
+            } catch (...) {
+                // Interrupted
+                nSleeping.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+            nSleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
     }
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
-        return Loop(true);
+        Worker* pself = vpWorker[0].load(std::memory_order_relaxed);
+        int nIdle = 0;
+        while (nTodo.load(std::memory_order_acquire) > 0) {
+            Task* ptask = Find(pself);
+            if (ptask) {
+                Run(pself, ptask);
+                nIdle = 0;
+                continue;
+            }
+            if (++nIdle < CHECKQUEUE_SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            nIdle = 0;
+
+            // Only checks in progress elsewhere are left
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fMasterSleeping.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (nTodo.load(std::memory_order_acquire) > 0)
+                condMaster.wait(lock);
+            fMasterSleeping.store(false, std::memory_order_relaxed);
+        }
+
+        // All checks are done, reset for new work later
+        bool fRet = fAllOk.load(std::memory_order_relaxed);
+        fAllOk.store(true, std::memory_order_relaxed);
+        for (size_t i = 0; i < nBatchesUsed; i++)
+            vBatches[i]->vChecks.clear();
+        nBatchesUsed = 0;
+        int n = std::min(nWorkers.load(std::memory_order_acquire), MAX_CHECKQUEUE_WORKERS);
+        for (int i = 0; i < n; i++) {
+            Worker* pworker = vpWorker[i].load(std::memory_order_acquire);
+            if (pworker)
+                pworker->nTasksUsed = 0;
+        }
+        return fRet;
     }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        for (T& check : vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
-        }
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1)
-            condWorker.notify_one();
-        else if (vChecks.size() > 1)
-            condWorker.notify_all();
+        if (vChecks.empty())
+            return;
+
+        if (nBatchesUsed == vBatches.size())
+            vBatches.emplace_back(new Batch);
+        Batch* pbatch = vBatches[nBatchesUsed++].get();
+        // Take the checks over by swapping vectors, the caller gets an empty one
+        pbatch->vChecks.swap(vChecks);
+
+        Worker* pself = vpWorker[0].load(std::memory_order_relaxed);
+        size_t nSize = pbatch->vChecks.size();
+        nTodo.fetch_add(nSize, std::memory_order_relaxed);
+        for (size_t nBegin = 0; nBegin < nSize; nBegin += nBatchSize)
+            pself->deque.Push(pself->NewTask(pbatch, nBegin, std::min(nSize, nBegin + nBatchSize)));
+        WakeWorkers();
     }
 
     ~CCheckQueue()
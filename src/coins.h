@@ -9,6 +9,7 @@
 #include <primitives/transaction.h>
 #include <compressor.h>
 #include <core_memusage.h>
+#include <flatmap.h>
 #include <hash.h>
 #include <memusage.h>
 #include <serialize.h>
@@ -127,7 +128,7 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+typedef flatmap<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -276,6 +277,13 @@ public:
      */
     bool Flush();
 
+    /**
+     * Move the modified entries of this cache into mapDirty, so they can be
+     * written while the cache is in use. The unmodified entries are kept as
+     * long as the cache uses at most nMaxCleanUsage bytes.
+     */
+    void ExtractDirty(CCoinsMap& mapDirty, size_t nMaxCleanUsage);
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is
      * not modified.
@@ -5,19 +5,33 @@
 #include <dbwrapper.h>
 
 #include <random.h>
+#include <utiltime.h>
 
 #include <leveldb/cache.h>
 #include <leveldb/env.h>
 #include <leveldb/filter_policy.h>
 #include <memenv.h>
 #include <stdint.h>
+#include <string.h>
 #include <algorithm>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
+    //! LevelDB doesn't count these, they are taken from its log messages
+    std::atomic<uint64_t> nFlushes{0};
+    std::atomic<uint64_t> nCompactions{0};
+    std::atomic<uint64_t> nStalls{0};
+
     // This code is adapted from posix_logger.h, which is why it is using vsprintf.
     // Please do not do this in normal code
     void Logv(const char * format, va_list ap) override {
+            if (!strcmp(format, "Level-0 table #%llu: started"))
+                nFlushes++;
+            else if (!strncmp(format, "Compacting ", 11))
+                nCompactions++;
+            else if (!strcmp(format, "Current memtable full; waiting...\n") || !strcmp(format, "Too many L0 files; waiting...\n"))
+                nStalls++;
+
             if (!LogAcceptCategory(BCLog::LEVELDB)) {
                 return;
             }
@@ -71,14 +85,116 @@ public:
     }
 };
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+/** A LevelDB LRU cache that counts the hits and misses of its lookups */
+class CCountingCache : public leveldb::Cache {
+private:
+    leveldb::Cache* pcache;
+
+public:
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+
+    explicit CCountingCache(size_t nCapacity) : pcache(leveldb::NewLRUCache(nCapacity)) {}
+    ~CCountingCache() { delete pcache; }
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, void (*deleter)(const leveldb::Slice& key, void* value)) override
+    {
+        return pcache->Insert(key, value, charge, deleter);
+    }
+
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle = pcache->Lookup(key);
+        if (handle)
+            nHits++;
+        else
+            nMisses++;
+        return handle;
+    }
+
+    void Release(Handle* handle) override { pcache->Release(handle); }
+    void* Value(Handle* handle) override { return pcache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { pcache->Erase(key); }
+    uint64_t NewId() override { return pcache->NewId(); }
+    void Prune() override { pcache->Prune(); }
+    size_t TotalCharge() const override { return pcache->TotalCharge(); }
+};
+
+bool ParseDBOptionArg(const std::string& strArg, std::string& strName, int& nValue)
+{
+    size_t nColon = strArg.find(':');
+    if (nColon == std::string::npos || nColon == 0)
+        return false;
+    strName = strArg.substr(0, nColon);
+    return ParseInt32(strArg.substr(nColon + 1), &nValue);
+}
+
+namespace {
+
+/** A -db* option and the values it allows */
+struct DBOptionArg
+{
+    const char* pszArg;
+    int nMin;
+    int nMax;
+};
+
+const DBOptionArg ARG_MAX_OPEN_FILES = {"-dbmaxopenfiles", 16, 1 << 16};
+const DBOptionArg ARG_COMPRESSION = {"-dbcompression", 0, 1};
+const DBOptionArg ARG_BLOOM_BITS = {"-dbbloombits", 0, 64};
+const DBOptionArg ARG_BLOCK_CACHE = {"-dbblockcache", 10, 90};
+
+const DBOptionArg* const DB_OPTION_ARGS[] = {&ARG_MAX_OPEN_FILES, &ARG_COMPRESSION, &ARG_BLOOM_BITS, &ARG_BLOCK_CACHE};
+
+/** The last value of arg given for database strName, or nDefault */
+int GetDBOptionArg(const DBOptionArg& arg, const std::string& strName, int nDefault)
+{
+    int nResult = nDefault;
+    for (const std::string& strArg : gArgs.GetArgs(arg.pszArg)) {
+        std::string strArgName;
+        int nValue;
+        if (ParseDBOptionArg(strArg, strArgName, nValue) && strArgName == strName)
+            nResult = std::max(arg.nMin, std::min(arg.nMax, nValue));
+    }
+    return nResult;
+}
+
+} // namespace
+
+bool CheckDBOptionArgs(std::string& strError)
+{
+    for (const DBOptionArg* arg : DB_OPTION_ARGS) {
+        for (const std::string& strArg : gArgs.GetArgs(arg->pszArg)) {
+            std::string strName;
+            int nValue;
+            if (!ParseDBOptionArg(strArg, strName, nValue) || nValue < arg->nMin || nValue > arg->nMax) {
+                strError = strprintf("Invalid %s=%s, expected <database>:<n> with n from %d to %d", arg->pszArg, strArg, arg->nMin, arg->nMax);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+CDBOptions GetDBOptions(const std::string& strName)
+{
+    CDBOptions dbopts;
+    dbopts.nMaxOpenFiles = GetDBOptionArg(ARG_MAX_OPEN_FILES, strName, dbopts.nMaxOpenFiles);
+    dbopts.fCompression = GetDBOptionArg(ARG_COMPRESSION, strName, dbopts.fCompression) != 0;
+    dbopts.nBloomBits = GetDBOptionArg(ARG_BLOOM_BITS, strName, dbopts.nBloomBits);
+    dbopts.nBlockCachePercent = GetDBOptionArg(ARG_BLOCK_CACHE, strName, dbopts.nBlockCachePercent);
+    return dbopts;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, const CDBOptions& dbopts)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
-    options.compression = leveldb::kNoCompression;
-    options.max_open_files = 64;
+    size_t nBlockCacheSize = nCacheSize / 100 * dbopts.nBlockCachePercent;
+    options.block_cache = new CCountingCache(nBlockCacheSize);
+    options.write_buffer_size = (nCacheSize - nBlockCacheSize) / 2; // up to two write buffers may be held in memory simultaneously
+    options.filter_policy = dbopts.nBloomBits ? leveldb::NewBloomFilterPolicy(dbopts.nBloomBits) : nullptr;
+    options.compression = dbopts.fCompression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    options.max_open_files = dbopts.nMaxOpenFiles;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
@@ -88,14 +204,18 @@ static leveldb::Options GetOptions(size_t nCacheSize)
     return options;
 }
 
-CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
+CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) :
+    nWrites(0), nWriteMicros(0), nStallMicros(0)
 {
     penv = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
+    dbopts = ::GetDBOptions(path.filename().string());
+    options = GetOptions(nCacheSize, dbopts);
+    plogger = static_cast<CBitcoinLevelDBLogger*>(options.info_log);
+    pcache = static_cast<CCountingCache*>(options.block_cache);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -115,7 +235,7 @@ CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bo
 
     if (gArgs.GetBoolArg("-forcecompactdb", false)) {
         LogPrintf("Starting database compaction of %s\n", path.string());
-        pdb->CompactRange(nullptr, nullptr);
+        CompactAll();
         LogPrintf("Finished database compaction of %s\n", path.string());
     }
 
@@ -155,11 +275,58 @@ CDBWrapper::~CDBWrapper()
 
 bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 {
+    int64_t nTimeStart = GetTimeMicros();
+    uint64_t nStallsBefore = plogger->nStalls;
     leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
+    int64_t nTime = GetTimeMicros() - nTimeStart;
+    nWrites++;
+    nWriteMicros += nTime;
+    // A stall is logged by the thread that waits, but another thread's write
+    // may be the one counted here when several write at the same time
+    if (plogger->nStalls != nStallsBefore)
+        nStallMicros += nTime;
     dbwrapper_private::HandleError(status);
     return true;
 }
 
+CDBStats CDBWrapper::GetStats() const
+{
+    CDBStats stats;
+    stats.nWrites = nWrites;
+    stats.nWriteMicros = nWriteMicros;
+    stats.nStalls = plogger->nStalls;
+    stats.nStallMicros = nStallMicros;
+    stats.nFlushes = plogger->nFlushes;
+    stats.nCompactions = plogger->nCompactions;
+    stats.nCacheHits = pcache->nHits;
+    stats.nCacheMisses = pcache->nMisses;
+    stats.nCacheUsage = pcache->TotalCharge();
+    return stats;
+}
+
+std::string CDBWrapper::GetProperty(const std::string& strProperty) const
+{
+    std::string strValue;
+    if (!pdb->GetProperty(strProperty, &strValue))
+        return std::string();
+    return strValue;
+}
+
+uint64_t CDBWrapper::EstimateTotalSize() const
+{
+    // The keys of every database start with a type character below 0xff
+    std::string strLast(DBWRAPPER_PREALLOC_KEY_SIZE, '\xff');
+    leveldb::Range range("", strLast);
+    uint64_t nSize = 0;
+    pdb->GetApproximateSizes(&range, 1, &nSize);
+    return nSize;
+}
+
+void CDBWrapper::CompactAll() const
+{
+    pdb->CompactRange(nullptr, nullptr);
+}
+
 // Prefixed with null character to avoid collisions with other keys
 //
 // We must use a string constructor which specifies length so that we copy
@@ -16,9 +16,20 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <atomic>
+
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 
+//! Default for -dbmaxopenfiles
+static const int DEFAULT_DB_MAX_OPEN_FILES = 64;
+//! Default for -dbcompression
+static const bool DEFAULT_DB_COMPRESSION = false;
+//! Default for -dbbloombits
+static const int DEFAULT_DB_BLOOM_BITS = 10;
+//! Default for -dbblockcache, the rest of the cache goes to the write buffers
+static const int DEFAULT_DB_BLOCK_CACHE_PERCENT = 50;
+
 class dbwrapper_error : public std::runtime_error
 {
 public:
@@ -26,6 +37,50 @@ public:
 };
 
 class CDBWrapper;
+class CBitcoinLevelDBLogger;
+class CCountingCache;
+
+/**
+ * LevelDB options of a database. They can be set per database on the
+ * command line, naming the database by its directory, for example
+ * -dbmaxopenfiles=opreturn:128.
+ */
+struct CDBOptions
+{
+    int nMaxOpenFiles;
+    bool fCompression;
+    //! bits per key of the bloom filters, 0 for none
+    int nBloomBits;
+    //! percentage of the cache size used for the block cache
+    int nBlockCachePercent;
+
+    CDBOptions() : nMaxOpenFiles(DEFAULT_DB_MAX_OPEN_FILES), fCompression(DEFAULT_DB_COMPRESSION),
+        nBloomBits(DEFAULT_DB_BLOOM_BITS), nBlockCachePercent(DEFAULT_DB_BLOCK_CACHE_PERCENT) {}
+};
+
+/** Parse a "<database>:<value>" argument of the -db* options */
+bool ParseDBOptionArg(const std::string& strArg, std::string& strName, int& nValue);
+
+/** Check the -db* options, returning false with strError set if one is invalid */
+bool CheckDBOptionArgs(std::string& strError);
+
+/** The options of the database in directory strName, from the command line */
+CDBOptions GetDBOptions(const std::string& strName);
+
+/** Counters of a CDBWrapper since it was opened */
+struct CDBStats
+{
+    uint64_t nWrites;
+    uint64_t nWriteMicros;
+    //! writes that waited for a memtable flush or for level 0 to be compacted
+    uint64_t nStalls;
+    uint64_t nStallMicros;
+    uint64_t nFlushes;
+    uint64_t nCompactions;
+    uint64_t nCacheHits;
+    uint64_t nCacheMisses;
+    size_t nCacheUsage;
+};
 
 /** These should be considered an implementation detail of the specific database.
  */
@@ -195,6 +250,19 @@ private:
     //! database options used
     leveldb::Options options;
 
+    //! the options the leveldb::Options were made from
+    CDBOptions dbopts;
+
+    //! options.info_log, which counts flushes, compactions and stalls
+    CBitcoinLevelDBLogger* plogger;
+
+    //! options.block_cache, which counts hits and misses
+    CCountingCache* pcache;
+
+    std::atomic<uint64_t> nWrites;
+    std::atomic<uint64_t> nWriteMicros;
+    std::atomic<uint64_t> nStallMicros;
+
     //! options used when reading from the database
     leveldb::ReadOptions readoptions;
 
@@ -344,6 +412,19 @@ public:
      */
     bool IsEmpty();
 
+    const CDBOptions& GetDBOptions() const { return dbopts; }
+
+    CDBStats GetStats() const;
+
+    /** The value of a LevelDB property such as "leveldb.stats", empty if unknown */
+    std::string GetProperty(const std::string& strProperty) const;
+
+    /** The approximate size of the database on disk */
+    uint64_t EstimateTotalSize() const;
+
+    /** Compact the whole database */
+    void CompactAll() const;
+
     template<typename K>
     size_t EstimateSize(const K& key_begin, const K& key_end) const
     {
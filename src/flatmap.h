@@ -0,0 +1,318 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_FLATMAP_H
+#define BITCOIN_FLATMAP_H
+
+#include <crypto/common.h>
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Hash map for many small entries, used as the map of the coins cache.
+ *
+ * The index is an open addressing table of 8 byte slots, holding 32 bits
+ * of the hash and the number of the entry. Lookups probe it linearly and
+ * only touch entries whose hash matches. The entries are kept in chunks of
+ * an arena, so there is no allocation per entry, and they never move:
+ * references and iterators stay valid until the entry is erased, even when
+ * the index grows.
+ *
+ * Entries have the members first and second like a std::pair, the slot of
+ * the entry is kept in between them, which costs nothing for keys like
+ * COutPoint that leave padding before an 8 byte aligned value.
+ *
+ * Erased entries leave a tombstone in the index and their place in the
+ * arena is reused, so erasing while iterating is safe.
+ */
+template <class K, class T, class Hash>
+class flatmap
+{
+public:
+    typedef K key_type;
+    typedef T mapped_type;
+    typedef size_t size_type;
+
+    class value_type
+    {
+    public:
+        const K first;
+    private:
+        uint32_t nSlot;
+        friend class flatmap;
+    public:
+        T second;
+
+        template <typename... Args>
+        value_type(const K& key, uint32_t nSlotIn, Args&&... args) : first(key), nSlot(nSlotIn), second(std::forward<Args>(args)...) {}
+    };
+
+private:
+    static const uint32_t SLOT_EMPTY = 0xffffffff;
+    static const uint32_t SLOT_DELETED = 0xfffffffe;
+    static const uint32_t END = 0xffffffff;
+    static const size_t MIN_SLOTS = 16;
+    static const int CHUNK_SHIFT = 6;
+    static const uint32_t CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+    struct Slot {
+        uint32_t nTag;
+        uint32_t nIndex;
+    };
+
+    struct Chunk {
+        //! Bit i is set when entry i is in use
+        uint64_t nUsed;
+        typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type entries[CHUNK_SIZE];
+
+        Chunk() : nUsed(0) {}
+        value_type* Get(uint32_t i) { return reinterpret_cast<value_type*>(&entries[i]); }
+        const value_type* Get(uint32_t i) const { return reinterpret_cast<const value_type*>(&entries[i]); }
+    };
+
+    Hash hasher;
+    std::vector<Slot> vSlots;
+    std::vector<std::unique_ptr<Chunk>> vChunks;
+    std::vector<uint32_t> vFree;
+    //! Entries of the last chunk that were never used
+    uint32_t nUnused;
+    size_t nSize;
+    size_t nDeleted;
+
+    static uint32_t Tag(size_t hash) { return (uint32_t)((uint64_t)hash >> 32); }
+
+    value_type* Get(uint32_t nIndex) { return vChunks[nIndex >> CHUNK_SHIFT]->Get(nIndex & (CHUNK_SIZE - 1)); }
+    const value_type* Get(uint32_t nIndex) const { return vChunks[nIndex >> CHUNK_SHIFT]->Get(nIndex & (CHUNK_SIZE - 1)); }
+
+    /** The first entry in use at or after nIndex, or END */
+    uint32_t NextUsed(uint32_t nIndex) const
+    {
+        for (size_t c = nIndex >> CHUNK_SHIFT; c < vChunks.size(); c++) {
+            uint32_t nOffset = nIndex & (CHUNK_SIZE - 1);
+            uint64_t nUsed = vChunks[c]->nUsed >> nOffset;
+            if (nUsed)
+                return nIndex + CountBits(nUsed & (~nUsed + 1)) - 1;
+            nIndex += CHUNK_SIZE - nOffset;
+        }
+        return END;
+    }
+
+    /** The slot of key, or the slot to insert it at when it is missing */
+    size_t FindSlot(const K& key, size_t hash, bool& fFound) const
+    {
+        const size_t nMask = vSlots.size() - 1;
+        const uint32_t nTag = Tag(hash);
+        size_t nInsert = SIZE_MAX;
+        for (size_t i = hash & nMask; ; i = (i + 1) & nMask) {
+            const Slot& slot = vSlots[i];
+            if (slot.nIndex == SLOT_EMPTY) {
+                fFound = false;
+                return nInsert == SIZE_MAX ? i : nInsert;
+            }
+            if (slot.nIndex == SLOT_DELETED) {
+                if (nInsert == SIZE_MAX)
+                    nInsert = i;
+            } else if (slot.nTag == nTag && Get(slot.nIndex)->first == key) {
+                fFound = true;
+                return i;
+            }
+        }
+    }
+
+    uint32_t Find(const K& key) const
+    {
+        if (nSize == 0)
+            return END;
+        bool fFound;
+        size_t i = FindSlot(key, hasher(key), fFound);
+        return fFound ? vSlots[i].nIndex : END;
+    }
+
+    void Rehash(size_t nSlots)
+    {
+        std::vector<Slot> vNew(nSlots, Slot{0, SLOT_EMPTY});
+        const size_t nMask = nSlots - 1;
+        for (uint32_t nIndex = NextUsed(0); nIndex != END; nIndex = NextUsed(nIndex + 1)) {
+            value_type* entry = Get(nIndex);
+            size_t hash = hasher(entry->first);
+            size_t i = hash & nMask;
+            while (vNew[i].nIndex != SLOT_EMPTY)
+                i = (i + 1) & nMask;
+            vNew[i] = Slot{Tag(hash), nIndex};
+            entry->nSlot = i;
+        }
+        vSlots.swap(vNew);
+        nDeleted = 0;
+    }
+
+    uint32_t Allocate()
+    {
+        if (!vFree.empty()) {
+            uint32_t nIndex = vFree.back();
+            vFree.pop_back();
+            return nIndex;
+        }
+        if (nUnused == 0) {
+            vChunks.emplace_back(new Chunk());
+            nUnused = CHUNK_SIZE;
+        }
+        return vChunks.size() * CHUNK_SIZE - nUnused--;
+    }
+
+    void Destroy(uint32_t nIndex)
+    {
+        Get(nIndex)->~value_type();
+        vChunks[nIndex >> CHUNK_SHIFT]->nUsed &= ~((uint64_t)1 << (nIndex & (CHUNK_SIZE - 1)));
+    }
+
+    template <bool fConst>
+    class iterator_base
+    {
+        typedef typename std::conditional<fConst, const flatmap*, flatmap*>::type map_pointer;
+        map_pointer pmap;
+        uint32_t nIndex;
+        friend class flatmap;
+        template <bool> friend class iterator_base;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::conditional<fConst, const typename flatmap::value_type, typename flatmap::value_type>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef value_type* pointer;
+        typedef value_type& reference;
+
+        iterator_base() : pmap(nullptr), nIndex(END) {}
+        iterator_base(map_pointer pmapIn, uint32_t nIndexIn) : pmap(pmapIn), nIndex(nIndexIn) {}
+        //! Allow converting an iterator to a const_iterator
+        iterator_base(const iterator_base<false>& it) : pmap(it.pmap), nIndex(it.nIndex) {}
+
+        reference operator*() const { return *pmap->Get(nIndex); }
+        pointer operator->() const { return pmap->Get(nIndex); }
+        iterator_base& operator++() { nIndex = pmap->NextUsed(nIndex + 1); return *this; }
+        iterator_base operator++(int) { iterator_base copy(*this); ++(*this); return copy; }
+        friend bool operator==(const iterator_base& a, const iterator_base& b) { return a.nIndex == b.nIndex; }
+        friend bool operator!=(const iterator_base& a, const iterator_base& b) { return a.nIndex != b.nIndex; }
+    };
+
+public:
+    typedef iterator_base<false> iterator;
+    typedef iterator_base<true> const_iterator;
+
+    flatmap() : nUnused(0), nSize(0), nDeleted(0) {}
+
+    flatmap(flatmap&& other) : hasher(other.hasher), vSlots(std::move(other.vSlots)), vChunks(std::move(other.vChunks)),
+        vFree(std::move(other.vFree)), nUnused(other.nUnused), nSize(other.nSize), nDeleted(other.nDeleted)
+    {
+        other.vSlots.clear();
+        other.vChunks.clear();
+        other.vFree.clear();
+        other.nUnused = 0;
+        other.nSize = 0;
+        other.nDeleted = 0;
+    }
+
+    flatmap(const flatmap&) = delete;
+    flatmap& operator=(const flatmap&) = delete;
+
+    ~flatmap() { clear(); }
+
+    iterator begin() { return iterator(this, NextUsed(0)); }
+    iterator end() { return iterator(this, END); }
+    const_iterator begin() const { return const_iterator(this, NextUsed(0)); }
+    const_iterator end() const { return const_iterator(this, END); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return nSize == 0; }
+    size_type size() const { return nSize; }
+
+    iterator find(const K& key) { return iterator(this, Find(key)); }
+    const_iterator find(const K& key) const { return const_iterator(this, Find(key)); }
+    size_type count(const K& key) const { return Find(key) != END; }
+
+    /** Insert an entry constructed from args unless key is present */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args)
+    {
+        // Keep at most 3/4 of the slots used, tombstones included
+        if ((nSize + nDeleted + 1) * 4 > vSlots.size() * 3) {
+            size_t nSlots = vSlots.empty() ? (size_t)MIN_SLOTS : vSlots.size();
+            while ((nSize + 1) * 8 > nSlots * 3)
+                nSlots *= 2;
+            Rehash(nSlots);
+        }
+
+        size_t hash = hasher(key);
+        bool fFound;
+        size_t i = FindSlot(key, hash, fFound);
+        if (fFound)
+            return std::make_pair(iterator(this, vSlots[i].nIndex), false);
+
+        uint32_t nIndex = Allocate();
+        new (Get(nIndex)) value_type(key, i, std::forward<Args>(args)...);
+        vChunks[nIndex >> CHUNK_SHIFT]->nUsed |= (uint64_t)1 << (nIndex & (CHUNK_SIZE - 1));
+
+        if (vSlots[i].nIndex == SLOT_DELETED)
+            nDeleted--;
+        vSlots[i] = Slot{Tag(hash), nIndex};
+        nSize++;
+        return std::make_pair(iterator(this, nIndex), true);
+    }
+
+    std::pair<iterator, bool> emplace(const K& key, T&& value) { return try_emplace(key, std::move(value)); }
+    std::pair<iterator, bool> emplace(const K& key, const T& value) { return try_emplace(key, value); }
+
+    T& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    iterator erase(const_iterator it)
+    {
+        uint32_t nIndex = it.nIndex;
+        vSlots[Get(nIndex)->nSlot].nIndex = SLOT_DELETED;
+        nDeleted++;
+        nSize--;
+
+        Destroy(nIndex);
+        vFree.push_back(nIndex);
+        return iterator(this, NextUsed(nIndex + 1));
+    }
+
+    size_type erase(const K& key)
+    {
+        const_iterator it = find(key);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    /** Remove all entries and release the memory */
+    void clear()
+    {
+        for (uint32_t nIndex = NextUsed(0); nIndex != END; nIndex = NextUsed(nIndex + 1))
+            Destroy(nIndex);
+        std::vector<Slot>().swap(vSlots);
+        std::vector<std::unique_ptr<Chunk>>().swap(vChunks);
+        std::vector<uint32_t>().swap(vFree);
+        nUnused = 0;
+        nSize = 0;
+        nDeleted = 0;
+    }
+
+    // Sizes of the allocations, for memusage::DynamicUsage
+    size_t index_bytes() const { return vSlots.capacity() * sizeof(Slot); }
+    size_t chunk_bytes() const { return sizeof(Chunk); }
+    size_t chunk_count() const { return vChunks.size(); }
+    size_t chunk_list_bytes() const { return vChunks.capacity() * sizeof(std::unique_ptr<Chunk>); }
+    size_t free_list_bytes() const { return vFree.capacity() * sizeof(uint32_t); }
+};
+
+#endif // BITCOIN_FLATMAP_H
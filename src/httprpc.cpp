@@ -7,8 +7,10 @@
 #include <base58.h>
 #include <chainparams.h>
 #include <httpserver.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <rpc/stats.h>
 #include <random.h>
 #include <sync.h>
 #include <util.h>
@@ -81,6 +83,15 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/** Terminate a chunked reply that failed after part of it was sent. The
+ * status line is gone already, the client sees a truncated JSON body.
+ */
+static void StreamedReplyAbort(HTTPRequest* req, const std::string& strError)
+{
+    LogPrintf("ThreadRPCServer streamed reply aborted: %s\n", strError);
+    req->WriteReplyEnd();
+}
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -142,14 +153,9 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
-static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
+/** Check the authorization header of req, replying with 401 if it fails */
+static bool HTTPAuthorized(HTTPRequest* req, std::string& strAuthUsernameOut)
 {
-    // JSONRPC handles only POST
-    if (req->GetRequestMethod() != HTTPRequest::POST) {
-        req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
-        return false;
-    }
-    // Check authorization
     std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
     if (!authHeader.first) {
         req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
@@ -157,8 +163,7 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         return false;
     }
 
-    JSONRPCRequest jreq;
-    if (!RPCAuthorized(authHeader.second, jreq.authUser)) {
+    if (!RPCAuthorized(authHeader.second, strAuthUsernameOut)) {
         LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
 
         /* Deter brute-forcing
@@ -170,6 +175,51 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteReply(HTTP_UNAUTHORIZED);
         return false;
     }
+    return true;
+}
+
+static bool HTTPReq_Metrics(HTTPRequest* req, const std::string &)
+{
+    if (req->GetRequestMethod() != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "Metrics are only served for GET requests");
+        return false;
+    }
+    std::string strAuthUser;
+    if (!HTTPAuthorized(req, strAuthUser))
+        return false;
+
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, RPCStatsToPrometheus());
+    return true;
+}
+
+static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
+{
+    int64_t nQueueWait = GetTimeMicros() - req->GetTimeReceived();
+
+    // JSONRPC handles only POST
+    if (req->GetRequestMethod() != HTTPRequest::POST) {
+        req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
+        return false;
+    }
+    // Check authorization
+    JSONRPCRequest jreq;
+    if (!HTTPAuthorized(req, jreq.authUser))
+        return false;
+
+    // Results written to the stream switch the reply to chunked transfer
+    // encoding once more than one chunk has been produced.
+    bool fChunked = false;
+    JSONStreamWriter stream([req, &fChunked](const std::string& strChunk) {
+        if (!fChunked) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReplyStart(HTTP_OK);
+            fChunked = true;
+            if (!req->WriteReplyChunk("{\"result\":"))
+                return false;
+        }
+        return req->WriteReplyChunk(strChunk);
+    });
 
     try {
         // Parse request
@@ -184,24 +234,51 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         // singleton request
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
+            jreq.stream = &stream;
+            if (tableRPC[jreq.strMethod])
+                g_rpc_stats.RecordQueue(jreq.strMethod, nQueueWait);
 
             UniValue result = tableRPC.execute(jreq);
 
-            // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            int64_t nSerializeStart = GetTimeMicros();
+            if (stream.HasOutput()) {
+                assert(stream.IsComplete());
+                // Remainder of the reply object, same layout as JSONRPCReplyObj
+                std::string strTail = ",\"error\":" + NullUniValue.write() + ",\"id\":" + jreq.id.write() + "}\n";
+                if (fChunked) {
+                    req->WriteReplyChunk(stream.TakeBuffer() + strTail);
+                    req->WriteReplyEnd();
+                    g_rpc_stats.RecordReply(jreq.strMethod, GetTimeMicros() - nSerializeStart, req->GetReplySize());
+                    return true;
+                }
+                strReply = "{\"result\":" + stream.TakeBuffer() + strTail;
+            } else {
+                // Send reply
+                strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            }
+            g_rpc_stats.RecordReply(jreq.strMethod, GetTimeMicros() - nSerializeStart, strReply.size());
 
         // array of requests
-        } else if (valRequest.isArray())
+        } else if (valRequest.isArray()) {
+            g_rpc_stats.RecordQueue(RPC_STATS_BATCH, nQueueWait);
             strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
-        else
+        } else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
+        if (fChunked) {
+            StreamedReplyAbort(req, find_value(objError, "message").getValStr());
+            return false;
+        }
         JSONErrorReply(req, objError, jreq.id);
         return false;
     } catch (const std::exception& e) {
+        if (fChunked) {
+            StreamedReplyAbort(req, e.what());
+            return false;
+        }
         JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
         return false;
     }
@@ -237,6 +314,8 @@ bool StartHTTPRPC()
     // ifdef can be removed once we switch to better endpoint support and API versioning
     RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
 #endif
+    if (gArgs.GetBoolArg("-rpcmetrics", DEFAULT_RPC_METRICS))
+        RegisterHTTPHandler("/metrics", true, HTTPReq_Metrics);
     assert(EventBase());
     httpRPCTimerInterface = MakeUnique<HTTPRPCTimerInterface>(EventBase());
     RPCSetTimerInterface(httpRPCTimerInterface.get());
@@ -252,6 +331,7 @@ void StopHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Stopping HTTP RPC server\n");
     UnregisterHTTPHandler("/", true);
+    UnregisterHTTPHandler("/metrics", true);
     if (httpRPCTimerInterface) {
         RPCUnsetTimerInterface(httpRPCTimerInterface.get());
         httpRPCTimerInterface.reset();
@@ -8,6 +8,9 @@
 #include <string>
 #include <map>
 
+/** Serve RPC statistics in Prometheus format at /metrics */
+static const bool DEFAULT_RPC_METRICS = false;
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
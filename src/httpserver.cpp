@@ -21,8 +21,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <future>
+#include <mutex>
 
+#include <event2/event.h>
 #include <event2/thread.h>
 #include <event2/buffer.h>
 #include <event2/bufferevent.h>
@@ -40,6 +45,27 @@
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
+/** Maximum amount of chunked reply data waiting to be sent before the writer blocks */
+static const size_t MAX_REPLY_STREAM_BACKLOG = 4 * 1024 * 1024;
+
+/** Flow control state of a chunked reply, shared between the worker
+ * producing the reply and the http thread sending it.
+ */
+struct HTTPReplyStream
+{
+    std::mutex cs;
+    std::condition_variable cond;
+    //! Bytes handed to the http thread that have not been written to the socket yet
+    size_t nBacklog;
+    //! Bytes passed to libevent by the http thread since the last completed write
+    size_t nBuffered;
+    //! Set when the connection is gone or the client stopped reading
+    bool fClosed;
+    //! How long a writer waits for the backlog to drain
+    int64_t nTimeout;
+
+    explicit HTTPReplyStream(int64_t nTimeoutIn) : nBacklog(0), nBuffered(0), fClosed(false), nTimeout(nTimeoutIn) {}
+};
 
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
@@ -96,6 +122,17 @@ public:
         cond.notify_one();
         return true;
     }
+    /** Number of items waiting for a worker thread */
+    size_t Depth()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return queue.size();
+    }
+    /** Maximum number of waiting items before requests are rejected */
+    size_t MaxDepth() const
+    {
+        return maxDepth;
+    }
     /** Thread function */
     void Run()
     {
@@ -144,6 +181,10 @@ struct evhttp* eventHTTP = nullptr;
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
 static WorkQueue<HTTPClosure>* workQueue = nullptr;
+//! Number of threads serving the work queue
+static std::atomic<int> nWorkQueueThreads(0);
+//! Requests rejected because the work queue was full
+static std::atomic<uint64_t> nWorkQueueRejected(0);
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -264,6 +305,7 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
             item.release(); /* if true, queue took ownership */
         else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            nWorkQueueRejected++;
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
@@ -435,6 +477,18 @@ bool StartHTTPServer()
     for (int i = 0; i < rpcThreads; i++) {
         g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
     }
+    nWorkQueueThreads = rpcThreads;
+    return true;
+}
+
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats)
+{
+    if (!workQueue || nWorkQueueThreads == 0)
+        return false;
+    stats.nDepth = workQueue->Depth();
+    stats.nMaxDepth = workQueue->MaxDepth();
+    stats.nThreads = nWorkQueueThreads;
+    stats.nRejected = nWorkQueueRejected;
     return true;
 }
 
@@ -524,7 +578,9 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       nTimeReceived(GetTimeMicros()),
+                                                       nReplySize(0)
 {
 }
 HTTPRequest::~HTTPRequest()
@@ -532,7 +588,10 @@ HTTPRequest::~HTTPRequest()
     if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
-        WriteReply(HTTP_INTERNAL, "Unhandled request");
+        if (replyStream)
+            WriteReplyEnd();
+        else
+            WriteReply(HTTP_INTERNAL, "Unhandled request");
     }
     // evhttpd cleans up the request, as long as a reply was sent.
 }
@@ -575,6 +634,22 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket once a reply is complete. This is the
+ * second part of the libevent workaround in http_request_cb.
+ */
+static void http_reply_done(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -582,25 +657,103 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
-    assert(!replySent && req);
+    assert(!replySent && req && !replyStream);
     // Send event to main http thread to send reply message
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
     evbuffer_add(evb, strReply.data(), strReply.size());
+    nReplySize += strReply.size();
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        http_reply_done(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/** Called by libevent when all queued output of a connection has been written */
+static void http_reply_stream_written_cb(struct evhttp_connection*, void* arg)
+{
+    HTTPReplyStream* stream = static_cast<HTTPReplyStream*>(arg);
+    std::unique_lock<std::mutex> lock(stream->cs);
+    stream->nBacklog -= stream->nBuffered;
+    stream->nBuffered = 0;
+    stream->cond.notify_all();
+}
+
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && req && !replyStream);
+    replyStream = std::make_shared<HTTPReplyStream>(gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(!replySent && req && replyStream);
+    if (strChunk.empty())
+        return true;
+    {
+        std::unique_lock<std::mutex> lock(replyStream->cs);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(replyStream->nTimeout);
+        while (!replyStream->fClosed && replyStream->nBacklog >= MAX_REPLY_STREAM_BACKLOG) {
+            if (replyStream->cond.wait_until(lock, deadline) == std::cv_status::timeout) {
+                LogPrint(BCLog::HTTP, "Client stopped reading chunked reply, dropping it\n");
+                replyStream->fClosed = true;
             }
         }
+        if (replyStream->fClosed)
+            return false;
+        replyStream->nBacklog += strChunk.size();
+    }
+
+    // Copy into an evbuffer here so the http thread only has to move it
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    nReplySize += strChunk.size();
+    auto req_copy = req;
+    std::shared_ptr<HTTPReplyStream> stream = replyStream;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, stream, evb]{
+        size_t nSize = evbuffer_get_length(evb);
+        if (evhttp_request_get_connection(req_copy) == nullptr) {
+            // Client went away, libevent keeps the request until the reply is ended
+            std::unique_lock<std::mutex> lock(stream->cs);
+            stream->fClosed = true;
+            stream->cond.notify_all();
+        } else {
+            {
+                std::unique_lock<std::mutex> lock(stream->cs);
+                stream->nBuffered += nSize;
+            }
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+            evhttp_send_reply_chunk_with_cb(req_copy, evb, http_reply_stream_written_cb, stream.get());
+#else
+            evhttp_send_reply_chunk(req_copy, evb);
+            http_reply_stream_written_cb(nullptr, stream.get());
+#endif
+        }
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(!replySent && req && replyStream);
+    auto req_copy = req;
+    // The stream must outlive any write callback registered before this event
+    std::shared_ptr<HTTPReplyStream> stream = replyStream;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, stream]{
+        evhttp_send_reply_end(req_copy);
+        http_reply_done(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
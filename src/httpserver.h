@@ -8,6 +8,7 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
@@ -17,6 +18,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPReplyStream;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -32,6 +34,20 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** Snapshot of the HTTP work queue, for monitoring */
+struct HTTPWorkQueueStats
+{
+    size_t nDepth;
+    size_t nMaxDepth;
+    int nThreads;
+    uint64_t nRejected;
+};
+
+/** Get the current state of the HTTP work queue.
+ * Returns false if the HTTP server is not running.
+ */
+bool GetHTTPWorkQueueStats(HTTPWorkQueueStats& stats);
+
 /** Change logging level for libevent. Removes BCLog::LIBEVENT from logCategories if
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
@@ -59,6 +75,9 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    std::shared_ptr<HTTPReplyStream> replyStream;
+    int64_t nTimeReceived;
+    size_t nReplySize;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -90,6 +109,16 @@ public:
      */
     std::pair<bool, std::string> GetHeader(const std::string& hdr);
 
+    /** Time (in microseconds) at which the request was received, before it
+     * was queued for a worker thread.
+     */
+    int64_t GetTimeReceived() const { return nTimeReceived; }
+
+    /** Number of reply body bytes handed to libevent so far.
+     * Unlike other methods this may still be called after the reply was sent.
+     */
+    size_t GetReplySize() const { return nReplySize; }
+
     /**
      * Read request body.
      *
@@ -114,6 +143,33 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, for bodies that are produced incrementally.
+     * nStatus is the HTTP status code to send.
+     *
+     * @note call WriteHeader before this. Follow up with WriteReplyChunk
+     * and finish with WriteReplyEnd instead of calling WriteReply.
+     */
+    void WriteReplyStart(int nStatus);
+
+    /**
+     * Send the next part of a chunked reply. Blocks while too much earlier
+     * output is still waiting to be written to the client, so a slow reader
+     * bounds the memory held for the reply.
+     *
+     * @returns false if the client went away or did not read within the
+     * server timeout. Any further chunks are discarded.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply.
+     *
+     * @note Same as for WriteReply, do not call any other HTTPRequest
+     * methods after calling this.
+     */
+    void WriteReplyEnd();
 };
 
 /** Event handler closure.
@@ -25,6 +25,7 @@
 #include "netbase.h"
 #include "net.h"
 #include "net_processing.h"
+#include "opreturnindex.h"
 #include "policy/feerate.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
@@ -169,6 +170,8 @@ void Interrupt()
     InterruptRPC();
     InterruptREST();
     InterruptTorControl();
+    if (g_opreturn_index)
+        g_opreturn_index->Interrupt();
     if (g_connman)
         g_connman->Interrupt();
 }
@@ -240,6 +243,12 @@ void Shutdown()
     // CValidationInterface callbacks, flush them...
     GetMainSignals().FlushBackgroundCallbacks();
 
+    // Stop the OP_RETURN index only after flushing background callbacks
+    if (g_opreturn_index) {
+        g_opreturn_index->Stop();
+        g_opreturn_index.reset();
+    }
+
     // Any future callbacks will be dropped. This should absolutely be safe - if
     // missing a callback results in an unrecoverable situation, unclean shutdown
     // would too. The only reason to do the above flushes is to let the wallet catch
@@ -257,6 +266,7 @@ void Shutdown()
         pblocktree.reset();
         psidechaintree.reset();
         popreturndb.reset();
+        pblockstatsdb.reset();
     }
 #ifdef ENABLE_WALLET
     StopWallets();
@@ -317,12 +327,15 @@ static void registerSignalHandler(int signal, void(*handler)(int))
 void OnRPCStarted()
 {
     uiInterface.NotifyBlockTip.connect(&RPCNotifyBlockChange);
+    uiInterface.NotifyBlockTip.connect(&RPCNotifySidechainChange);
 }
 
 void OnRPCStopped()
 {
     uiInterface.NotifyBlockTip.disconnect(&RPCNotifyBlockChange);
+    uiInterface.NotifyBlockTip.disconnect(&RPCNotifySidechainChange);
     RPCNotifyBlockChange(false, nullptr);
+    RPCNotifySidechainChange(false, nullptr);
     cvBlockChange.notify_all();
     LogPrint(BCLog::RPC, "RPC stopped.\n");
 }
@@ -342,6 +355,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-version", _("Print version and exit"));
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
     strUsage +=HelpMessageOpt("-assumevalid=<hex>", strprintf(_("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)"), defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()));
+    strUsage += HelpMessageOpt("-assumeutxo=<height>:<hash>", _("Trust the UTXO snapshot of the block at this height with this hash in loadtxoutset (can be specified multiple times)"));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     if (showDebug)
@@ -356,6 +370,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-datadir=<dir>", _("Specify data directory"));
     if (showDebug) {
         strUsage += HelpMessageOpt("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize));
+        strUsage += HelpMessageOpt("-dbblockcache=<db>:<n>", strprintf("Percentage of the cache of database <db> (chainstate, index, sidechain, opreturn or stats) used for the LevelDB block cache, the rest goes to the write buffers (10 to 90, default: %d)", DEFAULT_DB_BLOCK_CACHE_PERCENT));
+        strUsage += HelpMessageOpt("-dbbloombits=<db>:<n>", strprintf("Bits per key of the bloom filters of database <db>, 0 for none (default: %d)", DEFAULT_DB_BLOOM_BITS));
+        strUsage += HelpMessageOpt("-dbcompactinterval=<n>", strprintf("Compact the sidechain and OP_RETURN databases every <n> hours (default: %d = disabled)", DEFAULT_DB_COMPACT_INTERVAL));
+        strUsage += HelpMessageOpt("-dbcompression=<db>:<n>", strprintf("Compress the tables of database <db> with Snappy when LevelDB was built with it (default: %u)", DEFAULT_DB_COMPRESSION));
+        strUsage += HelpMessageOpt("-dbmaxopenfiles=<db>:<n>", strprintf("Maximum number of table files of database <db> kept open (default: %d)", DEFAULT_DB_MAX_OPEN_FILES));
     }
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
     strUsage += HelpMessageOpt("-debuglogfile=<file>", strprintf(_("Specify location of debug log file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)"), DEFAULT_DEBUGLOGFILE));
@@ -368,17 +387,20 @@ std::string HelpMessage(HelpMessageMode mode)
     if (showDebug) {
         strUsage += HelpMessageOpt("-minimumchainwork=<hex>", strprintf("Minimum work assumed to exist on a valid chain in hex (default: %s, testnet: %s)", defaultChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnetChainParams->GetConsensus().nMinimumChainWork.GetHex()));
     }
+    strUsage += HelpMessageOpt("-opreturnsearch", strprintf(_("Maintain a word index of OP_RETURN data, used by the searchopreturn rpc call and the GUI search (default: %u)"), DEFAULT_OPRETURN_SEARCH));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
     strUsage += HelpMessageOpt("-persistmempool", strprintf(_("Whether to save the mempool on shutdown and load on restart (default: %u)"), DEFAULT_PERSIST_MEMPOOL));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
+    strUsage += HelpMessageOpt("-prefetchblocks=<n>", strprintf(_("Number of blocks to read and check ahead on other threads while connecting blocks from disk (0 to disable, default: %d)"), DEFAULT_PREFETCH_BLOCKS));
     strUsage += HelpMessageOpt("-prune=<n>", strprintf(_("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks, and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex and -rescan. "
             "Warning: Reverting this setting requires re-downloading the entire blockchain. "
             "(default: 0 = disable pruning blocks, 1 = allow manual pruning via RPC, >%u = automatically prune block files to stay under the specified target size in MiB)"), MIN_DISK_SPACE_FOR_BLOCK_FILES / 1024 / 1024));
     strUsage += HelpMessageOpt("-reindex", _("Rebuild chain state and block index from the blk*.dat files on disk"));
     strUsage += HelpMessageOpt("-reindex-chainstate", _("Rebuild chain state from the currently indexed blocks"));
+    strUsage += HelpMessageOpt("-fastreindex", strprintf(_("With -reindex, rebuild the block index from the block headers, reading the block files on several threads. The blocks are checked when they are connected (default: %u)"), DEFAULT_FAST_REINDEX));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-sysperms", _("Create new files with system default permissions, instead of umask 077 (only effective with disabled wallet functionality)"));
 #endif
@@ -511,6 +533,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-rpcauth=<userpw>", _("Username and hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcuser. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times"));
     strUsage += HelpMessageOpt("-rpcbind=<addr>[:port]", _("Bind to given address to listen for JSON-RPC connections. This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -rpcallowip has been specified, 0.0.0.0 and :: i.e., all addresses)"));
     strUsage += HelpMessageOpt("-rpccookiefile=<loc>", _("Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)"));
+    strUsage += HelpMessageOpt("-rpcmetrics", strprintf(_("Serve RPC and REST latency statistics in Prometheus format at /metrics, using the same authentication as JSON-RPC (default: %u)"), DEFAULT_RPC_METRICS));
     strUsage += HelpMessageOpt("-rpcpassword=<pw>", _("Password for JSON-RPC connections"));
     strUsage += HelpMessageOpt("-rpcport=<port>", strprintf(_("Listen for JSON-RPC connections on <port> (default: %u or testnet: %u)"), defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort()));
     strUsage += HelpMessageOpt("-rpcserialversion", strprintf(_("Sets the serialization of raw transaction or block hex returned in non-verbose mode, non-segwit(0) or segwit(1) (default: %d)"), DEFAULT_RPC_SERIALIZE_VERSION));
@@ -629,6 +652,17 @@ void CleanupBlockRevFiles()
     }
 }
 
+/** Compact the sidechain and OP_RETURN databases, see -dbcompactinterval */
+static void CompactSidechainDBs()
+{
+    const std::pair<const char*, const CDBWrapper*> dbs[] = {{"sidechain", psidechaintree.get()}, {"opreturn", popreturndb.get()}};
+    for (const auto& db : dbs) {
+        int64_t nStart = GetTimeMillis();
+        db.second->CompactAll();
+        LogPrintf("Compacted the %s database in %dms\n", db.first, GetTimeMillis() - nStart);
+    }
+}
+
 void ThreadImport(std::vector<fs::path> vImportFiles)
 {
     const CChainParams& chainparams = Params();
@@ -639,17 +673,21 @@ void ThreadImport(std::vector<fs::path> vImportFiles)
 
     // -reindex
     if (fReindex) {
-        int nFile = 0;
-        while (true) {
-            CDiskBlockPos pos(nFile, 0);
-            if (!fs::exists(GetBlockPosFilename(pos, "blk")))
-                break; // No block files left to reindex
-            FILE *file = OpenBlockFile(pos, true);
-            if (!file)
-                break; // This error is logged in OpenBlockFile
-            LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
-            LoadExternalBlockFile(chainparams, file, &pos);
-            nFile++;
+        if (gArgs.GetBoolArg("-fastreindex", DEFAULT_FAST_REINDEX)) {
+            ReindexBlockFiles(chainparams);
+        } else {
+            int nFile = 0;
+            while (true) {
+                CDiskBlockPos pos(nFile, 0);
+                if (!fs::exists(GetBlockPosFilename(pos, "blk")))
+                    break; // No block files left to reindex
+                FILE *file = OpenBlockFile(pos, true);
+                if (!file)
+                    break; // This error is logged in OpenBlockFile
+                LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
+                LoadExternalBlockFile(chainparams, file, &pos);
+                nFile++;
+            }
         }
         pblocktree->WriteReindexing(false);
         fReindex = false;
@@ -1014,6 +1052,12 @@ bool AppInitParameterInteraction()
         LogPrintf("Warning: nMinimumChainWork set below default value of %s\n", chainparams.GetConsensus().nMinimumChainWork.GetHex());
     }
 
+    std::string strDBOptionError;
+    if (!CheckDBOptionArgs(strDBOptionError))
+        return InitError(strDBOptionError);
+    if (gArgs.GetArg("-dbcompactinterval", DEFAULT_DB_COMPACT_INTERVAL) < 0)
+        return InitError("-dbcompactinterval can't be negative");
+
     // mempool limits
     int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     int64_t nMempoolSizeMin = gArgs.GetArg("-limitdescendantsize", DEFAULT_DESCENDANT_SIZE_LIMIT) * 1000 * 40;
@@ -1455,6 +1499,8 @@ bool AppInitMain()
                 psidechaintree.reset(new CSidechainTreeDB(nSidechainTreeDBCache, false, fReset));
                 popreturndb.reset();
                 popreturndb.reset(new OPReturnDB(nOPReturnCache, false, fReset));
+                pblockstatsdb.reset();
+                pblockstatsdb.reset(new CBlockStatsDB(nBlockStatsCache, false, fReset));
 
                 if (fReset) {
                     pblocktree->WriteReindexing(true);
@@ -1537,6 +1583,15 @@ bool AppInitMain()
 
     		    drivechainsEnabled = IsDrivechainEnabled(chainActive.Tip(), chainparams.GetConsensus());
 
+                // Blocks connected after the last flush of the sidechain tree
+                // are connected again from the coins best block, which writes
+                // their sidechain data again
+                uint256 hashSidechainBest;
+                if (chainActive.Tip() && psidechaintree->ReadBestBlock(hashSidechainBest) && hashSidechainBest != chainActive.Tip()->GetBlockHash()) {
+                    LogPrintf("%s: Sidechain database best block %s, replaying sidechain data from %s\n", __func__,
+                            hashSidechainBest.ToString(), chainActive.Tip()->GetBlockHash().ToString());
+                }
+
                 // Synchronize SCDB
                 if (drivechainsEnabled && !fReindex && chainActive.Tip() && (chainActive.Tip()->GetBlockHash() != scdb.GetHashBlockLastSeen()))
                 {
@@ -1607,6 +1662,11 @@ bool AppInitMain()
                         strLoadError = _("Corrupted block database detected");
                         break;
                     }
+
+                    if (!InitUTXOSetStats()) {
+                        strLoadError = _("Error computing the UTXO set statistics");
+                        break;
+                    }
                 }
 
                 // Load user's drivechain data
@@ -1666,6 +1726,10 @@ bool AppInitMain()
         LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
     }
 
+    int64_t nCompactInterval = gArgs.GetArg("-dbcompactinterval", DEFAULT_DB_COMPACT_INTERVAL);
+    if (nCompactInterval > 0)
+        scheduler.scheduleEvery(CompactSidechainDBs, nCompactInterval * 60 * 60 * 1000);
+
     fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
     CAutoFile est_filein(fsbridge::fopen(est_path, "rb"), SER_DISK, CLIENT_VERSION);
     // Allowed to fail as this file IS missing on first startup.
@@ -1673,6 +1737,10 @@ bool AppInitMain()
         ::feeEstimator.Read(est_filein);
     fFeeEstimatesInitialized = true;
 
+    // Index OP_RETURN outputs for CoinNews in the background
+    g_opreturn_index.reset(new OPReturnIndex());
+    g_opreturn_index->Start();
+
 
     // ********************************************************* Step 9: load wallet
 #ifdef ENABLE_WALLET
@@ -0,0 +1,674 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <opreturnindex.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <init.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <txdb.h>
+#include <undo.h>
+#include <util.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <functional>
+#include <set>
+
+std::unique_ptr<OPReturnIndex> g_opreturn_index;
+
+/** How often the catch-up thread logs its progress */
+static const int64_t SYNC_LOG_INTERVAL = 30; // seconds
+
+std::vector<OPReturnData> GetBlockOPReturnData(const CBlock& block, const std::vector<CAmount>& vFee)
+{
+    std::vector<OPReturnData> vData;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
+
+        unsigned int nSize = 0;
+        for (const CTxOut& o : tx.vout) {
+            const CScript& scriptPubKey = o.scriptPubKey;
+            if (scriptPubKey.empty() || scriptPubKey[0] != OP_RETURN)
+                continue;
+
+            if (!nSize)
+                nSize = ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
+
+            OPReturnData data;
+            data.txid = tx.GetHash();
+            data.script = scriptPubKey;
+            data.nSize = nSize;
+            data.fees = i < vFee.size() ? vFee[i] : CAmount(0);
+
+            vData.push_back(data);
+        }
+    }
+    return vData;
+}
+
+std::vector<OPReturnNews> GetBlockNews(const CBlock& block, int nHeight, const std::vector<CAmount>& vFee)
+{
+    std::vector<OPReturnNews> vNews;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const CTransaction& tx = *block.vtx[i];
+
+        for (size_t j = 0; j < tx.vout.size(); j++) {
+            const CScript& scriptPubKey = tx.vout[j].scriptPubKey;
+            if (scriptPubKey.size() <= NEWS_HEADER_SIZE || scriptPubKey[0] != OP_RETURN)
+                continue;
+
+            OPReturnNews news;
+            news.txid = tx.GetHash();
+            news.n = j;
+            news.fees = i < vFee.size() ? vFee[i] : CAmount(0);
+            news.nTime = block.GetBlockTime();
+            news.nHeight = nHeight;
+            news.script = scriptPubKey;
+
+            vNews.push_back(news);
+        }
+    }
+    return vNews;
+}
+
+/** Append the words of vch with at least nMinSize bytes to vWord */
+static void AddSearchWords(const std::vector<unsigned char>& vch, size_t nMinSize, std::vector<std::string>& vWord)
+{
+    std::string word;
+    for (size_t i = 0; i <= vch.size(); i++) {
+        if (i < vch.size()) {
+            unsigned char c = vch[i];
+            if (c >= 'A' && c <= 'Z') {
+                word += (char)(c - 'A' + 'a');
+                continue;
+            }
+            if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+                word += (char)c;
+                continue;
+            }
+        }
+        if (word.size() >= nMinSize)
+            vWord.push_back(word.substr(0, OPRETURN_SEARCH_MAX_WORD));
+        word.clear();
+    }
+}
+
+/** Keep the first nMax distinct words */
+static std::vector<std::string> GetDistinctWords(const std::vector<std::string>& vWord, size_t nMax)
+{
+    std::vector<std::string> vDistinct;
+    std::set<std::string> setSeen;
+    for (const std::string& word : vWord) {
+        if (vDistinct.size() >= nMax)
+            break;
+        if (setSeen.insert(word).second)
+            vDistinct.push_back(word);
+    }
+    return vDistinct;
+}
+
+std::vector<std::string> GetOPReturnSearchWords(const CScript& script)
+{
+    std::vector<std::string> vWord;
+    if (script.empty() || script[0] != OP_RETURN)
+        return vWord;
+
+    // Split the data of each push, or the raw bytes when the payload isn't
+    // made of pushes (text written right after OP_RETURN)
+    CScript::const_iterator pc = script.begin() + 1;
+    while (pc < script.end()) {
+        opcodetype opcode;
+        std::vector<unsigned char> vch;
+        if (!script.GetOp(pc, opcode, vch) || opcode > OP_16) {
+            vWord.clear();
+            AddSearchWords(std::vector<unsigned char>(script.begin() + 1, script.end()), OPRETURN_SEARCH_MIN_WORD, vWord);
+            break;
+        }
+        AddSearchWords(vch, OPRETURN_SEARCH_MIN_WORD, vWord);
+    }
+    return GetDistinctWords(vWord, OPRETURN_SEARCH_MAX_WORDS);
+}
+
+std::vector<std::string> ParseOPReturnSearchQuery(const std::string& strQuery)
+{
+    std::vector<std::string> vWord;
+    AddSearchWords(std::vector<unsigned char>(strQuery.begin(), strQuery.end()), 1, vWord);
+    return GetDistinctWords(vWord, vWord.size());
+}
+
+std::vector<OPReturnSearchEntry> GetOPReturnSearchEntries(const std::vector<OPReturnData>& vData, const CBlockIndex* pindex)
+{
+    std::vector<OPReturnSearchEntry> vEntry;
+    for (size_t i = 0; i < vData.size(); i++) {
+        for (const std::string& word : GetOPReturnSearchWords(vData[i].script)) {
+            OPReturnSearchEntry entry;
+            entry.word = word;
+            entry.nHeight = pindex->nHeight;
+            entry.hashBlock = pindex->GetBlockHash();
+            entry.nData = i;
+            entry.txid = vData[i].txid;
+            entry.fees = vData[i].fees;
+            entry.nTime = pindex->GetBlockTime();
+            entry.script = vData[i].script;
+
+            vEntry.push_back(entry);
+        }
+    }
+    return vEntry;
+}
+
+/** Whether every word of the query starts a word of the script */
+static bool HasSearchWords(const CScript& script, const std::vector<std::string>& vQuery)
+{
+    std::vector<std::string> vWord = GetOPReturnSearchWords(script);
+    for (const std::string& query : vQuery) {
+        bool fFound = false;
+        for (const std::string& word : vWord) {
+            if (word.compare(0, query.size(), query) == 0) {
+                fFound = true;
+                break;
+            }
+        }
+        if (!fFound)
+            return false;
+    }
+    return true;
+}
+
+bool SearchOPReturn(const std::string& strQuery, size_t nMax, std::vector<OPReturnSearchEntry>& vResult)
+{
+    vResult.clear();
+
+    std::vector<std::string> vQuery = ParseOPReturnSearchQuery(strQuery);
+    if (vQuery.empty())
+        return false;
+
+    // The longest word should have the fewest entries
+    std::string strLookup;
+    for (const std::string& query : vQuery) {
+        if (query.size() > strLookup.size())
+            strLookup = query;
+    }
+    if (strLookup.size() < OPRETURN_SEARCH_MIN_WORD)
+        return false;
+
+    std::vector<OPReturnSearchEntry> vEntry;
+    if (!popreturndb->SearchWords(strLookup, OPRETURN_SEARCH_MAX_READ, vEntry))
+        return false;
+
+    // Entries are sorted by word, and an output may have several words
+    // starting with the one looked up
+    std::sort(vEntry.begin(), vEntry.end(), [](const OPReturnSearchEntry& a, const OPReturnSearchEntry& b) {
+        if (a.nHeight != b.nHeight)
+            return a.nHeight > b.nHeight;
+        if (a.hashBlock != b.hashBlock)
+            return a.hashBlock < b.hashBlock;
+        return a.nData < b.nData;
+    });
+
+    LOCK(cs_main);
+    for (size_t i = 0; i < vEntry.size() && vResult.size() < nMax; i++) {
+        const OPReturnSearchEntry& entry = vEntry[i];
+        if (i && entry.hashBlock == vEntry[i - 1].hashBlock && entry.nData == vEntry[i - 1].nData)
+            continue;
+
+        // Blocks disconnected while the index was stopped leave their
+        // entries behind
+        BlockMap::iterator mi = mapBlockIndex.find(entry.hashBlock);
+        if (mi == mapBlockIndex.end() || !chainActive.Contains(mi->second))
+            continue;
+
+        if (!HasSearchWords(entry.script, vQuery))
+            continue;
+
+        vResult.push_back(entry);
+    }
+    return true;
+}
+
+/** Whether a transaction other than the coinbase has OP_RETURN outputs, in
+ * which case the fees of the block are needed */
+static bool NeedBlockFees(const CBlock& block)
+{
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        for (const CTxOut& o : block.vtx[i]->vout) {
+            if (!o.scriptPubKey.empty() && o.scriptPubKey[0] == OP_RETURN)
+                return true;
+        }
+    }
+    return false;
+}
+
+OPReturnIndex::OPReturnIndex() :
+    fSynced(false),
+    pindexBest(nullptr),
+    nSyncThreads(std::max(1, std::min(GetNumCores(), MAX_OPRETURN_SYNC_THREADS))),
+    fSearch(gArgs.GetBoolArg("-opreturnsearch", DEFAULT_OPRETURN_SEARCH)),
+    pindexSyncStart(nullptr),
+    nSyncStartTime(0)
+{
+    interrupt.reset();
+}
+
+OPReturnIndex::~OPReturnIndex()
+{
+    Interrupt();
+    Stop();
+}
+
+void OPReturnIndex::Start()
+{
+    // Resume from the last block saved. Data of blocks after it which may
+    // have been written before a crash is simply written again.
+    CBlockLocator locator;
+    int nVersion = 0;
+    if (!popreturndb->ReadIndexVersion(nVersion) || nVersion != OPRETURN_INDEX_VERSION ||
+            popreturndb->HaveSearchIndex() != fSearch) {
+        LogPrintf("%s: Building the OP_RETURN index from scratch\n", __func__);
+        if (!popreturndb->WipeIndex(OPRETURN_INDEX_VERSION, fSearch))
+            LogPrintf("%s: Failed to wipe the OP_RETURN index\n", __func__);
+    } else if (popreturndb->ReadBestBlock(locator) && !locator.IsNull()) {
+        LOCK(cs_main);
+        pindexBest = FindForkInGlobalIndex(chainActive, locator);
+    }
+
+    RegisterValidationInterface(this);
+
+    threadSync = std::thread(&TraceThread<std::function<void()>>, "opreturnidx",
+            std::bind(&OPReturnIndex::ThreadSync, this));
+}
+
+void OPReturnIndex::Interrupt()
+{
+    interrupt();
+}
+
+void OPReturnIndex::Stop()
+{
+    UnregisterValidationInterface(this);
+
+    if (threadSync.joinable())
+        threadSync.join();
+}
+
+void OPReturnIndex::ThreadSync()
+{
+    const CBlockIndex* pindex = pindexBest.load();
+    int64_t nLastLog = 0;
+
+    pindexSyncStart = pindex;
+    nSyncStartTime = GetTimeMillis();
+
+    while (!fSynced) {
+        // Progress is saved with each batch
+        if (interrupt)
+            return;
+
+        std::vector<const CBlockIndex*> vIndex;
+        bool fStale = false;
+        {
+            LOCK(cs_main);
+            // The blocks up to the base of a loaded UTXO snapshot have no
+            // data, the index starts after it
+            if (pindexSnapshotBase && chainActive.Contains(pindexSnapshotBase) &&
+                    (!pindex || pindex->nHeight < pindexSnapshotBase->nHeight)) {
+                pindex = pindexSnapshotBase;
+                pindexBest = pindex;
+            }
+
+            if (pindex && !chainActive.Contains(pindex)) {
+                // The block was disconnected while we were not following
+                // the chain
+                fStale = true;
+            } else {
+                const CBlockIndex* pindexNext = pindex ? chainActive.Next(pindex) : chainActive.Genesis();
+                while (pindexNext && vIndex.size() < OPRETURN_SYNC_BATCH_SIZE) {
+                    vIndex.push_back(pindexNext);
+                    pindexNext = chainActive.Next(pindexNext);
+                }
+            }
+
+            // Follow notifications from here on. Blocks connected from now
+            // on are announced after this point in the notification queue.
+            if (vIndex.empty() && !fStale) {
+                pindexBest = pindex;
+                fSynced = true;
+                break;
+            }
+        }
+
+        if (fStale) {
+            // Take its news out before going back towards the fork point
+            CBlock block;
+            if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus()) || !EraseBlock(block, pindex)) {
+                LogPrintf("%s: Failed to remove stale block %s from the OP_RETURN index, index stopped\n",
+                        __func__, pindex->GetBlockHash().ToString());
+                return;
+            }
+            pindex = pindex->pprev;
+            pindexBest = pindex;
+            WriteBestBlock(pindex);
+            continue;
+        }
+
+        int64_t nNow = GetTime();
+        if (nLastLog + SYNC_LOG_INTERVAL < nNow) {
+            LogPrintf("Syncing OP_RETURN index with block chain from height %d\n", vIndex.front()->nHeight);
+            nLastLog = nNow;
+        }
+
+        std::vector<OPReturnBlock> vData;
+        if (!ReadBlocks(vIndex, vData)) {
+            if (!interrupt)
+                LogPrintf("%s: Failed to read blocks from height %d, OP_RETURN index stopped\n",
+                        __func__, vIndex.front()->nHeight);
+            return;
+        }
+
+        CBlockLocator locator;
+        {
+            LOCK(cs_main);
+            locator = chainActive.GetLocator(vIndex.back());
+        }
+        if (!popreturndb->WriteBlocks(vData, locator)) {
+            LogPrintf("%s: Failed to write blocks from height %d to the OP_RETURN index, index stopped\n",
+                    __func__, vIndex.front()->nHeight);
+            return;
+        }
+        pindex = vIndex.back();
+        pindexBest = pindex;
+    }
+
+    if (pindex)
+        LogPrintf("OP_RETURN index is enabled at height %d\n", pindex->nHeight);
+    else
+        LogPrintf("OP_RETURN index is enabled\n");
+}
+
+bool OPReturnIndex::ReadBlocks(const std::vector<const CBlockIndex*>& vIndex, std::vector<OPReturnBlock>& vData)
+{
+    vData.assign(vIndex.size(), OPReturnBlock());
+
+    std::atomic<size_t> nNext(0);
+    std::atomic<bool> fFailed(false);
+    auto read = [&]() {
+        while (!fFailed && !interrupt) {
+            size_t i = nNext++;
+            if (i >= vIndex.size())
+                return;
+
+            CBlock block;
+            if (!ReadBlockFromDisk(block, vIndex[i], Params().GetConsensus()) ||
+                    !GetBlockData(block, vIndex[i], vData[i])) {
+                LogPrintf("%s: Failed to read block %s\n", __func__, vIndex[i]->GetBlockHash().ToString());
+                fFailed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> vThread;
+    for (int i = 1; i < nSyncThreads && (size_t)i < vIndex.size(); i++)
+        vThread.emplace_back(read);
+    read();
+    for (std::thread& thread : vThread)
+        thread.join();
+
+    return !fFailed && !interrupt;
+}
+
+bool OPReturnIndex::BlockUntilSyncedToCurrentChain()
+{
+    if (!fSynced)
+        return false;
+
+    {
+        // Skip the queue if the index already has the tip. An index ahead
+        // of the tip still has to erase the disconnected blocks.
+        LOCK(cs_main);
+        const CBlockIndex* pindexTip = chainActive.Tip();
+        if (pindexTip && pindexBest.load() == pindexTip)
+            return true;
+    }
+
+    SyncWithValidationInterfaceQueue();
+    return true;
+}
+
+void OPReturnIndex::CacheBlockFees(const uint256& hashBlock, std::vector<CAmount>&& vFee)
+{
+    LOCK(cs_fees);
+
+    // Fees of blocks that are never announced (connected for VerifyDB, or
+    // while still catching up) must not pile up
+    if (mapBlockFees.size() >= MAX_OPRETURN_FEE_CACHE)
+        mapBlockFees.clear();
+
+    mapBlockFees[hashBlock] = std::move(vFee);
+}
+
+bool OPReturnIndex::Rebuild()
+{
+    LOCK(cs_rebuild);
+
+    Interrupt();
+    Stop();
+
+    // Let notifications already queued for the index finish before wiping
+    SyncWithValidationInterfaceQueue();
+
+    bool fWiped = popreturndb->WipeIndex(OPRETURN_INDEX_VERSION, fSearch);
+    if (!fWiped)
+        LogPrintf("%s: Failed to wipe the OP_RETURN index\n", __func__);
+
+    if (ShutdownRequested())
+        return false;
+
+    fSynced = false;
+    pindexBest = nullptr;
+    interrupt.reset();
+    {
+        LOCK(cs_fees);
+        mapBlockFees.clear();
+    }
+
+    Start();
+
+    return fWiped;
+}
+
+OPReturnIndexSummary OPReturnIndex::GetSummary() const
+{
+    OPReturnIndexSummary summary;
+    summary.fSynced = fSynced;
+    summary.nBestHeight = -1;
+    summary.progress = 0;
+    summary.nETA = -1;
+
+    const CBlockIndex* pindex = pindexBest.load();
+    if (pindex)
+        summary.nBestHeight = pindex->nHeight;
+
+    LOCK(cs_main);
+    const CBlockIndex* pindexTip = chainActive.Tip();
+    if (!pindexTip || !pindexTip->nChainTx)
+        return summary;
+
+    double nTxDone = pindex ? pindex->nChainTx : 0;
+    summary.progress = std::min(1.0, nTxDone / pindexTip->nChainTx);
+
+    if (summary.fSynced) {
+        summary.nETA = 0;
+        return summary;
+    }
+
+    // Extrapolate from the transactions indexed since the catch-up started
+    const CBlockIndex* pindexStart = pindexSyncStart.load();
+    double nTxStart = pindexStart ? pindexStart->nChainTx : 0;
+    int64_t nElapsed = GetTimeMillis() - nSyncStartTime;
+    if (nTxDone > nTxStart && nElapsed > 0)
+        summary.nETA = (pindexTip->nChainTx - nTxDone) * nElapsed / (nTxDone - nTxStart) / 1000;
+
+    return summary;
+}
+
+bool OPReturnIndex::GetBlockFees(const CBlock& block, const CBlockIndex* pindex, std::vector<CAmount>& vFee)
+{
+    {
+        LOCK(cs_fees);
+        auto it = mapBlockFees.find(pindex->GetBlockHash());
+        if (it != mapBlockFees.end()) {
+            vFee = std::move(it->second);
+            mapBlockFees.erase(it);
+            return true;
+        }
+    }
+
+    vFee.assign(block.vtx.size(), CAmount(0));
+    if (!NeedBlockFees(block))
+        return true;
+
+    // Compute the fees from the coins the block spent
+    CDiskBlockPos posUndo;
+    {
+        LOCK(cs_main);
+        posUndo = pindex->GetUndoPos();
+    }
+    CBlockUndo blockundo;
+    if (!UndoReadFromDisk(blockundo, posUndo, pindex->pprev->GetBlockHash()))
+        return false;
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size())
+        return false;
+
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        CAmount nValueIn = 0;
+        for (const Coin& coin : blockundo.vtxundo[i - 1].vprevout)
+            nValueIn += coin.out.nValue;
+        vFee[i] = nValueIn - block.vtx[i]->GetValueOut();
+    }
+    return true;
+}
+
+bool OPReturnIndex::GetBlockData(const CBlock& block, const CBlockIndex* pindex, OPReturnBlock& data)
+{
+    std::vector<CAmount> vFee;
+    if (!GetBlockFees(block, pindex, vFee))
+        return false;
+
+    data.hashBlock = pindex->GetBlockHash();
+    data.vData = GetBlockOPReturnData(block, vFee);
+    if (!data.vData.empty())
+        data.vNews = GetBlockNews(block, pindex->nHeight, vFee);
+    if (fSearch)
+        data.vSearch = GetOPReturnSearchEntries(data.vData, pindex);
+
+    return true;
+}
+
+bool OPReturnIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    OPReturnBlock data;
+    if (!GetBlockData(block, pindex, data))
+        return false;
+
+    if (data.vData.empty())
+        return true;
+
+    return popreturndb->WriteBlockData(data.hashBlock, data.vData, data.vNews, data.vSearch);
+}
+
+bool OPReturnIndex::EraseBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    std::vector<OPReturnData> vData;
+    if (!popreturndb->GetBlockData(pindex->GetBlockHash(), vData))
+        return true;
+
+    // The news keys include the fees, which the block data has
+    std::map<uint256, CAmount> mapFee;
+    for (const OPReturnData& data : vData)
+        mapFee[data.txid] = data.fees;
+
+    std::vector<CAmount> vFee(block.vtx.size(), CAmount(0));
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        auto it = mapFee.find(block.vtx[i]->GetHash());
+        if (it != mapFee.end())
+            vFee[i] = it->second;
+    }
+
+    std::vector<OPReturnNews> vNews = GetBlockNews(block, pindex->nHeight, vFee);
+
+    std::vector<OPReturnSearchEntry> vSearch;
+    if (fSearch)
+        vSearch = GetOPReturnSearchEntries(vData, pindex);
+
+    return popreturndb->EraseBlockData(pindex->GetBlockHash(), vNews, vSearch);
+}
+
+void OPReturnIndex::WriteBestBlock(const CBlockIndex* pindex)
+{
+    if (!pindex)
+        return;
+
+    LOCK(cs_main);
+    if (!popreturndb->WriteBestBlock(chainActive.GetLocator(pindex)))
+        LogPrintf("%s: Failed to write OP_RETURN index locator\n", __func__);
+}
+
+void OPReturnIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted)
+{
+    if (!fSynced)
+        return;
+
+    const CBlockIndex* pindexPrev = pindexBest.load();
+
+    // Announcements queued before the catch-up finished may be for blocks
+    // which are already written
+    if (pindexPrev && pindexPrev->GetAncestor(pindex->nHeight) == pindex)
+        return;
+
+    if (pindexPrev && pindex->pprev != pindexPrev) {
+        LogPrintf("%s: WARNING: Block %s does not connect to the OP_RETURN index best block %s\n",
+                __func__, pindex->GetBlockHash().ToString(), pindexPrev->GetBlockHash().ToString());
+        return;
+    }
+
+    if (!WriteBlock(*block, pindex)) {
+        LogPrintf("%s: Failed to write block %s to the OP_RETURN index\n",
+                __func__, pindex->GetBlockHash().ToString());
+        return;
+    }
+    pindexBest = pindex;
+}
+
+void OPReturnIndex::BlockDisconnected(const std::shared_ptr<const CBlock>& block)
+{
+    if (!fSynced)
+        return;
+
+    const CBlockIndex* pindex = pindexBest.load();
+    if (!pindex || pindex->GetBlockHash() != block->GetHash()) {
+        LogPrintf("%s: WARNING: Disconnected block %s is not the OP_RETURN index best block\n",
+                __func__, block->GetHash().ToString());
+        return;
+    }
+
+    if (!EraseBlock(*block, pindex))
+        LogPrintf("%s: Failed to erase block %s from the OP_RETURN index\n",
+                __func__, pindex->GetBlockHash().ToString());
+
+    pindexBest = pindex->pprev;
+}
+
+void OPReturnIndex::SetBestChain(const CBlockLocator& locator)
+{
+    if (!fSynced)
+        return;
+
+    // Save progress together with the chain state. The locator write is
+    // synced, which also makes the block data written before it durable.
+    WriteBestBlock(pindexBest.load());
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_OPRETURNINDEX_H
+#define BITCOIN_OPRETURNINDEX_H
+
+#include <amount.h>
+#include <sync.h>
+#include <threadinterrupt.h>
+#include <uint256.h>
+#include <validationinterface.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+struct OPReturnBlock;
+struct OPReturnData;
+struct OPReturnNews;
+struct OPReturnSearchEntry;
+class CScript;
+
+/** Maximum number of blocks whose fees are kept for the index to pick up */
+static const size_t MAX_OPRETURN_FEE_CACHE = 64;
+
+/** Version of the data the index writes. Data of older versions is built
+ * again from the blocks. */
+static const int OPRETURN_INDEX_VERSION = 2;
+
+/** Number of blocks read ahead and written in one batch while catching up */
+static const size_t OPRETURN_SYNC_BATCH_SIZE = 1000;
+
+/** Maximum number of threads reading blocks while catching up */
+static const int MAX_OPRETURN_SYNC_THREADS = 8;
+
+/** Default for -opreturnsearch, the word index of OP_RETURN outputs */
+static const bool DEFAULT_OPRETURN_SEARCH = false;
+
+/** Shorter words are neither indexed nor looked up */
+static const size_t OPRETURN_SEARCH_MIN_WORD = 3;
+
+/** Longer words are indexed and matched by their first bytes */
+static const size_t OPRETURN_SEARCH_MAX_WORD = 32;
+
+/** Maximum number of distinct words indexed per OP_RETURN output */
+static const size_t OPRETURN_SEARCH_MAX_WORDS = 16;
+
+/** Maximum number of search index entries read to answer a query */
+static const size_t OPRETURN_SEARCH_MAX_READ = 10000;
+
+/** Progress of the OP_RETURN index, as reported by getindexinfo */
+struct OPReturnIndexSummary
+{
+    bool fSynced;
+    //! Height of the last block written, -1 if none
+    int nBestHeight;
+    //! Share of the active chain's transactions that have been indexed
+    double progress;
+    //! Estimated seconds until caught up, -1 if unknown
+    int64_t nETA;
+};
+
+/**
+ * Maintains the OP_RETURN (CoinNews) data in OPReturnDB in the background,
+ * so that connecting a block does not pay for the news feature.
+ *
+ * On start the index catches up with the active chain from its own best
+ * block locator. After that it follows BlockConnected / BlockDisconnected
+ * notifications. Fees of OP_RETURN transactions are taken from what
+ * ConnectBlock already computed (see CacheBlockFees) or, while catching up,
+ * from the block's undo data.
+ *
+ * Catching up reads OPRETURN_SYNC_BATCH_SIZE blocks at a time on several
+ * threads and writes them together with the locator of the last one, so an
+ * interrupted catch-up resumes from the last batch. Rebuild wipes the index
+ * and catches up again from genesis while the node keeps running. On a node
+ * loaded from a UTXO snapshot the index starts after the snapshot's base.
+ *
+ * With -opreturnsearch the words of each output are written to a search
+ * index as well (see SearchOPReturn). Turning it on or off rebuilds the
+ * index.
+ */
+class OPReturnIndex final : public CValidationInterface
+{
+public:
+    OPReturnIndex();
+    ~OPReturnIndex();
+
+    /** Start catching up with the active chain and follow it afterwards */
+    void Start();
+
+    /** Make the catch-up thread stop at the next block */
+    void Interrupt();
+
+    /** Stop following the chain. Waits for the catch-up thread. */
+    void Stop();
+
+    /** Wait until the index has processed the current chain tip. Returns
+     * false right away if the initial catch-up is still running. Must not be
+     * called with cs_main held. */
+    bool BlockUntilSyncedToCurrentChain();
+
+    /** Remember the per-transaction fees of a block ConnectBlock just
+     * computed, so the index doesn't need to read the undo data */
+    void CacheBlockFees(const uint256& hashBlock, std::vector<CAmount>&& vFee);
+
+    /** Erase everything indexed and catch up again from genesis. Must not
+     * be called with cs_main held. */
+    bool Rebuild();
+
+    OPReturnIndexSummary GetSummary() const;
+
+    bool IsSearchEnabled() const { return fSearch; }
+
+protected:
+    void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block) override;
+    void SetBestChain(const CBlockLocator& locator) override;
+
+private:
+    void ThreadSync();
+
+    /** Get the fees of the block's transactions, from the cache if possible */
+    bool GetBlockFees(const CBlock& block, const CBlockIndex* pindex, std::vector<CAmount>& vFee);
+
+    /** Collect what the index writes for a block */
+    bool GetBlockData(const CBlock& block, const CBlockIndex* pindex, OPReturnBlock& data);
+
+    /** Read consecutive blocks from disk on the catch-up threads and collect
+     * their data, in order */
+    bool ReadBlocks(const std::vector<const CBlockIndex*>& vIndex, std::vector<OPReturnBlock>& vData);
+
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex);
+
+    /** Remove the data of a block that is no longer in the active chain */
+    bool EraseBlock(const CBlock& block, const CBlockIndex* pindex);
+
+    void WriteBestBlock(const CBlockIndex* pindex);
+
+    /** Whether the initial catch-up is done and notifications are followed */
+    std::atomic<bool> fSynced;
+
+    /** Last block whose data has been written */
+    std::atomic<const CBlockIndex*> pindexBest;
+
+    std::thread threadSync;
+    CThreadInterrupt interrupt;
+
+    /** Number of threads reading blocks while catching up */
+    const int nSyncThreads;
+
+    /** Whether the search index is written */
+    const bool fSearch;
+
+    /** Where and when the current catch-up started, for the ETA */
+    std::atomic<const CBlockIndex*> pindexSyncStart;
+    std::atomic<int64_t> nSyncStartTime;
+
+    /** Serializes Rebuild calls */
+    CCriticalSection cs_rebuild;
+
+    CCriticalSection cs_fees;
+    std::map<uint256, std::vector<CAmount>> mapBlockFees;
+};
+
+/** Collect the OP_RETURN outputs of a block, given the fee paid by each of
+ * its transactions */
+std::vector<OPReturnData> GetBlockOPReturnData(const CBlock& block, const std::vector<CAmount>& vFee);
+
+/** Collect the OP_RETURN outputs of a block that are long enough to carry a
+ * news header, as written to the news index */
+std::vector<OPReturnNews> GetBlockNews(const CBlock& block, int nHeight, const std::vector<CAmount>& vFee);
+
+/** The lower case words of the data an OP_RETURN script pushes, or of its
+ * raw bytes when it is not made of pushes: runs of ASCII letters and digits
+ * or of non-ASCII bytes, at most OPRETURN_SEARCH_MAX_WORDS of them */
+std::vector<std::string> GetOPReturnSearchWords(const CScript& script);
+
+/** The words of a search query, split like GetOPReturnSearchWords */
+std::vector<std::string> ParseOPReturnSearchQuery(const std::string& strQuery);
+
+/** Collect the search index entries of the OP_RETURN data of a block */
+std::vector<OPReturnSearchEntry> GetOPReturnSearchEntries(const std::vector<OPReturnData>& vData, const CBlockIndex* pindex);
+
+/**
+ * Find the OP_RETURN outputs of the active chain with, for each word of
+ * strQuery, a word starting with it, newest first. The longest word of the
+ * query is looked up in the search index. Returns false if the query has no
+ * word of at least OPRETURN_SEARCH_MIN_WORD characters, or the index can't
+ * be read.
+ */
+bool SearchOPReturn(const std::string& strQuery, size_t nMax, std::vector<OPReturnSearchEntry>& vResult);
+
+extern std::unique_ptr<OPReturnIndex> g_opreturn_index;
+
+#endif // BITCOIN_OPRETURNINDEX_H
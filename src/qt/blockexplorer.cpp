@@ -57,8 +57,6 @@ BlockExplorer::BlockExplorer(const PlatformStyle *_platformStyle, QWidget *paren
 
     ui->tableViewBlocks->setStyleSheet(style);
 
-    connect(this, SIGNAL(UpdateTable()), blockExplorerModel, SLOT(UpdateModel()));
-    connect(blockExplorerModel, SIGNAL(columnsInserted(QModelIndex, int, int)), this, SLOT(scrollRight()));
 }
 
 BlockExplorer::~BlockExplorer()
@@ -75,15 +73,17 @@ void BlockExplorer::numBlocksChanged(int nHeight, const QDateTime& time)
 {
     ui->labelNumBlocks->setText(QString::number(nHeight));
     ui->labelBlockTime->setText(time.toString("dd MMMM yyyy hh:mm"));
-
-    // Update the table model if the explorer is open
-    if (this->isVisible())
-        Q_EMIT(UpdateTable());
 }
 
 void BlockExplorer::setClientModel(ClientModel *model)
 {
     this->clientModel = model;
+
+    // The table model lists the blocks of the client model's block summary
+    // cache, the dialog loads blocks through it
+    blockExplorerModel->setClientModel(model);
+    blockIndexDialog->setClientModel(model);
+
     if(model)
     {
         connect(model, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
@@ -132,15 +132,10 @@ void BlockExplorer::on_tableViewBlocks_doubleClicked(const QModelIndex& index)
     blockIndexDialog->show();
 }
 
-void BlockExplorer::scrollRight()
-{
-    int nMax = ui->tableViewBlocks->horizontalScrollBar()->maximum();
-    ui->tableViewBlocks->horizontalScrollBar()->setValue(nMax);
-}
-
 void BlockExplorer::updateOnShow()
 {
-    Q_EMIT(UpdateTable());
+    // The newest block is on the left
+    ui->tableViewBlocks->horizontalScrollBar()->setValue(0);
 }
 
 void BlockExplorer::on_lineEditSearch_returnPressed()
@@ -32,7 +32,6 @@ public:
 
 public Q_SLOTS:
     void updateOnShow();
-    void scrollRight();
 
 private Q_SLOTS:
     void on_pushButtonSearch_clicked();
@@ -50,9 +49,6 @@ private:
     BlockIndexDetailsDialog* blockIndexDialog = nullptr;
 
     void Search();
-
-Q_SIGNALS:
-    void UpdateTable();
 };
 
 #endif // BLOCKEXPLORER_H
@@ -4,29 +4,35 @@
 
 #include <qt/blockexplorertablemodel.h>
 
+#include <qt/blocksummarycache.h>
+#include <qt/clientmodel.h>
+#include <qt/drivenetunits.h>
+#include <qt/guiutil.h>
+
 #include <chain.h>
 #include <validation.h>
 
+#include <algorithm>
+
 #include <QDateTime>
 #include <QIcon>
-#include <QMetaType>
 #include <QVariant>
 
-Q_DECLARE_METATYPE(BlockExplorerTableObject)
-
 BlockExplorerTableModel::BlockExplorerTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
+    nTipHeight = -1;
+    nColumns = 0;
 }
 
 int BlockExplorerTableModel::rowCount(const QModelIndex & /*parent*/) const
 {
-    return 6;
+    return 10;
 }
 
 int BlockExplorerTableModel::columnCount(const QModelIndex & /*parent*/) const
 {
-    return model.size();
+    return nColumns;
 }
 
 QVariant BlockExplorerTableModel::data(const QModelIndex &index, int role) const
@@ -38,10 +44,15 @@ QVariant BlockExplorerTableModel::data(const QModelIndex &index, int role) const
     int row = index.row();
     int col = index.column();
 
-    if (!model.at(col).canConvert<BlockExplorerTableObject>())
+    // The summary is loaded in the background if it isn't cached yet, the
+    // column is updated once it is in
+    int nHeight = nTipHeight - col;
+    BlockSummary object;
+    if (!cache || !cache->getSummary(nHeight, object)) {
+        if ((role == Qt::DisplayRole && row == 0) || role == HeightRole)
+            return nHeight;
         return QVariant();
-
-    BlockExplorerTableObject object = model.at(col).value<BlockExplorerTableObject>();
+    }
 
     switch (role) {
     case Qt::DisplayRole:
@@ -70,6 +81,31 @@ QVariant BlockExplorerTableModel::data(const QModelIndex &index, int role) const
         if (row == 5) {
             return QString::fromStdString(strprintf("%08x", object.nBits));
         }
+        // Transactions
+        if (row == 6) {
+            return object.nTx;
+        }
+        // Statistics, missing for blocks connected before the statistics
+        // index existed
+        if (!object.fStats) {
+            return QString("?");
+        }
+        // Size
+        if (row == 7) {
+            return GUIUtil::formatBytes(object.nSize);
+        }
+        // Fees
+        if (row == 8) {
+            return DrivenetUnits::formatWithUnit(DrivenetUnits::BTC, object.nFees);
+        }
+        // Sidechain deposits & withdrawals
+        if (row == 9) {
+            if (!object.depositVolume && !object.withdrawalVolume)
+                return QString("-");
+            return "+" + DrivenetUnits::format(DrivenetUnits::BTC, object.depositVolume)
+                + " / -" + DrivenetUnits::format(DrivenetUnits::BTC, object.withdrawalVolume);
+        }
+        return QVariant();
     }
     case HeightRole:
     {
@@ -101,10 +137,11 @@ QVariant BlockExplorerTableModel::data(const QModelIndex &index, int role) const
         if (row == 4) {
             return int(Qt::AlignRight | Qt::AlignVCenter);
         }
-        // nBits
-        if (row == 5) {
+        // nBits, transactions, size, fees & sidechain
+        if (row >= 5) {
             return int(Qt::AlignRight | Qt::AlignVCenter);
         }
+        return QVariant();
     }
     }
     return QVariant();
@@ -127,49 +164,104 @@ QVariant BlockExplorerTableModel::headerData(int section, Qt::Orientation orient
                 return QString("Time");
             case 5:
                 return QString("Bits");
+            case 6:
+                return QString("Transactions");
+            case 7:
+                return QString("Size");
+            case 8:
+                return QString("Fees");
+            case 9:
+                return QString("Sidechain");
             }
         }
     }
     return QVariant();
 }
 
-void BlockExplorerTableModel::UpdateModel()
+bool BlockExplorerTableModel::canFetchMore(const QModelIndex &parent) const
 {
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
+    if (parent.isValid())
+        return false;
 
-    int nHeight = chainActive.Height() + 1;
-    int nBlocksToDisplay = 10;
-    if (nHeight < nBlocksToDisplay)
-        nBlocksToDisplay = nHeight;
+    return nColumns < nTipHeight + 1;
+}
 
-    beginInsertColumns(QModelIndex(), model.size(), model.size() + nBlocksToDisplay - 1);
-    for (int i = nBlocksToDisplay; i; i--) {
-        CBlockIndex *index = chainActive[nHeight - i];
+void BlockExplorerTableModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
 
-        // TODO add error message or something to table?
-        if (!index) {
-            continue;
-        }
+    int nFetch = std::min(BLOCK_EXPLORER_FETCH_SIZE, nTipHeight + 1 - nColumns);
+    if (nFetch <= 0)
+        return;
 
-        BlockExplorerTableObject object;
-        object.nHeight = nHeight - i;
-        object.hash = index->GetBlockHash();
-        object.hashMerkleRoot = index->hashMerkleRoot;
+    beginInsertColumns(QModelIndex(), nColumns, nColumns + nFetch - 1);
+    nColumns += nFetch;
+    endInsertColumns();
+}
+
+void BlockExplorerTableModel::setClientModel(ClientModel *model)
+{
+    if (cache)
+        disconnect(cache, 0, this, 0);
+
+    cache = model ? model->getBlockSummaryCache() : nullptr;
 
-        uint256 hashPrev = uint256();
-        if (index->pprev)
-            hashPrev = index->pprev->GetBlockHash();
+    beginResetModel();
+    nTipHeight = -1;
+    nColumns = 0;
+    endResetModel();
 
-        object.hashPrev = hashPrev;
-        object.nTime = index->nTime;
-        object.nBits = index->nBits;
+    if (cache) {
+        connect(cache, SIGNAL(tipChanged(int,int)), this, SLOT(tipChanged(int,int)));
+        connect(cache, SIGNAL(summariesChanged(int,int)), this, SLOT(summariesChanged(int,int)));
 
-        model.append(QVariant::fromValue(object));
+        if (cache->getTipHeight() >= 0)
+            tipChanged(cache->getTipHeight(), cache->getTipHeight());
     }
-    endInsertColumns();
+}
+
+void BlockExplorerTableModel::tipChanged(int nHeight, int nForkHeight)
+{
+    if (nTipHeight < 0) {
+        beginResetModel();
+        nTipHeight = nHeight;
+        nColumns = std::min(BLOCK_EXPLORER_FETCH_SIZE, nHeight + 1);
+        endResetModel();
+        return;
+    }
+
+    // Column c is the block at height nTipHeight - c, so new blocks are
+    // inserted on the left and the other columns keep their height
+    if (nHeight > nTipHeight) {
+        beginInsertColumns(QModelIndex(), 0, nHeight - nTipHeight - 1);
+        nColumns += nHeight - nTipHeight;
+        nTipHeight = nHeight;
+        endInsertColumns();
+    }
+    else
+    if (nHeight < nTipHeight) {
+        int nRemove = std::min(nTipHeight - nHeight, nColumns);
+        if (nRemove > 0) {
+            beginRemoveColumns(QModelIndex(), 0, nRemove - 1);
+            nColumns -= nRemove;
+            endRemoveColumns();
+        }
+        nTipHeight = nHeight;
+    }
+
+    // Blocks above the fork that were already listed were replaced
+    int nLast = std::min(nHeight - nForkHeight, nColumns) - 1;
+    if (nLast >= 0)
+        Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, nLast));
+}
+
+void BlockExplorerTableModel::summariesChanged(int nBegin, int nEnd)
+{
+    int nFirst = std::max(nTipHeight - nEnd, 0);
+    int nLast = std::min(nTipHeight - nBegin, nColumns - 1);
+    if (nFirst <= nLast)
+        Q_EMIT dataChanged(index(0, nFirst), index(rowCount() - 1, nLast));
 }
 
 CBlockIndex* BlockExplorerTableModel::GetBlockIndex(const uint256& hash) const
@@ -8,20 +8,20 @@
 #include <uint256.h>
 
 #include <QAbstractTableModel>
-#include <QList>
 
+class BlockSummaryCache;
 class CBlockIndex;
+class ClientModel;
 
-struct BlockExplorerTableObject
-{
-    int nHeight;
-    uint256 hash;
-    uint256 hashPrev;
-    uint256 hashMerkleRoot;
-    int nTime;
-    int nBits;
-};
+//! Number of columns the block explorer starts with and fetches at a time
+static const int BLOCK_EXPLORER_FETCH_SIZE = 20;
 
+/**
+ * The blocks of the active chain, one per column with the newest first.
+ * Column c is the block at height tip - c. Columns are added by fetchMore as
+ * the view scrolls right, and their data comes from the BlockSummaryCache of
+ * the client model.
+ */
 class BlockExplorerTableModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -32,6 +32,10 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    void setClientModel(ClientModel *model);
 
     CBlockIndex* GetBlockIndex(const uint256& hash) const;
     CBlockIndex* GetBlockIndex(int nHeight) const;
@@ -43,10 +47,14 @@ public:
     };
 
 public Q_SLOTS:
-    void UpdateModel();
+    void tipChanged(int nHeight, int nForkHeight);
+    void summariesChanged(int nBegin, int nEnd);
 
 private:
-    QList<QVariant> model;
+    BlockSummaryCache *cache = nullptr;
+
+    int nTipHeight;
+    int nColumns;
 };
 
 #endif // BLOCKEXPLORERTABLEMODEL_H
@@ -5,6 +5,8 @@
 #include <qt/blockindexdetailsdialog.h>
 #include <qt/forms/ui_blockindexdetailsdialog.h>
 
+#include <qt/blocksummarycache.h>
+#include <qt/clientmodel.h>
 #include <qt/guiutil.h>
 #include <qt/merkletreedialog.h>
 #include <qt/txdetails.h>
@@ -127,9 +129,20 @@ void BlockIndexDetailsDialog::SetBlockIndex(const CBlockIndex* index)
     merkleTreeDialog->close();
 }
 
+void BlockIndexDetailsDialog::setClientModel(ClientModel *model)
+{
+    if (cache)
+        disconnect(cache, 0, this, 0);
+
+    cache = model ? model->getBlockSummaryCache() : nullptr;
+
+    if (cache)
+        connect(cache, SIGNAL(blockLoaded(BlockSummaryBlock)), this, SLOT(blockLoaded(BlockSummaryBlock)));
+}
+
 void BlockIndexDetailsDialog::on_pushButtonLoadTransactions_clicked()
 {
-    if (!pBlockIndex) {
+    if (!pBlockIndex || !cache) {
         // TODO error message
         return;
     }
@@ -139,20 +152,24 @@ void BlockIndexDetailsDialog::on_pushButtonLoadTransactions_clicked()
         return;
     }
 
-    // Double check that the block is in the chain and should be on disk
-    if (!mapBlockIndex.count(pBlockIndex->GetBlockHash())) {
-        // TODO display error
-        return;
-    }
+    // The block is read on the cache's thread, see blockLoaded
+    ui->labelBlockInfo->setText("Loading transactions...");
+    cache->requestBlock(hashBlock);
+}
 
-    // Load block from disk
+void BlockIndexDetailsDialog::blockLoaded(const BlockSummaryBlock& result)
+{
+    // Skip blocks requested before another block was selected
+    if (result.hash != hashBlock)
+        return;
 
-    CBlock block;
-    if (!ReadBlockFromDisk(block, pBlockIndex, Params().GetConsensus())) {
-        // TODO display error
+    if (!result.fLoaded) {
+        ui->labelBlockInfo->setText("#Tx: ?    Block Size: ? (failed to load block)");
         return;
     }
 
+    const CBlock& block = result.block;
+
     vtx = block.vtx;
 
     ui->tableWidgetTransactions->setRowCount(0);
@@ -13,8 +13,11 @@
 
 #include <vector>
 
+class BlockSummaryCache;
 class CBlockIndex;
+class ClientModel;
 class MerkleTreeDialog;
+struct BlockSummaryBlock;
 
 namespace Ui {
 class BlockIndexDetailsDialog;
@@ -30,7 +33,10 @@ public:
 
     void SetBlockIndex(const CBlockIndex* index);
 
+    void setClientModel(ClientModel *model);
+
 private Q_SLOTS:
+    void blockLoaded(const BlockSummaryBlock& result);
     void on_pushButtonLoadTransactions_clicked();
     void on_tableWidgetTransactions_doubleClicked(const QModelIndex& i);
     void on_pushButtonMerkleTree_clicked();
@@ -48,6 +54,9 @@ private:
     std::vector<CTransactionRef> vtx;
 
     MerkleTreeDialog* merkleTreeDialog = nullptr;
+
+    // Reads the blocks off the GUI thread
+    BlockSummaryCache* cache = nullptr;
 };
 
 #endif // BLOCKINDEXDETAILSDIALOG_H
@@ -0,0 +1,210 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/blocksummarycache.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <sync.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+BlockSummaryLoader::BlockSummaryLoader() :
+    QObject(),
+    pindexLast(nullptr)
+{
+}
+
+void BlockSummaryLoader::updateTip()
+{
+    int nHeight;
+    int nForkHeight;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pindexTip = chainActive.Tip();
+        if (!pindexTip || pindexTip == pindexLast)
+            return;
+
+        nHeight = pindexTip->nHeight;
+        nForkHeight = -1;
+        if (pindexLast) {
+            const CBlockIndex* pindexFork = chainActive.FindFork(pindexLast);
+            if (pindexFork)
+                nForkHeight = pindexFork->nHeight;
+        }
+        pindexLast = pindexTip;
+    }
+    Q_EMIT tipChanged(nHeight, nForkHeight);
+}
+
+void BlockSummaryLoader::loadSummaries(int nBegin, int nEnd)
+{
+    // Report a new tip first so that the summaries match it
+    updateTip();
+
+    QVector<BlockSummary> vSummary;
+    {
+        LOCK(cs_main);
+        nEnd = std::min(nEnd, chainActive.Height());
+        for (int nHeight = nBegin; nHeight <= nEnd; nHeight++) {
+            const CBlockIndex* pindex = chainActive[nHeight];
+            if (!pindex)
+                break;
+
+            BlockSummary summary;
+            summary.nHeight = nHeight;
+            summary.hash = pindex->GetBlockHash();
+            summary.hashPrev = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+            summary.hashMerkleRoot = pindex->hashMerkleRoot;
+            summary.nTime = pindex->GetBlockTime();
+            summary.nBits = pindex->nBits;
+            summary.nTx = pindex->nTx;
+            summary.fStats = false;
+            summary.nSize = 0;
+            summary.nFees = 0;
+            summary.depositVolume = 0;
+            summary.withdrawalVolume = 0;
+
+            vSummary.push_back(summary);
+        }
+    }
+
+    // Statistics of blocks connected before the block statistics index
+    // existed are missing until -reindex-chainstate
+    for (BlockSummary& summary : vSummary) {
+        BlockStats stats;
+        if (!pblockstatsdb->ReadBlockStats(summary.hash, stats))
+            continue;
+
+        summary.fStats = true;
+        summary.nSize = stats.nSize;
+        summary.nFees = stats.totalFees;
+        summary.depositVolume = stats.depositVolume;
+        summary.withdrawalVolume = stats.withdrawalVolume;
+    }
+
+    Q_EMIT summariesLoaded(nBegin, nEnd, vSummary);
+}
+
+void BlockSummaryLoader::loadBlock(const QString& strHash)
+{
+    BlockSummaryBlock result;
+    result.hash = uint256S(strHash.toStdString());
+    result.fLoaded = false;
+
+    CDiskBlockPos pos;
+    {
+        LOCK(cs_main);
+        BlockMap::iterator it = mapBlockIndex.find(result.hash);
+        if (it != mapBlockIndex.end() && (it->second->nStatus & BLOCK_HAVE_DATA))
+            pos = it->second->GetBlockPos();
+    }
+
+    if (!pos.IsNull() && ReadBlockFromDisk(result.block, pos, Params().GetConsensus()))
+        result.fLoaded = result.block.GetHash() == result.hash;
+
+    Q_EMIT blockLoaded(result);
+}
+
+BlockSummaryCache::BlockSummaryCache(QObject *parent) :
+    QObject(parent),
+    nTipHeight(-1),
+    nLastLookup(0)
+{
+    qRegisterMetaType<BlockSummaryBlock>("BlockSummaryBlock");
+    qRegisterMetaType<QVector<BlockSummary>>("QVector<BlockSummary>");
+
+    BlockSummaryLoader *loader = new BlockSummaryLoader();
+    loader->moveToThread(&thread);
+
+    connect(this, SIGNAL(tipRequested()), loader, SLOT(updateTip()));
+    connect(this, SIGNAL(summariesRequested(int,int)), loader, SLOT(loadSummaries(int,int)));
+    connect(this, SIGNAL(blockRequested(QString)), loader, SLOT(loadBlock(QString)));
+    connect(loader, SIGNAL(tipChanged(int,int)), this, SLOT(applyTip(int,int)));
+    connect(loader, SIGNAL(summariesLoaded(int,int,QVector<BlockSummary>)), this, SLOT(applySummaries(int,int,QVector<BlockSummary>)));
+    connect(loader, SIGNAL(blockLoaded(BlockSummaryBlock)), this, SIGNAL(blockLoaded(BlockSummaryBlock)));
+
+    // Delete the loader in its own thread once the thread is stopped
+    connect(&thread, SIGNAL(finished()), loader, SLOT(deleteLater()), Qt::DirectConnection);
+
+    thread.start();
+
+    Q_EMIT tipRequested();
+}
+
+BlockSummaryCache::~BlockSummaryCache()
+{
+    stop();
+}
+
+void BlockSummaryCache::stop()
+{
+    thread.quit();
+    thread.wait();
+}
+
+void BlockSummaryCache::updateTip()
+{
+    Q_EMIT tipRequested();
+}
+
+bool BlockSummaryCache::getSummary(int nHeight, BlockSummary& summary)
+{
+    if (nHeight < 0 || nHeight > nTipHeight)
+        return false;
+
+    nLastLookup = nHeight;
+
+    auto it = mapSummary.find(nHeight);
+    if (it != mapSummary.end()) {
+        summary = it->second;
+        return true;
+    }
+
+    int nBegin = nHeight - nHeight % BLOCK_SUMMARY_BATCH_SIZE;
+    if (setPending.insert(nBegin).second)
+        Q_EMIT summariesRequested(nBegin, std::min(nBegin + BLOCK_SUMMARY_BATCH_SIZE - 1, nTipHeight));
+
+    return false;
+}
+
+void BlockSummaryCache::requestBlock(const uint256& hash)
+{
+    Q_EMIT blockRequested(QString::fromStdString(hash.ToString()));
+}
+
+void BlockSummaryCache::applyTip(int nHeight, int nForkHeight)
+{
+    // Drop the summaries of disconnected blocks
+    mapSummary.erase(mapSummary.upper_bound(nForkHeight), mapSummary.end());
+
+    nTipHeight = nHeight;
+
+    Q_EMIT tipChanged(nHeight, nForkHeight);
+}
+
+void BlockSummaryCache::applySummaries(int nBegin, int nEnd, const QVector<BlockSummary>& vSummary)
+{
+    setPending.erase(nBegin - nBegin % BLOCK_SUMMARY_BATCH_SIZE);
+
+    for (const BlockSummary& summary : vSummary) {
+        if (summary.nHeight <= nTipHeight)
+            mapSummary[summary.nHeight] = summary;
+    }
+
+    // Keep the summaries closest to the last lookup
+    while (mapSummary.size() > BLOCK_SUMMARY_CACHE_SIZE) {
+        if (nLastLookup - mapSummary.begin()->first > mapSummary.rbegin()->first - nLastLookup)
+            mapSummary.erase(mapSummary.begin());
+        else
+            mapSummary.erase(std::prev(mapSummary.end()));
+    }
+
+    if (!vSummary.empty())
+        Q_EMIT summariesChanged(nBegin, nEnd);
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BLOCKSUMMARYCACHE_H
+#define BLOCKSUMMARYCACHE_H
+
+#include <amount.h>
+#include <primitives/block.h>
+#include <uint256.h>
+
+#include <map>
+#include <set>
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+class CBlockIndex;
+
+//! Number of block summaries kept by BlockSummaryCache
+static const size_t BLOCK_SUMMARY_CACHE_SIZE = 5000;
+//! Number of consecutive block summaries loaded at once
+static const int BLOCK_SUMMARY_BATCH_SIZE = 100;
+
+/** Summary of a block of the active chain listed by the block tables */
+struct BlockSummary
+{
+    int nHeight;
+    uint256 hash;
+    uint256 hashPrev;
+    uint256 hashMerkleRoot;
+    int64_t nTime;
+    unsigned int nBits;
+    unsigned int nTx;
+
+    // From the block statistics index, set if fStats
+    bool fStats;
+    unsigned int nSize;
+    CAmount nFees;
+    CAmount depositVolume;
+    CAmount withdrawalVolume;
+};
+
+/** A block read from disk for the block details dialog */
+struct BlockSummaryBlock
+{
+    uint256 hash;
+    bool fLoaded;
+    CBlock block;
+};
+
+Q_DECLARE_METATYPE(BlockSummary)
+Q_DECLARE_METATYPE(BlockSummaryBlock)
+
+/** Reads the block summaries and blocks for BlockSummaryCache on its thread */
+class BlockSummaryLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    BlockSummaryLoader();
+
+public Q_SLOTS:
+    void updateTip();
+    void loadSummaries(int nBegin, int nEnd);
+    void loadBlock(const QString& strHash);
+
+Q_SIGNALS:
+    void tipChanged(int nHeight, int nForkHeight);
+    void summariesLoaded(int nBegin, int nEnd, const QVector<BlockSummary>& vSummary);
+    void blockLoaded(const BlockSummaryBlock& block);
+
+private:
+    /** Tip of the last tipChanged signal */
+    const CBlockIndex* pindexLast;
+};
+
+/**
+ * Summaries of the blocks of the active chain, shared by the block tables.
+ *
+ * Summaries are looked up on the GUI thread without locking cs_main. Missing
+ * ones are loaded in batches by a BlockSummaryLoader on a worker thread, from
+ * the block index and the block statistics index, and summariesChanged is
+ * emitted once they are in. When the tip changes the summaries above the
+ * fork are dropped and tipChanged is emitted. The cache keeps the
+ * BLOCK_SUMMARY_CACHE_SIZE summaries closest to the last lookup.
+ */
+class BlockSummaryCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BlockSummaryCache(QObject *parent = 0);
+    ~BlockSummaryCache();
+
+    /** Height of the tip of the last tipChanged signal, -1 before the first */
+    int getTipHeight() const { return nTipHeight; }
+
+    /** Get the summary of the block at nHeight. Returns false and loads the
+     * summary if it isn't cached. */
+    bool getSummary(int nHeight, BlockSummary& summary);
+
+    /** Read a block from disk, blockLoaded is emitted when done */
+    void requestBlock(const uint256& hash);
+
+    /** Stop the worker thread, before the node shuts down */
+    void stop();
+
+public Q_SLOTS:
+    /** Bring the cache up to the current chain tip */
+    void updateTip();
+
+Q_SIGNALS:
+    void tipChanged(int nHeight, int nForkHeight);
+    void summariesChanged(int nBegin, int nEnd);
+    void blockLoaded(const BlockSummaryBlock& block);
+
+    // To the loader
+    void tipRequested();
+    void summariesRequested(int nBegin, int nEnd);
+    void blockRequested(const QString& strHash);
+
+private Q_SLOTS:
+    void applyTip(int nHeight, int nForkHeight);
+    void applySummaries(int nBegin, int nEnd, const QVector<BlockSummary>& vSummary);
+
+private:
+    QThread thread;
+
+    int nTipHeight;
+    int nLastLookup;
+
+    std::map<int, BlockSummary> mapSummary;
+    /** First heights of the batches being loaded */
+    std::set<int> setPending;
+};
+
+#endif // BLOCKSUMMARYCACHE_H
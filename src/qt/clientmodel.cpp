@@ -5,6 +5,7 @@
 #include <qt/clientmodel.h>
 
 #include <qt/bantablemodel.h>
+#include <qt/blocksummarycache.h>
 #include <qt/guiconstants.h>
 #include <qt/guiutil.h>
 #include <qt/peertablemodel.h>
@@ -35,6 +36,7 @@ ClientModel::ClientModel(OptionsModel *_optionsModel, QObject *parent) :
     optionsModel(_optionsModel),
     peerTableModel(0),
     banTableModel(0),
+    blockSummaryCache(0),
     pollTimer(0),
     ignoredBlockChangeTimer(0)
 {
@@ -42,6 +44,8 @@ ClientModel::ClientModel(OptionsModel *_optionsModel, QObject *parent) :
     cachedBestHeaderTime = -1;
     peerTableModel = new PeerTableModel(this);
     banTableModel = new BanTableModel(this);
+    blockSummaryCache = new BlockSummaryCache(this);
+    connect(this, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)), blockSummaryCache, SLOT(updateTip()));
     pollTimer = new QTimer(this);
     connect(pollTimer, SIGNAL(timeout()), this, SLOT(updateTimer()));
     pollTimer->start(MODEL_UPDATE_DELAY);
@@ -61,6 +65,9 @@ ClientModel::ClientModel(OptionsModel *_optionsModel, QObject *parent) :
 ClientModel::~ClientModel()
 {
     unsubscribeFromCoreSignals();
+
+    // The cache reads the block databases, stop it before they go away
+    blockSummaryCache->stop();
 }
 
 int ClientModel::getNumConnections(unsigned int flags) const
@@ -231,6 +238,11 @@ BanTableModel *ClientModel::getBanTableModel()
     return banTableModel;
 }
 
+BlockSummaryCache *ClientModel::getBlockSummaryCache()
+{
+    return blockSummaryCache;
+}
+
 QString ClientModel::formatFullVersion() const
 {
     return QString::fromStdString(FormatFullVersion());
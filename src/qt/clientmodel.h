@@ -12,6 +12,7 @@
 #include <mutex>
 
 class BanTableModel;
+class BlockSummaryCache;
 class OptionsModel;
 class PeerTableModel;
 
@@ -47,6 +48,7 @@ public:
     OptionsModel *getOptionsModel();
     PeerTableModel *getPeerTableModel();
     BanTableModel *getBanTableModel();
+    BlockSummaryCache *getBlockSummaryCache();
 
     //! Return number of connections, default is in- and outbound (total)
     int getNumConnections(unsigned int flags = CONNECTIONS_ALL) const;
@@ -94,6 +96,7 @@ private:
     OptionsModel *optionsModel;
     PeerTableModel *peerTableModel;
     BanTableModel *banTableModel;
+    BlockSummaryCache *blockSummaryCache;
 
     QTimer *pollTimer;
     QTimer *ignoredBlockChangeTimer;
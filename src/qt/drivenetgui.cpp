@@ -571,6 +571,8 @@ void BitcoinGUI::setClientModel(ClientModel *_clientModel)
         {
             walletFrame->setClientModel(nullptr);
         }
+
+        blockExplorerDialog->setClientModel(nullptr);
 #endif // ENABLE_WALLET
     }
 }
@@ -785,7 +787,6 @@ void BitcoinGUI::showBlockExplorerDialog()
 {
     blockExplorerDialog->show();
     blockExplorerDialog->updateOnShow();
-    blockExplorerDialog->scrollRight();
 }
 
 void BitcoinGUI::openClicked()
@@ -7,24 +7,25 @@
 #include <chain.h>
 #include <validation.h>
 
+#include <qt/blocksummarycache.h>
 #include <qt/clientmodel.h>
 
+#include <algorithm>
+
 #include <QDateTime>
 #include <QIcon>
-#include <QMetaType>
-#include <QTimer>
 #include <QVariant>
 
-Q_DECLARE_METATYPE(BlockTableObject)
-
 LatestBlockTableModel::LatestBlockTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
+    nTipHeight = -1;
+    nRows = 0;
 }
 
 int LatestBlockTableModel::rowCount(const QModelIndex & /*parent*/) const
 {
-    return model.size();
+    return nRows;
 }
 
 int LatestBlockTableModel::columnCount(const QModelIndex & /*parent*/) const
@@ -41,30 +42,36 @@ QVariant LatestBlockTableModel::data(const QModelIndex &index, int role) const
     int row = index.row();
     int col = index.column();
 
-    if (!model.at(row).canConvert<BlockTableObject>())
+    // The summary is loaded in the background if it isn't cached yet, the
+    // row is updated once it is in
+    int nHeight = nTipHeight - row;
+    BlockSummary summary;
+    if (!cache || !cache->getSummary(nHeight, summary)) {
+        if (role == Qt::DisplayRole && col == 1)
+            return nHeight;
         return QVariant();
-
-    BlockTableObject object = model.at(row).value<BlockTableObject>();
+    }
 
     switch (role) {
     case Qt::DisplayRole:
     {
         // Time
         if (col == 0) {
-            return QDateTime::fromTime_t((int64_t)object.nTime).toString("hh:mm MMM dd");
+            return QDateTime::fromTime_t(summary.nTime).toString("hh:mm MMM dd");
         }
         // Height
         if (col == 1) {
-            return object.nHeight;
+            return summary.nHeight;
         }
         // Hash
         if (col == 2) {
-            return QString::fromStdString(object.hash.ToString()).left(32) + "...";
+            return QString::fromStdString(summary.hash.ToString()).left(32) + "...";
         }
+        return QVariant();
     }
     case HashRole:
     {
-        return QString::fromStdString(object.hash.ToString());
+        return QString::fromStdString(summary.hash.ToString());
     }
     case Qt::TextAlignmentRole:
     {
@@ -102,52 +109,91 @@ QVariant LatestBlockTableModel::headerData(int section, Qt::Orientation orientat
     return QVariant();
 }
 
-void LatestBlockTableModel::setClientModel(ClientModel *model)
+bool LatestBlockTableModel::canFetchMore(const QModelIndex &parent) const
 {
-    this->clientModel = model;
-    if(model)
-    {
-        numBlocksChanged();
+    if (parent.isValid())
+        return false;
 
-        connect(model, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
-                this, SLOT(numBlocksChanged()));
-    }
+    return nRows < nTipHeight + 1;
 }
 
-void LatestBlockTableModel::numBlocksChanged()
+void LatestBlockTableModel::fetchMore(const QModelIndex &parent)
 {
-    UpdateModel();
+    if (parent.isValid())
+        return;
+
+    int nFetch = std::min(LATEST_BLOCK_FETCH_SIZE, nTipHeight + 1 - nRows);
+    if (nFetch <= 0)
+        return;
+
+    beginInsertRows(QModelIndex(), nRows, nRows + nFetch - 1);
+    nRows += nFetch;
+    endInsertRows();
 }
 
-void LatestBlockTableModel::UpdateModel()
+void LatestBlockTableModel::setClientModel(ClientModel *model)
 {
-    // Clear old data
+    if (cache)
+        disconnect(cache, 0, this, 0);
+
+    this->clientModel = model;
+    this->cache = model ? model->getBlockSummaryCache() : nullptr;
+
     beginResetModel();
-    model.clear();
+    nTipHeight = -1;
+    nRows = 0;
     endResetModel();
 
-    int nHeight = chainActive.Height() + 1;
-    int nBlocksToDisplay = 10;
-    if (nHeight < nBlocksToDisplay)
-        nBlocksToDisplay = nHeight;
+    if (cache) {
+        connect(cache, SIGNAL(tipChanged(int,int)), this, SLOT(tipChanged(int,int)));
+        connect(cache, SIGNAL(summariesChanged(int,int)), this, SLOT(summariesChanged(int,int)));
 
-    beginInsertRows(QModelIndex(), model.size(), model.size() + nBlocksToDisplay - 1);
-    for (int i = 0; i < nBlocksToDisplay; i++) {
-        CBlockIndex *index = chainActive[nHeight - i];
+        if (cache->getTipHeight() >= 0)
+            tipChanged(cache->getTipHeight(), cache->getTipHeight());
+    }
+}
+
+void LatestBlockTableModel::tipChanged(int nHeight, int nForkHeight)
+{
+    if (nTipHeight < 0) {
+        beginResetModel();
+        nTipHeight = nHeight;
+        nRows = std::min(LATEST_BLOCK_FETCH_SIZE, nHeight + 1);
+        endResetModel();
+        return;
+    }
 
-        // TODO add error message or something to table?
-        if (!index) {
-            continue;
+    // Row r is the block at height nTipHeight - r, so new blocks are
+    // inserted at the top and the other rows keep their height
+    if (nHeight > nTipHeight) {
+        beginInsertRows(QModelIndex(), 0, nHeight - nTipHeight - 1);
+        nRows += nHeight - nTipHeight;
+        nTipHeight = nHeight;
+        endInsertRows();
+    }
+    else
+    if (nHeight < nTipHeight) {
+        int nRemove = std::min(nTipHeight - nHeight, nRows);
+        if (nRemove > 0) {
+            beginRemoveRows(QModelIndex(), 0, nRemove - 1);
+            nRows -= nRemove;
+            endRemoveRows();
         }
+        nTipHeight = nHeight;
+    }
 
-        BlockTableObject object;
-        object.nHeight = nHeight - i;
-        object.hash = index->GetBlockHash();
-        object.nTime = index->nTime;
+    // Blocks above the fork that were already listed were replaced
+    int nLast = std::min(nHeight - nForkHeight, nRows) - 1;
+    if (nLast >= 0)
+        Q_EMIT dataChanged(index(0, 0), index(nLast, columnCount() - 1));
+}
 
-        model.append(QVariant::fromValue(object));
-    }
-    endInsertRows();
+void LatestBlockTableModel::summariesChanged(int nBegin, int nEnd)
+{
+    int nFirst = std::max(nTipHeight - nEnd, 0);
+    int nLast = std::min(nTipHeight - nBegin, nRows - 1);
+    if (nFirst <= nLast)
+        Q_EMIT dataChanged(index(nFirst, 0), index(nLast, columnCount() - 1));
 }
 
 CBlockIndex* LatestBlockTableModel::GetBlockIndex(const uint256& hash) const
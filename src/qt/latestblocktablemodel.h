@@ -8,22 +8,19 @@
 #include <uint256.h>
 
 #include <QAbstractTableModel>
-#include <QList>
 
+class BlockSummaryCache;
 class CBlockIndex;
 class ClientModel;
 
-QT_BEGIN_NAMESPACE
-class QTimer;
-QT_END_NAMESPACE
-
-struct BlockTableObject
-{
-    int nHeight;
-    uint256 hash;
-    int nTime;
-};
+//! Number of rows the latest block table starts with and fetches at a time
+static const int LATEST_BLOCK_FETCH_SIZE = 50;
 
+/**
+ * The blocks of the active chain, newest first. Row r is the block at height
+ * tip - r. Rows are added by fetchMore as the view scrolls down, and their
+ * data comes from the BlockSummaryCache of the client model.
+ */
 class LatestBlockTableModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -34,6 +31,8 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 
     void setClientModel(ClientModel *model);
 
@@ -46,14 +45,15 @@ public:
     };
 
 public Q_SLOTS:
-    void numBlocksChanged();
+    void tipChanged(int nHeight, int nForkHeight);
+    void summariesChanged(int nBegin, int nEnd);
 
 private:
-    QList<QVariant> model;
-
     ClientModel *clientModel = nullptr;
+    BlockSummaryCache *cache = nullptr;
 
-    void UpdateModel();
+    int nTipHeight;
+    int nRows;
 };
 
 #endif // LATESTBLOCKTABLEMODEL_H
@@ -14,6 +14,8 @@
 #include <utilmoneystr.h>
 #include <validation.h>
 
+#include <set>
+
 #include <QDateTime>
 #include <QLocale>
 #include <QString>
@@ -25,6 +27,7 @@ MemPoolTableModel::MemPoolTableModel(QObject *parent) :
 {
     nTx = 0;
     nBytes = 0;
+    nSequence = 0;
 }
 
 int MemPoolTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -150,50 +153,67 @@ void MemPoolTableModel::setClientModel(ClientModel *model)
 
 void MemPoolTableModel::updateModel()
 {
-    // Get recent mempool entries
-    std::vector<TxMempoolInfo> vInfo = mempool.InfoRecent(10);
+    // Skip transactions that we already know
+    std::set<uint256> setKnown;
+    for (const QVariant& v : model)
+        setKnown.insert(v.value<MemPoolTableObject>().txid);
+
+    // Get the transactions added since the last update, newest first
+    std::vector<MemPoolTableObject> vObj;
+    std::vector<TxMempoolDelta> vDelta;
+    if (mempool.GetDeltas(nSequence, vDelta, nSequence)) {
+        // Skip transactions that already left the mempool again
+        std::set<uint256> setRemoved;
+        for (auto it = vDelta.rbegin(); it != vDelta.rend(); it++) {
+            if (!it->fAdded) {
+                setRemoved.insert(it->txid);
+                continue;
+            }
+            if (setRemoved.count(it->txid) || setKnown.count(it->txid))
+                continue;
 
-    // Check if there is a transaction that we already know.
-    // If we find one then cut down vInfo to only new transactions.
-    if (model.size() && model.front().canConvert<MemPoolTableObject>()) {
-        MemPoolTableObject old = model.front().value<MemPoolTableObject>();
+            MemPoolTableObject object;
+            object.txid = it->txid;
+            object.time = QDateTime::fromTime_t(it->nTime).toString("hh:mm MMM dd");
+            object.value = it->nValueOut;
+            object.feeRate = CFeeRate(it->nFee, it->nVsize);
+            object.fee = it->nFee;
 
-        for (auto it = vInfo.begin(); it != vInfo.end(); it++) {
-            if (!it->tx)
+            vObj.push_back(object);
+            if (vObj.size() == MEMPOOL_TABLE_MAX_ROWS)
+                break;
+        }
+    } else {
+        // Too far behind, start over from the latest entries
+        for (const TxMempoolInfo& info : mempool.InfoRecent(MEMPOOL_TABLE_MAX_ROWS)) {
+            if (!info.tx || setKnown.count(info.tx->GetHash()))
                 continue;
 
-            if (it->tx->GetHash() == old.txid) {
-                vInfo = std::vector<TxMempoolInfo>(vInfo.begin(), it);
-                break;
-            }
+            MemPoolTableObject object;
+            object.txid = info.tx->GetHash();
+            object.time = QDateTime::fromTime_t((int64_t)info.nTime).toString("hh:mm MMM dd");
+            object.value = info.tx->GetValueOut();
+            object.feeRate = info.feeRate;
+            object.fee = info.fee;
+
+            vObj.push_back(object);
         }
     }
 
-    if (vInfo.empty())
+    if (vObj.empty())
         return;
 
-    // Add new data to table
-    beginInsertRows(QModelIndex(), 0, vInfo.size() - 1);
-    for (auto it = vInfo.begin(); it != vInfo.end(); it++) {
-        if (!it->tx)
-            continue;
-
-        MemPoolTableObject object;
-        object.txid = it->tx->GetHash();
-        object.time = QDateTime::fromTime_t((int64_t)it->nTime).toString("hh:mm MMM dd");
-        object.value = it->tx->GetValueOut();
-        object.feeRate = it->feeRate;
-        object.fee = it->fee;
-
-        model.prepend(QVariant::fromValue(object));
-    }
+    // Add new data to table, newest first
+    beginInsertRows(QModelIndex(), 0, vObj.size() - 1);
+    for (auto it = vObj.rbegin(); it != vObj.rend(); it++)
+        model.prepend(QVariant::fromValue(*it));
     endInsertRows();
 
     // Remove extra entries
-    if (model.size() > 50)
+    if (model.size() > (int)MEMPOOL_TABLE_MAX_ROWS)
     {
-        beginRemoveRows(QModelIndex(), model.size() - std::abs(50 - model.size()), model.size() - 1);
-        while (model.size() > 50)
+        beginRemoveRows(QModelIndex(), MEMPOOL_TABLE_MAX_ROWS, model.size() - 1);
+        while (model.size() > (int)MEMPOOL_TABLE_MAX_ROWS)
             model.pop_back();
         endRemoveRows();
     }
@@ -29,6 +29,9 @@ struct MemPoolTableObject
     CAmount fee;
 };
 
+// Number of latest transactions listed
+static const size_t MEMPOOL_TABLE_MAX_ROWS = 50;
+
 class MemPoolTableModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -60,6 +63,8 @@ private:
 
     long nTx;
     size_t nBytes;
+    // Mempool delta sequence of the last update
+    uint64_t nSequence;
     int64_t nUSDBTC;
 };
 
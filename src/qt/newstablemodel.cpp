@@ -12,6 +12,8 @@
 #include <qt/clientmodel.h>
 #include <qt/newstypestablemodel.h>
 
+#include <set>
+
 #include <QDateTime>
 #include <QMetaType>
 #include <QTimer>
@@ -23,6 +25,28 @@ NewsTableModel::NewsTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
     nFilter = 0;
+    nFilterDays = 0;
+
+    qRegisterMetaType<OPReturnFeedDelta>("OPReturnFeedDelta");
+
+    // Keep track of the news on a worker thread
+    OPReturnFeed *feed = new OPReturnFeed(NEWS_TABLE_MAX_ROWS);
+    feed->moveToThread(&thread);
+
+    connect(this, SIGNAL(filterChanged(QByteArray,int)), feed, SLOT(setFilter(QByteArray,int)));
+    connect(this, SIGNAL(updateRequested()), feed, SLOT(update()));
+    connect(feed, SIGNAL(changed(OPReturnFeedDelta)), this, SLOT(applyDelta(OPReturnFeedDelta)));
+
+    // Delete the feed in its own thread once the thread is stopped
+    connect(&thread, SIGNAL(finished()), feed, SLOT(deleteLater()), Qt::DirectConnection);
+
+    thread.start();
+}
+
+NewsTableModel::~NewsTableModel()
+{
+    thread.quit();
+    thread.wait();
 }
 
 int NewsTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -152,6 +176,13 @@ void NewsTableModel::setClientModel(ClientModel *model)
         connect(model, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
                 this, SLOT(numBlocksChanged()));
     }
+    else
+    {
+        // Client model is being set to 0, this means shutdown() is about to
+        // be called. Stop the feed before the databases it reads go away.
+        thread.quit();
+        thread.wait();
+    }
 }
 
 void NewsTableModel::setNewsTypesModel(NewsTypesTableModel *model)
@@ -164,101 +195,81 @@ void NewsTableModel::numBlocksChanged()
     UpdateModel();
 }
 
-// TODO append new data to the model instead of loading all every time
 void NewsTableModel::UpdateModel()
 {
     if (!newsTypesModel)
         return;
 
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
-
-    int nHeight = chainActive.Height();
-
     NewsType type;
     if (!newsTypesModel->GetType(nFilter, type))
         return;
 
-    QDateTime tipTime = QDateTime::fromMSecsSinceEpoch(chainActive.Tip()->GetBlockTime() * 1000);
-    QDateTime targetTime = tipTime.addDays(-type.nDays);
-
-    // Loop backwards from chainTip until we reach target time or genesis block.
-    std::vector<NewsTableObject> vNews;
-    for (int i = nHeight; i > 1; i--) {
-        CBlockIndex *index = chainActive[i];
-        if (!index)
-            break;
-
-        // Have we gone back in time far enough?
-        QDateTime indexTime = QDateTime::fromTime_t(index->GetBlockTime());
-
-        if (indexTime <= targetTime)
-            break;
-
-        // For each block load our cached OP_RETURN data
-        std::vector<OPReturnData> vData;
-        if (!popreturndb->GetBlockData(index->GetBlockHash(), vData))
-            continue;
-
-        // Find the data we want to display
-        for (const OPReturnData& d : vData) {
-            bool fFound = false;
-            if (d.script.size() >= 5 && type.header.size() >= 4) {
-                if (d.script[0] ==  OP_RETURN &&
-                        d.script[1] == type.header[0] &&
-                        d.script[2] == type.header[1] &&
-                        d.script[3] == type.header[2] &&
-                        d.script[4] == type.header[3])
-                {
-                            fFound = true;
-                }
-            }
-            if (!fFound)
-                continue;
+    // Only load everything again if the news type changed, otherwise the
+    // feed adds the news of new blocks
+    QByteArray header((const char*)type.header.data(), type.header.size());
+    if (header != filterHeader || type.nDays != nFilterDays) {
+        filterHeader = header;
+        nFilterDays = type.nDays;
+        Q_EMIT filterChanged(filterHeader, nFilterDays);
+        return;
+    }
 
-            NewsTableObject object;
-            object.nTime = index->nTime;
+    Q_EMIT updateRequested();
+}
 
-            // Copy chars from script, skipping non-message bytes
-            std::string strDecode;
-            for (size_t i = 5; i < d.script.size(); i++)
-                strDecode += d.script[i];
+void NewsTableModel::applyDelta(const OPReturnFeedDelta& delta)
+{
+    if (delta.fReset) {
+        beginResetModel();
+        model.clear();
+        endResetModel();
+    }
 
-            object.decode = strDecode;
-            object.fees = FormatMoney(d.fees);
-            object.feeAmount = d.fees;
-            object.hex = HexStr(d.script.begin(), d.script.end(), false);
+    if (!delta.vRemove.empty()) {
+        std::set<uint256> setRemove(delta.vRemove.begin(), delta.vRemove.end());
+
+        // Remove from the back so that the rows left to check keep their
+        // numbers
+        for (int i = model.size() - 1; i >= 0; i--) {
+            if (!setRemove.count(model.at(i).value<NewsTableObject>().key))
+                continue;
 
-            vNews.push_back(object);
+            beginRemoveRows(QModelIndex(), i, i);
+            model.removeAt(i);
+            endRemoveRows();
         }
     }
 
-    // Sort by fees
-    SortByFees(vNews);
+    if (delta.vAdd.empty())
+        return;
+
+    // The views sort by fee, new rows are appended in one batch
+    beginInsertRows(QModelIndex(), model.size(), model.size() + delta.vAdd.size() - 1);
+    for (const OPReturnFeedEntry& entry : delta.vAdd) {
+        NewsTableObject object;
+        object.key = entry.key;
+        object.nTime = entry.nTime;
+
+        // Copy chars from script, skipping non-message bytes
+        std::string strDecode;
+        for (size_t i = 5; i < entry.script.size(); i++)
+            strDecode += entry.script[i];
+
+        object.decode = strDecode;
+        object.fees = FormatMoney(entry.fees);
+        object.feeAmount = entry.fees;
+        object.hex = HexStr(entry.script.begin(), entry.script.end(), false);
 
-    beginInsertRows(QModelIndex(), model.size(), model.size() + vNews.size() - 1);
-    for (const NewsTableObject& o : vNews)
-        model.append(QVariant::fromValue(o));
+        model.append(QVariant::fromValue(object));
+    }
     endInsertRows();
 }
 
 void NewsTableModel::setFilter(size_t nFilterIn)
 {
     nFilter = nFilterIn;
-    UpdateModel();
-}
 
-struct CompareByFee
-{
-    bool operator()(const NewsTableObject& a, const NewsTableObject& b) const
-    {
-        return a.fees > b.fees;
-    }
-};
-
-void NewsTableModel::SortByFees(std::vector<NewsTableObject>& vNews)
-{
-    std::sort(vNews.begin(), vNews.end(), CompareByFee());
+    // Load the news of the type again even if it has the same header
+    filterHeader.clear();
+    UpdateModel();
 }
@@ -7,8 +7,12 @@
 
 #include <uint256.h>
 
+#include <qt/opreturnfeed.h>
+
 #include <QAbstractTableModel>
+#include <QByteArray>
 #include <QList>
+#include <QThread>
 
 class CBlockIndex;
 class ClientModel;
@@ -21,6 +25,7 @@ QT_END_NAMESPACE
 
 struct NewsTableObject
 {
+    uint256 key;
     int nTime;
     std::string decode;
     std::string fees;
@@ -30,12 +35,16 @@ struct NewsTableObject
 
 static const size_t NEWS_HEADLINE_CHARS = 64;
 
+// Maximum number of news listed for a news type
+static const size_t NEWS_TABLE_MAX_ROWS = 1000;
+
 class NewsTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 
 public:
     explicit NewsTableModel(QObject *parent = 0);
+    ~NewsTableModel();
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
@@ -52,15 +61,26 @@ public:
 
 public Q_SLOTS:
     void numBlocksChanged();
+    void applyDelta(const OPReturnFeedDelta& delta);
+
+Q_SIGNALS:
+    void filterChanged(const QByteArray& header, int nDays);
+    void updateRequested();
 
 private:
     QList<QVariant> model;
 
+    // Runs the OPReturnFeed that keeps track of the news
+    QThread thread;
+
+    // Header and number of days of the news type the feed lists
+    QByteArray filterHeader;
+    int nFilterDays;
+
     ClientModel *clientModel = nullptr;
     NewsTypesTableModel *newsTypesModel = nullptr;
 
     void UpdateModel();
-    void SortByFees(std::vector<NewsTableObject>& vNews);
 
     size_t nFilter;
 };
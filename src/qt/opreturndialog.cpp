@@ -12,6 +12,8 @@
 #include <qt/opreturntablemodel.h>
 #include <qt/platformstyle.h>
 
+#include <opreturnindex.h>
+
 #include <QMenu>
 #include <QMessageBox>
 #include <QPoint>
@@ -82,6 +84,15 @@ OPReturnDialog::OPReturnDialog(const PlatformStyle *_platformStyle, QWidget *par
 
     opReturnModel->setDays(ui->spinBoxDays->value());
 
+    // Without the search index only the listed rows can be filtered
+    if (g_opreturn_index && g_opreturn_index->IsSearchEnabled()) {
+        ui->lineEditSearch->setPlaceholderText(tr("Search all OP_RETURN data"));
+    } else {
+        ui->lineEditSearch->setPlaceholderText(tr("Filter (start with -opreturnsearch to search all data)"));
+        proxyModel->setFilterKeyColumn(2);
+        proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    }
+
     ui->tableView->setSortingEnabled(true);
     ui->tableView->sortByColumn(0, Qt::DescendingOrder);
 
@@ -100,6 +111,11 @@ void OPReturnDialog::setClientModel(ClientModel *model)
         connect(model, SIGNAL(numBlocksChanged(int,QDateTime,double,bool)),
                 this, SLOT(numBlocksChanged(int, QDateTime)));
     }
+    else
+    {
+        // Shutdown is about to be called
+        opReturnModel->shutdown();
+    }
 }
 
 void OPReturnDialog::on_tableView_doubleClicked(const QModelIndex& index)
@@ -182,6 +198,17 @@ void OPReturnDialog::on_spinBoxDays_editingFinished()
     opReturnModel->setDays(ui->spinBoxDays->value());
 }
 
+void OPReturnDialog::on_lineEditSearch_textChanged(const QString& text)
+{
+    if (g_opreturn_index && g_opreturn_index->IsSearchEnabled()) {
+        // Search results are not limited to the period
+        ui->spinBoxDays->setEnabled(text.isEmpty());
+        opReturnModel->setSearch(text);
+    } else {
+        proxyModel->setFilterFixedString(text);
+    }
+}
+
 void OPReturnDialog::updateOnShow()
 {
     Q_EMIT(UpdateTable());
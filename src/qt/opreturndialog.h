@@ -53,6 +53,7 @@ private Q_SLOTS:
     void copyHex();
     void on_pushButtonCreate_clicked();
     void on_spinBoxDays_editingFinished();
+    void on_lineEditSearch_textChanged(const QString& text);
     void numBlocksChanged(int nHeight, const QDateTime& time);
 
 Q_SIGNALS:
@@ -0,0 +1,251 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/opreturnfeed.h>
+
+#include <chain.h>
+#include <hash.h>
+#include <opreturnindex.h>
+#include <sync.h>
+#include <txdb.h>
+#include <validation.h>
+
+uint256 OPReturnFeedEntry::GetKey(const uint256& txid, const CScript& script)
+{
+    return SerializeHash(std::make_pair(txid, script));
+}
+
+OPReturnFeed::OPReturnFeed(size_t nMaxRowsIn) :
+    QObject(),
+    nMaxRows(nMaxRowsIn),
+    nDays(1),
+    fFilterSet(false),
+    pindexLast(nullptr),
+    fTruncated(false)
+{
+}
+
+void OPReturnFeed::setFilter(const QByteArray& headerIn, int nDaysIn)
+{
+    const unsigned char* pheader = (const unsigned char*)headerIn.constData();
+    header = CScript(pheader, pheader + headerIn.size());
+    nDays = nDaysIn;
+    fFilterSet = true;
+
+    // Load from scratch on the next update
+    pindexLast = nullptr;
+
+    update();
+}
+
+void OPReturnFeed::setSearch(const QString& strQuery)
+{
+    strSearch = strQuery.toStdString();
+
+    // Load from scratch on the next update
+    pindexLast = nullptr;
+
+    update();
+}
+
+void OPReturnFeed::update()
+{
+    if (!fFilterSet)
+        return;
+
+    // Wait for the OP_RETURN index to write the latest blocks, or come back
+    // with the next block if it is still catching up
+    if (g_opreturn_index && !g_opreturn_index->BlockUntilSyncedToCurrentChain())
+        return;
+
+    const CBlockIndex* pindexTip;
+    bool fConnect;
+    {
+        LOCK(cs_main);
+        pindexTip = chainActive.Tip();
+        if (!pindexTip || pindexTip == pindexLast)
+            return;
+
+        fConnect = pindexLast && chainActive.Contains(pindexLast);
+    }
+
+    const int64_t nTimeBegin = pindexTip->GetBlockTime() - nDays * NEWS_INDEX_BUCKET + 1;
+
+    // When everything we have is out of the period loading the period is
+    // as cheap as connecting the blocks
+    if (fConnect && pindexLast->GetBlockTime() < nTimeBegin)
+        fConnect = false;
+
+    // Search results are looked up again, which the index makes cheap
+    if (!strSearch.empty())
+        fConnect = false;
+
+    if (fConnect) {
+        std::vector<const CBlockIndex*> vConnect;
+        for (const CBlockIndex* pindex = pindexTip; pindex != pindexLast; pindex = pindex->pprev)
+            vConnect.push_back(pindex);
+
+        for (auto it = vConnect.rbegin(); it != vConnect.rend(); it++)
+            ConnectBlock(*it, nTimeBegin);
+
+        size_t nSize = mapEntries.size();
+        Expire(nTimeBegin);
+
+        // Entries left out before may now belong to the top
+        if (fTruncated && mapEntries.size() < nSize)
+            fConnect = false;
+    }
+
+    OPReturnFeedDelta delta;
+    if (fConnect) {
+        delta.vRemove = vRemoved;
+        for (const uint256& key : setAdded)
+            delta.vAdd.push_back(mapEntries[key]);
+    } else {
+        if (!Load(pindexTip, nTimeBegin))
+            return;
+
+        delta.fReset = true;
+        for (const auto& entry : mapEntries)
+            delta.vAdd.push_back(entry.second);
+    }
+    setAdded.clear();
+    vRemoved.clear();
+
+    pindexLast = pindexTip;
+
+    if (delta.fReset || !delta.vRemove.empty() || !delta.vAdd.empty())
+        Q_EMIT changed(delta);
+}
+
+bool OPReturnFeed::Load(const CBlockIndex* pindexTip, int64_t nTimeBegin)
+{
+    mapEntries.clear();
+    setByFee.clear();
+    setByTime.clear();
+    fTruncated = false;
+
+    if (!strSearch.empty())
+        return LoadSearch();
+
+    if (!header.empty())
+        return LoadNews(nTimeBegin);
+
+    // Without a header to look up, read the blocks of the period
+    for (const CBlockIndex* pindex = pindexTip; pindex; pindex = pindex->pprev) {
+        if (pindex->GetBlockTime() < nTimeBegin)
+            break;
+
+        ConnectBlock(pindex, nTimeBegin);
+    }
+    return true;
+}
+
+bool OPReturnFeed::LoadNews(int64_t nTimeBegin)
+{
+    std::vector<OPReturnNews> vNews;
+    if (!popreturndb->GetTopNews(header, nTimeBegin, nMaxRows, vNews))
+        return false;
+
+    for (const OPReturnNews& news : vNews) {
+        OPReturnFeedEntry entry;
+        entry.key = OPReturnFeedEntry::GetKey(news.txid, news.script);
+        entry.txid = news.txid;
+        entry.fees = news.fees;
+        entry.nTime = news.nTime;
+        entry.script = news.script;
+
+        Add(entry);
+    }
+    fTruncated = vNews.size() == nMaxRows;
+
+    return true;
+}
+
+bool OPReturnFeed::LoadSearch()
+{
+    // A query without a word long enough to look up lists nothing
+    std::vector<OPReturnSearchEntry> vResult;
+    SearchOPReturn(strSearch, nMaxRows, vResult);
+
+    for (const OPReturnSearchEntry& result : vResult) {
+        OPReturnFeedEntry entry;
+        entry.key = OPReturnFeedEntry::GetKey(result.txid, result.script);
+        entry.txid = result.txid;
+        entry.fees = result.fees;
+        entry.nTime = result.nTime;
+        entry.script = result.script;
+
+        Add(entry);
+    }
+
+    return true;
+}
+
+bool OPReturnFeed::ConnectBlock(const CBlockIndex* pindex, int64_t nTimeBegin)
+{
+    if (pindex->GetBlockTime() < nTimeBegin)
+        return true;
+
+    // Only the payloads with the header are read
+    std::vector<OPReturnData> vData;
+    if (!popreturndb->GetBlockData(pindex->GetBlockHash(), header, vData))
+        return false;
+
+    for (const OPReturnData& d : vData) {
+        OPReturnFeedEntry entry;
+        entry.key = OPReturnFeedEntry::GetKey(d.txid, d.script);
+        entry.txid = d.txid;
+        entry.fees = d.fees;
+        entry.nTime = pindex->GetBlockTime();
+        entry.script = d.script;
+
+        Add(entry);
+    }
+    return true;
+}
+
+void OPReturnFeed::Add(const OPReturnFeedEntry& entry)
+{
+    if (mapEntries.count(entry.key))
+        return;
+
+    // Keep the nMaxRows highest fees
+    if (mapEntries.size() >= nMaxRows) {
+        fTruncated = true;
+        if (setByFee.empty() || entry.fees <= setByFee.begin()->first)
+            return;
+
+        uint256 keyLowest = setByFee.begin()->second;
+        Remove(keyLowest);
+    }
+
+    mapEntries[entry.key] = entry;
+    setByFee.insert(std::make_pair(entry.fees, entry.key));
+    setByTime.insert(std::make_pair(entry.nTime, entry.key));
+    setAdded.insert(entry.key);
+}
+
+void OPReturnFeed::Remove(const uint256& key)
+{
+    auto it = mapEntries.find(key);
+    if (it == mapEntries.end())
+        return;
+
+    setByFee.erase(std::make_pair(it->second.fees, key));
+    setByTime.erase(std::make_pair(it->second.nTime, key));
+    mapEntries.erase(it);
+
+    // Only report rows the model has been told about
+    if (!setAdded.erase(key))
+        vRemoved.push_back(key);
+}
+
+void OPReturnFeed::Expire(int64_t nTimeBegin)
+{
+    while (!setByTime.empty() && setByTime.begin()->first < nTimeBegin) {
+        uint256 key = setByTime.begin()->second;
+        Remove(key);
+    }
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef OPRETURNFEED_H
+#define OPRETURNFEED_H
+
+#include <amount.h>
+#include <script/script.h>
+#include <uint256.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+
+class CBlockIndex;
+
+/** An OP_RETURN output listed by the news or OP_RETURN table */
+struct OPReturnFeedEntry
+{
+    // Identifies the row, see OPReturnFeedEntry::GetKey
+    uint256 key;
+    uint256 txid;
+    CAmount fees;
+    int64_t nTime;
+    CScript script;
+
+    static uint256 GetKey(const uint256& txid, const CScript& script);
+};
+
+/** Changes for a table model to apply. If fReset is set the rows of the
+ * model are replaced by vAdd, otherwise vRemove are removed and vAdd are
+ * appended. */
+struct OPReturnFeedDelta
+{
+    bool fReset = false;
+    std::vector<uint256> vRemove;
+    std::vector<OPReturnFeedEntry> vAdd;
+};
+
+Q_DECLARE_METATYPE(OPReturnFeedDelta)
+
+/**
+ * Keeps the top OP_RETURN outputs by fee of the last nDays days, optionally
+ * only those with a news header, and reports the changes of each update.
+ *
+ * Lives on a worker thread of the table model. When blocks are connected
+ * only their OP_RETURN data is read; entries are ranked in a set bounded to
+ * nMaxRows and dropped once they are older than the period. The entries are
+ * loaded from scratch only when the filter changes, after a reorg, when far
+ * behind, or when entries aged out of a truncated set.
+ */
+class OPReturnFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OPReturnFeed(size_t nMaxRowsIn);
+
+public Q_SLOTS:
+    /** Select the outputs to list. An empty header lists all OP_RETURN
+     * outputs. Loads the entries again. */
+    void setFilter(const QByteArray& header, int nDays);
+
+    /** List the outputs of the whole chain matching a search query instead
+     * of those of the period, see SearchOPReturn. An empty query goes back
+     * to the period. */
+    void setSearch(const QString& strQuery);
+
+    /** Bring the entries up to the current chain tip */
+    void update();
+
+Q_SIGNALS:
+    void changed(const OPReturnFeedDelta& delta);
+
+private:
+    bool Load(const CBlockIndex* pindexTip, int64_t nTimeBegin);
+    bool LoadNews(int64_t nTimeBegin);
+    bool LoadSearch();
+    bool ConnectBlock(const CBlockIndex* pindex, int64_t nTimeBegin);
+
+    void Add(const OPReturnFeedEntry& entry);
+    void Remove(const uint256& key);
+    void Expire(int64_t nTimeBegin);
+
+    const size_t nMaxRows;
+
+    CScript header;
+    int nDays;
+    bool fFilterSet;
+    std::string strSearch;
+
+    /** Last block whose data is included */
+    const CBlockIndex* pindexLast;
+
+    /** Whether entries of the period were left out because of nMaxRows */
+    bool fTruncated;
+
+    std::map<uint256, OPReturnFeedEntry> mapEntries;
+    std::set<std::pair<CAmount, uint256>> setByFee;
+    std::set<std::pair<int64_t, uint256>> setByTime;
+
+    /** Changes since the last changed signal */
+    std::set<uint256> setAdded;
+    std::vector<uint256> vRemoved;
+};
+
+#endif // OPRETURNFEED_H
@@ -9,6 +9,8 @@
 #include <utilmoneystr.h>
 #include <validation.h>
 
+#include <set>
+
 #include <QDateTime>
 #include <QMetaType>
 #include <QVariant>
@@ -19,6 +21,27 @@ OPReturnTableModel::OPReturnTableModel(QObject *parent) :
     QAbstractTableModel(parent)
 {
     nDays = 1;
+
+    qRegisterMetaType<OPReturnFeedDelta>("OPReturnFeedDelta");
+
+    // Keep track of the OP_RETURN data on a worker thread
+    OPReturnFeed *feed = new OPReturnFeed(OPRETURN_TABLE_MAX_ROWS);
+    feed->moveToThread(&thread);
+
+    connect(this, SIGNAL(filterChanged(QByteArray,int)), feed, SLOT(setFilter(QByteArray,int)));
+    connect(this, SIGNAL(searchChanged(QString)), feed, SLOT(setSearch(QString)));
+    connect(this, SIGNAL(updateRequested()), feed, SLOT(update()));
+    connect(feed, SIGNAL(changed(OPReturnFeedDelta)), this, SLOT(applyDelta(OPReturnFeedDelta)));
+
+    // Delete the feed in its own thread once the thread is stopped
+    connect(&thread, SIGNAL(finished()), feed, SLOT(deleteLater()), Qt::DirectConnection);
+
+    thread.start();
+}
+
+OPReturnTableModel::~OPReturnTableModel()
+{
+    shutdown();
 }
 
 int OPReturnTableModel::rowCount(const QModelIndex & /*parent*/) const
@@ -123,74 +146,69 @@ QVariant OPReturnTableModel::headerData(int section, Qt::Orientation orientation
 void OPReturnTableModel::setDays(int nDaysIn)
 {
     nDays = nDaysIn;
-    UpdateModel();
+    Q_EMIT filterChanged(QByteArray(), nDays);
+}
+
+void OPReturnTableModel::setSearch(const QString& strQuery)
+{
+    Q_EMIT searchChanged(strQuery);
 }
 
-// TODO append new data to the model instead of loading all every time
 void OPReturnTableModel::UpdateModel()
 {
-    // Clear old data
-    beginResetModel();
-    model.clear();
-    endResetModel();
-
-    int nHeight = chainActive.Height();
-
-    QDateTime tipTime = QDateTime::fromTime_t(chainActive.Tip()->GetBlockTime());
-    QDateTime targetTime = tipTime.addDays(-nDays);
-
-    // Loop backwards from chainTip until we reach target time or genesis block.
-    std::vector<OPReturnTableObject> vObj;
-    int nBatchSize = 300;
-    for (int i = nHeight; i > 1; i--) {
-        CBlockIndex *index = chainActive[i];
-        if (!index)
-            break;
-
-        // Have we gone back in time far enough?
-        QDateTime indexTime = QDateTime::fromTime_t(index->GetBlockTime());
-
-        if (indexTime <= targetTime)
-            break;
-
-        // For each block load our cached OP_RETURN data
-        std::vector<OPReturnData> vData;
-        if (!popreturndb->GetBlockData(index->GetBlockHash(), vData))
-            continue;
-
-        for (const OPReturnData& d : vData) {
-            OPReturnTableObject object;
-            object.nTime = index->nTime;
-
-            // Copy chars from script, skipping OP_RETURN
-            std::string strDecode;
-            for (size_t i = 1; i < d.script.size(); i++)
-                strDecode += d.script[i];
-
-            object.decode = strDecode;
-            object.fees = FormatMoney(d.fees);
-            object.feeAmount = d.fees;
-            object.hex = HexStr(d.script.begin(), d.script.end(), false);
-
-            vObj.push_back(object);
-        }
+    Q_EMIT updateRequested();
+}
+
+void OPReturnTableModel::shutdown()
+{
+    thread.quit();
+    thread.wait();
+}
+
+void OPReturnTableModel::applyDelta(const OPReturnFeedDelta& delta)
+{
+    if (delta.fReset) {
+        beginResetModel();
+        model.clear();
+        endResetModel();
+    }
 
-        // Write batch
-        if (i % nBatchSize == 0 && vObj.size()) {
-            int offset = model.size() ? 2 : 1;
-            beginInsertRows(QModelIndex(), model.size(), model.size() + vObj.size() - offset);
-            for (const OPReturnTableObject& o : vObj)
-                model.append(QVariant::fromValue(o));
-            endInsertRows();
+    if (!delta.vRemove.empty()) {
+        std::set<uint256> setRemove(delta.vRemove.begin(), delta.vRemove.end());
 
-            vObj.clear();
+        // Remove from the back so that the rows left to check keep their
+        // numbers
+        for (int i = model.size() - 1; i >= 0; i--) {
+            if (!setRemove.count(model.at(i).value<OPReturnTableObject>().key))
+                continue;
+
+            beginRemoveRows(QModelIndex(), i, i);
+            model.removeAt(i);
+            endRemoveRows();
         }
     }
 
-    // Write final batch
-    int offset = model.size() ? 2 : 1;
-    beginInsertRows(QModelIndex(), model.size(), model.size() + vObj.size() - offset);
-    for (const OPReturnTableObject& o : vObj)
-        model.append(QVariant::fromValue(o));
+    if (delta.vAdd.empty())
+        return;
+
+    // The view sorts the rows, new rows are appended in one batch
+    beginInsertRows(QModelIndex(), model.size(), model.size() + delta.vAdd.size() - 1);
+    for (const OPReturnFeedEntry& entry : delta.vAdd) {
+        OPReturnTableObject object;
+        object.key = entry.key;
+        object.nTime = entry.nTime;
+
+        // Copy chars from script, skipping OP_RETURN
+        std::string strDecode;
+        for (size_t i = 1; i < entry.script.size(); i++)
+            strDecode += entry.script[i];
+
+        object.decode = strDecode;
+        object.fees = FormatMoney(entry.fees);
+        object.feeAmount = entry.fees;
+        object.hex = HexStr(entry.script.begin(), entry.script.end(), false);
+
+        model.append(QVariant::fromValue(object));
+    }
     endInsertRows();
 }
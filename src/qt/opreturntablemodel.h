@@ -7,8 +7,12 @@
 
 #include <uint256.h>
 
+#include <qt/opreturnfeed.h>
+
 #include <QAbstractTableModel>
+#include <QByteArray>
 #include <QList>
+#include <QThread>
 
 class CBlockIndex;
 class OPReturnData;
@@ -19,6 +23,7 @@ QT_END_NAMESPACE
 
 struct OPReturnTableObject
 {
+    uint256 key;
     int nTime;
     std::string decode;
     std::string fees;
@@ -26,12 +31,16 @@ struct OPReturnTableObject
     int feeAmount;
 };
 
+// Maximum number of rows, those with the highest fees are listed
+static const size_t OPRETURN_TABLE_MAX_ROWS = 10000;
+
 class OPReturnTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 
 public:
     explicit OPReturnTableModel(QObject *parent = 0);
+    ~OPReturnTableModel();
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
@@ -39,6 +48,13 @@ public:
 
     void setDays(int nDays);
 
+    /** List the outputs of the whole chain matching strQuery, or those of
+     * the last days if it is empty. Requires -opreturnsearch. */
+    void setSearch(const QString& strQuery);
+
+    /** Stop the worker thread, before the node shuts down */
+    void shutdown();
+
     enum RoleIndex {
         DecodeRole = Qt::UserRole,
         HexRole,
@@ -46,10 +62,19 @@ public:
 
 public Q_SLOTS:
     void UpdateModel();
+    void applyDelta(const OPReturnFeedDelta& delta);
+
+Q_SIGNALS:
+    void filterChanged(const QByteArray& header, int nDays);
+    void searchChanged(const QString& strQuery);
+    void updateRequested();
 
 private:
     QList<QVariant> model;
     int nDays;
+
+    // Runs the OPReturnFeed that keeps track of the OP_RETURN data
+    QThread thread;
 };
 
 #endif // OPRETURNTABLEMODEL_H
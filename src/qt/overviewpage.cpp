@@ -326,11 +326,22 @@ void OverviewPage::setClientModel(ClientModel *model)
         updateAlerts(model->getStatusBarWarnings());
 
         latestBlockModel->setClientModel(model);
+        blockIndexDialog->setClientModel(model);
 
         newsModel1->setClientModel(model);
         newsModel2->setClientModel(model);
         opReturnDialog->setClientModel(model);
     }
+    else
+    {
+        // Stop the news feeds and let go of the block summary cache
+        // before shutdown
+        latestBlockModel->setClientModel(nullptr);
+        blockIndexDialog->setClientModel(nullptr);
+        newsModel1->setClientModel(nullptr);
+        newsModel2->setClientModel(nullptr);
+        opReturnDialog->setClientModel(nullptr);
+    }
 }
 
 void OverviewPage::setWalletModel(WalletModel *model)
@@ -5,6 +5,9 @@
 #include <util.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <map>
+
 #include <QIcon>
 #include <QMetaType>
 #include <QPushButton>
@@ -17,10 +20,10 @@
 Q_DECLARE_METATYPE(SidechainActivationTableObject)
 
 SidechainActivationTableModel::SidechainActivationTableModel(QObject *parent) :
-    QAbstractTableModel(parent)
+    QAbstractTableModel(parent),
+    fSynced(false),
+    nSequence(0)
 {
-    // TODO update only when block connected or sidechain votes changed.
-
     // This timer will be fired repeatedly to update the model
     pollTimer = new QTimer(this);
     connect(pollTimer, SIGNAL(timeout()), this, SLOT(updateModel()));
@@ -139,113 +142,114 @@ QVariant SidechainActivationTableModel::headerData(int section, Qt::Orientation
 
 void SidechainActivationTableModel::updateModel()
 {
-    // TODO there are many ways to improve the efficiency of this
+    // Don't hold up the GUI if the node is busy
+    TRY_LOCK(cs_main, lockMain);
+    if (!lockMain)
+        return;
 
-    std::vector<SidechainActivationStatus> vActivationStatus;
-    vActivationStatus = scdb.GetSidechainActivationStatus();
+    std::vector<SidechainDBChangeSet> vChangeSet;
+    uint64_t nSequenceNew;
+    if (!fSynced || !scdb.GetChangeSets(nSequence, vChangeSet, nSequenceNew)) {
+        loadModel();
+        return;
+    }
 
-    // Look for updates to sidechain activation status which is already
-    // cached by the model and update our model / view.
-    //
-    // Also look for sidechains which have been removed from the pending list,
-    // and remove them from our model / view.
-    std::vector<SidechainActivationTableObject> vRemoved;
-    for (int i = 0; i < model.size(); i++) {
-        if (!model[i].canConvert<SidechainActivationTableObject>())
+    for (const SidechainDBChangeSet& changeSet : vChangeSet) {
+        // The replacement column depends on which sidechains are active
+        if (changeSet.fSidechainsChanged) {
+            loadModel();
             return;
+        }
 
-        SidechainActivationTableObject object = model[i].value<SidechainActivationTableObject>();
-
-        bool fFound = false;
+        std::map<QString, int> mapRow;
+        for (int i = 0; i < model.size(); i++) {
+            if (!model[i].canConvert<SidechainActivationTableObject>())
+                continue;
+            mapRow[model[i].value<SidechainActivationTableObject>().hash] = i;
+        }
 
-        // We have an update
-        for (const SidechainActivationStatus& s : vActivationStatus) {
-            if (s.proposal.GetHash() == uint256S(object.hash.toStdString())) {
-                // Update nAge
-                object.nAge = s.nAge;
-                // Update nFail
-                object.nFail = s.nFail;
-                // Update fAck
-                object.fAck = scdb.GetAckSidechain(s.proposal.GetHash());
-                // Update replacement status
-                object.fReplacement = scdb.IsSidechainActive(s.proposal.nSidechain);
+        for (const SidechainActivationStatus& s : changeSet.vActivationUpdated) {
+            auto it = mapRow.find(QString::fromStdString(s.proposal.GetHash().ToString()));
+            if (it == mapRow.end())
+                continue;
 
-                // Emit signal that model data has changed
-                QModelIndex topLeft = index(i, 0);
-                QModelIndex topRight = index(i, columnCount() - 1);
-                Q_EMIT QAbstractItemModel::dataChanged(topLeft, topRight, {Qt::DecorationRole});
+            SidechainActivationTableObject object = model[it->second].value<SidechainActivationTableObject>();
+            object.nAge = s.nAge;
+            object.nFail = s.nFail;
+            model[it->second] = QVariant::fromValue(object);
 
-                model[i] = QVariant::fromValue(object);
+            Q_EMIT dataChanged(index(it->second, 5), index(it->second, 6));
+        }
 
-                fFound = true;
-            }
+        // Remove from the bottom up so that the rows left to remove stay put
+        std::vector<int> vRemove;
+        for (const uint256& hash : changeSet.vActivationRemoved) {
+            auto it = mapRow.find(QString::fromStdString(hash.ToString()));
+            if (it != mapRow.end())
+                vRemove.push_back(it->second);
+        }
+        std::sort(vRemove.rbegin(), vRemove.rend());
+        for (int nRow : vRemove) {
+            beginRemoveRows(QModelIndex(), nRow, nRow);
+            model.removeAt(nRow);
+            endRemoveRows();
         }
 
-        // Add to vector of sidechains to be removed from model / view
-        if (!fFound) {
-            vRemoved.push_back(object);
+        if (!changeSet.vActivationAdded.empty()) {
+            int nAdded = changeSet.vActivationAdded.size();
+            beginInsertRows(QModelIndex(), model.size(), model.size() + nAdded - 1);
+            for (const SidechainActivationStatus& s : changeSet.vActivationAdded)
+                model.append(QVariant::fromValue(makeObject(s)));
+            endInsertRows();
         }
     }
+    nSequence = nSequenceNew;
 
-    // Loop through the model and remove expired sidechains
+    // Votes are set by the user rather than by blocks, so check them on
+    // every poll
     for (int i = 0; i < model.size(); i++) {
         if (!model[i].canConvert<SidechainActivationTableObject>())
-            return;
+            continue;
 
         SidechainActivationTableObject object = model[i].value<SidechainActivationTableObject>();
+        bool fAck = scdb.GetAckSidechain(uint256S(object.hash.toStdString()));
+        if (fAck == object.fAck)
+            continue;
 
-        for (const SidechainActivationTableObject& s : vRemoved) {
-            if (s.hash == object.hash) {
-                beginRemoveRows(QModelIndex(), i, i);
-                model[i] = model.back();
-                model.pop_back();
-                endRemoveRows();
-            }
-        }
-    }
-
-    // Check if any new sidechains have been added to the pending list,
-    // collect them into a vector.
-    std::vector<SidechainActivationStatus> vNew;
-    for (const SidechainActivationStatus& s : vActivationStatus) {
-        bool fFound = false;
-
-        for (const QVariant& v : model) {
-            if (!v.canConvert<SidechainActivationTableObject>())
-                return;
-            SidechainActivationTableObject object = v.value<SidechainActivationTableObject>();
-
-            if (s.proposal.GetHash() == uint256S(object.hash.toStdString()))
-                fFound = true;
-        }
+        object.fAck = fAck;
+        model[i] = QVariant::fromValue(object);
 
-        if (!fFound)
-            vNew.push_back(s);
+        Q_EMIT dataChanged(index(i, 0), index(i, 0));
     }
+}
 
-    size_t nSidechains = vNew.size();
-    if (vNew.empty())
-        return;
+void SidechainActivationTableModel::loadModel()
+{
+    beginResetModel();
+    model.clear();
+    for (const SidechainActivationStatus& s : scdb.GetSidechainActivationStatus())
+        model.append(QVariant::fromValue(makeObject(s)));
+    endResetModel();
+
+    fSynced = true;
+    nSequence = scdb.GetChangeSequence();
+}
 
-    // Add new sidechains if we need to
-    beginInsertRows(QModelIndex(), model.size(), model.size() + nSidechains - 1);
-    for (const SidechainActivationStatus& s : vNew) {
-        SidechainActivationTableObject object;
-
-        object.fAck = scdb.GetAckSidechain(s.proposal.GetHash());
-        object.nSidechain = s.proposal.nSidechain;
-        object.fReplacement = scdb.IsSidechainActive(s.proposal.nSidechain);
-        object.title = QString::fromStdString(s.proposal.title);
-        object.description = QString::fromStdString(s.proposal.description);
-        object.sidechainKeyID = QString::fromStdString(s.proposal.strKeyID);
-        object.sidechainPriv = QString::fromStdString(s.proposal.strPrivKey);
-        object.nAge = s.nAge;
-        object.nFail = s.nFail;
-        object.hash = QString::fromStdString(s.proposal.GetHash().ToString());
-
-        model.append(QVariant::fromValue(object));
-    }
-    endInsertRows();
+SidechainActivationTableObject SidechainActivationTableModel::makeObject(const SidechainActivationStatus& s) const
+{
+    SidechainActivationTableObject object;
+    object.fAck = scdb.GetAckSidechain(s.proposal.GetHash());
+    object.nSidechain = s.proposal.nSidechain;
+    object.fReplacement = scdb.IsSidechainActive(s.proposal.nSidechain);
+    object.title = QString::fromStdString(s.proposal.title);
+    object.description = QString::fromStdString(s.proposal.description);
+    object.sidechainKeyID = QString::fromStdString(s.proposal.strKeyID);
+    object.sidechainPriv = QString::fromStdString(s.proposal.strPrivKey);
+    object.nAge = s.nAge;
+    object.nFail = s.nFail;
+    object.hash = QString::fromStdString(s.proposal.GetHash().ToString());
+
+    return object;
 }
 
 bool SidechainActivationTableModel::GetHashAtRow(int row, uint256& hash) const
@@ -10,6 +10,8 @@ QT_BEGIN_NAMESPACE
 class QTimer;
 QT_END_NAMESPACE
 
+struct SidechainActivationStatus;
+
 struct SidechainActivationTableObject
 {
     bool fAck;
@@ -43,6 +45,16 @@ public Q_SLOTS:
 private:
     QList<QVariant> model;
     QTimer *pollTimer;
+
+    /** Whether the model holds the proposals up to SCDB change set nSequence */
+    bool fSynced;
+    uint64_t nSequence;
+
+    /** Load every sidechain proposal from SCDB, requires cs_main */
+    void loadModel();
+
+    /** Make a row for a sidechain proposal, requires cs_main */
+    SidechainActivationTableObject makeObject(const SidechainActivationStatus& status) const;
 };
 
 #endif // SIDECHAINACTIVATIONTABLEMODEL_H
@@ -14,6 +14,7 @@
 #endif
 
 #include <math.h>
+#include <set>
 
 #include <QIcon>
 #include <QMetaType>
@@ -23,7 +24,9 @@
 Q_DECLARE_METATYPE(SidechainEscrowTableObject)
 
 SidechainEscrowTableModel::SidechainEscrowTableModel(QObject *parent) :
-    QAbstractTableModel(parent)
+    QAbstractTableModel(parent),
+    fSynced(false),
+    nSequence(0)
 {
     // This timer will be fired repeatedly to update the model
     pollTimer = new QTimer(this);
@@ -134,8 +137,44 @@ void SidechainEscrowTableModel::updateModel()
         return;
 #endif
 
-    // TODO this is functional but not great
+    std::vector<SidechainDBChangeSet> vChangeSet;
+    uint64_t nSequenceNew;
+    if (!fSynced || !scdb.GetChangeSets(nSequence, vChangeSet, nSequenceNew)) {
+        loadModel();
+        return;
+    }
+
+    // Only the CTIP columns change unless sidechains are (de)activated
+    std::set<uint8_t> setCTIPChanged;
+    for (const SidechainDBChangeSet& changeSet : vChangeSet) {
+        if (changeSet.fSidechainsChanged) {
+            loadModel();
+            return;
+        }
+        setCTIPChanged.insert(changeSet.vCTIPChanged.begin(), changeSet.vCTIPChanged.end());
+    }
+    nSequence = nSequenceNew;
+
+    if (setCTIPChanged.empty())
+        return;
+
+    for (int i = 0; i < model.size(); i++) {
+        if (!model[i].canConvert<SidechainEscrowTableObject>())
+            continue;
+
+        SidechainEscrowTableObject object = model[i].value<SidechainEscrowTableObject>();
+        if (!setCTIPChanged.count(object.nSidechain))
+            continue;
 
+        setCTIP(object);
+        model[i] = QVariant::fromValue(object);
+
+        Q_EMIT dataChanged(index(i, 4), index(i, 5));
+    }
+}
+
+void SidechainEscrowTableModel::loadModel()
+{
     // Clear old data
     beginResetModel();
     model.clear();
@@ -144,7 +183,8 @@ void SidechainEscrowTableModel::updateModel()
     std::vector<Sidechain> vSidechain = scdb.GetActiveSidechains();
 
     int nSidechains = vSidechain.size();
-    beginInsertRows(QModelIndex(), 0, nSidechains - 1);
+    if (nSidechains)
+        beginInsertRows(QModelIndex(), 0, nSidechains - 1);
 
     for (const Sidechain& s : vSidechain) {
         SidechainEscrowTableObject object;
@@ -161,25 +201,36 @@ void SidechainEscrowTableModel::updateModel()
         object.address = QString::fromStdString(address.ToString());
         object.privKey = QString::fromStdString(s.strPrivKey);
 
-        // Get the sidechain CTIP info
-        SidechainCTIP ctip;
-        if (scdb.GetCTIP(s.nSidechain, ctip)) {
-                object.CTIPIndex = QString::number(ctip.out.n);
-                object.CTIPTxID = QString::fromStdString(ctip.out.hash.ToString());
-        } else {
-                object.CTIPIndex = "NA";
-                object.CTIPTxID = "NA";
-        }
+        setCTIP(object);
+
         model.append(QVariant::fromValue(object));
     }
 
-    endInsertRows();
+    if (nSidechains)
+        endInsertRows();
+
+    fSynced = true;
+    nSequence = scdb.GetChangeSequence();
+}
+
+void SidechainEscrowTableModel::setCTIP(SidechainEscrowTableObject& object) const
+{
+    // Get the sidechain CTIP info
+    SidechainCTIP ctip;
+    if (scdb.GetCTIP(object.nSidechain, ctip)) {
+        object.CTIPIndex = QString::number(ctip.out.n);
+        object.CTIPTxID = QString::fromStdString(ctip.out.hash.ToString());
+    } else {
+        object.CTIPIndex = "NA";
+        object.CTIPTxID = "NA";
+    }
 }
 
 void SidechainEscrowTableModel::AddDemoData()
 {
     // Stop updating the model with real data
     pollTimer->stop();
+    fSynced = false;
 
     // Clear old data
     beginResetModel();
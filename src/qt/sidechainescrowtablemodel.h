@@ -42,6 +42,16 @@ public Q_SLOTS:
 private:
     QList<QVariant> model;
     QTimer *pollTimer;
+
+    /** Whether the model holds real data up to SCDB change set nSequence */
+    bool fSynced;
+    uint64_t nSequence;
+
+    /** Load every active sidechain from SCDB, requires cs_main */
+    void loadModel();
+
+    /** Set the CTIP columns of object from SCDB, requires cs_main */
+    void setCTIP(SidechainEscrowTableObject& object) const;
 };
 
 #endif // SIDECHAINESCROWTABLEMODEL_H
@@ -11,6 +11,8 @@
 #include <wallet/wallet.h>
 #endif
 
+#include <algorithm>
+#include <map>
 #include <math.h>
 
 #include <QIcon>
@@ -38,7 +40,9 @@
 Q_DECLARE_METATYPE(SidechainWithdrawalTableObject)
 
 SidechainWithdrawalTableModel::SidechainWithdrawalTableModel(QObject *parent) :
-    QAbstractTableModel(parent)
+    QAbstractTableModel(parent),
+    fSynced(false),
+    nSequence(0)
 {
 }
 
@@ -164,42 +168,122 @@ QVariant SidechainWithdrawalTableModel::headerData(int section, Qt::Orientation
 
 void SidechainWithdrawalTableModel::updateModel()
 {
+    LOCK(cs_main);
+
     // Clear old data
     beginResetModel();
     model.clear();
     endResetModel();
 
+    fSynced = true;
+    nSequence = scdb.GetChangeSequence();
+
     if (!scdb.HasState())
         return;
 
-    std::vector<Sidechain> vSidechain = scdb.GetActiveSidechains();
-
-    int nSidechains = vSidechain.size();
-    beginInsertRows(QModelIndex(), model.size(), model.size() + nSidechains);
-    for (const Sidechain& s : vSidechain) {
-        std::vector<SidechainWithdrawalState> vState = scdb.GetState(s.nSidechain);
-        for (const SidechainWithdrawalState& state : vState) {
-            SidechainWithdrawalTableObject object;
-            object.sidechain = QString::fromStdString(s.GetSidechainName());
-            object.hash = QString::fromStdString(state.hash.ToString());
-            object.nAcks = state.nWorkScore;
-            object.nAge = abs(state.nBlocksLeft - SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
-            object.nMaxAge = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD;
-            object.fApproved = scdb.CheckWorkScore(state.nSidechain, state.hash);
-
-            model.append(QVariant::fromValue(object));
-        }
+    std::vector<std::vector<SidechainWithdrawalState>> vState = scdb.GetState();
+
+    QList<QVariant> vObject;
+    for (const Sidechain& s : scdb.GetActiveSidechains()) {
+        if (s.nSidechain >= vState.size())
+            continue;
+        for (const SidechainWithdrawalState& state : vState[s.nSidechain])
+            vObject.append(QVariant::fromValue(makeObject(state)));
     }
+
+    if (vObject.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), 0, vObject.size() - 1);
+    model = vObject;
     endInsertRows();
 }
 
 void SidechainWithdrawalTableModel::numBlocksChanged()
 {
-    updateModel();
+    // Don't hold up the GUI while a block is being connected, try again a
+    // little later instead
+    TRY_LOCK(cs_main, lockMain);
+    if (!lockMain) {
+        QTimer::singleShot(MODEL_UPDATE_DELAY, this, SLOT(numBlocksChanged()));
+        return;
+    }
+
+    std::vector<SidechainDBChangeSet> vChangeSet;
+    uint64_t nSequenceNew;
+    if (!fSynced || !scdb.GetChangeSets(nSequence, vChangeSet, nSequenceNew)) {
+        updateModel();
+        return;
+    }
+
+    for (const SidechainDBChangeSet& changeSet : vChangeSet) {
+        if (changeSet.fSidechainsChanged) {
+            updateModel();
+            return;
+        }
+
+        // Rows by sidechain number and withdrawal hash
+        std::map<std::pair<uint8_t, QString>, int> mapRow;
+        for (int i = 0; i < model.size(); i++) {
+            if (!model[i].canConvert<SidechainWithdrawalTableObject>())
+                continue;
+            SidechainWithdrawalTableObject object = model[i].value<SidechainWithdrawalTableObject>();
+            mapRow[std::make_pair(object.nSidechain, object.hash)] = i;
+        }
+
+        for (const SidechainWithdrawalState& state : changeSet.vWithdrawalUpdated) {
+            auto it = mapRow.find(std::make_pair(state.nSidechain, QString::fromStdString(state.hash.ToString())));
+            if (it == mapRow.end())
+                continue;
+
+            model[it->second] = QVariant::fromValue(makeObject(state));
+            Q_EMIT dataChanged(index(it->second, 0), index(it->second, columnCount() - 1));
+        }
+
+        // Remove from the bottom up so that the rows left to remove stay put
+        std::vector<int> vRemove;
+        for (const SidechainWithdrawalState& state : changeSet.vWithdrawalRemoved) {
+            auto it = mapRow.find(std::make_pair(state.nSidechain, QString::fromStdString(state.hash.ToString())));
+            if (it != mapRow.end())
+                vRemove.push_back(it->second);
+        }
+        std::sort(vRemove.rbegin(), vRemove.rend());
+        for (int nRow : vRemove) {
+            beginRemoveRows(QModelIndex(), nRow, nRow);
+            model.removeAt(nRow);
+            endRemoveRows();
+        }
+
+        if (!changeSet.vWithdrawalAdded.empty()) {
+            int nAdded = changeSet.vWithdrawalAdded.size();
+            beginInsertRows(QModelIndex(), model.size(), model.size() + nAdded - 1);
+            for (const SidechainWithdrawalState& state : changeSet.vWithdrawalAdded)
+                model.append(QVariant::fromValue(makeObject(state)));
+            endInsertRows();
+        }
+    }
+    nSequence = nSequenceNew;
+}
+
+SidechainWithdrawalTableObject SidechainWithdrawalTableModel::makeObject(const SidechainWithdrawalState& state) const
+{
+    SidechainWithdrawalTableObject object;
+    object.nSidechain = state.nSidechain;
+    object.sidechain = QString::fromStdString(scdb.GetSidechainName(state.nSidechain));
+    object.hash = QString::fromStdString(state.hash.ToString());
+    object.nAcks = state.nWorkScore;
+    object.nAge = abs(state.nBlocksLeft - SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD);
+    object.nMaxAge = SIDECHAIN_WITHDRAWAL_VERIFICATION_PERIOD;
+    object.fApproved = scdb.CheckWorkScore(state.nSidechain, state.hash);
+
+    return object;
 }
 
 void SidechainWithdrawalTableModel::AddDemoData()
 {
+    // Load real data again with the next block
+    fSynced = false;
+
     // Clear old data
     beginResetModel();
     model.clear();
@@ -298,4 +382,7 @@ void SidechainWithdrawalTableModel::ClearDemoData()
     beginResetModel();
     model.clear();
     endResetModel();
+
+    // Start syncing with real data again
+    numBlocksChanged();
 }
@@ -8,8 +8,11 @@ QT_BEGIN_NAMESPACE
 class QTimer;
 QT_END_NAMESPACE
 
+struct SidechainWithdrawalState;
+
 struct SidechainWithdrawalTableObject
 {
+    uint8_t nSidechain;
     QString sidechain;
     QString hash;
     uint16_t nAcks;
@@ -47,6 +50,13 @@ public Q_SLOTS:
 
 private:
     QList<QVariant> model;
+
+    /** Whether the model holds real data up to SCDB change set nSequence */
+    bool fSynced;
+    uint64_t nSequence;
+
+    /** Make a row for a withdrawal, requires cs_main */
+    SidechainWithdrawalTableObject makeObject(const SidechainWithdrawalState& state) const;
 };
 
 #endif // SIDECHAINWITHDRAWALTABLEMODEL_H
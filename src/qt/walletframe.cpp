@@ -39,6 +39,10 @@ WalletFrame::~WalletFrame()
 void WalletFrame::setClientModel(ClientModel *_clientModel)
 {
     this->clientModel = _clientModel;
+
+    QMap<QString, WalletView*>::const_iterator i;
+    for (i = mapWalletViews.constBegin(); i != mapWalletViews.constEnd(); ++i)
+        i.value()->setClientModel(_clientModel);
 }
 
 void WalletFrame::setWithdrawalModel(SidechainWithdrawalTableModel *model)
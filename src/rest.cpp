@@ -12,10 +12,12 @@
 #include <httpserver.h>
 #include <rpc/blockchain.h>
 #include <rpc/server.h>
+#include <rpc/stats.h>
 #include <streams.h>
 #include <sync.h>
 #include <txmempool.h>
 #include <utilstrencodings.h>
+#include <utiltime.h>
 #include <version.h>
 
 #include <boost/algorithm/string.hpp>
@@ -584,10 +586,35 @@ static const struct {
       {"/rest/getutxos", rest_getutxos},
 };
 
+/** Wrap a REST handler so its calls are recorded in g_rpc_stats as
+ * "rest/<endpoint>". Execution time includes writing the reply. */
+static HTTPRequestHandler WithStats(const std::string& strPrefix, bool (*handler)(HTTPRequest* req, const std::string& strReq))
+{
+    std::string strName = strPrefix.substr(1);
+    if (!strName.empty() && strName.back() == '/')
+        strName.pop_back();
+
+    return [strName, handler](HTTPRequest* req, const std::string& strReq) {
+        int64_t nStart = GetTimeMicros();
+        g_rpc_stats.RecordQueue(strName, nStart - req->GetTimeReceived());
+        int64_t nMainLockWaitStart = GetThreadMainLockWait();
+        bool fSuccess = false;
+        try {
+            fSuccess = handler(req, strReq);
+        } catch (...) {
+            g_rpc_stats.RecordExec(strName, GetTimeMicros() - nStart, GetThreadMainLockWait() - nMainLockWaitStart, true);
+            throw;
+        }
+        g_rpc_stats.RecordExec(strName, GetTimeMicros() - nStart, GetThreadMainLockWait() - nMainLockWaitStart, !fSuccess);
+        g_rpc_stats.RecordReply(strName, req->GetReplySize());
+        return fSuccess;
+    };
+}
+
 bool StartREST()
 {
     for (unsigned int i = 0; i < ARRAYLEN(uri_prefixes); i++)
-        RegisterHTTPHandler(uri_prefixes[i].prefix, false, uri_prefixes[i].handler);
+        RegisterHTTPHandler(uri_prefixes[i].prefix, false, WithStats(uri_prefixes[i].prefix, uri_prefixes[i].handler));
     return true;
 }
 
@@ -16,14 +16,19 @@
 #include <policy/feerate.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
+#include <sidechain.h>
+#include <sidechaindb.h>
 #include <streams.h>
 #include <sync.h>
 #include <txdb.h>
 #include <txmempool.h>
 #include <util.h>
+#include <utilmoneystr.h>
 #include <utilstrencodings.h>
 #include <hash.h>
+#include <opreturnindex.h>
 #include <validationinterface.h>
 #include <warnings.h>
 
@@ -42,6 +47,38 @@ struct CUpdatedBlock
     int height;
 };
 
+/** The parts of SCDB state that sidechain long-poll RPCs can wait on */
+struct CSidechainSnapshot
+{
+    uint256 hashBlock;
+    int nHeight = -1;
+    std::map<uint8_t, SidechainCTIP> mapCTIP;
+    uint256 hashWithdrawalState;
+    uint256 hashSidechains;
+    size_t nSpentWithdrawals = 0;
+    size_t nFailedWithdrawals = 0;
+};
+
+/** Names of the kinds of SCDB changes reported by waitforsidechainevent */
+static const char* const SIDECHAIN_EVENT_CTIP = "ctip";
+static const char* const SIDECHAIN_EVENT_WITHDRAWAL = "withdrawal";
+static const char* const SIDECHAIN_EVENT_SPENT = "spentwithdrawal";
+static const char* const SIDECHAIN_EVENT_FAILED = "failedwithdrawal";
+static const char* const SIDECHAIN_EVENT_SIDECHAIN = "sidechain";
+
+// Lock order: cs_main before cs_sidechainchange
+static std::mutex cs_sidechainchange;
+static std::condition_variable cond_sidechainchange;
+static bool fHaveSidechainSnapshot = false;
+static CSidechainSnapshot sidechainSnapshot;
+//! Incremented every time the snapshot differs from the previous one
+static uint64_t nSidechainEventSequence = 0;
+//! Sequence number of the last change of each kind
+static std::map<std::string, uint64_t> mapSidechainEventSequence;
+
+/** Number of mempool entries written per acquisition of mempool.cs when streaming */
+static const size_t MEMPOOL_STREAM_BATCH_SIZE = 1000;
+
 static std::mutex cs_blockchange;
 static std::condition_variable cond_blockchange;
 static CUpdatedBlock latestblock;
@@ -158,6 +195,31 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     return result;
 }
 
+void blockToJSONStream(const CBlock& block, const UniValue& blockSummary, JSONStreamWriter& stream)
+{
+    // Everything except the transactions comes from the verbosity 1 object,
+    // the transactions are written one at a time and never held all at once.
+    const std::vector<std::string>& keys = blockSummary.getKeys();
+    const std::vector<UniValue>& values = blockSummary.getValues();
+    stream.BeginObject();
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (keys[i] != "tx") {
+            stream.PushKV(keys[i], values[i]);
+            continue;
+        }
+        stream.Key("tx");
+        stream.BeginArray();
+        for (const auto& tx : block.vtx) {
+            UniValue objTx(UniValue::VOBJ);
+            TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags());
+            stream.Value(objTx);
+            stream.MaybeFlush();
+        }
+        stream.EndArray();
+    }
+    stream.EndObject();
+}
+
 UniValue getblockcount(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -324,6 +386,229 @@ UniValue waitforblockheight(const JSONRPCRequest& request)
     return ret;
 }
 
+static bool SidechainCTIPEqual(const SidechainCTIP& a, const SidechainCTIP& b)
+{
+    return a.out == b.out && a.amount == b.amount;
+}
+
+static CSidechainSnapshot GetSidechainSnapshot(const CBlockIndex* pindex)
+{
+    AssertLockHeld(cs_main);
+
+    CSidechainSnapshot snapshot;
+    if (pindex) {
+        snapshot.hashBlock = pindex->GetBlockHash();
+        snapshot.nHeight = pindex->nHeight;
+    }
+    snapshot.mapCTIP = scdb.GetCTIP();
+    snapshot.hashWithdrawalState = scdb.GetSCDBHash();
+    snapshot.hashSidechains = SerializeHash(std::make_pair(scdb.GetSidechains(), scdb.GetSidechainActivationStatus()));
+    snapshot.nSpentWithdrawals = scdb.GetSpentWithdrawalCount();
+    snapshot.nFailedWithdrawals = scdb.GetFailedWithdrawalCount();
+    return snapshot;
+}
+
+/** Replace the current snapshot, recording which kinds of state changed */
+static void UpdateSidechainSnapshot(const CSidechainSnapshot& snapshot)
+{
+    if (fHaveSidechainSnapshot) {
+        const CSidechainSnapshot& old = sidechainSnapshot;
+        std::vector<std::string> vChanged;
+
+        bool fCTIPChanged = old.mapCTIP.size() != snapshot.mapCTIP.size();
+        for (auto it = snapshot.mapCTIP.begin(); !fCTIPChanged && it != snapshot.mapCTIP.end(); it++) {
+            auto itOld = old.mapCTIP.find(it->first);
+            fCTIPChanged = itOld == old.mapCTIP.end() || !SidechainCTIPEqual(itOld->second, it->second);
+        }
+        if (fCTIPChanged)
+            vChanged.push_back(SIDECHAIN_EVENT_CTIP);
+        if (old.hashWithdrawalState != snapshot.hashWithdrawalState)
+            vChanged.push_back(SIDECHAIN_EVENT_WITHDRAWAL);
+        if (old.nSpentWithdrawals != snapshot.nSpentWithdrawals)
+            vChanged.push_back(SIDECHAIN_EVENT_SPENT);
+        if (old.nFailedWithdrawals != snapshot.nFailedWithdrawals)
+            vChanged.push_back(SIDECHAIN_EVENT_FAILED);
+        if (old.hashSidechains != snapshot.hashSidechains)
+            vChanged.push_back(SIDECHAIN_EVENT_SIDECHAIN);
+
+        if (!vChanged.empty()) {
+            nSidechainEventSequence++;
+            for (const std::string& strKind : vChanged)
+                mapSidechainEventSequence[strKind] = nSidechainEventSequence;
+        }
+    }
+    sidechainSnapshot = snapshot;
+    fHaveSidechainSnapshot = true;
+}
+
+/** Make sure there is a snapshot to compare against before waiting */
+static void InitSidechainSnapshot()
+{
+    LOCK(cs_main);
+    std::lock_guard<std::mutex> lock(cs_sidechainchange);
+    if (!fHaveSidechainSnapshot)
+        UpdateSidechainSnapshot(GetSidechainSnapshot(chainActive.Tip()));
+}
+
+void RPCNotifySidechainChange(bool ibd, const CBlockIndex* pindex)
+{
+    if (pindex) {
+        // SCDB may already be ahead of pindex, label it with the tip it matches
+        LOCK(cs_main);
+        std::lock_guard<std::mutex> lock(cs_sidechainchange);
+        UpdateSidechainSnapshot(GetSidechainSnapshot(chainActive.Tip()));
+    }
+    cond_sidechainchange.notify_all();
+}
+
+/** Wait on cond_sidechainchange until pred is true, timeout (in milliseconds,
+ * 0 for none) expires or the RPC server stops */
+template <typename Predicate>
+static void WaitForSidechainChange(std::unique_lock<std::mutex>& lock, int timeout, Predicate pred)
+{
+    if (timeout)
+        cond_sidechainchange.wait_for(lock, std::chrono::milliseconds(timeout), [&pred]{ return pred() || !IsRPCRunning(); });
+    else
+        cond_sidechainchange.wait(lock, [&pred]{ return pred() || !IsRPCRunning(); });
+}
+
+UniValue waitforsidechainevent(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 2)
+        throw std::runtime_error(
+            "waitforsidechainevent ( sequence timeout )\n"
+            "\nWaits until a new block changes the sidechain state tracked by SCDB.\n"
+            "Pass the sequence number of the previous result to resume without\n"
+            "missing events that happened in between calls.\n"
+            "\nReturns the current state on timeout or exit.\n"
+            "\nArguments:\n"
+            "1. sequence (numeric, optional) Return once the event sequence number is higher than this.\n"
+            "                                Defaults to the current sequence number, i.e. waits for the next event.\n"
+            "2. timeout  (numeric, optional, default=0) Time in milliseconds to wait for a response. 0 indicates no timeout.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"sequence\" : n,        (numeric) The current event sequence number\n"
+            "  \"hash\" : \"hash\",       (string) The blockhash of the tip the state belongs to\n"
+            "  \"height\" : n,          (numeric) Block height of that tip\n"
+            "  \"changed\" : [          (array) What changed since the given sequence number:\n"
+            "     \"ctip\"               sidechain CTIP (deposits and withdrawal payouts)\n"
+            "     \"withdrawal\"         withdrawal bundles or their work scores\n"
+            "     \"spentwithdrawal\"    spent withdrawal bundles\n"
+            "     \"failedwithdrawal\"   failed withdrawal bundles\n"
+            "     \"sidechain\"          sidechain activation\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("waitforsidechainevent", "")
+            + HelpExampleCli("waitforsidechainevent", "12 60000")
+            + HelpExampleRpc("waitforsidechainevent", "12, 60000")
+        );
+
+    InitSidechainSnapshot();
+
+    int timeout = 0;
+    if (!request.params[1].isNull())
+        timeout = request.params[1].get_int();
+
+    UniValue ret(UniValue::VOBJ);
+    {
+        std::unique_lock<std::mutex> lock(cs_sidechainchange);
+        uint64_t nSequence = nSidechainEventSequence;
+        if (!request.params[0].isNull()) {
+            int64_t nSequenceIn = request.params[0].get_int64();
+            if (nSequenceIn < 0)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sequence number");
+            nSequence = nSequenceIn;
+        }
+
+        WaitForSidechainChange(lock, timeout, [nSequence]{ return nSidechainEventSequence > nSequence; });
+
+        UniValue changed(UniValue::VARR);
+        for (const auto& it : mapSidechainEventSequence) {
+            if (it.second > nSequence)
+                changed.push_back(it.first);
+        }
+        ret.push_back(Pair("sequence", (uint64_t)nSidechainEventSequence));
+        ret.push_back(Pair("hash", sidechainSnapshot.hashBlock.GetHex()));
+        ret.push_back(Pair("height", sidechainSnapshot.nHeight));
+        ret.push_back(Pair("changed", changed));
+    }
+    return ret;
+}
+
+UniValue waitforctipchange(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
+        throw std::runtime_error(
+            "waitforctipchange nsidechain \"known_ctip\" ( timeout )\n"
+            "\nWaits until the CTIP (critical transaction index pair) of a sidechain\n"
+            "is different from the one the caller already knows.\n"
+            "\nReturns the current CTIP on timeout or exit.\n"
+            "\nArguments:\n"
+            "1. nsidechain    (numeric, required) The sidechain number\n"
+            "2. \"known_ctip\"  (string, required) The CTIP known to the caller as \"txid:n\",\n"
+            "                 or \"\" if the sidechain had no CTIP\n"
+            "3. timeout       (numeric, optional, default=0) Time in milliseconds to wait for a response. 0 indicates no timeout.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"changed\" : true|false,    (boolean) Whether the CTIP differs from known_ctip\n"
+            "  \"txid\" : \"txid\",           (string) The CTIP txid, omitted if there is no CTIP\n"
+            "  \"n\" : n,                   (numeric) The CTIP output index\n"
+            "  \"amount\" : n,              (numeric) The CTIP amount in satoshis\n"
+            "  \"amountformatted\" : \"x\"    (string) The CTIP amount\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("waitforctipchange", "0 \"\" 60000")
+            + HelpExampleRpc("waitforctipchange", "0, \"txid:n\", 60000")
+        );
+
+    int nSidechain = request.params[0].get_int();
+    if (nSidechain < 0 || nSidechain > 255)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sidechain number!");
+
+    bool fKnown = false;
+    COutPoint known;
+    const std::string strKnown = request.params[1].get_str();
+    if (!strKnown.empty()) {
+        size_t nPos = strKnown.find(':');
+        int32_t n;
+        if (nPos == std::string::npos || !IsHex(strKnown.substr(0, nPos)) || !ParseInt32(strKnown.substr(nPos + 1), &n) || n < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid known_ctip, expected \"txid:n\"");
+        known = COutPoint(uint256S(strKnown.substr(0, nPos)), n);
+        fKnown = true;
+    }
+
+    int timeout = 0;
+    if (!request.params[2].isNull())
+        timeout = request.params[2].get_int();
+
+    InitSidechainSnapshot();
+
+    UniValue ret(UniValue::VOBJ);
+    {
+        std::unique_lock<std::mutex> lock(cs_sidechainchange);
+        auto fnChanged = [nSidechain, fKnown, &known]{
+            auto it = sidechainSnapshot.mapCTIP.find(nSidechain);
+            if (it == sidechainSnapshot.mapCTIP.end())
+                return fKnown;
+            return !fKnown || it->second.out != known;
+        };
+
+        WaitForSidechainChange(lock, timeout, fnChanged);
+
+        ret.push_back(Pair("changed", fnChanged()));
+        auto it = sidechainSnapshot.mapCTIP.find(nSidechain);
+        if (it != sidechainSnapshot.mapCTIP.end()) {
+            const SidechainCTIP& ctip = it->second;
+            ret.push_back(Pair("txid", ctip.out.hash.ToString()));
+            ret.push_back(Pair("n", (int64_t)ctip.out.n));
+            ret.push_back(Pair("amount", ctip.amount));
+            ret.push_back(Pair("amountformatted", FormatMoney(ctip.amount)));
+        }
+    }
+    return ret;
+}
+
 UniValue syncwithvalidationinterfacequeue(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 0) {
@@ -436,6 +721,34 @@ UniValue mempoolToJSON(bool fVerbose)
     }
 }
 
+void mempoolToJSONStream(JSONStreamWriter& stream)
+{
+    // mempool.cs is only held for one batch of entries at a time, so a slow
+    // client doesn't stall the mempool. Transactions removed in the meantime
+    // are skipped.
+    std::vector<uint256> vtxid;
+    mempool.queryHashes(vtxid);
+
+    stream.BeginObject();
+    size_t i = 0;
+    while (i < vtxid.size()) {
+        {
+            LOCK(mempool.cs);
+            size_t nBatchEnd = std::min(vtxid.size(), i + MEMPOOL_STREAM_BATCH_SIZE);
+            for (; i < nBatchEnd; i++) {
+                CTxMemPool::txiter it = mempool.mapTx.find(vtxid[i]);
+                if (it == mempool.mapTx.end())
+                    continue;
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(info, *it);
+                stream.PushKV(vtxid[i].ToString(), info);
+            }
+        }
+        stream.MaybeFlush();
+    }
+    stream.EndObject();
+}
+
 UniValue getrawmempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 1)
@@ -465,6 +778,11 @@ UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
+    if (fVerbose && request.stream) {
+        mempoolToJSONStream(*request.stream);
+        return NullUniValue;
+    }
+
     return mempoolToJSON(fVerbose);
 }
 
@@ -763,8 +1081,6 @@ UniValue getblock(const JSONRPCRequest& request)
             + HelpExampleRpc("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"")
         );
 
-    LOCK(cs_main);
-
     std::string strHash = request.params[0].get_str();
     uint256 hash(uint256S(strHash));
 
@@ -776,32 +1092,44 @@ UniValue getblock(const JSONRPCRequest& request)
             verbosity = request.params[1].get_bool() ? 1 : 0;
     }
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-
     CBlock block;
-    CBlockIndex* pblockindex = mapBlockIndex[hash];
+    UniValue blockSummary;
+    {
+        LOCK(cs_main);
 
-    if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
-        throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+        if (mapBlockIndex.count(hash) == 0)
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
-    if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-        // Block not found on disk. This could be because we have the block
-        // header in our index but don't have the block (for example if a
-        // non-whitelisted node sends us an unrequested long chain of valid
-        // blocks, we add the headers to our index, but don't accept the
-        // block).
-        throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+        CBlockIndex* pblockindex = mapBlockIndex[hash];
 
-    if (verbosity <= 0)
-    {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
-        return strHex;
+        if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+
+        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+            // Block not found on disk. This could be because we have the block
+            // header in our index but don't have the block (for example if a
+            // non-whitelisted node sends us an unrequested long chain of valid
+            // blocks, we add the headers to our index, but don't accept the
+            // block).
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+
+        if (verbosity <= 0)
+        {
+            CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+            ssBlock << block;
+            std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
+            return strHex;
+        }
+
+        if (verbosity < 2 || !request.stream)
+            return blockToJSON(block, pblockindex, verbosity >= 2);
+
+        blockSummary = blockToJSON(block, pblockindex, false);
     }
 
-    return blockToJSON(block, pblockindex, verbosity >= 2);
+    // Stream transaction details to the client without holding cs_main
+    blockToJSONStream(block, blockSummary, *request.stream);
+    return NullUniValue;
 }
 
 struct CCoinsStats
@@ -814,8 +1142,9 @@ struct CCoinsStats
     uint256 hashSerialized;
     uint64_t nDiskSize;
     CAmount nTotalAmount;
+    CAmount nEscrowAmount;
 
-    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0) {}
+    CCoinsStats() : nHeight(0), nTransactions(0), nTransactionOutputs(0), nBogoSize(0), nDiskSize(0), nTotalAmount(0), nEscrowAmount(0) {}
 };
 
 static void ApplyStats(CCoinsStats &stats, CHashWriter& ss, const uint256& hash, const std::map<uint32_t, Coin>& outputs)
@@ -847,6 +1176,8 @@ static bool GetUTXOStats(CCoinsView *view, CCoinsStats &stats)
     {
         LOCK(cs_main);
         stats.nHeight = mapBlockIndex.find(stats.hashBlock)->second->nHeight;
+        for (const std::pair<uint8_t, SidechainCTIP>& ctip : scdb.GetCTIP())
+            stats.nEscrowAmount += ctip.second.amount;
     }
     ss << stats.hashBlock;
     uint256 prevkey;
@@ -926,29 +1257,92 @@ UniValue pruneblockchain(const JSONRPCRequest& request)
 
 UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
-            "gettxoutsetinfo\n"
+            "gettxoutsetinfo ( \"hash_type\" hash_or_height )\n"
             "\nReturns statistics about the unspent transaction output set.\n"
-            "Note this call may take some time.\n"
+            "With hash_type hash_serialized_2 the set is scanned, which may take some time.\n"
+            "With hash_type muhash the statistics recorded when the block was connected are\n"
+            "returned, for the tip or any earlier block of the active chain.\n"
+            "\nArguments:\n"
+            "1. \"hash_type\"        (string, optional, default=hash_serialized_2) hash_serialized_2 or muhash\n"
+            "2. hash_or_height     (string or numeric, optional) The block hash or height, only for muhash. Default: the tip\n"
             "\nResult:\n"
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
             "  \"bestblock\": \"hex\",   (string) the best block hash hex\n"
-            "  \"transactions\": n,      (numeric) The number of transactions\n"
+            "  \"transactions\": n,      (numeric) The number of transactions, only for hash_serialized_2\n"
             "  \"txouts\": n,            (numeric) The number of output transactions\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
-            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
-            "  \"total_amount\": x.xxx          (numeric) The total amount\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash, only for hash_serialized_2\n"
+            "  \"muhash\": \"hash\",      (string) The MuHash3072 set hash, only for muhash\n"
+            "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk, only for hash_serialized_2\n"
+            "  \"total_amount\": x.xxx,  (numeric) The total amount\n"
+            "  \"escrow_amount\": x.xxx  (numeric) The amount held by the sidechains' CTIPs\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("gettxoutsetinfo", "")
-            + HelpExampleRpc("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "muhash 1000")
+            + HelpExampleRpc("gettxoutsetinfo", "\"muhash\", 1000")
         );
 
+    std::string strHashType = "hash_serialized_2";
+    if (!request.params[0].isNull())
+        strHashType = request.params[0].get_str();
+    if (strHashType != "hash_serialized_2" && strHashType != "muhash")
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown hash_type, use hash_serialized_2 or muhash");
+
     UniValue ret(UniValue::VOBJ);
 
+    if (strHashType == "muhash") {
+        uint256 hashBlock;
+        int nHeight;
+        {
+            LOCK(cs_main);
+            const CBlockIndex* pindex = chainActive.Tip();
+            const UniValue& param = request.params[1];
+            if (param.isNum() || (param.isStr() && param.get_str().size() != 64)) {
+                int n;
+                if (param.isNum())
+                    n = param.get_int();
+                else if (!ParseInt32(param.get_str(), &n))
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block hash or height");
+                if (n < 0 || n > chainActive.Height())
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+                pindex = chainActive[n];
+            } else if (!param.isNull()) {
+                uint256 hash = ParseHashV(param, "hash_or_height");
+                BlockMap::const_iterator it = mapBlockIndex.find(hash);
+                if (it == mapBlockIndex.end())
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+                if (!chainActive.Contains(it->second))
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Block is not in the active chain");
+                pindex = it->second;
+            }
+            hashBlock = pindex->GetBlockHash();
+            nHeight = pindex->nHeight;
+        }
+
+        UTXOSetStats stats;
+        if (!pblockstatsdb->ReadUTXOSetStats(hashBlock, stats))
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("No UTXO set statistics for block %s (connected before they were recorded)", hashBlock.GetHex()));
+
+        uint256 hashMuHash;
+        stats.muhash.Finalize(hashMuHash.begin());
+
+        ret.push_back(Pair("height", nHeight));
+        ret.push_back(Pair("bestblock", hashBlock.GetHex()));
+        ret.push_back(Pair("txouts", stats.nTransactionOutputs));
+        ret.push_back(Pair("bogosize", stats.nBogoSize));
+        ret.push_back(Pair("muhash", hashMuHash.GetHex()));
+        ret.push_back(Pair("total_amount", ValueFromAmount(stats.totalAmount)));
+        ret.push_back(Pair("escrow_amount", ValueFromAmount(stats.escrowAmount)));
+        return ret;
+    }
+
+    if (!request.params[1].isNull())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "hash_serialized_2 is only available for the tip, use hash_type muhash");
+
     CCoinsStats stats;
     FlushStateToDisk();
     if (GetUTXOStats(pcoinsdbview.get(), stats)) {
@@ -960,6 +1354,7 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
         ret.push_back(Pair("hash_serialized_2", stats.hashSerialized.GetHex()));
         ret.push_back(Pair("disk_size", stats.nDiskSize));
         ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+        ret.push_back(Pair("escrow_amount", ValueFromAmount(stats.nEscrowAmount)));
     } else {
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
     }
@@ -1402,6 +1797,77 @@ UniValue getmempoolinfo(const JSONRPCRequest& request)
     return mempoolInfoToJSON();
 }
 
+UniValue getmempooldeltas(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getmempooldeltas ( sequence )\n"
+            "\nReturns the transactions added to and removed from the mempool after a sequence number.\n"
+            "\nPass in the sequence returned by the previous call to follow the mempool without\n"
+            "listing all of it. If \"complete\" is false some changes are no longer kept and the\n"
+            "caller should start over from getrawmempool.\n"
+            "\nArguments:\n"
+            "1. sequence       (numeric, optional) The sequence returned by the previous call. Omit to get the current sequence only.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"sequence\": n,              (numeric) The sequence to pass in next time\n"
+            "  \"complete\": true|false,     (boolean) Whether all changes after the given sequence are listed\n"
+            "  \"deltas\": [                 (array) The changes, oldest first\n"
+            "    {\n"
+            "      \"sequence\": n,          (numeric) Sequence number of the change\n"
+            "      \"txid\": \"hash\",         (string) The transaction id\n"
+            "      \"added\": true|false,    (boolean) Whether the transaction was added or removed\n"
+            "      \"time\": n,              (numeric) Added only. Time the transaction entered the mempool\n"
+            "      \"fee\": n,               (numeric) Added only. Transaction fee in " + CURRENCY_UNIT + "\n"
+            "      \"vsize\": n,             (numeric) Added only. Virtual transaction size\n"
+            "      \"reason\": \"str\"         (string) Removed only. Why the transaction was removed\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmempooldeltas", "")
+            + HelpExampleCli("getmempooldeltas", "1000")
+            + HelpExampleRpc("getmempooldeltas", "1000")
+        );
+
+    UniValue ret(UniValue::VOBJ);
+    if (request.params[0].isNull()) {
+        ret.push_back(Pair("sequence", (uint64_t)mempool.GetDeltaSequence()));
+        ret.push_back(Pair("complete", true));
+        ret.push_back(Pair("deltas", UniValue(UniValue::VARR)));
+        return ret;
+    }
+
+    int64_t nSequence = request.params[0].get_int64();
+    if (nSequence < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative sequence");
+
+    std::vector<TxMempoolDelta> vDelta;
+    uint64_t nSequenceNext;
+    bool fComplete = mempool.GetDeltas(nSequence, vDelta, nSequenceNext);
+
+    UniValue deltas(UniValue::VARR);
+    for (const TxMempoolDelta& delta : vDelta) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("sequence", delta.nSequence));
+        obj.push_back(Pair("txid", delta.txid.GetHex()));
+        obj.push_back(Pair("added", delta.fAdded));
+        if (delta.fAdded) {
+            obj.push_back(Pair("time", delta.nTime));
+            obj.push_back(Pair("fee", ValueFromAmount(delta.nFee)));
+            obj.push_back(Pair("vsize", delta.nVsize));
+        } else {
+            obj.push_back(Pair("reason", RemovalReasonToString(delta.reason)));
+        }
+        deltas.push_back(obj);
+    }
+
+    ret.push_back(Pair("sequence", nSequenceNext));
+    ret.push_back(Pair("complete", fComplete));
+    ret.push_back(Pair("deltas", deltas));
+    return ret;
+}
+
 UniValue preciousblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1596,6 +2062,143 @@ UniValue getchaintxstats(const JSONRPCRequest& request)
     return ret;
 }
 
+static UniValue BlockStatsToJSON(const uint256& hashBlock, const BlockStats& stats)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("height", stats.nHeight));
+    obj.push_back(Pair("hash", hashBlock.GetHex()));
+    obj.push_back(Pair("time", stats.nTime));
+    obj.push_back(Pair("txs", (uint64_t)stats.nTx));
+    obj.push_back(Pair("size", (uint64_t)stats.nSize));
+    obj.push_back(Pair("weight", (uint64_t)stats.nWeight));
+    obj.push_back(Pair("totalfee", ValueFromAmount(stats.totalFees)));
+    obj.push_back(Pair("avgfeerate", stats.nFeeWeight ? stats.totalFees * WITNESS_SCALE_FACTOR / stats.nFeeWeight : 0));
+    UniValue percentiles(UniValue::VARR);
+    for (const CAmount& feerate : stats.vFeeRatePercentiles)
+        percentiles.push_back(feerate);
+    obj.push_back(Pair("feerate_percentiles", percentiles));
+    obj.push_back(Pair("opreturns", (uint64_t)stats.nOPReturn));
+    obj.push_back(Pair("depositvolume", ValueFromAmount(stats.depositVolume)));
+    obj.push_back(Pair("withdrawalvolume", ValueFromAmount(stats.withdrawalVolume)));
+    return obj;
+}
+
+UniValue getblockstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
+        throw std::runtime_error(
+            "getblockstats height ( nblocks verbose )\n"
+            "\nCompute fee and size statistics for a range of blocks of the active chain.\n"
+            "Statistics are recorded when blocks are connected, so no blocks are read from disk.\n"
+            "Blocks connected by older versions have no statistics until -reindex-chainstate.\n"
+            "\nArguments:\n"
+            "1. height          (numeric, required) Height of the first block of the range\n"
+            "2. nblocks         (numeric, optional, default=1) Number of blocks in the range\n"
+            "3. verbose         (boolean, optional, default=false) Include the statistics of every block\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"startheight\": xxxxx,      (numeric) Height of the first block\n"
+            "  \"endheight\": xxxxx,        (numeric) Height of the last block\n"
+            "  \"blocks\": xxxxx,           (numeric) Number of blocks\n"
+            "  \"txs\": xxxxx,              (numeric) Number of transactions (including coinbase)\n"
+            "  \"totalsize\": xxxxx,        (numeric) Total size of the blocks\n"
+            "  \"totalweight\": xxxxx,      (numeric) Total weight of the blocks\n"
+            "  \"totalfee\": x.xxx,         (numeric) Total fees in " + CURRENCY_UNIT + "\n"
+            "  \"avgfee\": x.xxx,           (numeric) Average fee per transaction (excluding coinbase) in " + CURRENCY_UNIT + "\n"
+            "  \"avgfeerate\": xxxxx,       (numeric) Average fee rate in satoshis per virtual byte\n"
+            "  \"opreturns\": xxxxx,        (numeric) Number of OP_RETURN outputs\n"
+            "  \"depositvolume\": x.xxx,    (numeric) Amount deposited into sidechains in " + CURRENCY_UNIT + "\n"
+            "  \"withdrawalvolume\": x.xxx, (numeric) Amount withdrawn from sidechains in " + CURRENCY_UNIT + "\n"
+            "  \"blockstats\": [            (array) Only if verbose is true\n"
+            "    {\n"
+            "      \"height\": xxxxx,       (numeric) The block height\n"
+            "      \"hash\": \"hash\",        (string) The block hash\n"
+            "      \"time\": ttt,           (numeric) The block time\n"
+            "      \"txs\", \"size\", \"weight\", \"totalfee\", \"avgfeerate\", \"opreturns\",\n"
+            "      \"depositvolume\", \"withdrawalvolume\": as above for this block\n"
+            "      \"feerate_percentiles\": [ xx, ... ]  (array) 10th, 25th, 50th, 75th and 90th\n"
+            "                               percentile fee rates in satoshis per virtual byte\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getblockstats", "1000 144")
+            + HelpExampleRpc("getblockstats", "1000, 144, true")
+        );
+
+    int nHeight = request.params[0].get_int();
+
+    int nBlocks = 1;
+    if (!request.params[1].isNull())
+        nBlocks = request.params[1].get_int();
+
+    bool fVerbose = false;
+    if (!request.params[2].isNull())
+        fVerbose = request.params[2].get_bool();
+
+    // Only hold cs_main to look up the block hashes
+    std::vector<uint256> vHash;
+    {
+        LOCK(cs_main);
+        if (nHeight < 0 || nHeight > chainActive.Height())
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+        if (nBlocks < 1 || nBlocks > chainActive.Height() - nHeight + 1)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid number of blocks");
+
+        vHash.reserve(nBlocks);
+        for (int i = nHeight; i < nHeight + nBlocks; i++)
+            vHash.push_back(chainActive[i]->GetBlockHash());
+    }
+
+    uint64_t nTx = 0;
+    uint64_t nSize = 0;
+    uint64_t nWeight = 0;
+    int64_t nFeeWeight = 0;
+    CAmount totalFees = 0;
+    uint64_t nOPReturn = 0;
+    CAmount depositVolume = 0;
+    CAmount withdrawalVolume = 0;
+    UniValue blockstats(UniValue::VARR);
+    for (const uint256& hash : vHash) {
+        BlockStats stats;
+        if (!pblockstatsdb->ReadBlockStats(hash, stats))
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("No statistics for block %s (connected before the index existed, use -reindex-chainstate)", hash.GetHex()));
+
+        nTx += stats.nTx;
+        nSize += stats.nSize;
+        nWeight += stats.nWeight;
+        nFeeWeight += stats.nFeeWeight;
+        totalFees += stats.totalFees;
+        nOPReturn += stats.nOPReturn;
+        depositVolume += stats.depositVolume;
+        withdrawalVolume += stats.withdrawalVolume;
+
+        if (fVerbose)
+            blockstats.push_back(BlockStatsToJSON(hash, stats));
+    }
+
+    // Every block has a coinbase, which pays no fee
+    uint64_t nFeeTx = nTx - vHash.size();
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("startheight", nHeight));
+    ret.push_back(Pair("endheight", nHeight + nBlocks - 1));
+    ret.push_back(Pair("blocks", nBlocks));
+    ret.push_back(Pair("txs", nTx));
+    ret.push_back(Pair("totalsize", nSize));
+    ret.push_back(Pair("totalweight", nWeight));
+    ret.push_back(Pair("totalfee", ValueFromAmount(totalFees)));
+    ret.push_back(Pair("avgfee", ValueFromAmount(nFeeTx ? totalFees / (CAmount)nFeeTx : 0)));
+    ret.push_back(Pair("avgfeerate", nFeeWeight ? totalFees * WITNESS_SCALE_FACTOR / nFeeWeight : 0));
+    ret.push_back(Pair("opreturns", nOPReturn));
+    ret.push_back(Pair("depositvolume", ValueFromAmount(depositVolume)));
+    ret.push_back(Pair("withdrawalvolume", ValueFromAmount(withdrawalVolume)));
+    if (fVerbose)
+        ret.push_back(Pair("blockstats", blockstats));
+
+    return ret;
+}
+
 UniValue savemempool(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0) {
@@ -1615,11 +2218,260 @@ UniValue savemempool(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+UniValue dumptxoutset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "dumptxoutset \"path\"\n"
+            "\nWrite the UTXO set, the block headers and the sidechain database state at the tip to a snapshot file,\n"
+            "which loadtxoutset can bootstrap a new node with.\n"
+            "\nArguments:\n"
+            "1. \"path\"           (string, required) Path of the file to write, relative to the data directory if not absolute\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"coins_written\": n,       (numeric) The number of coins written\n"
+            "  \"base_hash\": \"hash\",      (string) The hash of the block the snapshot was made at\n"
+            "  \"base_height\": n,         (numeric) The height of that block\n"
+            "  \"snapshot_hash\": \"hash\",  (string) The hash of the file, for -assumeutxo=<base_height>:<snapshot_hash>\n"
+            "  \"path\": \"path\"            (string) The absolute path of the file\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("dumptxoutset", "\"utxo.dat\"")
+            + HelpExampleRpc("dumptxoutset", "\"utxo.dat\"")
+        );
+    }
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (fs::exists(path)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " already exists");
+    }
+
+    SnapshotMetadata metadata;
+    uint64_t nCoins = 0;
+    uint256 hashSnapshot;
+    std::string strError;
+    if (!DumpUTXOSnapshot(path, metadata, nCoins, hashSnapshot, strError)) {
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("coins_written", nCoins));
+    ret.push_back(Pair("base_hash", metadata.hashBase.GetHex()));
+    ret.push_back(Pair("base_height", metadata.nHeight));
+    ret.push_back(Pair("snapshot_hash", hashSnapshot.GetHex()));
+    ret.push_back(Pair("path", path.string()));
+    return ret;
+}
+
+UniValue loadtxoutset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "loadtxoutset \"path\"\n"
+            "\nLoad a snapshot written by dumptxoutset and continue the chain from its base block.\n"
+            "The hash of the file must be trusted through -assumeutxo or the chain parameters, and the node must not\n"
+            "have connected any block after genesis (start it with -connect=0). The blocks up to the base are not\n"
+            "downloaded or validated.\n"
+            "\nArguments:\n"
+            "1. \"path\"           (string, required) Path of the snapshot, relative to the data directory if not absolute\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"coins_loaded\": n,        (numeric) The number of coins loaded\n"
+            "  \"base_hash\": \"hash\",      (string) The hash of the new tip\n"
+            "  \"base_height\": n          (numeric) The height of the new tip\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("loadtxoutset", "\"utxo.dat\"")
+            + HelpExampleRpc("loadtxoutset", "\"utxo.dat\"")
+        );
+    }
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+
+    SnapshotMetadata metadata;
+    uint64_t nCoins = 0;
+    std::string strError;
+    if (!LoadUTXOSnapshot(Params(), path, metadata, nCoins, strError)) {
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+    }
+
+    // Connect the blocks after the base we may already have
+    CValidationState state;
+    if (!ActivateBestChain(state, Params())) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, state.GetRejectReason());
+    }
+
+    // The OP_RETURN index starts over after the base
+    if (g_opreturn_index) {
+        g_opreturn_index->Rebuild();
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("coins_loaded", nCoins));
+    ret.push_back(Pair("base_hash", metadata.hashBase.GetHex()));
+    ret.push_back(Pair("base_height", metadata.nHeight));
+    return ret;
+}
+
+/** The databases by the name of their directory, which the -db* options use */
+static std::vector<std::pair<std::string, const CDBWrapper*>> GetNamedDBs()
+{
+    LOCK(cs_main);
+    std::vector<std::pair<std::string, const CDBWrapper*>> vDBs;
+    if (pcoinsdbview)
+        vDBs.emplace_back("chainstate", &pcoinsdbview->GetDB());
+    if (pblocktree)
+        vDBs.emplace_back("index", pblocktree.get());
+    if (psidechaintree)
+        vDBs.emplace_back("sidechain", psidechaintree.get());
+    if (popreturndb)
+        vDBs.emplace_back("opreturn", popreturndb.get());
+    if (pblockstatsdb)
+        vDBs.emplace_back("stats", pblockstatsdb.get());
+    return vDBs;
+}
+
+static UniValue DBInfoToJSON(const CDBWrapper& db)
+{
+    const CDBOptions& dbopts = db.GetDBOptions();
+    UniValue options(UniValue::VOBJ);
+    options.push_back(Pair("max_open_files", dbopts.nMaxOpenFiles));
+    options.push_back(Pair("compression", dbopts.fCompression));
+    options.push_back(Pair("bloom_bits", dbopts.nBloomBits));
+    options.push_back(Pair("block_cache_percent", dbopts.nBlockCachePercent));
+
+    UniValue files(UniValue::VARR);
+    for (int nLevel = 0; ; nLevel++) {
+        std::string strFiles = db.GetProperty(strprintf("leveldb.num-files-at-level%d", nLevel));
+        if (strFiles.empty())
+            break;
+        files.push_back(atoi(strFiles));
+    }
+
+    CDBStats stats = db.GetStats();
+    uint64_t nLookups = stats.nCacheHits + stats.nCacheMisses;
+    UniValue cache(UniValue::VOBJ);
+    cache.push_back(Pair("usage", (uint64_t)stats.nCacheUsage));
+    cache.push_back(Pair("hits", stats.nCacheHits));
+    cache.push_back(Pair("misses", stats.nCacheMisses));
+    cache.push_back(Pair("hit_rate", nLookups ? (double)stats.nCacheHits / nLookups : 0.0));
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("options", options));
+    ret.push_back(Pair("approximate_size", db.EstimateTotalSize()));
+    ret.push_back(Pair("memtable_usage", atoi64(db.GetProperty("leveldb.approximate-memory-usage"))));
+    ret.push_back(Pair("files_per_level", files));
+    ret.push_back(Pair("writes", stats.nWrites));
+    ret.push_back(Pair("write_time", stats.nWriteMicros * 0.000001));
+    ret.push_back(Pair("stalls", stats.nStalls));
+    ret.push_back(Pair("stall_time", stats.nStallMicros * 0.000001));
+    ret.push_back(Pair("flushes", stats.nFlushes));
+    ret.push_back(Pair("compactions", stats.nCompactions));
+    ret.push_back(Pair("block_cache", cache));
+    ret.push_back(Pair("leveldb_stats", db.GetProperty("leveldb.stats")));
+    return ret;
+}
+
+UniValue getdbinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1) {
+        throw std::runtime_error(
+            "getdbinfo ( \"name\" )\n"
+            "\nReturns the options and statistics of the LevelDB databases, counted since the node started.\n"
+            "\nArguments:\n"
+            "1. \"name\"             (string, optional) Only this database: chainstate, index, sidechain, opreturn or stats\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"name\": {                    (json object) The database in the directory of this name\n"
+            "    \"options\": {               (json object) The -db* options in effect\n"
+            "      \"max_open_files\": n,\n"
+            "      \"compression\": true|false,\n"
+            "      \"bloom_bits\": n,\n"
+            "      \"block_cache_percent\": n\n"
+            "    },\n"
+            "    \"approximate_size\": n,     (numeric) The approximate size on disk in bytes\n"
+            "    \"memtable_usage\": n,       (numeric) The memory used by the write buffers in bytes\n"
+            "    \"files_per_level\": [n,...], (json array) The number of table files in each level\n"
+            "    \"writes\": n,               (numeric) The number of batches written\n"
+            "    \"write_time\": x.xxx,       (numeric) The time spent writing them in seconds\n"
+            "    \"stalls\": n,               (numeric) The number of times a write waited for a flush or for level 0 to be compacted\n"
+            "    \"stall_time\": x.xxx,       (numeric) The time spent in the writes that waited in seconds\n"
+            "    \"flushes\": n,              (numeric) The number of write buffers written to level 0\n"
+            "    \"compactions\": n,          (numeric) The number of compactions\n"
+            "    \"block_cache\": {           (json object) The block cache\n"
+            "      \"usage\": n,              (numeric) The bytes used\n"
+            "      \"hits\": n,               (numeric) The lookups that found the block\n"
+            "      \"misses\": n,             (numeric) The lookups that didn't\n"
+            "      \"hit_rate\": x.xxx        (numeric) The share of lookups that found the block\n"
+            "    },\n"
+            "    \"leveldb_stats\": \"...\"     (string) The compaction statistics of LevelDB\n"
+            "  },\n"
+            "  ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdbinfo", "")
+            + HelpExampleCli("getdbinfo", "\"chainstate\"")
+            + HelpExampleRpc("getdbinfo", "\"chainstate\"")
+        );
+    }
+
+    std::string strName;
+    if (!request.params[0].isNull())
+        strName = request.params[0].get_str();
+
+    UniValue ret(UniValue::VOBJ);
+    for (const auto& db : GetNamedDBs()) {
+        if (strName.empty() || db.first == strName)
+            ret.push_back(Pair(db.first, DBInfoToJSON(*db.second)));
+    }
+    if (!strName.empty() && ret.empty())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown database " + strName);
+    return ret;
+}
+
+UniValue compactdb(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "compactdb \"name\"\n"
+            "\nCompacts a LevelDB database, which can take a while for the large ones.\n"
+            "\nArguments:\n"
+            "1. \"name\"             (string, required) The database: chainstate, index, sidechain, opreturn or stats\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"size_before\": n,   (numeric) The approximate size on disk in bytes before compacting\n"
+            "  \"size_after\": n,    (numeric) The approximate size on disk in bytes after compacting\n"
+            "  \"time\": x.xxx       (numeric) The time it took in seconds\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("compactdb", "\"opreturn\"")
+            + HelpExampleRpc("compactdb", "\"opreturn\"")
+        );
+    }
+
+    const std::string& strName = request.params[0].get_str();
+    for (const auto& db : GetNamedDBs()) {
+        if (db.first != strName)
+            continue;
+
+        // Compacting doesn't need cs_main, LevelDB serializes it with the writes
+        UniValue ret(UniValue::VOBJ);
+        ret.push_back(Pair("size_before", db.second->EstimateTotalSize()));
+        int64_t nTimeStart = GetTimeMicros();
+        db.second->CompactAll();
+        ret.push_back(Pair("size_after", db.second->EstimateTotalSize()));
+        ret.push_back(Pair("time", (GetTimeMicros() - nTimeStart) * 0.000001));
+        return ret;
+    }
+    throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown database " + strName);
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
     { "blockchain",         "getblockchaininfo",      &getblockchaininfo,      {} },
     { "blockchain",         "getchaintxstats",        &getchaintxstats,        {"nblocks", "blockhash"} },
+    { "blockchain",         "getblockstats",          &getblockstats,          {"height", "nblocks", "verbose"} },
     { "blockchain",         "getbestblockhash",       &getbestblockhash,       {} },
     { "blockchain",         "getblockcount",          &getblockcount,          {} },
     { "blockchain",         "getblock",               &getblock,               {"blockhash","verbosity|verbose"} },
@@ -1632,11 +2484,16 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        {"txid"} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
+    { "blockchain",         "getmempooldeltas",       &getmempooldeltas,       {"sequence"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type", "hash_or_height"} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
+    { "blockchain",         "dumptxoutset",           &dumptxoutset,           {"path"} },
+    { "blockchain",         "loadtxoutset",           &loadtxoutset,           {"path"} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
+    { "blockchain",         "getdbinfo",              &getdbinfo,              {"name"} },
+    { "blockchain",         "compactdb",              &compactdb,              {"name"} },
 
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
 
@@ -1647,6 +2504,9 @@ static const CRPCCommand commands[] =
     { "hidden",             "waitforblock",           &waitforblock,           {"blockhash","timeout"} },
     { "hidden",             "waitforblockheight",     &waitforblockheight,     {"height","timeout"} },
     { "hidden",             "syncwithvalidationinterfacequeue", &syncwithvalidationinterfacequeue, {} },
+
+    { "DriveChain",         "waitforsidechainevent",  &waitforsidechainevent,  {"sequence","timeout"} },
+    { "DriveChain",         "waitforctipchange",      &waitforctipchange,      {"nsidechain","known_ctip","timeout"} },
 };
 
 void RegisterBlockchainRPCCommands(CRPCTable &t)
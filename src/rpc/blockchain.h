@@ -7,6 +7,7 @@
 
 class CBlock;
 class CBlockIndex;
+class JSONStreamWriter;
 class UniValue;
 
 /**
@@ -21,15 +22,29 @@ double GetDifficulty(const CBlockIndex* blockindex = nullptr);
 /** Callback for when block tip changed. */
 void RPCNotifyBlockChange(bool ibd, const CBlockIndex *);
 
+/** Callback for when block tip changed, wakes sidechain long-poll RPCs if
+ * the tip changed the state tracked by SCDB. */
+void RPCNotifySidechainChange(bool ibd, const CBlockIndex *);
+
 /** Block description to JSON */
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false);
 
+/**
+ * Write a verbosity 2 block description to stream. blockSummary is the
+ * verbosity 1 description of the same block, which supplies all fields other
+ * than the transactions. Does not require cs_main.
+ */
+void blockToJSONStream(const CBlock& block, const UniValue& blockSummary, JSONStreamWriter& stream);
+
 /** Mempool information to JSON */
 UniValue mempoolInfoToJSON();
 
 /** Mempool to JSON */
 UniValue mempoolToJSON(bool fVerbose = false);
 
+/** Verbose mempool contents to stream, same format as mempoolToJSON(true) */
+void mempoolToJSONStream(JSONStreamWriter& stream);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* blockindex);
 
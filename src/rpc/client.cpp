@@ -55,6 +55,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "waitforblockheight", 1, "timeout" },
     { "waitforblock", 1, "timeout" },
     { "waitfornewblock", 0, "timeout" },
+    { "waitforsidechainevent", 0, "sequence" },
+    { "waitforsidechainevent", 1, "timeout" },
+    { "waitforctipchange", 0, "nsidechain" },
+    { "waitforctipchange", 2, "timeout" },
     { "move", 2, "amount" },
     { "move", 3, "minconf" },
     { "sendfrom", 2, "amount" },
@@ -87,6 +91,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblock", 1, "verbose" },
     { "getblockheader", 1, "verbose" },
     { "getchaintxstats", 0, "nblocks" },
+    { "getblockstats", 0, "height" },
+    { "getblockstats", 1, "nblocks" },
+    { "getblockstats", 2, "verbose" },
     { "gettransaction", 1, "include_watchonly" },
     { "getrawtransaction", 1, "verbose" },
     { "createrawtransaction", 0, "inputs" },
@@ -116,6 +123,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "pruneblockchain", 0, "height" },
     { "keypoolrefill", 0, "newsize" },
     { "getrawmempool", 0, "verbose" },
+    { "getmempooldeltas", 0, "sequence" },
     { "estimatesmartfee", 0, "conf_target" },
     { "estimaterawfee", 0, "conf_target" },
     { "estimaterawfee", 1, "threshold" },
@@ -130,6 +138,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "logging", 0, "include" },
     { "logging", 1, "exclude" },
     { "disconnectnode", 1, "nodeid" },
+    { "getrpcstats", 0, "reset" },
     { "addwitnessaddress", 1, "p2sh" },
     { "createcriticaldatatx", 0, "amount" },
     { "createcriticaldatatx", 1, "height" },
@@ -154,6 +163,13 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "setwithdrawalvote", 1, "nsidechain" },
     { "listwithdrawalstatus", 0, "nsidechain" },
     { "listcachedwithdrawaltx", 0, "nsidechain" },
+    { "listcachedwithdrawaltx", 1, "limit" },
+    { "listspentwithdrawals", 0, "limit" },
+    { "listfailedwithdrawals", 0, "limit" },
+    { "getopreturndata", 1, "limit" },
+    { "searchopreturn", 1, "count" },
+    { "gettopnews", 1, "days" },
+    { "gettopnews", 2, "limit" },
     { "verifydeposit", 2, "nTx" },
     // Echo with conversion (For testing only)
     { "echojson", 0, "arg0" },
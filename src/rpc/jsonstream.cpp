@@ -0,0 +1,102 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <univalue.h>
+
+#include <assert.h>
+#include <stdexcept>
+
+JSONStreamWriter::JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn) :
+    sink(sinkIn), nChunkSize(nChunkSizeIn), fAfterKey(false), fHasOutput(false), fFlushed(false)
+{
+}
+
+void JSONStreamWriter::Separate()
+{
+    fHasOutput = true;
+    if (fAfterKey) {
+        fAfterKey = false;
+        return;
+    }
+    if (vNeedComma.empty())
+        return;
+    if (vNeedComma.back())
+        buffer += ',';
+    vNeedComma.back() = true;
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separate();
+    buffer += '{';
+    vNeedComma.push_back(false);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!vNeedComma.empty() && !fAfterKey);
+    vNeedComma.pop_back();
+    buffer += '}';
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separate();
+    buffer += '[';
+    vNeedComma.push_back(false);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!vNeedComma.empty() && !fAfterKey);
+    vNeedComma.pop_back();
+    buffer += ']';
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!vNeedComma.empty() && !fAfterKey);
+    Separate();
+    // UniValue takes care of escaping
+    buffer += UniValue(key).write();
+    buffer += ':';
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    buffer += value.write();
+}
+
+void JSONStreamWriter::PushKV(const std::string& key, const UniValue& value)
+{
+    Key(key);
+    Value(value);
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    if (buffer.size() >= nChunkSize)
+        Flush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (buffer.empty())
+        return;
+    fFlushed = true;
+    if (!sink(buffer))
+        throw std::runtime_error("JSON stream reader went away");
+    buffer.clear();
+}
+
+std::string JSONStreamWriter::TakeBuffer()
+{
+    std::string ret;
+    ret.swap(buffer);
+    return ret;
+}
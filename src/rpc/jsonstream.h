@@ -0,0 +1,70 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class UniValue;
+
+/** Buffered output size at which MaybeFlush() hands data to the sink */
+static const size_t DEFAULT_JSON_STREAM_CHUNK = 64 * 1024;
+
+/**
+ * Incremental JSON emitter for RPC results that are too large to build as a
+ * single UniValue. Callers write the outer structure token by token and pass
+ * small UniValue subtrees (one transaction, one mempool entry, ...) as values.
+ *
+ * Output is buffered and only handed to the sink when the caller reaches a
+ * safe point and calls MaybeFlush() (for example after releasing locks), so
+ * the buffer is bounded by the flush threshold plus one value.
+ */
+class JSONStreamWriter
+{
+public:
+    /** Receives a chunk of output. Returns false if the reader went away. */
+    typedef std::function<bool(const std::string&)> Sink;
+
+    explicit JSONStreamWriter(const Sink& sinkIn, size_t nChunkSizeIn = DEFAULT_JSON_STREAM_CHUNK);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(const std::string& key);
+    void Value(const UniValue& value);
+    void PushKV(const std::string& key, const UniValue& value);
+
+    /** Flush if the buffer exceeds the chunk size. Throws if the sink fails. */
+    void MaybeFlush();
+    /** Flush all buffered output. Throws if the sink fails. */
+    void Flush();
+
+    /** Whether anything has been written to the stream */
+    bool HasOutput() const { return fHasOutput; }
+    /** Whether output has already been passed to the sink */
+    bool HasFlushed() const { return fFlushed; }
+    /** Whether all opened objects and arrays have been closed */
+    bool IsComplete() const { return fHasOutput && vNeedComma.empty(); }
+    /** Take the buffered output without passing it to the sink */
+    std::string TakeBuffer();
+
+private:
+    void Separate();
+
+    Sink sink;
+    size_t nChunkSize;
+    std::string buffer;
+    //! One entry per open object or array, true once it has an element
+    std::vector<bool> vNeedComma;
+    bool fAfterKey;
+    bool fHasOutput;
+    bool fFlushed;
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
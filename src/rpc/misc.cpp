@@ -14,7 +14,9 @@
 #include <merkleblock.h>
 #include <net.h>
 #include <netbase.h>
+#include <opreturnindex.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <sidechain.h>
@@ -710,21 +712,86 @@ UniValue listsidechainctip(const JSONRPCRequest& request)
     return obj;
 }
 
+/** Tags that tie a pagination cursor to the RPC which handed it out */
+enum DriveChainCursorTag : uint8_t {
+    CURSOR_SIDECHAIN_DEPOSITS = 1,
+    CURSOR_SPENT_WITHDRAWALS = 2,
+    CURSOR_FAILED_WITHDRAWALS = 3,
+    CURSOR_CACHED_WITHDRAWALS = 4,
+    CURSOR_OPRETURN_DATA = 5,
+};
+
+/** Result object of a paginated call. The cursor is null on the last page. */
+static UniValue RPCPage(const UniValue& results, const std::string& strCursor)
+{
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("results", results));
+    if (strCursor.empty())
+        ret.push_back(Pair("cursor", NullUniValue));
+    else
+        ret.push_back(Pair("cursor", strCursor));
+    return ret;
+}
+
+static UniValue SidechainDepositToJSON(const SidechainDeposit& d)
+{
+    LOCK(cs_main);
+
+    BlockMap::iterator it = mapBlockIndex.find(d.hashBlock);
+    if (it == mapBlockIndex.end()) {
+        std::string strError = "Block hash not found";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
+    }
+
+    CBlockIndex* pblockindex = it->second;
+    if (pblockindex == NULL) {
+        std::string strError = "Block index null";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
+    }
+
+    if (!chainActive.Contains(pblockindex)) {
+        std::string strError = "Block not in active chain";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("nsidechain", d.nSidechain));
+    obj.push_back(Pair("strdest", d.strDest));
+    obj.push_back(Pair("txhex", EncodeHexTx(d.tx)));
+    obj.push_back(Pair("nburnindex", (int)d.nBurnIndex));
+    obj.push_back(Pair("ntx", (int)d.nTx));
+    obj.push_back(Pair("hashblock", d.hashBlock.ToString()));
+
+    return obj;
+}
+
 UniValue listsidechaindeposits(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() < 1)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 5)
         throw std::runtime_error(
             "listsidechaindeposits\n"
             "List the most recent cached deposits for sidechain.\n"
             "Optionally limited to count. Note that this only has access to "
             "deposits which are currently cached.\n"
+            "If a cursor is passed in (an empty string for the first page) the "
+            "deposits are returned one page at a time, see Result (paged).\n"
             "\nArguments:\n"
             "1. \"sidechainkey\"  (string, required) The sidechain key\n"
             "2. \"txid\"          (string, optional) Only return deposits after this deposit TXID\n"
             "3. \"n\"             (numeric, optional, required if txid is set) The output index of the previous argument txn\n"
-            "4. \"count\"         (numeric, optional) The number of most recent deposits to list\n"
+            "4. \"count\"         (numeric, optional) The number of most recent deposits to list (the page size if paged, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ")\n"
+            "5. \"cursor\"        (string, optional) The cursor returned with the previous page\n"
+            "\nResult (paged):\n"
+            "{\n"
+            "  \"results\" : [ ... ],    (array) The deposits of this page\n"
+            "  \"cursor\"  : \"xxx\"       (string) Pass in to get the next page, null on the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("listsidechaindeposits", "\"sidechainkey\", \"count\"")
+            + HelpExampleCli("listsidechaindeposits", "\"sidechainkey\" \"\" 0 100 \"\"")
             + HelpExampleRpc("listsidechaindeposits", "\"sidechainkey\", \"count\"")
             );
 
@@ -747,16 +814,9 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
-    // If TXID was passed in, make sure we also received N
-    if (request.params.size() > 1 && request.params.size() < 3) {
-        std::string strError = "Output index 'n' is required if TXID is provided!";
-        LogPrintf("%s: %s\n", __func__, strError);
-        throw JSONRPCError(RPC_MISC_ERROR, strError);
-    }
-
-    // Was a TXID passed in?
+    // Was a TXID passed in? (An empty string is the same as none)
     uint256 txidKnown;
-    if (request.params.size() > 1) {
+    if (!request.params[1].isNull() && !request.params[1].get_str().empty()) {
         std::string strTXID = request.params[1].get_str();
         txidKnown = uint256S(strTXID);
         if (txidKnown.IsNull()) {
@@ -764,11 +824,18 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
             LogPrintf("%s: %s\n", __func__, strError);
             throw JSONRPCError(RPC_MISC_ERROR, strError);
         }
+
+        // If TXID was passed in, make sure we also received N
+        if (request.params[2].isNull()) {
+            std::string strError = "Output index 'n' is required if TXID is provided!";
+            LogPrintf("%s: %s\n", __func__, strError);
+            throw JSONRPCError(RPC_MISC_ERROR, strError);
+        }
     }
 
     // Was N passed in?
     uint32_t nKnown = 0;
-    if (request.params.size() > 2) {
+    if (!request.params[2].isNull()) {
         nKnown = request.params[2].get_int();
     }
 
@@ -777,17 +844,56 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
     key.Set(hashSidechain.begin(), hashSidechain.end(), false);
     CBitcoinSecret vchSecret(key);
 
+    // Return one page of deposits if a cursor was passed in. Only the page
+    // is copied out of the deposit cache.
+    if (!request.params[4].isNull()) {
+        int nLimit = ParsePageLimit(request.params[3]);
+
+        UniValue results(UniValue::VARR);
+        uint8_t nSidechain = 0;
+        if (!scdb.GetSidechainNumber(vchSecret.ToString(), nSidechain))
+            return RPCPage(results, "");
+
+        // The cursor is the last deposit returned and its cache position
+        size_t nEnd = scdb.GetDepositCount(nSidechain);
+        std::string strCursor = request.params[4].get_str();
+        if (!strCursor.empty()) {
+            std::pair<COutPoint, uint32_t> cursor;
+            DecodeRPCCursor(strCursor, CURSOR_SIDECHAIN_DEPOSITS, cursor);
+            size_t nPos = 0;
+            if (!scdb.GetDepositPosition(nSidechain, cursor.first, cursor.second, nPos))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor deposit is no longer cached");
+            nEnd = nPos;
+        }
+
+        std::vector<SidechainDeposit> vDeposit = scdb.GetDepositPage(nSidechain, nEnd, nLimit);
+        std::string strNext;
+        for (size_t i = 0; i < vDeposit.size(); i++) {
+            const SidechainDeposit& d = vDeposit[i];
+            if (!txidKnown.IsNull() && d.tx.GetHash() == txidKnown && d.nBurnIndex == nKnown)
+                break;
+
+            results.push_back(SidechainDepositToJSON(d));
+
+            size_t nPos = nEnd - i - 1;
+            if (i + 1 == vDeposit.size() && nPos > 0) {
+                COutPoint out(d.tx.GetHash(), d.nBurnIndex);
+                strNext = EncodeRPCCursor(CURSOR_SIDECHAIN_DEPOSITS, std::make_pair(out, (uint32_t)nPos));
+            }
+        }
+        return RPCPage(results, strNext);
+    }
+
     // Get number of recent deposits to return (default is all cached deposits)
     bool fLimit = false;
     int count = 0;
-    if (request.params.size() == 4) {
+    if (!request.params[3].isNull()) {
         fLimit = true;
         count = request.params[3].get_int();
     }
 
     UniValue arr(UniValue::VARR);
 
-#ifdef ENABLE_WALLET
     std::vector<SidechainDeposit> vDeposit = scdb.GetDeposits(vchSecret.ToString());
     if (!vDeposit.size()) {
         std::string strError = "No deposits in cache for this sidechain!";
@@ -795,7 +901,14 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
+    // Large deposit lists are written to the stream one deposit at a time
+    if (request.stream)
+        request.stream->BeginArray();
+
     for (auto rit = vDeposit.crbegin(); rit != vDeposit.crend(); rit++) {
+        if (request.stream)
+            request.stream->MaybeFlush();
+
         const SidechainDeposit d = *rit;
 
         // Check if we have reached a deposit the sidechain already has. The
@@ -808,45 +921,13 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
             break;
         }
 
-        // Add deposit txid to set
-        uint256 txid = d.tx.GetHash();
-        std::set<uint256> setTxids;
-        setTxids.insert(txid);
+        UniValue obj = SidechainDepositToJSON(d);
 
-        LOCK(cs_main);
-
-        BlockMap::iterator it = mapBlockIndex.find(d.hashBlock);
-        if (it == mapBlockIndex.end()) {
-            std::string strError = "Block hash not found";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
-        }
-
-        CBlockIndex* pblockindex = it->second;
-        if (pblockindex == NULL) {
-            std::string strError = "Block index null";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
-        }
-
-        if (!chainActive.Contains(pblockindex)) {
-            std::string strError = "Block not in active chain";
-            LogPrintf("%s: %s\n", __func__, strError);
-            throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
-        }
-#endif
+        if (request.stream)
+            request.stream->Value(obj);
+        else
+            arr.push_back(obj);
 
-#ifdef ENABLE_WALLET
-        UniValue obj(UniValue::VOBJ);
-        obj.push_back(Pair("nsidechain", d.nSidechain));
-        obj.push_back(Pair("strdest", d.strDest));
-        obj.push_back(Pair("txhex", EncodeHexTx(d.tx)));
-        obj.push_back(Pair("nburnindex", (int)d.nBurnIndex));
-        obj.push_back(Pair("ntx", (int)d.nTx));
-        obj.push_back(Pair("hashblock", d.hashBlock.ToString()));
-
-        arr.push_back(obj);
-#endif
         if (fLimit) {
             count--;
             if (count <= 0)
@@ -854,6 +935,11 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
         }
     }
 
+    if (request.stream) {
+        request.stream->EndArray();
+        return NullUniValue;
+    }
+
     return arr;
 }
 
@@ -1583,6 +1669,8 @@ UniValue getaveragefee(const JSONRPCRequest& request)
     if (request.params.size() >= 1)
         nBlocks = request.params[0].get_int();
 
+    LOCK(cs_main);
+
     int nHeight = chainActive.Height();
     if (request.params.size() == 2) {
         int nHeightIn = request.params[1].get_int();
@@ -1600,6 +1688,15 @@ UniValue getaveragefee(const JSONRPCRequest& request)
     for (int i = nHeight; i >= (nHeight - nBlocks); i--) {
         uint256 hashBlock = chainActive[i]->GetBlockHash();
 
+        BlockStats stats;
+        if (pblockstatsdb->ReadBlockStats(hashBlock, stats)) {
+            nTotalFees += stats.totalFees;
+            nTx += stats.nTx;
+            continue;
+        }
+
+        // Blocks connected before the statistics index existed have to be
+        // read from disk
         if (mapBlockIndex.count(hashBlock) == 0)
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
@@ -1724,19 +1821,29 @@ UniValue listwithdrawalstatus(const JSONRPCRequest& request)
 
 UniValue listcachedwithdrawaltx(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 1)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
         throw std::runtime_error(
             "listcachedwithdrawaltx\n"
             "List my cached Withdrawal(s) for nSidechain\n"
+            "If a limit or cursor is passed in the Withdrawal(s) are returned "
+            "one page at a time, see Result (paged).\n"
             "\nArguments:\n"
             "1. nsidechain     (numeric, required) Sidechain number to list Withdrawal(s) of\n"
+            "2. limit          (numeric, optional, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ") Page size\n"
+            "3. \"cursor\"       (string, optional) The cursor returned with the previous page\n"
             "\nResult: (array)\n"
             "{\n"
             "  \"hash\" : x (string) hash of Withdrawal\n"
             "}\n"
+            "\nResult (paged):\n"
+            "{\n"
+            "  \"results\" : [ ... ],    (array) The Withdrawal(s) of this page\n"
+            "  \"cursor\"  : \"xxx\"       (string) Pass in to get the next page, null on the last page\n"
+            "}\n"
             "\n"
             "\nExample:\n"
             + HelpExampleCli("listcachedwithdrawaltransactions", "0")
+            + HelpExampleCli("listcachedwithdrawaltransactions", "0 100")
             );
 
     // nSidechain
@@ -1746,6 +1853,36 @@ UniValue listcachedwithdrawaltx(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_TYPE_ERROR, "Invalid Sidechain number");
 
     std::vector<SidechainWithdrawalState> vState = scdb.GetState(nSidechain);
+
+    if (!request.params[1].isNull() || !request.params[2].isNull()) {
+        int nLimit = ParsePageLimit(request.params[1]);
+
+        // The cursor is the hash of the last Withdrawal returned
+        auto it = vState.cbegin();
+        std::string strCursor = request.params[2].isNull() ? "" : request.params[2].get_str();
+        if (!strCursor.empty()) {
+            uint256 hashLast;
+            DecodeRPCCursor(strCursor, CURSOR_CACHED_WITHDRAWALS, hashLast);
+            it = std::find_if(vState.cbegin(), vState.cend(),
+                    [&hashLast](const SidechainWithdrawalState& s) { return s.hash == hashLast; });
+            if (it == vState.cend())
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor Withdrawal is no longer cached");
+            it++;
+        }
+
+        UniValue results(UniValue::VARR);
+        for (; it != vState.cend() && (int)results.size() < nLimit; it++) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("hash", it->hash.ToString()));
+            results.push_back(obj);
+        }
+
+        std::string strNext;
+        if (it != vState.cend())
+            strNext = EncodeRPCCursor(CURSOR_CACHED_WITHDRAWALS, std::prev(it)->hash);
+        return RPCPage(results, strNext);
+    }
+
     if (vState.empty())
         throw JSONRPCError(RPC_TYPE_ERROR, "No Withdrawal(s) in SCDB for sidechain");
 
@@ -1820,21 +1957,60 @@ UniValue havefailedwithdrawal(const JSONRPCRequest& request)
 
 UniValue listspentwithdrawals(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size())
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
             "listspentwithdrawals\n"
             "List Withdrawal(s) which have been approved by workscore and spent\n"
+            "If a limit or cursor is passed in the Withdrawal(s) are returned "
+            "one page at a time, see Result (paged).\n"
+            "\nArguments:\n"
+            "1. limit          (numeric, optional, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ") Page size\n"
+            "2. \"cursor\"       (string, optional) The cursor returned with the previous page\n"
             "\nResult: (array)\n"
             "{\n"
             "  \"nsidechain\" : (numeric) Sidechain number of Withdrawal\n"
             "  \"hash\" : (string) hash of Withdrawal\n"
             "  \"hashblock\"   : (string) hash of block Withdrawal was spent in\n"
             "}\n"
+            "\nResult (paged):\n"
+            "{\n"
+            "  \"results\" : [ ... ],    (array) The Withdrawal(s) of this page\n"
+            "  \"cursor\"  : \"xxx\"       (string) Pass in to get the next page, null on the last page\n"
+            "}\n"
             "\n"
             "\nExample:\n"
             + HelpExampleCli("listspentwithdrawals", "")
+            + HelpExampleCli("listspentwithdrawals", "100")
             );
 
+    if (!request.params[0].isNull() || !request.params[1].isNull()) {
+        int nLimit = ParsePageLimit(request.params[0]);
+
+        // The cursor is the position (block hash, index) of the next entry
+        std::pair<uint256, uint32_t> cursor;
+        std::string strCursor = request.params[1].isNull() ? "" : request.params[1].get_str();
+        if (!strCursor.empty())
+            DecodeRPCCursor(strCursor, CURSOR_SPENT_WITHDRAWALS, cursor);
+
+        uint256 hashBlock = cursor.first;
+        size_t nIndex = cursor.second;
+        std::vector<SidechainSpentWithdrawal> vSpent = scdb.GetSpentWithdrawalPage(hashBlock, nIndex, nLimit);
+
+        UniValue results(UniValue::VARR);
+        for (const SidechainSpentWithdrawal& s : vSpent) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("nsidechain", s.nSidechain));
+            obj.push_back(Pair("hash", s.hash.ToString()));
+            obj.push_back(Pair("hashblock", s.hashBlock.ToString()));
+            results.push_back(obj);
+        }
+
+        std::string strNext;
+        if (!hashBlock.IsNull())
+            strNext = EncodeRPCCursor(CURSOR_SPENT_WITHDRAWALS, std::make_pair(hashBlock, (uint32_t)nIndex));
+        return RPCPage(results, strNext);
+    }
+
     std::vector<SidechainSpentWithdrawal> vSpent = scdb.GetSpentWithdrawalCache();
     if (vSpent.empty())
         throw JSONRPCError(RPC_TYPE_ERROR, "No spent Withdrawal(s) in cache!");
@@ -1855,20 +2031,57 @@ UniValue listspentwithdrawals(const JSONRPCRequest& request)
 
 UniValue listfailedwithdrawals(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size())
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
             "listfailedwithdrawals\n"
             "List Withdrawal(s) which have failed\n"
+            "If a limit or cursor is passed in the Withdrawal(s) are returned "
+            "one page at a time, see Result (paged).\n"
+            "\nArguments:\n"
+            "1. limit          (numeric, optional, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ") Page size\n"
+            "2. \"cursor\"       (string, optional) The cursor returned with the previous page\n"
             "\nResult: (array)\n"
             "{\n"
             "  \"nsidechain\" : (numeric) Sidechain number of Withdrawal\n"
             "  \"hash\" : (string) hash of withdrawal\n"
             "}\n"
+            "\nResult (paged):\n"
+            "{\n"
+            "  \"results\" : [ ... ],    (array) The Withdrawal(s) of this page\n"
+            "  \"cursor\"  : \"xxx\"       (string) Pass in to get the next page, null on the last page\n"
+            "}\n"
             "\n"
             "\nExample:\n"
             + HelpExampleCli("listfailedwithdrawals", "")
+            + HelpExampleCli("listfailedwithdrawals", "100")
             );
 
+    if (!request.params[0].isNull() || !request.params[1].isNull()) {
+        int nLimit = ParsePageLimit(request.params[0]);
+
+        // The cursor is the hash of the last Withdrawal returned
+        uint256 hashLast;
+        std::string strCursor = request.params[1].isNull() ? "" : request.params[1].get_str();
+        if (!strCursor.empty())
+            DecodeRPCCursor(strCursor, CURSOR_FAILED_WITHDRAWALS, hashLast);
+
+        // Ask for one more than the limit to know if there is another page
+        std::vector<SidechainFailedWithdrawal> vFailed = scdb.GetFailedWithdrawalPage(hashLast, nLimit + 1);
+
+        UniValue results(UniValue::VARR);
+        for (size_t i = 0; i < vFailed.size() && (int)i < nLimit; i++) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("nsidechain", vFailed[i].nSidechain));
+            obj.push_back(Pair("hash", vFailed[i].hash.ToString()));
+            results.push_back(obj);
+        }
+
+        std::string strNext;
+        if ((int)vFailed.size() > nLimit)
+            strNext = EncodeRPCCursor(CURSOR_FAILED_WITHDRAWALS, vFailed[nLimit - 1].hash);
+        return RPCPage(results, strNext);
+    }
+
     std::vector<SidechainFailedWithdrawal> vFailed = scdb.GetFailedWithdrawalCache();
     if (vFailed.empty())
         throw JSONRPCError(RPC_TYPE_ERROR, "No failed Withdrawal(s) in cache!");
@@ -2007,10 +2220,16 @@ UniValue listfailedbmm(const JSONRPCRequest& request)
 
 UniValue getopreturndata(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 1)
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
         throw std::runtime_error(
             "getopreturndata\n"
             "Print OP_RETURN data for block.\n"
+            "If a limit or cursor is passed in the data is returned one page "
+            "at a time, see Result (paged).\n"
+            "\nArguments:\n"
+            "1. \"blockhash\"    (string, required) The block hash\n"
+            "2. limit          (numeric, optional, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ") Page size\n"
+            "3. \"cursor\"       (string, optional) The cursor returned with the previous page\n"
             "\nResult:\n"
             "{\n"
             "  \"txid\"   : (string) transaction id\n"
@@ -2019,9 +2238,15 @@ UniValue getopreturndata(const JSONRPCRequest& request)
             "  \"hex\"    : (string) hex from output.\n"
             "  \"decode\" : (string) decoded hex.\n"
             "}\n"
+            "\nResult (paged):\n"
+            "{\n"
+            "  \"results\" : [ ... ],    (array) The data of this page\n"
+            "  \"cursor\"  : \"xxx\"       (string) Pass in to get the next page, null on the last page\n"
+            "}\n"
             "\n"
             "\nExample:\n"
-            + HelpExampleCli("getopreturndata", "")
+            + HelpExampleCli("getopreturndata", "\"blockhash\"")
+            + HelpExampleCli("getopreturndata", "\"blockhash\" 100")
             );
 
     uint256 hashBlock = uint256S(request.params[0].get_str());
@@ -2040,12 +2265,34 @@ UniValue getopreturndata(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
     }
 
+    // The cursor is the block hash and the index of the next entry
+    bool fPaged = !request.params[1].isNull() || !request.params[2].isNull();
+    int nLimit = fPaged ? ParsePageLimit(request.params[1]) : 0;
+    size_t nStart = 0;
+    std::string strCursor = request.params[2].isNull() ? "" : request.params[2].get_str();
+    if (!strCursor.empty()) {
+        std::pair<uint256, uint32_t> cursor;
+        DecodeRPCCursor(strCursor, CURSOR_OPRETURN_DATA, cursor);
+        if (cursor.first != hashBlock)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor is for a different block");
+        nStart = cursor.second;
+    }
+
+    // The index may still be processing the latest blocks
+    if (g_opreturn_index)
+        g_opreturn_index->BlockUntilSyncedToCurrentChain();
+
     std::vector<OPReturnData> vData;
     if (!popreturndb->GetBlockData(hashBlock, vData))
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Couldn't find data for block.");
 
+    size_t nEnd = vData.size();
+    if (fPaged)
+        nEnd = std::min(nEnd, nStart + nLimit);
+
     UniValue ret(UniValue::VARR);
-    for (const OPReturnData& d : vData) {
+    for (size_t i = nStart; i < nEnd; i++) {
+        const OPReturnData& d = vData[i];
         UniValue obj(UniValue::VOBJ);
         obj.push_back(Pair("txid", d.txid.ToString()));
         obj.push_back(Pair("size", (uint64_t)d.nSize));
@@ -2061,6 +2308,216 @@ UniValue getopreturndata(const JSONRPCRequest& request)
         ret.push_back(obj);
     }
 
+    if (fPaged) {
+        std::string strNext;
+        if (nEnd < vData.size())
+            strNext = EncodeRPCCursor(CURSOR_OPRETURN_DATA, std::make_pair(hashBlock, (uint32_t)nEnd));
+        return RPCPage(ret, strNext);
+    }
+
+    return ret;
+}
+
+UniValue gettopnews(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
+        throw std::runtime_error(
+            "gettopnews \"header\" ( days limit )\n"
+            "List the news with the highest fees for a news type.\n"
+            "\nArguments:\n"
+            "1. \"header\"  (string, required) The header bytes of the news type (ex: a1a1a1a1)\n"
+            "2. days      (numeric, optional, default=1) Number of days before the chain tip to list news from\n"
+            "3. limit     (numeric, optional, default=" + std::to_string(DEFAULT_RPC_PAGE_LIMIT) + ") Maximum number of news\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\"   : (string) transaction id\n"
+            "    \"vout\"   : (numeric) output index\n"
+            "    \"fees\"   : (numeric) transaction fees.\n"
+            "    \"time\"   : (numeric) block time\n"
+            "    \"height\" : (numeric) block height\n"
+            "    \"hex\"    : (string) hex from output.\n"
+            "    \"decode\" : (string) decoded news, without the header.\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExample:\n"
+            + HelpExampleCli("gettopnews", "\"a1a1a1a1\"")
+            + HelpExampleCli("gettopnews", "\"a1a1a1a1\" 7 10")
+            );
+
+    std::string strHeader = request.params[0].get_str();
+    if (strHeader.size() != NEWS_HEADER_SIZE * 2 || !IsHex(strHeader))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid header bytes");
+    std::vector<unsigned char> vHeader = ParseHex(strHeader);
+    CScript header(vHeader.begin(), vHeader.end());
+
+    int nDays = 1;
+    if (!request.params[1].isNull()) {
+        nDays = request.params[1].get_int();
+        if (nDays < 1)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid number of days");
+    }
+
+    int nLimit = ParsePageLimit(request.params[2]);
+
+    int64_t nTimeTip;
+    {
+        LOCK(cs_main);
+        nTimeTip = chainActive.Tip()->GetBlockTime();
+    }
+
+    // The index may still be processing the latest blocks
+    if (g_opreturn_index)
+        g_opreturn_index->BlockUntilSyncedToCurrentChain();
+
+    std::vector<OPReturnNews> vNews;
+    if (!popreturndb->GetTopNews(header, nTimeTip - nDays * NEWS_INDEX_BUCKET, nLimit, vNews))
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to read news index");
+
+    UniValue ret(UniValue::VARR);
+    for (const OPReturnNews& news : vNews) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", news.txid.ToString()));
+        obj.push_back(Pair("vout", (uint64_t)news.n));
+        obj.push_back(Pair("fees", ValueFromAmount(news.fees)));
+        obj.push_back(Pair("time", news.nTime));
+        obj.push_back(Pair("height", news.nHeight));
+        obj.push_back(Pair("hex", HexStr(news.script.begin(), news.script.end(), false)));
+        obj.push_back(Pair("decode", std::string(news.script.begin() + NEWS_HEADER_SIZE + 1, news.script.end())));
+
+        ret.push_back(obj);
+    }
+
+    return ret;
+}
+
+UniValue getindexinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getindexinfo ( \"index_name\" )\n"
+            "\nReturns the status of the optional indices.\n"
+            "\nArguments:\n"
+            "1. \"index_name\"     (string, optional) Only return the status of this index\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"opreturnindex\": {            (object) The OP_RETURN (CoinNews) index\n"
+            "    \"synced\": true|false,       (boolean) Whether the index follows the chain tip\n"
+            "    \"best_block_height\": n,     (numeric) Height of the last block indexed, -1 if none\n"
+            "    \"progress\": x.xxx,          (numeric) Share of the chain's transactions indexed, 0 to 1\n"
+            "    \"eta\": n,                   (numeric) Estimated seconds until synced, -1 if unknown\n"
+            "    \"search\": true|false        (boolean) Whether the search index is maintained (-opreturnsearch)\n"
+            "  }\n"
+            "}\n"
+            "\nExample:\n"
+            + HelpExampleCli("getindexinfo", "")
+            + HelpExampleCli("getindexinfo", "\"opreturnindex\"")
+            );
+
+    std::string strName = request.params[0].isNull() ? "" : request.params[0].get_str();
+
+    UniValue ret(UniValue::VOBJ);
+    if (g_opreturn_index && (strName.empty() || strName == "opreturnindex")) {
+        OPReturnIndexSummary summary = g_opreturn_index->GetSummary();
+
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("synced", summary.fSynced));
+        obj.push_back(Pair("best_block_height", summary.nBestHeight));
+        obj.push_back(Pair("progress", summary.progress));
+        obj.push_back(Pair("eta", summary.nETA));
+        obj.push_back(Pair("search", g_opreturn_index->IsSearchEnabled()));
+        ret.push_back(Pair("opreturnindex", obj));
+    }
+
+    return ret;
+}
+
+UniValue rebuildopreturnindex(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "rebuildopreturnindex\n"
+            "\nErase the OP_RETURN (CoinNews) index and build it again from the\n"
+            "block files in the background. News types are kept. Use getindexinfo\n"
+            "to follow the progress.\n"
+            "\nExample:\n"
+            + HelpExampleCli("rebuildopreturnindex", "")
+            );
+
+    if (!g_opreturn_index)
+        throw JSONRPCError(RPC_MISC_ERROR, "OP_RETURN index is not running");
+
+    if (!g_opreturn_index->Rebuild())
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to wipe the OP_RETURN index");
+
+    return NullUniValue;
+}
+
+UniValue searchopreturn(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "searchopreturn \"query\" ( count )\n"
+            "\nFind OP_RETURN outputs of the active chain which have, for every word\n"
+            "of the query, a word starting with it. Words are runs of letters and\n"
+            "digits, matched case insensitively. Requires -opreturnsearch.\n"
+            "\nArguments:\n"
+            "1. \"query\"    (string, required) Words to look for, one of at least " + std::to_string(OPRETURN_SEARCH_MIN_WORD) + " characters\n"
+            "2. count      (numeric, optional, default=100) Maximum number of results\n"
+            "\nResult: (newest first)\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\"      : (string) transaction id\n"
+            "    \"blockhash\" : (string) block hash\n"
+            "    \"height\"    : (numeric) block height\n"
+            "    \"time\"      : (numeric) block time\n"
+            "    \"fees\"      : (numeric) transaction fees\n"
+            "    \"hex\"       : (string) hex from output\n"
+            "    \"decode\"    : (string) decoded hex\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExample:\n"
+            + HelpExampleCli("searchopreturn", "\"hello world\"")
+            + HelpExampleCli("searchopreturn", "\"hello\" 10")
+            );
+
+    if (!g_opreturn_index || !g_opreturn_index->IsSearchEnabled())
+        throw JSONRPCError(RPC_MISC_ERROR, "OP_RETURN search index is disabled, start with -opreturnsearch");
+
+    std::string strQuery = request.params[0].get_str();
+
+    int nCount = 100;
+    if (!request.params[1].isNull())
+        nCount = request.params[1].get_int();
+    if (nCount < 1 || nCount > 1000)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "count must be from 1 to 1000");
+
+    // The index may still be processing the latest blocks
+    g_opreturn_index->BlockUntilSyncedToCurrentChain();
+
+    std::vector<OPReturnSearchEntry> vResult;
+    if (!SearchOPReturn(strQuery, nCount, vResult))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Query must have a word of at least %u characters", OPRETURN_SEARCH_MIN_WORD));
+
+    UniValue ret(UniValue::VARR);
+    for (const OPReturnSearchEntry& entry : vResult) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", entry.txid.ToString()));
+        obj.push_back(Pair("blockhash", entry.hashBlock.ToString()));
+        obj.push_back(Pair("height", entry.nHeight));
+        obj.push_back(Pair("time", entry.nTime));
+        obj.push_back(Pair("fees", FormatMoney(entry.fees)));
+        obj.push_back(Pair("hex", HexStr(entry.script.begin(), entry.script.end(), false)));
+
+        std::string strDecode;
+        for (const unsigned char& c : entry.script) {
+            strDecode += c;
+        }
+        obj.push_back(Pair("decode", strDecode));
+
+        ret.push_back(obj);
+    }
+
     return ret;
 }
 
@@ -2098,6 +2555,7 @@ static const CRPCCommand commands[] =
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys"} },
     { "util",               "verifymessage",          &verifymessage,          {"address","signature","message"} },
     { "util",               "signmessagewithprivkey", &signmessagewithprivkey, {"privkey","message"} },
+    { "util",               "getindexinfo",           &getindexinfo,           {"index_name"} },
 
     /* Not shown in help */
     { "hidden",             "setmocktime",            &setmocktime,            {"timestamp"}},
@@ -2109,7 +2567,7 @@ static const CRPCCommand commands[] =
     /* DriveChain rpc commands (mainly used by sidechains) */
     { "DriveChain",  "createcriticaldatatx",          &createcriticaldatatx,            {"amount", "height", "criticalhash"}},
     { "DriveChain",  "listsidechainctip",             &listsidechainctip,               {"nsidechain"}},
-    { "DriveChain",  "listsidechaindeposits",         &listsidechaindeposits,           {"addressbytes"}},
+    { "DriveChain",  "listsidechaindeposits",         &listsidechaindeposits,           {"addressbytes","txid","n","count","cursor"}},
     { "DriveChain",  "countsidechaindeposits",        &countsidechaindeposits,          {"nsidechain"}},
     { "DriveChain",  "receivewithdrawalbundle",       &receivewithdrawalbundle,         {"nsidechain","rawtx"}},
     { "DriveChain",  "verifybmm",                     &verifybmm,                       {"blockhash", "bmmhash"}},
@@ -2127,17 +2585,20 @@ static const CRPCCommand commands[] =
     { "DriveChain",  "getworkscore",                  &getworkscore,                    {"nsidechain", "hashwithdrawal"}},
     { "DriveChain",  "havespentwithdrawal",           &havespentwithdrawal,             {"hashwithdrawal", "nsidechain"}},
     { "DriveChain",  "havefailedwithdrawal",          &havefailedwithdrawal,            {"hashwithdrawal", "nsidechain"}},
-    { "DriveChain",  "listcachedwithdrawaltx",        &listcachedwithdrawaltx,          {"nsidechain"}},
+    { "DriveChain",  "listcachedwithdrawaltx",        &listcachedwithdrawaltx,          {"nsidechain","limit","cursor"}},
     { "DriveChain",  "listwithdrawalstatus",          &listwithdrawalstatus,            {"nsidechain"}},
-    { "DriveChain",  "listspentwithdrawals",          &listspentwithdrawals,            {}},
-    { "DriveChain",  "listfailedwithdrawals",         &listfailedwithdrawals,           {}},
+    { "DriveChain",  "listspentwithdrawals",          &listspentwithdrawals,            {"limit","cursor"}},
+    { "DriveChain",  "listfailedwithdrawals",         &listfailedwithdrawals,           {"limit","cursor"}},
     { "DriveChain",  "getscdbhash",                   &getscdbhash,                     {}},
     { "DriveChain",  "gettotalscdbhash",              &gettotalscdbhash,                {}},
     { "DriveChain",  "getscdbdataforblock",           &getscdbdataforblock,             {"blockhash"}},
     { "DriveChain",  "listfailedbmm",                 &listfailedbmm,                   {}},
 
     /* Coin News RPC */
-    { "CoinNews",    "getopreturndata",               &getopreturndata,                 {"blockhash"}},
+    { "CoinNews",    "getopreturndata",               &getopreturndata,                 {"blockhash","limit","cursor"}},
+    { "CoinNews",    "gettopnews",                    &gettopnews,                      {"header","days","limit"}},
+    { "CoinNews",    "rebuildopreturnindex",          &rebuildopreturnindex,            {}},
+    { "CoinNews",    "searchopreturn",                &searchopreturn,                  {"query","count"}},
 
 };
 
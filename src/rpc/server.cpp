@@ -9,6 +9,7 @@
 #include <fs.h>
 #include <init.h>
 #include <random.h>
+#include <rpc/stats.h>
 #include <sync.h>
 #include <ui_interface.h>
 #include <util.h>
@@ -256,6 +257,58 @@ UniValue uptime(const JSONRPCRequest& jsonRequest)
     return GetTime() - GetStartupTime();
 }
 
+UniValue getrpcstats(const JSONRPCRequest& jsonRequest)
+{
+    if (jsonRequest.fHelp || jsonRequest.params.size() > 1)
+        throw std::runtime_error(
+                "getrpcstats ( reset )\n"
+                        "\nReturns per-method call counters and latency histograms of the RPC and REST\n"
+                        "interfaces, the state of the HTTP work queue and cs_main contention.\n"
+                        "REST endpoints are listed as \"rest/<endpoint>\", the HTTP level figures of\n"
+                        "JSON-RPC batches as \"" + RPC_STATS_BATCH + "\".\n"
+                        "\nArguments:\n"
+                        "1. reset    (boolean, optional, default=false) Clear the per-method counters after reading them\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"bucket_limits_us\": [ n, ... ],    (array) Upper bound in microseconds of each histogram bucket but the last\n"
+                        "  \"methods\": {\n"
+                        "    \"method\": {\n"
+                        "      \"calls\": n,                    (numeric) Number of calls\n"
+                        "      \"errors\": n,                   (numeric) Number of calls that failed\n"
+                        "      \"bytes_out\": n,                (numeric) Reply body bytes sent\n"
+                        "      \"cs_main_wait_us\": n,          (numeric) Time spent waiting for cs_main while executing\n"
+                        "      \"queue\": {                     (json object) Time waiting in the HTTP work queue\n"
+                        "        \"count\": n,                  (numeric) Number of samples\n"
+                        "        \"total_us\": n,               (numeric) Sum of all samples in microseconds\n"
+                        "        \"buckets\": [ n, ... ]        (array) Samples per bucket, the last one is unbounded\n"
+                        "      },\n"
+                        "      \"exec\": { ... },               (json object) Time spent executing the command\n"
+                        "      \"serialize\": { ... }           (json object) Time spent writing the reply body\n"
+                        "    }, ...\n"
+                        "  },\n"
+                        "  \"work_queue\": {                   (json object) HTTP work queue, if the HTTP server is running\n"
+                        "    \"depth\": n,                      (numeric) Requests currently waiting for a worker thread\n"
+                        "    \"max_depth\": n,                  (numeric) Depth at which requests are rejected (-rpcworkqueue)\n"
+                        "    \"threads\": n,                    (numeric) Number of worker threads (-rpcthreads)\n"
+                        "    \"rejected\": n                    (numeric) Requests rejected because the queue was full\n"
+                        "  },\n"
+                        "  \"cs_main\": {                      (json object) Contention on cs_main across all threads\n"
+                        "    \"contended\": n,                  (numeric) Acquisitions that had to wait\n"
+                        "    \"wait_us\": n                     (numeric) Total time spent waiting\n"
+                        "  }\n"
+                        "}\n"
+                        "\nExamples:\n"
+                + HelpExampleCli("getrpcstats", "")
+                + HelpExampleRpc("getrpcstats", "true")
+        );
+
+    UniValue ret = RPCStatsToJSON();
+    if (!jsonRequest.params[0].isNull() && jsonRequest.params[0].get_bool())
+        g_rpc_stats.Reset();
+
+    return ret;
+}
+
 /**
  * Call Table
  */
@@ -266,6 +319,7 @@ static const CRPCCommand vRPCCommands[] =
     { "control",            "help",                   &help,                   {"command"}  },
     { "control",            "stop",                   &stop,                   {}  },
     { "control",            "uptime",                 &uptime,                 {}  },
+    { "control",            "getrpcstats",            &getrpcstats,            {"reset"}  },
 };
 
 CRPCTable::CRPCTable()
@@ -416,7 +470,10 @@ std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
     for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
         ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
 
-    return ret.write() + "\n";
+    int64_t nStart = GetTimeMicros();
+    std::string strReply = ret.write() + "\n";
+    g_rpc_stats.RecordReply(RPC_STATS_BATCH, GetTimeMicros() - nStart, strReply.size());
+    return strReply;
 }
 
 /**
@@ -485,19 +542,34 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    int64_t nStart = GetTimeMicros();
+    int64_t nMainLockWaitStart = GetThreadMainLockWait();
+    auto record = [&](bool fError) {
+        g_rpc_stats.RecordExec(request.strMethod, GetTimeMicros() - nStart, GetThreadMainLockWait() - nMainLockWaitStart, fError);
+    };
+
+    UniValue result;
     try
     {
         // Execute, convert arguments to array if necessary
         if (request.params.isObject()) {
-            return pcmd->actor(transformNamedArguments(request, pcmd->argNames));
+            result = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
         } else {
-            return pcmd->actor(request);
+            result = pcmd->actor(request);
         }
     }
     catch (const std::exception& e)
     {
+        record(true);
         throw JSONRPCError(RPC_MISC_ERROR, e.what());
     }
+    catch (...)
+    {
+        record(true);
+        throw;
+    }
+    record(false);
+    return result;
 }
 
 std::vector<std::string> CRPCTable::listCommands() const
@@ -0,0 +1,222 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/stats.h>
+
+#include <httpserver.h>
+#include <tinyformat.h>
+
+#include <univalue.h>
+
+RPCStats g_rpc_stats;
+
+const size_t LatencyHistogram::NUM_BUCKETS;
+const int64_t LatencyHistogram::BUCKET_LIMITS[LatencyHistogram::NUM_BUCKETS - 1] = {
+    100, 250, 500,
+    1000, 2500, 5000,
+    10000, 25000, 50000,
+    100000, 250000, 500000,
+    1000000, 2500000, 5000000,
+    10000000
+};
+
+LatencyHistogram::LatencyHistogram() : nCount(0), nTotalMicros(0)
+{
+    for (size_t i = 0; i < NUM_BUCKETS; i++)
+        vBuckets[i] = 0;
+}
+
+void LatencyHistogram::Add(int64_t nMicros)
+{
+    if (nMicros < 0)
+        nMicros = 0;
+
+    size_t i = 0;
+    while (i < NUM_BUCKETS - 1 && nMicros > BUCKET_LIMITS[i])
+        i++;
+
+    vBuckets[i]++;
+    nCount++;
+    nTotalMicros += nMicros;
+}
+
+void RPCStats::RecordQueue(const std::string& strMethod, int64_t nMicros)
+{
+    LOCK(cs);
+    mapStats[strMethod].queue.Add(nMicros);
+}
+
+void RPCStats::RecordExec(const std::string& strMethod, int64_t nMicros, int64_t nMainLockWaitMicros, bool fError)
+{
+    LOCK(cs);
+    RPCMethodStats& stats = mapStats[strMethod];
+    stats.nCalls++;
+    if (fError)
+        stats.nErrors++;
+    stats.nMainLockWaitMicros += nMainLockWaitMicros;
+    stats.exec.Add(nMicros);
+}
+
+void RPCStats::RecordReply(const std::string& strMethod, int64_t nSerializeMicros, size_t nBytes)
+{
+    LOCK(cs);
+    RPCMethodStats& stats = mapStats[strMethod];
+    stats.nBytesOut += nBytes;
+    stats.serialize.Add(nSerializeMicros);
+}
+
+void RPCStats::RecordReply(const std::string& strMethod, size_t nBytes)
+{
+    LOCK(cs);
+    mapStats[strMethod].nBytesOut += nBytes;
+}
+
+std::map<std::string, RPCMethodStats> RPCStats::GetStats() const
+{
+    LOCK(cs);
+    return mapStats;
+}
+
+void RPCStats::Reset()
+{
+    LOCK(cs);
+    mapStats.clear();
+}
+
+static UniValue HistogramToJSON(const LatencyHistogram& hist)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("count", hist.nCount);
+    obj.pushKV("total_us", hist.nTotalMicros);
+    UniValue buckets(UniValue::VARR);
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++)
+        buckets.push_back(hist.vBuckets[i]);
+    obj.pushKV("buckets", buckets);
+    return obj;
+}
+
+UniValue RPCStatsToJSON()
+{
+    UniValue ret(UniValue::VOBJ);
+
+    UniValue limits(UniValue::VARR);
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS - 1; i++)
+        limits.push_back(LatencyHistogram::BUCKET_LIMITS[i]);
+    ret.pushKV("bucket_limits_us", limits);
+
+    UniValue methods(UniValue::VOBJ);
+    for (const auto& entry : g_rpc_stats.GetStats()) {
+        const RPCMethodStats& stats = entry.second;
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("calls", stats.nCalls);
+        obj.pushKV("errors", stats.nErrors);
+        obj.pushKV("bytes_out", stats.nBytesOut);
+        obj.pushKV("cs_main_wait_us", stats.nMainLockWaitMicros);
+        obj.pushKV("queue", HistogramToJSON(stats.queue));
+        obj.pushKV("exec", HistogramToJSON(stats.exec));
+        obj.pushKV("serialize", HistogramToJSON(stats.serialize));
+        methods.pushKV(entry.first, obj);
+    }
+    ret.pushKV("methods", methods);
+
+    HTTPWorkQueueStats queue;
+    if (GetHTTPWorkQueueStats(queue)) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("depth", (uint64_t)queue.nDepth);
+        obj.pushKV("max_depth", (uint64_t)queue.nMaxDepth);
+        obj.pushKV("threads", queue.nThreads);
+        obj.pushKV("rejected", queue.nRejected);
+        ret.pushKV("work_queue", obj);
+    }
+
+    uint64_t nContended;
+    int64_t nWaitMicros;
+    GetMainLockContention(nContended, nWaitMicros);
+    UniValue lock(UniValue::VOBJ);
+    lock.pushKV("contended", nContended);
+    lock.pushKV("wait_us", nWaitMicros);
+    ret.pushKV("cs_main", lock);
+
+    return ret;
+}
+
+static std::string FormatSeconds(int64_t nMicros)
+{
+    return strprintf("%d.%06d", nMicros / 1000000, nMicros % 1000000);
+}
+
+static void PrometheusHistogram(std::string& out, const std::string& strName, const std::string& strMethod, const LatencyHistogram& hist)
+{
+    uint64_t nCumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS - 1; i++) {
+        nCumulative += hist.vBuckets[i];
+        out += strprintf("%s_bucket{method=\"%s\",le=\"%s\"} %u\n", strName, strMethod, FormatSeconds(LatencyHistogram::BUCKET_LIMITS[i]), nCumulative);
+    }
+    out += strprintf("%s_bucket{method=\"%s\",le=\"+Inf\"} %u\n", strName, strMethod, hist.nCount);
+    out += strprintf("%s_sum{method=\"%s\"} %s\n", strName, strMethod, FormatSeconds(hist.nTotalMicros));
+    out += strprintf("%s_count{method=\"%s\"} %u\n", strName, strMethod, hist.nCount);
+}
+
+std::string RPCStatsToPrometheus()
+{
+    const std::map<std::string, RPCMethodStats> mapStats = g_rpc_stats.GetStats();
+    std::string out;
+
+    out += "# HELP drivenet_rpc_calls_total Number of calls per RPC method or REST endpoint.\n";
+    out += "# TYPE drivenet_rpc_calls_total counter\n";
+    for (const auto& entry : mapStats)
+        out += strprintf("drivenet_rpc_calls_total{method=\"%s\"} %u\n", entry.first, entry.second.nCalls);
+
+    out += "# HELP drivenet_rpc_errors_total Number of calls that returned an error.\n";
+    out += "# TYPE drivenet_rpc_errors_total counter\n";
+    for (const auto& entry : mapStats)
+        out += strprintf("drivenet_rpc_errors_total{method=\"%s\"} %u\n", entry.first, entry.second.nErrors);
+
+    out += "# HELP drivenet_rpc_response_bytes_total Reply body bytes sent.\n";
+    out += "# TYPE drivenet_rpc_response_bytes_total counter\n";
+    for (const auto& entry : mapStats)
+        out += strprintf("drivenet_rpc_response_bytes_total{method=\"%s\"} %u\n", entry.first, entry.second.nBytesOut);
+
+    out += "# HELP drivenet_rpc_cs_main_wait_seconds_total Time spent waiting for cs_main while executing.\n";
+    out += "# TYPE drivenet_rpc_cs_main_wait_seconds_total counter\n";
+    for (const auto& entry : mapStats)
+        out += strprintf("drivenet_rpc_cs_main_wait_seconds_total{method=\"%s\"} %s\n", entry.first, FormatSeconds(entry.second.nMainLockWaitMicros));
+
+    const std::pair<std::string, LatencyHistogram RPCMethodStats::*> vHistograms[] = {
+        {"drivenet_rpc_queue_seconds", &RPCMethodStats::queue},
+        {"drivenet_rpc_exec_seconds", &RPCMethodStats::exec},
+        {"drivenet_rpc_serialize_seconds", &RPCMethodStats::serialize},
+    };
+    for (const auto& histogram : vHistograms) {
+        out += strprintf("# TYPE %s histogram\n", histogram.first);
+        for (const auto& entry : mapStats)
+            PrometheusHistogram(out, histogram.first, entry.first, entry.second.*histogram.second);
+    }
+
+    HTTPWorkQueueStats queue;
+    if (GetHTTPWorkQueueStats(queue)) {
+        out += "# HELP drivenet_http_work_queue_depth Requests waiting for an RPC worker thread.\n";
+        out += "# TYPE drivenet_http_work_queue_depth gauge\n";
+        out += strprintf("drivenet_http_work_queue_depth %u\n", queue.nDepth);
+        out += "# TYPE drivenet_http_work_queue_max_depth gauge\n";
+        out += strprintf("drivenet_http_work_queue_max_depth %u\n", queue.nMaxDepth);
+        out += "# TYPE drivenet_http_worker_threads gauge\n";
+        out += strprintf("drivenet_http_worker_threads %d\n", queue.nThreads);
+        out += "# HELP drivenet_http_work_queue_rejected_total Requests rejected because the work queue was full.\n";
+        out += "# TYPE drivenet_http_work_queue_rejected_total counter\n";
+        out += strprintf("drivenet_http_work_queue_rejected_total %u\n", queue.nRejected);
+    }
+
+    uint64_t nContended;
+    int64_t nWaitMicros;
+    GetMainLockContention(nContended, nWaitMicros);
+    out += "# HELP drivenet_cs_main_contended_total Acquisitions of cs_main that had to wait.\n";
+    out += "# TYPE drivenet_cs_main_contended_total counter\n";
+    out += strprintf("drivenet_cs_main_contended_total %u\n", nContended);
+    out += "# HELP drivenet_cs_main_wait_seconds_total Time all threads spent waiting for cs_main.\n";
+    out += "# TYPE drivenet_cs_main_wait_seconds_total counter\n";
+    out += strprintf("drivenet_cs_main_wait_seconds_total %s\n", FormatSeconds(nWaitMicros));
+
+    return out;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_STATS_H
+#define BITCOIN_RPC_STATS_H
+
+#include <sync.h>
+
+#include <map>
+#include <stdint.h>
+#include <string>
+
+class UniValue;
+
+/** Pseudo method name used for per-request figures of JSON-RPC batches */
+static const std::string RPC_STATS_BATCH = "(batch)";
+
+/**
+ * Latency histogram with fixed, roughly logarithmic buckets from 100us to 10s
+ * plus an overflow bucket. Counts are per bucket (not cumulative).
+ */
+class LatencyHistogram
+{
+public:
+    static const size_t NUM_BUCKETS = 17;
+    /** Upper bound (inclusive, in microseconds) of every bucket but the last */
+    static const int64_t BUCKET_LIMITS[NUM_BUCKETS - 1];
+
+    LatencyHistogram();
+
+    void Add(int64_t nMicros);
+
+    uint64_t nCount;
+    int64_t nTotalMicros;
+    uint64_t vBuckets[NUM_BUCKETS];
+};
+
+/** Counters collected for one RPC method or REST endpoint */
+struct RPCMethodStats
+{
+    uint64_t nCalls = 0;
+    uint64_t nErrors = 0;
+    uint64_t nBytesOut = 0;
+    //! Time spent waiting for cs_main while executing
+    int64_t nMainLockWaitMicros = 0;
+    //! Time between the HTTP request arriving and a worker picking it up
+    LatencyHistogram queue;
+    //! Time spent in the command itself
+    LatencyHistogram exec;
+    //! Time spent writing the result into the reply body
+    LatencyHistogram serialize;
+};
+
+/**
+ * Per-method latency and throughput counters for the RPC and REST interfaces.
+ * REST endpoints are recorded as "rest/<endpoint>".
+ */
+class RPCStats
+{
+public:
+    void RecordQueue(const std::string& strMethod, int64_t nMicros);
+    void RecordExec(const std::string& strMethod, int64_t nMicros, int64_t nMainLockWaitMicros, bool fError);
+    void RecordReply(const std::string& strMethod, int64_t nSerializeMicros, size_t nBytes);
+    /** Count reply bytes of handlers that serialize while executing (REST) */
+    void RecordReply(const std::string& strMethod, size_t nBytes);
+
+    /** Return a copy of the counters of all methods called so far */
+    std::map<std::string, RPCMethodStats> GetStats() const;
+
+    void Reset();
+
+private:
+    mutable CCriticalSection cs;
+    std::map<std::string, RPCMethodStats> mapStats;
+};
+
+extern RPCStats g_rpc_stats;
+
+/** Return the collected stats as the result object of getrpcstats */
+UniValue RPCStatsToJSON();
+
+/** Return the collected stats in the Prometheus text exposition format */
+std::string RPCStatsToPrometheus();
+
+#endif // BITCOIN_RPC_STATS_H
@@ -10,6 +10,8 @@
 #include <tinyformat.h>
 #include <utilstrencodings.h>
 
+#include <univalue.h>
+
 // Converts a hex string to a public key if possible
 CPubKey HexToPubKey(const std::string& hex_in)
 {
@@ -66,3 +68,14 @@ CScript CreateMultisigRedeemscript(const int required, const std::vector<CPubKey
 
     return result;
 }
+
+int ParsePageLimit(const UniValue& value)
+{
+    if (value.isNull())
+        return DEFAULT_RPC_PAGE_LIMIT;
+
+    int nLimit = value.get_int();
+    if (nLimit < 1 || nLimit > MAX_RPC_PAGE_LIMIT)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid limit, must be between 1 and %d", MAX_RPC_PAGE_LIMIT));
+    return nLimit;
+}
@@ -5,15 +5,62 @@
 #ifndef BITCOIN_RPC_UTIL_H
 #define BITCOIN_RPC_UTIL_H
 
+#include <rpc/protocol.h>
+#include <streams.h>
+#include <utilstrencodings.h>
+#include <version.h>
+
 #include <string>
 #include <vector>
 
 class CKeyStore;
 class CPubKey;
 class CScript;
+class UniValue;
+
+/** Number of entries per page of paginated RPCs if no limit is given */
+static const int DEFAULT_RPC_PAGE_LIMIT = 1000;
+/** Largest page a paginated RPC will return */
+static const int MAX_RPC_PAGE_LIMIT = 10000;
 
 CPubKey HexToPubKey(const std::string& hex_in);
 CPubKey AddrToPubKey(CKeyStore* const keystore, const std::string& addr_in);
 CScript CreateMultisigRedeemscript(const int required, const std::vector<CPubKey>& pubkeys);
 
+/** Read the optional page size argument of a paginated RPC */
+int ParsePageLimit(const UniValue& value);
+
+/**
+ * Create the continuation token of a paginated RPC. The token is opaque to
+ * clients: a tag identifying the RPC followed by the ordered index key of
+ * the last entry returned, so a later call (possibly after reconnecting)
+ * resumes right after that entry.
+ */
+template <typename Key>
+std::string EncodeRPCCursor(uint8_t nTag, const Key& key)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << nTag << key;
+    return HexStr(ss.begin(), ss.end());
+}
+
+/** Decode a token created by EncodeRPCCursor. Throws if it is malformed or
+ * was handed out by a different RPC. */
+template <typename Key>
+void DecodeRPCCursor(const std::string& strCursor, uint8_t nTag, Key& key)
+{
+    if (!IsHex(strCursor))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+
+    CDataStream ss(ParseHex(strCursor), SER_NETWORK, PROTOCOL_VERSION);
+    uint8_t nTagIn;
+    try {
+        ss >> nTagIn >> key;
+    } catch (const std::exception&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    if (nTagIn != nTag || !ss.empty())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+}
+
 #endif // BITCOIN_RPC_UTIL_H
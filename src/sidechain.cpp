@@ -158,6 +158,18 @@ uint256 SidechainCTIP::GetHash() const
     return SerializeHash(*this);
 }
 
+bool SidechainDBChangeSet::IsEmpty() const
+{
+    return (!fSidechainsChanged &&
+            vWithdrawalAdded.empty() &&
+            vWithdrawalUpdated.empty() &&
+            vWithdrawalRemoved.empty() &&
+            vCTIPChanged.empty() &&
+            vActivationAdded.empty() &&
+            vActivationUpdated.empty() &&
+            vActivationRemoved.empty());
+}
+
 CScript Sidechain::GetProposalScript() const
 {
     CDataStream ds(SER_DISK, CLIENT_VERSION);
@@ -269,6 +269,36 @@ struct SidechainCTIP {
     }
 };
 
+/**
+ * Changes to the withdrawal, CTIP and activation state of SCDB made by one
+ * block being connected, disconnected or resynced. The GUI applies these to
+ * its tables row by row instead of reloading SCDB.
+ */
+struct SidechainDBChangeSet {
+    uint64_t nSequence;
+    //! hashBlockLastSeen after the change
+    uint256 hashBlock;
+    //! Sidechains were activated or replaced, so everything must be reloaded
+    bool fSidechainsChanged;
+
+    std::vector<SidechainWithdrawalState> vWithdrawalAdded;
+    //! Work score or blocks left changed
+    std::vector<SidechainWithdrawalState> vWithdrawalUpdated;
+    //! Spent, failed or expired
+    std::vector<SidechainWithdrawalState> vWithdrawalRemoved;
+
+    //! Sidechains whose CTIP was created, moved or removed
+    std::vector<uint8_t> vCTIPChanged;
+
+    std::vector<SidechainActivationStatus> vActivationAdded;
+    //! Age or failure count changed
+    std::vector<SidechainActivationStatus> vActivationUpdated;
+    //! Proposal hashes of activated or failed proposals
+    std::vector<uint256> vActivationRemoved;
+
+    bool IsEmpty() const;
+};
+
 /**
  * Base object for sidechain related database entries
  */
@@ -14,7 +14,8 @@
 #include <util.h>
 #include <utilstrencodings.h>
 
-SidechainDB::SidechainDB()
+SidechainDB::SidechainDB() :
+    nChangeSequence(0)
 {
     Reset();
 }
@@ -26,6 +27,8 @@ bool SidechainDB::ApplyLDBData(const uint256& hashBlock, const SidechainBlockDat
     vActivationStatus = data.vActivationStatus;
     vSidechain = data.vSidechain;
 
+    PublishChanges();
+
     // TODO verify SCDB hash matches MT hash commit for block
     return true;
 }
@@ -380,6 +383,29 @@ std::map<uint8_t, SidechainCTIP> SidechainDB::GetCTIP() const
     return mapCTIP;
 }
 
+uint64_t SidechainDB::GetChangeSequence() const
+{
+    return nChangeSequence;
+}
+
+bool SidechainDB::GetChangeSets(uint64_t nSequence, std::vector<SidechainDBChangeSet>& vChangeSetOut, uint64_t& nSequenceOut) const
+{
+    vChangeSetOut.clear();
+    nSequenceOut = nChangeSequence;
+
+    if (nSequence > nChangeSequence)
+        return false;
+    if (nSequence == nChangeSequence)
+        return true;
+
+    // The change sets are numbered without gaps
+    if (vChangeSet.empty() || vChangeSet.front().nSequence > nSequence + 1)
+        return false;
+
+    vChangeSetOut.assign(vChangeSet.begin() + (nSequence + 1 - vChangeSet.front().nSequence), vChangeSet.end());
+    return true;
+}
+
 std::vector<SidechainCustomVote> SidechainDB::GetCustomVoteCache() const
 {
     return vCustomVoteCache;
@@ -403,21 +429,58 @@ std::vector<SidechainDeposit> SidechainDB::GetDeposits(const std::string& strPri
     // Make sure that the hash is related to an active sidechain,
     // and then return the result of the old function call.
     uint8_t nSidechain = 0;
-    bool fFound = false;
-    for (const Sidechain& s : vSidechain) {
-        if (s.strPrivKey == strPrivKey) {
-            nSidechain = s.nSidechain;
-            fFound = true;
-            break;
-        }
-    }
-
-    if (!fFound)
+    if (!GetSidechainNumber(strPrivKey, nSidechain))
         return std::vector<SidechainDeposit>{};
 
     return GetDeposits(nSidechain);
 }
 
+size_t SidechainDB::GetDepositCount(uint8_t nSidechain) const
+{
+    if (!IsSidechainActive(nSidechain))
+        return 0;
+
+    return vDepositCache[nSidechain].size();
+}
+
+std::vector<SidechainDeposit> SidechainDB::GetDepositPage(uint8_t nSidechain, size_t nEnd, size_t nMax) const
+{
+    std::vector<SidechainDeposit> vDeposit;
+    if (!IsSidechainActive(nSidechain))
+        return vDeposit;
+
+    const std::vector<SidechainDeposit>& vCache = vDepositCache[nSidechain];
+    if (nEnd > vCache.size())
+        nEnd = vCache.size();
+
+    for (size_t i = nEnd; i > 0 && vDeposit.size() < nMax; i--)
+        vDeposit.push_back(vCache[i - 1]);
+
+    return vDeposit;
+}
+
+bool SidechainDB::GetDepositPosition(uint8_t nSidechain, const COutPoint& out, size_t nHint, size_t& nPos) const
+{
+    if (!IsSidechainActive(nSidechain))
+        return false;
+
+    const std::vector<SidechainDeposit>& vCache = vDepositCache[nSidechain];
+    if (nHint < vCache.size() && vCache[nHint].nBurnIndex == out.n
+            && vCache[nHint].tx.GetHash() == out.hash) {
+        nPos = nHint;
+        return true;
+    }
+
+    // Deposits before the hint were removed (disconnected block) - search
+    for (size_t i = 0; i < vCache.size(); i++) {
+        if (vCache[i].nBurnIndex == out.n && vCache[i].tx.GetHash() == out.hash) {
+            nPos = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 uint256 SidechainDB::GetHashBlockLastSeen()
 {
     return hashBlockLastSeen;
@@ -506,7 +569,7 @@ uint256 SidechainDB::GetSCDBHash() const
             vLeaf.push_back(state.GetHash());
         }
     }
-    return ComputeMerkleRoot(vLeaf);
+    return ComputeMerkleRoot(std::move(vLeaf));
 }
 
 uint256 SidechainDB::GetSCDBHashIfUpdate(const std::vector<SidechainWithdrawalState>& vNewScores, int nHeight, const std::map<uint8_t, uint256>& mapNewWithdrawal, bool fRemoveExpired) const
@@ -530,6 +593,17 @@ bool SidechainDB::GetSidechain(const uint8_t nSidechain, Sidechain& sidechain) c
     return true;
 }
 
+bool SidechainDB::GetSidechainNumber(const std::string& strPrivKey, uint8_t& nSidechain) const
+{
+    for (const Sidechain& s : vSidechain) {
+        if (s.strPrivKey == strPrivKey) {
+            nSidechain = s.nSidechain;
+            return IsSidechainActive(nSidechain);
+        }
+    }
+    return false;
+}
+
 std::vector<SidechainActivationStatus> SidechainDB::GetSidechainActivationStatus() const
 {
     return vActivationStatus;
@@ -660,6 +734,55 @@ std::vector<SidechainFailedWithdrawal> SidechainDB::GetFailedWithdrawalCache() c
     return vFailed;
 }
 
+std::vector<SidechainSpentWithdrawal> SidechainDB::GetSpentWithdrawalPage(uint256& hashBlock, size_t& nIndex, size_t nMax) const
+{
+    std::vector<SidechainSpentWithdrawal> vSpent;
+
+    auto it = mapSpentWithdrawal.lower_bound(hashBlock);
+
+    // If the block we stopped in was removed, continue with the next block
+    if (it == mapSpentWithdrawal.end() || it->first != hashBlock)
+        nIndex = 0;
+
+    for (; it != mapSpentWithdrawal.end(); it++, nIndex = 0) {
+        for (; nIndex < it->second.size(); nIndex++) {
+            if (vSpent.size() == nMax) {
+                hashBlock = it->first;
+                return vSpent;
+            }
+            vSpent.push_back(it->second[nIndex]);
+        }
+    }
+
+    hashBlock.SetNull();
+    nIndex = 0;
+    return vSpent;
+}
+
+std::vector<SidechainFailedWithdrawal> SidechainDB::GetFailedWithdrawalPage(const uint256& hashAfter, size_t nMax) const
+{
+    std::vector<SidechainFailedWithdrawal> vFailed;
+
+    auto it = hashAfter.IsNull() ? mapFailedWithdrawal.begin() : mapFailedWithdrawal.upper_bound(hashAfter);
+    for (; it != mapFailedWithdrawal.end() && vFailed.size() < nMax; it++)
+        vFailed.push_back(it->second);
+
+    return vFailed;
+}
+
+size_t SidechainDB::GetSpentWithdrawalCount() const
+{
+    size_t nSpent = 0;
+    for (auto const& it : mapSpentWithdrawal)
+        nSpent += it.second.size();
+    return nSpent;
+}
+
+size_t SidechainDB::GetFailedWithdrawalCount() const
+{
+    return mapFailedWithdrawal.size();
+}
+
 bool SidechainDB::HasState() const
 {
     // Make sure that SCDB is actually initialized
@@ -906,6 +1029,8 @@ void SidechainDB::Reset()
     vSidechain.resize(SIDECHAIN_ACTIVATION_MAX_ACTIVE);
     for (size_t i = 0; i < vSidechain.size(); i++)
         vSidechain[i].nSidechain = i;
+
+    PublishChanges();
 }
 
 bool SidechainDB::SpendWithdrawal(uint8_t nSidechain, const uint256& hashBlock, const CTransaction& tx, const int nTx, bool fJustCheck, bool fDebug)
@@ -1301,11 +1426,18 @@ bool SidechainDB::Update(int nHeight, const uint256& hashBlock, const uint256& h
 {
     // Make a copy of SCDB to test update
     SidechainDB scdbCopy = (*this);
-    if (scdbCopy.ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug)) {
-        return ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug);
-    } else {
+    if (!scdbCopy.ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug))
         return false;
-    }
+
+    if (!ApplyUpdate(nHeight, hashBlock, hashPrevBlock, vout, fJustCheck, fDebug))
+        return false;
+
+    // The deposits and withdrawal spends of the block were added before the
+    // update, so this change set includes them as well
+    if (!fJustCheck)
+        PublishChanges();
+
+    return true;
 }
 
 bool SidechainDB::ApplyUpdate(int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock, const std::vector<CTxOut>& vout, bool fJustCheck, bool fDebug)
@@ -1704,6 +1836,8 @@ bool SidechainDB::Undo(int nHeight, const uint256& hashBlock, const uint256& has
     // Undo hashBlockLastSeen
     hashBlockLastSeen = hashPrevBlock;
 
+    PublishChanges();
+
     LogPrintf("%s: SCDB undo for block: %s complete!\n", __func__, hashBlock.ToString());
 
     return true;
@@ -1944,6 +2078,88 @@ void SidechainDB::ApplyDefaultUpdate()
     RemoveExpiredWithdrawals();
 }
 
+void SidechainDB::PublishChanges()
+{
+    SidechainDBChangeSet changeSet;
+    changeSet.nSequence = nChangeSequence + 1;
+    changeSet.hashBlock = hashBlockLastSeen;
+
+    // Active sidechains
+    std::vector<uint256> vSidechainHash(vSidechain.size());
+    for (size_t i = 0; i < vSidechain.size(); i++) {
+        if (vSidechain[i].fActive)
+            vSidechainHash[i] = vSidechain[i].GetHash();
+    }
+    changeSet.fSidechainsChanged = vSidechainHash != vSidechainPublished;
+
+    // Withdrawals
+    std::map<std::pair<uint8_t, uint256>, SidechainWithdrawalState> mapWithdrawalPublished;
+    for (const std::vector<SidechainWithdrawalState>& vState : vWithdrawalStatusPublished) {
+        for (const SidechainWithdrawalState& state : vState)
+            mapWithdrawalPublished[std::make_pair(state.nSidechain, state.hash)] = state;
+    }
+    for (const std::vector<SidechainWithdrawalState>& vState : vWithdrawalStatus) {
+        for (const SidechainWithdrawalState& state : vState) {
+            auto it = mapWithdrawalPublished.find(std::make_pair(state.nSidechain, state.hash));
+            if (it == mapWithdrawalPublished.end()) {
+                changeSet.vWithdrawalAdded.push_back(state);
+                continue;
+            }
+            if (it->second.nWorkScore != state.nWorkScore || it->second.nBlocksLeft != state.nBlocksLeft)
+                changeSet.vWithdrawalUpdated.push_back(state);
+
+            mapWithdrawalPublished.erase(it);
+        }
+    }
+    for (const auto& it : mapWithdrawalPublished)
+        changeSet.vWithdrawalRemoved.push_back(it.second);
+
+    // CTIP
+    for (const auto& it : mapCTIP) {
+        auto itPublished = mapCTIPPublished.find(it.first);
+        if (itPublished == mapCTIPPublished.end() ||
+                itPublished->second.out != it.second.out ||
+                itPublished->second.amount != it.second.amount) {
+            changeSet.vCTIPChanged.push_back(it.first);
+        }
+    }
+    for (const auto& it : mapCTIPPublished) {
+        if (!mapCTIP.count(it.first))
+            changeSet.vCTIPChanged.push_back(it.first);
+    }
+
+    // Sidechain activation
+    std::map<uint256, SidechainActivationStatus> mapActivationPublished;
+    for (const SidechainActivationStatus& status : vActivationStatusPublished)
+        mapActivationPublished[status.proposal.GetHash()] = status;
+    for (const SidechainActivationStatus& status : vActivationStatus) {
+        auto it = mapActivationPublished.find(status.proposal.GetHash());
+        if (it == mapActivationPublished.end()) {
+            changeSet.vActivationAdded.push_back(status);
+            continue;
+        }
+        if (it->second.nAge != status.nAge || it->second.nFail != status.nFail)
+            changeSet.vActivationUpdated.push_back(status);
+
+        mapActivationPublished.erase(it);
+    }
+    for (const auto& it : mapActivationPublished)
+        changeSet.vActivationRemoved.push_back(it.first);
+
+    if (changeSet.IsEmpty())
+        return;
+
+    nChangeSequence++;
+    vChangeSet.push_back(changeSet);
+    if (vChangeSet.size() > MAX_SCDB_CHANGE_SETS)
+        vChangeSet.erase(vChangeSet.begin());
+
+    vSidechainPublished = vSidechainHash;
+    vWithdrawalStatusPublished = vWithdrawalStatus;
+    mapCTIPPublished = mapCTIP;
+    vActivationStatusPublished = vActivationStatus;
+}
+
 void SidechainDB::UpdateActivationStatus(const std::vector<uint256>& vHash)
 {
     // TODO change containers
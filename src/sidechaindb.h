@@ -27,11 +27,15 @@ struct SidechainActivationStatus;
 struct SidechainBlockData;
 struct SidechainCustomVote;
 struct SidechainCTIP;
+struct SidechainDBChangeSet;
 struct SidechainDeposit;
 struct SidechainWithdrawalState;
 struct SidechainSpentWithdrawal;
 struct SidechainFailedWithdrawal;
 
+//! Number of change sets kept by SidechainDB for GetChangeSets
+static const size_t MAX_SCDB_CHANGE_SETS = 10;
+
 class SidechainDB
 {
 public:
@@ -111,6 +115,14 @@ public:
 
     bool GetCachedWithdrawalTx(const uint256& hash, CMutableTransaction& mtx) const;
 
+    /** Return the sequence number of the latest change set */
+    uint64_t GetChangeSequence() const;
+
+    /** Get the change sets made after change set nSequence, and the sequence
+     * number of the latest one. Returns false if some of them were dropped,
+     * in which case the caller must load SCDB again. */
+    bool GetChangeSets(uint64_t nSequence, std::vector<SidechainDBChangeSet>& vChangeSetOut, uint64_t& nSequenceOut) const;
+
     /** Return vector of cached custom withdrawal votes */
     std::vector<SidechainCustomVote> GetCustomVoteCache() const;
 
@@ -120,6 +132,17 @@ public:
     /** Return vector of cached deposits for nSidechain. */
     std::vector<SidechainDeposit> GetDeposits(const std::string& sidechainPriv) const;
 
+    /** Return the number of cached deposits for nSidechain */
+    size_t GetDepositCount(uint8_t nSidechain) const;
+
+    /** Return up to nMax cached deposits for nSidechain, newest first,
+     * starting below cache position nEnd (positions count from the oldest) */
+    std::vector<SidechainDeposit> GetDepositPage(uint8_t nSidechain, size_t nEnd, size_t nMax) const;
+
+    /** Find the cache position of the deposit burn output. The position in
+     * nHint is checked first so that resuming a page is usually O(1). */
+    bool GetDepositPosition(uint8_t nSidechain, const COutPoint& out, size_t nHint, size_t& nPos) const;
+
     /** Return the hash of the last block SCDB processed */
     uint256 GetHashBlockLastSeen();
 
@@ -136,6 +159,9 @@ public:
     /** Return what the SCDB hash would be if the updates are applied */
     uint256 GetSCDBHashIfUpdate(const std::vector<SidechainWithdrawalState>& vNewScores, int nHeight, const std::map<uint8_t, uint256>& mapNewWithdrawal = {}, bool fRemoveExpired = false) const;
 
+    /** Get the number of the active sidechain with private key strPrivKey */
+    bool GetSidechainNumber(const std::string& strPrivKey, uint8_t& nSidechain) const;
+
     /** Get the sidechain that relates to nSidechain if it exists */
     bool GetSidechain(const uint8_t nSidechain, Sidechain& sidechain) const;
 
@@ -178,6 +204,23 @@ public:
     /** Return cached failed withdrawals^ as a vector for dumping to disk */
     std::vector<SidechainFailedWithdrawal> GetFailedWithdrawalCache() const;
 
+    /** Return up to nMax cached spent withdrawals, ordered by block hash and
+     * then by spend order within the block, starting at entry nIndex of the
+     * first block at or after hashBlock. The position is updated to the entry
+     * following the page and hashBlock is set null once the cache is
+     * exhausted. */
+    std::vector<SidechainSpentWithdrawal> GetSpentWithdrawalPage(uint256& hashBlock, size_t& nIndex, size_t nMax) const;
+
+    /** Return up to nMax cached failed withdrawals ordered by hash, starting
+     * after hashAfter (or at the first one if hashAfter is null) */
+    std::vector<SidechainFailedWithdrawal> GetFailedWithdrawalPage(const uint256& hashAfter, size_t nMax) const;
+
+    /** Return the number of spent withdrawals in the cache */
+    size_t GetSpentWithdrawalCount() const;
+
+    /** Return the number of failed withdrawals in the cache */
+    size_t GetFailedWithdrawalCount() const;
+
     /** Is there anything being tracked by the SCDB? */
     bool HasState() const;
 
@@ -257,6 +300,10 @@ private:
     /** Apply the changes in a block to SCDB */
     bool ApplyUpdate(int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock, const std::vector<CTxOut>& vout, bool fJustCheck = false, bool fDebug = false);
 
+    /** Record the changes to the state shown by the GUI since the last change
+     * set, if there are any */
+    void PublishChanges();
+
     /** Takes a list of sidechain hashes to upvote */
     void UpdateActivationStatus(const std::vector<uint256>& vHash);
 
@@ -326,6 +373,17 @@ private:
      * spending the same CTIP as the deposit. */
     std::vector<uint256> vRemovedDeposit;
 
+    /** Sequence number of the latest change set */
+    uint64_t nChangeSequence;
+
+    /** The last MAX_SCDB_CHANGE_SETS change sets, oldest first */
+    std::vector<SidechainDBChangeSet> vChangeSet;
+
+    /** State as of the latest change set, to diff the next one against */
+    std::vector<std::vector<SidechainWithdrawalState>> vWithdrawalStatusPublished;
+    std::map<uint8_t, SidechainCTIP> mapCTIPPublished;
+    std::vector<SidechainActivationStatus> vActivationStatusPublished;
+    std::vector<uint256> vSidechainPublished;
 };
 
 /** Read encoded sum of withdrawal fees output script */
@@ -8,7 +8,9 @@
 #include <util.h>
 #include <utilstrencodings.h>
 
+#include <atomic>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef DEBUG_LOCKCONTENTION
 #if !defined(HAVE_THREAD_LOCAL)
@@ -21,6 +23,45 @@ void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 }
 #endif /* DEBUG_LOCKCONTENTION */
 
+static std::atomic<uint64_t> nMainLockContended(0);
+static std::atomic<int64_t> nMainLockWaitMicros(0);
+#ifdef HAVE_THREAD_LOCAL
+static thread_local int64_t nThreadMainLockWait = 0;
+#endif
+
+void WaitForLock(std::unique_lock<CCriticalSection>& lock, const char* pszName)
+{
+    if (strcmp(pszName, "cs_main") != 0) {
+        lock.lock();
+        return;
+    }
+
+    int64_t nStart = GetTimeMicros();
+    lock.lock();
+    int64_t nWait = GetTimeMicros() - nStart;
+
+    nMainLockContended++;
+    nMainLockWaitMicros += nWait;
+#ifdef HAVE_THREAD_LOCAL
+    nThreadMainLockWait += nWait;
+#endif
+}
+
+int64_t GetThreadMainLockWait()
+{
+#ifdef HAVE_THREAD_LOCAL
+    return nThreadMainLockWait;
+#else
+    return 0;
+#endif
+}
+
+void GetMainLockContention(uint64_t& nContended, int64_t& nWaitMicros)
+{
+    nContended = nMainLockContended;
+    nWaitMicros = nMainLockWaitMicros;
+}
+
 #ifdef DEBUG_LOCKORDER
 //
 // Early deadlock detection.
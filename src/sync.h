@@ -9,6 +9,7 @@
 #include <threadsafety.h>
 
 #include <condition_variable>
+#include <stdint.h>
 #include <thread>
 #include <mutex>
 
@@ -112,6 +113,17 @@ typedef std::unique_lock<std::mutex> WaitableLock;
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine);
 #endif
 
+/** Block until a contended lock is acquired. Time spent waiting for cs_main
+ * is accounted to the calling thread, see GetThreadMainLockWait(). */
+void WaitForLock(std::unique_lock<CCriticalSection>& lock, const char* pszName);
+
+/** Total microseconds the calling thread has spent waiting for cs_main */
+int64_t GetThreadMainLockWait();
+
+/** Number of contended cs_main acquisitions and total microseconds spent
+ * waiting for them, across all threads */
+void GetMainLockContention(uint64_t& nContended, int64_t& nWaitMicros);
+
 /** Wrapper around std::unique_lock<CCriticalSection> */
 class SCOPED_LOCKABLE CCriticalBlock
 {
@@ -121,14 +133,12 @@ private:
     void Enter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()));
-#ifdef DEBUG_LOCKCONTENTION
         if (!lock.try_lock()) {
+#ifdef DEBUG_LOCKCONTENTION
             PrintLockContention(pszName, pszFile, nLine);
 #endif
-            lock.lock();
-#ifdef DEBUG_LOCKCONTENTION
+            WaitForLock(lock, pszName);
         }
-#endif
     }
 
     bool TryEnter(const char* pszName, const char* pszFile, int nLine)
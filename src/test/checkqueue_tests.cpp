@@ -302,6 +302,35 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_UniqueCheck)
     tg.join_all();
 }
 
+// Test that big batches, which are split up between the threads, have each
+// check performed exactly once
+BOOST_AUTO_TEST_CASE(test_CheckQueue_UniqueCheck_Big_Batches)
+{
+    auto queue = std::unique_ptr<Unique_Queue>(new Unique_Queue {QUEUE_BATCH_SIZE});
+    boost::thread_group tg;
+    for (auto x = 0; x < nScriptCheckThreads; ++x) {
+       tg.create_thread([&]{queue->Thread();});
+    }
+
+    UniqueCheck::results.clear();
+    size_t COUNT = 100000;
+    for (size_t nBatch : {COUNT / 2, (size_t) QUEUE_BATCH_SIZE * 3 + 1, COUNT / 2 - QUEUE_BATCH_SIZE * 3 - 1}) {
+        CCheckQueueControl<UniqueCheck> control(queue.get());
+        std::vector<UniqueCheck> vChecks;
+        for (size_t k = 0; k < nBatch; k++)
+            vChecks.emplace_back(UniqueCheck::results.size() + k);
+        control.Add(vChecks);
+        BOOST_REQUIRE(control.Wait());
+    }
+    bool r = true;
+    BOOST_REQUIRE_EQUAL(UniqueCheck::results.size(), COUNT);
+    for (size_t i = 0; i < COUNT; ++i)
+        r = r && UniqueCheck::results.count(i) == 1;
+    BOOST_REQUIRE(r);
+    tg.interrupt_all();
+    tg.join_all();
+}
+
 
 // Test that blocks which might allocate lots of memory free their memory aggressively.
 //
@@ -4,6 +4,7 @@
 
 #include <coins.h>
 #include <script/standard.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <undo.h>
 #include <utilstrencodings.h>
@@ -859,4 +860,140 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+
+BOOST_FIXTURE_TEST_CASE(ccoins_background_write, TestingSetup)
+{
+    CCoinsViewDB db(1 << 20, true);
+    CCoinsViewCacheTest cache(&db);
+
+    std::vector<COutPoint> vOutPoint;
+    for (int i = 0; i < 110; i++) {
+        Coin coin;
+        coin.out.nValue = i + 1;
+        coin.out.scriptPubKey.assign(InsecureRandBits(6), 0);
+        coin.nHeight = 1;
+        vOutPoint.emplace_back(InsecureRand256(), 0);
+        cache.AddCoin(vOutPoint.back(), std::move(coin), false);
+
+        // The first generation is written in the foreground
+        if (i == 99) {
+            cache.SetBestBlock(InsecureRand256());
+            BOOST_CHECK(cache.Flush());
+            for (int j = 0; j < 50; j++)
+                BOOST_CHECK(cache.HaveCoin(vOutPoint[j]));
+            for (int j = 0; j < 25; j++)
+                BOOST_CHECK(cache.SpendCoin(vOutPoint[j], false));
+        }
+    }
+    uint256 hashBlock = InsecureRand256();
+    cache.SetBestBlock(hashBlock);
+
+    // The spent and the new coins are handed over, the coins only read stay
+    CCoinsMap mapDirty;
+    cache.ExtractDirty(mapDirty, std::numeric_limits<size_t>::max());
+    BOOST_CHECK_EQUAL(mapDirty.size(), 35U);
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 25U);
+    cache.SelfTest();
+
+    // The view shows the new generation while and after it is written
+    BOOST_CHECK(db.BatchWriteInBackground(mapDirty, hashBlock));
+    BOOST_CHECK(mapDirty.empty());
+    for (int i = 0; i < 2; i++) {
+        BOOST_CHECK(db.GetBestBlock() == hashBlock);
+        for (size_t j = 0; j < vOutPoint.size(); j++) {
+            BOOST_CHECK_EQUAL(db.HaveCoin(vOutPoint[j]), j >= 25);
+            BOOST_CHECK_EQUAL(cache.HaveCoin(vOutPoint[j]), j >= 25);
+        }
+        BOOST_CHECK(db.WaitForWrite());
+    }
+    BOOST_CHECK(!db.IsWriting());
+    BOOST_CHECK_EQUAL(db.WritingMemoryUsage(), 0U);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+
+    // The unmodified coins are dropped when the cache has to shrink
+    cache.ExtractDirty(mapDirty, 0);
+    BOOST_CHECK(mapDirty.empty());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    cache.SelfTest();
+}
+
+BOOST_FIXTURE_TEST_CASE(ccoins_bulk_write, TestingSetup)
+{
+    CCoinsViewDB db(1 << 20, true);
+    uint256 hashBlock = InsecureRand256();
+
+    // The database is marked as unfinished until the end
+    BOOST_CHECK(db.BeginBulkWrite(hashBlock));
+    BOOST_CHECK(db.GetBestBlock().IsNull());
+    BOOST_CHECK_EQUAL(db.GetHeadBlocks().size(), 2U);
+
+    std::vector<std::pair<COutPoint, Coin>> vCoins;
+    {
+        CCoinsBulkWriter writer(db, 3);
+        for (int i = 0; i < 20; i++) {
+            std::vector<std::pair<COutPoint, Coin>> vChunk;
+            for (int j = 0; j < 50; j++) {
+                Coin coin;
+                coin.out.nValue = InsecureRandRange(1000) + 1;
+                coin.nHeight = 1;
+                vChunk.emplace_back(COutPoint(InsecureRand256(), j), coin);
+            }
+            vCoins.insert(vCoins.end(), vChunk.begin(), vChunk.end());
+            writer.Add(std::move(vChunk));
+        }
+        BOOST_CHECK(writer.Finish());
+    }
+
+    BOOST_CHECK(db.EndBulkWrite(hashBlock));
+    BOOST_CHECK(db.GetBestBlock() == hashBlock);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+    for (const std::pair<COutPoint, Coin>& coin : vCoins) {
+        Coin coinRead;
+        BOOST_CHECK(db.GetCoin(coin.first, coinRead));
+        BOOST_CHECK(coinRead.out == coin.second.out);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(utxo_set_stats)
+{
+    std::vector<std::pair<COutPoint, Coin>> vCoins;
+    for (int i = 0; i < 100; i++) {
+        Coin coin;
+        coin.out.nValue = InsecureRandRange(1000) + 1;
+        coin.out.scriptPubKey.assign(InsecureRandRange(30), 0);
+        coin.nHeight = InsecureRandRange(1000);
+        coin.fCoinBase = InsecureRandBool();
+        vCoins.emplace_back(COutPoint(InsecureRand256(), InsecureRandRange(4)), coin);
+    }
+
+    // Adding coins and removing some again gives the statistics of the
+    // coins that are left, whatever the order
+    UTXOSetStats stats;
+    for (const std::pair<COutPoint, Coin>& coin : vCoins)
+        stats.AddCoin(coin.first, coin.second);
+    for (size_t i = 0; i < vCoins.size(); i += 2)
+        stats.RemoveCoin(vCoins[i].first, vCoins[i].second);
+
+    UTXOSetStats statsLeft;
+    for (int i = vCoins.size() - 1; i >= 0; i -= 2)
+        statsLeft.AddCoin(vCoins[i].first, vCoins[i].second);
+
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, 50U);
+    BOOST_CHECK_EQUAL(stats.nTransactionOutputs, statsLeft.nTransactionOutputs);
+    BOOST_CHECK_EQUAL(stats.nBogoSize, statsLeft.nBogoSize);
+    BOOST_CHECK_EQUAL(stats.totalAmount, statsLeft.totalAmount);
+    uint256 hash, hashLeft;
+    stats.muhash.Finalize(hash.begin());
+    statsLeft.muhash.Finalize(hashLeft.begin());
+    BOOST_CHECK(hash == hashLeft);
+
+    // The same coin at another height is another element of the set
+    Coin coinMoved = vCoins[1].second;
+    coinMoved.nHeight++;
+    statsLeft.RemoveCoin(vCoins[1].first, vCoins[1].second);
+    statsLeft.AddCoin(vCoins[1].first, coinMoved);
+    statsLeft.muhash.Finalize(hashLeft.begin());
+    BOOST_CHECK(hash != hashLeft);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
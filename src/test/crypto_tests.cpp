@@ -10,7 +10,10 @@
 #include <crypto/sha512.h>
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
+#include <crypto/muhash.h>
+#include <hash.h>
 #include <random.h>
+#include <streams.h>
 #include <utilstrencodings.h>
 #include <test/test_drivenet.h>
 
@@ -524,6 +527,93 @@ BOOST_AUTO_TEST_CASE(chacha20_testvector)
                  "fab78c9");
 }
 
+BOOST_AUTO_TEST_CASE(sha256d64)
+{
+    std::string strIn = "This is exactly 64 bytes long, not counting the terminating byte";
+    unsigned char out[32];
+    SHA256D64(out, (const unsigned char*)strIn.data(), 1);
+    BOOST_CHECK_EQUAL(HexStr(out, out + 32), "67d888912a5ba391bf704f33a9882f280cd5a75dbaed64de4ff436a6cf653058");
+
+    // Every batch size up to a few rounds of the widest implementation, so
+    // that the multi-way implementations and the remainders are all used
+    for (int i = 0; i <= 32; ++i) {
+        unsigned char in[64 * 32];
+        unsigned char out1[32 * 32], out2[32 * 32];
+        for (int j = 0; j < 64 * i; ++j) {
+            in[j] = InsecureRandBits(8);
+        }
+        for (int j = 0; j < i; ++j) {
+            CHash256().Write(in + 64 * j, 64).Finalize(out1 + 32 * j);
+        }
+        SHA256D64(out2, in, i);
+        BOOST_CHECK(memcmp(out1, out2, 32 * i) == 0);
+
+        // Hashing in place, as the merkle root computation does
+        SHA256D64(in, in, i);
+        BOOST_CHECK(memcmp(out1, in, 32 * i) == 0);
+    }
+}
+
+static MuHash3072 FromInt(unsigned char i)
+{
+    unsigned char tmp[32] = {i, 0};
+    return MuHash3072(tmp, sizeof(tmp));
+}
+
+static uint256 MuHashFinalize(MuHash3072 muhash)
+{
+    uint256 out;
+    muhash.Finalize(out.begin());
+    return out;
+}
+
+BOOST_AUTO_TEST_CASE(muhash_tests)
+{
+    // The same set hashes the same whatever the order of insertions and
+    // removals, and whether it is built up or combined from other sets
+    for (int iter = 0; iter < 10; ++iter) {
+        uint256 x = InsecureRand256();
+        uint256 y = InsecureRand256();
+        uint256 z = InsecureRand256();
+
+        MuHash3072 a;
+        a.Insert(x.begin(), x.size());
+        a.Insert(y.begin(), y.size());
+
+        MuHash3072 b(y.begin(), y.size());
+        b.Insert(z.begin(), z.size());
+        b.Insert(x.begin(), x.size());
+        b.Remove(z.begin(), z.size());
+        BOOST_CHECK(MuHashFinalize(a) == MuHashFinalize(b));
+
+        MuHash3072 c(x.begin(), x.size());
+        c *= MuHash3072(y.begin(), y.size());
+        BOOST_CHECK(MuHashFinalize(a) == MuHashFinalize(c));
+
+        MuHash3072 d;
+        d.Insert(z.begin(), z.size());
+        d /= MuHash3072(z.begin(), z.size());
+        BOOST_CHECK(MuHashFinalize(d) == MuHashFinalize(MuHash3072()));
+
+        // A removal that is not undone keeps the hash apart
+        b.Remove(y.begin(), y.size());
+        BOOST_CHECK(MuHashFinalize(a) != MuHashFinalize(b));
+
+        // Serialized set hashes carry on where they left off
+        CDataStream ss(SER_DISK, 0);
+        ss << b;
+        MuHash3072 e;
+        ss >> e;
+        e.Insert(y.begin(), y.size());
+        BOOST_CHECK(MuHashFinalize(a) == MuHashFinalize(e));
+    }
+
+    MuHash3072 acc = FromInt(0);
+    acc *= FromInt(1);
+    acc /= FromInt(2);
+    BOOST_CHECK_EQUAL(MuHashFinalize(acc).GetHex(), "10d312b100cbd32ada024a6646e40d3482fcff103668d2625f10002a607d5863");
+}
+
 BOOST_AUTO_TEST_CASE(countbits_tests)
 {
     FastRandomContext ctx;
@@ -315,6 +315,44 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_options_and_stats)
+{
+    std::string strName;
+    int nValue;
+    BOOST_CHECK(ParseDBOptionArg("opreturn:128", strName, nValue));
+    BOOST_CHECK_EQUAL(strName, "opreturn");
+    BOOST_CHECK_EQUAL(nValue, 128);
+    BOOST_CHECK(!ParseDBOptionArg("opreturn", strName, nValue));
+    BOOST_CHECK(!ParseDBOptionArg(":128", strName, nValue));
+    BOOST_CHECK(!ParseDBOptionArg("opreturn:x", strName, nValue));
+
+    // Without -db* options every database gets the defaults
+    CDBOptions dbopts = GetDBOptions("opreturn");
+    BOOST_CHECK_EQUAL(dbopts.nMaxOpenFiles, DEFAULT_DB_MAX_OPEN_FILES);
+    BOOST_CHECK_EQUAL(dbopts.nBloomBits, DEFAULT_DB_BLOOM_BITS);
 
+    fs::path ph = fs::temp_directory_path() / fs::unique_path();
+    CDBWrapper dbw(ph, (1 << 20), true, false, false);
+    for (uint32_t i = 0; i < 1000; i++)
+        BOOST_CHECK(dbw.Write(std::make_pair('k', i), InsecureRand256()));
+
+    // Compacting writes the memtable to a table file first
+    dbw.CompactAll();
+    CDBStats stats = dbw.GetStats();
+    BOOST_CHECK_EQUAL(stats.nWrites, 1000U);
+    BOOST_CHECK(stats.nFlushes >= 1);
+    BOOST_CHECK(dbw.EstimateTotalSize() > 0);
+    BOOST_CHECK(!dbw.GetProperty("leveldb.stats").empty());
+    BOOST_CHECK(dbw.GetProperty("leveldb.unknown").empty());
+
+    // The second read of a key finds its block in the cache
+    uint256 res;
+    BOOST_CHECK(dbw.Read(std::make_pair('k', (uint32_t)500), res));
+    BOOST_CHECK(dbw.Read(std::make_pair('k', (uint32_t)500), res));
+    stats = dbw.GetStats();
+    BOOST_CHECK(stats.nCacheMisses >= 1);
+    BOOST_CHECK(stats.nCacheHits >= 1);
+    BOOST_CHECK(stats.nCacheUsage > 0);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
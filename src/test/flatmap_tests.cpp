@@ -0,0 +1,118 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <flatmap.h>
+#include <memusage.h>
+
+#include <test/test_drivenet.h>
+
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(flatmap_tests, BasicTestingSetup)
+
+namespace {
+//! Collide a lot so that probing and tombstones get exercised
+struct CollidingHasher {
+    size_t operator()(uint32_t n) const { return (size_t)(n % 61) * 0x9E3779B97F4A7C15ULL; }
+};
+
+typedef flatmap<uint32_t, uint64_t, CollidingHasher> TestMap;
+
+void CheckEqual(const TestMap& map, const std::map<uint32_t, uint64_t>& real)
+{
+    BOOST_CHECK_EQUAL(map.size(), real.size());
+    BOOST_CHECK_EQUAL(map.empty(), real.empty());
+
+    std::map<uint32_t, uint64_t> seen;
+    for (const auto& entry : map)
+        BOOST_CHECK(seen.emplace(entry.first, entry.second).second);
+    BOOST_CHECK(seen == real);
+
+    for (const auto& entry : real) {
+        TestMap::const_iterator it = map.find(entry.first);
+        BOOST_CHECK(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, entry.second);
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(flatmap_random)
+{
+    TestMap map;
+    std::map<uint32_t, uint64_t> real;
+
+    for (int i = 0; i < 20000; i++) {
+        uint32_t key = InsecureRandRange(2000);
+        switch (InsecureRandRange(4)) {
+        case 0:
+        case 1: {
+            uint64_t value = InsecureRand32();
+            auto ret = map.try_emplace(key, value);
+            BOOST_CHECK_EQUAL(ret.second, real.emplace(key, value).second);
+            BOOST_CHECK_EQUAL(ret.first->first, key);
+            break;
+        }
+        case 2:
+            map[key] += 1;
+            real[key] += 1;
+            break;
+        case 3:
+            BOOST_CHECK_EQUAL(map.erase(key), real.erase(key));
+            break;
+        }
+        BOOST_CHECK_EQUAL(map.count(key), real.count(key));
+
+        if (i % 1000 == 0)
+            CheckEqual(map, real);
+        if (i % 7000 == 0) {
+            map.clear();
+            real.clear();
+            BOOST_CHECK(map.begin() == map.end());
+        }
+    }
+    CheckEqual(map, real);
+}
+
+BOOST_AUTO_TEST_CASE(flatmap_stability)
+{
+    TestMap map;
+
+    // Entries do not move when the index grows
+    std::vector<const uint64_t*> vAddress;
+    for (uint32_t i = 0; i < 1000; i++)
+        vAddress.push_back(&map.try_emplace(i, i).first->second);
+    for (uint32_t i = 0; i < 1000; i++)
+        BOOST_CHECK_EQUAL(&map.find(i)->second, vAddress[i]);
+
+    // Erase every other entry while iterating
+    for (TestMap::iterator it = map.begin(); it != map.end();) {
+        if (it->first % 2)
+            it = map.erase(it);
+        else
+            it++;
+    }
+    BOOST_CHECK_EQUAL(map.size(), 500U);
+    for (uint32_t i = 0; i < 1000; i++)
+        BOOST_CHECK_EQUAL(map.count(i), (i % 2) ? 0U : 1U);
+
+    // The erased places are reused before the arena grows
+    size_t nUsage = memusage::DynamicUsage(map);
+    for (uint32_t i = 1; i < 1000; i += 2)
+        map.try_emplace(i, i);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), nUsage);
+
+    // Moving keeps the entries and leaves an empty map
+    TestMap moved(std::move(map));
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(map.find(0) == map.end());
+    BOOST_CHECK_EQUAL(moved.size(), 1000U);
+    BOOST_CHECK_EQUAL(&moved.find(0)->second, vAddress[0]);
+
+    moved.clear();
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(moved), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -571,4 +571,64 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     SetMockTime(0);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolDeltaTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    LOCK(pool.cs);
+
+    // A fresh pool has nothing to report, an unknown sequence starts over
+    uint64_t nSequence = pool.GetDeltaSequence();
+    std::vector<TxMempoolDelta> vDelta;
+    BOOST_CHECK(pool.GetDeltas(nSequence, vDelta, nSequence));
+    BOOST_CHECK(vDelta.empty());
+    uint64_t nSequenceOut;
+    BOOST_CHECK(!pool.GetDeltas(nSequence + 1, vDelta, nSequenceOut));
+
+    // Entry times are out of order, InfoRecent lists by arrival
+    std::vector<CMutableTransaction> vTx(3);
+    for (size_t i = 0; i < vTx.size(); i++) {
+        vTx[i].vin.resize(1);
+        vTx[i].vin[0].scriptSig = CScript() << OP_11 << (int64_t)i;
+        vTx[i].vout.resize(1);
+        vTx[i].vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        vTx[i].vout[0].nValue = 10000LL;
+        pool.addUnchecked(vTx[i].GetHash(), entry.Time(100 - i).FromTx(vTx[i]));
+    }
+    std::vector<TxMempoolInfo> vInfo = pool.InfoRecent(2);
+    BOOST_REQUIRE_EQUAL(vInfo.size(), 2U);
+    BOOST_CHECK(vInfo[0].tx->GetHash() == vTx[2].GetHash());
+    BOOST_CHECK(vInfo[1].tx->GetHash() == vTx[1].GetHash());
+
+    pool.removeRecursive(vTx[1], MemPoolRemovalReason::CONFLICT);
+
+    BOOST_CHECK(pool.GetDeltas(nSequence, vDelta, nSequence));
+    BOOST_REQUIRE_EQUAL(vDelta.size(), 4U);
+    for (size_t i = 0; i < vTx.size(); i++) {
+        BOOST_CHECK(vDelta[i].fAdded);
+        BOOST_CHECK(vDelta[i].txid == vTx[i].GetHash());
+        BOOST_CHECK_EQUAL(vDelta[i].nTime, 100 - (int64_t)i);
+        BOOST_CHECK_EQUAL(vDelta[i].nValueOut, 10000LL);
+    }
+    BOOST_CHECK(!vDelta[3].fAdded);
+    BOOST_CHECK(vDelta[3].txid == vTx[1].GetHash());
+    BOOST_CHECK(vDelta[3].reason == MemPoolRemovalReason::CONFLICT);
+    BOOST_CHECK_EQUAL(vDelta[3].nSequence, nSequence);
+    BOOST_CHECK_EQUAL(nSequence, pool.GetDeltaSequence());
+
+    // Subscribers that fall too far behind have to start over
+    uint64_t nSequenceOld = nSequence;
+    for (size_t i = 0; i < MAX_MEMPOOL_DELTAS; i++) {
+        pool.addUnchecked(vTx[1].GetHash(), entry.FromTx(vTx[1]));
+        pool.removeRecursive(vTx[1], MemPoolRemovalReason::CONFLICT);
+    }
+    BOOST_CHECK(!pool.GetDeltas(nSequenceOld, vDelta, nSequence));
+    BOOST_CHECK(pool.GetDeltas(nSequence - 1, vDelta, nSequence));
+    BOOST_CHECK_EQUAL(vDelta.size(), 1U);
+
+    // As do those of a cleared pool
+    pool.clear();
+    BOOST_CHECK(!pool.GetDeltas(nSequence, vDelta, nSequence));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,477 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <opreturnindex.h>
+#include <script/script.h>
+#include <script/sign.h>
+#include <txdb.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <test/test_drivenet.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(opreturnindex_tests)
+
+static CMutableTransaction CreateOPReturnTx(const CTransaction& txPrev, const CKey& key, const CAmount& fee, const std::string& strPayload = "news")
+{
+    CMutableTransaction mtx;
+    mtx.nVersion = 1;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint(txPrev.GetHash(), 0);
+    mtx.vout.resize(2);
+    mtx.vout[0].nValue = txPrev.vout[0].nValue - fee;
+    mtx.vout[0].scriptPubKey = txPrev.vout[0].scriptPubKey;
+    mtx.vout[1].nValue = 0;
+    mtx.vout[1].scriptPubKey = CScript() << OP_RETURN << std::vector<unsigned char>(strPayload.begin(), strPayload.end());
+
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(txPrev.vout[0].scriptPubKey, mtx, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    mtx.vin[0].scriptSig << vchSig;
+
+    return mtx;
+}
+
+static void CheckBlockData(const CBlock& block, const CMutableTransaction& mtx, const CAmount& fee)
+{
+    std::vector<OPReturnData> vData;
+    BOOST_REQUIRE(popreturndb->GetBlockData(block.GetHash(), vData));
+
+    // The coinbase may carry OP_RETURN commitments too
+    bool fFound = false;
+    for (const OPReturnData& data : vData) {
+        if (data.txid != mtx.GetHash())
+            continue;
+        fFound = true;
+        BOOST_CHECK(data.script == mtx.vout[1].scriptPubKey);
+        BOOST_CHECK_EQUAL(data.fees, fee);
+        BOOST_CHECK_EQUAL(data.nSize, ::GetSerializeSize(mtx, SER_DISK, CLIENT_VERSION));
+    }
+    BOOST_CHECK(fFound);
+}
+
+static void WaitForIndexSync()
+{
+    int64_t nTimeStart = GetTimeMillis();
+    while (!g_opreturn_index->BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(GetTimeMillis() - nTimeStart < 10000);
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(opreturnindex_initial_sync, TestChain100Setup)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // Connected before the index exists: nothing is written
+    CMutableTransaction mtx = CreateOPReturnTx(coinbaseTxns[0], coinbaseKey, 1000);
+    CBlock block = CreateAndProcessBlock({mtx}, scriptPubKey);
+    BOOST_CHECK(!popreturndb->HaveBlockData(block.GetHash()));
+
+    g_opreturn_index.reset(new OPReturnIndex());
+    BOOST_CHECK(!g_opreturn_index->BlockUntilSyncedToCurrentChain());
+    g_opreturn_index->Start();
+
+    // Catching up takes the fees from the undo data
+    WaitForIndexSync();
+    CheckBlockData(block, mtx, 1000);
+
+    // Once synced new blocks come in through notifications, with the fees
+    // ConnectBlock computed
+    CMutableTransaction mtx2 = CreateOPReturnTx(coinbaseTxns[1], coinbaseKey, 2000);
+    CBlock block2 = CreateAndProcessBlock({mtx2}, scriptPubKey);
+    BOOST_CHECK(g_opreturn_index->BlockUntilSyncedToCurrentChain());
+    CheckBlockData(block2, mtx2, 2000);
+
+    // Both news are in the news index, highest fee first
+    CScript header(mtx.vout[1].scriptPubKey.begin() + 1, mtx.vout[1].scriptPubKey.begin() + 1 + NEWS_HEADER_SIZE);
+    std::vector<OPReturnNews> vNews;
+    BOOST_CHECK(popreturndb->GetTopNews(header, 0, 10, vNews));
+    BOOST_REQUIRE_EQUAL(vNews.size(), 2U);
+    BOOST_CHECK(vNews[0].txid == mtx2.GetHash());
+    BOOST_CHECK_EQUAL(vNews[0].n, 1U);
+    BOOST_CHECK_EQUAL(vNews[0].fees, 2000);
+    BOOST_CHECK_EQUAL(vNews[0].nTime, block2.GetBlockTime());
+    BOOST_CHECK(vNews[1].txid == mtx.GetHash());
+
+    // Disconnecting the block removes its data
+    {
+        CValidationState state;
+        CBlockIndex* pindex;
+        {
+            LOCK(cs_main);
+            pindex = chainActive.Tip();
+        }
+        BOOST_CHECK(InvalidateBlock(state, Params(), pindex));
+        BOOST_CHECK(ActivateBestChain(state, Params()));
+    }
+    BOOST_CHECK(g_opreturn_index->BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!popreturndb->HaveBlockData(block2.GetHash()));
+    CheckBlockData(block, mtx, 1000);
+    BOOST_CHECK(popreturndb->GetTopNews(header, 0, 10, vNews));
+    BOOST_REQUIRE_EQUAL(vNews.size(), 1U);
+    BOOST_CHECK(vNews[0].txid == mtx.GetHash());
+
+    // The locator written with the chain state lets a new instance resume
+    FlushStateToDisk();
+    SyncWithValidationInterfaceQueue();
+    CBlockLocator locator;
+    BOOST_CHECK(popreturndb->ReadBestBlock(locator));
+    BOOST_CHECK(locator.vHave.front() == block.GetHash());
+
+    g_opreturn_index->Interrupt();
+    g_opreturn_index->Stop();
+    g_opreturn_index.reset();
+}
+
+BOOST_FIXTURE_TEST_CASE(opreturnindex_rebuild, TestChain100Setup)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction mtx = CreateOPReturnTx(coinbaseTxns[0], coinbaseKey, 1000);
+    CBlock block = CreateAndProcessBlock({mtx}, scriptPubKey);
+
+    NewsType type;
+    type.header = CScript(mtx.vout[1].scriptPubKey.begin() + 1, mtx.vout[1].scriptPubKey.end());
+    type.title = "news";
+    type.nDays = 1;
+    popreturndb->WriteNewsType(type);
+
+    g_opreturn_index.reset(new OPReturnIndex());
+    g_opreturn_index->Start();
+    WaitForIndexSync();
+    CheckBlockData(block, mtx, 1000);
+
+    OPReturnIndexSummary summary = g_opreturn_index->GetSummary();
+    BOOST_CHECK(summary.fSynced);
+    BOOST_CHECK_EQUAL(summary.nBestHeight, chainActive.Height());
+    BOOST_CHECK_EQUAL(summary.progress, 1.0);
+    BOOST_CHECK_EQUAL(summary.nETA, 0);
+
+    // Data left behind by a block that isn't in the chain is wiped
+    uint256 hashStale = InsecureRand256();
+    OPReturnData data;
+    data.txid = InsecureRand256();
+    data.script = mtx.vout[1].scriptPubKey;
+    data.nSize = 100;
+    data.fees = 1;
+    BOOST_CHECK(popreturndb->WriteBlockData(hashStale, {data}, {}, {}));
+
+    BOOST_CHECK(g_opreturn_index->Rebuild());
+    BOOST_CHECK(!popreturndb->HaveBlockData(hashStale));
+
+    // The chain is indexed again, and the news types are kept
+    WaitForIndexSync();
+    CheckBlockData(block, mtx, 1000);
+
+    std::vector<NewsType> vType;
+    popreturndb->GetNewsTypes(vType);
+    BOOST_REQUIRE_EQUAL(vType.size(), 1U);
+    BOOST_CHECK(vType[0].header == type.header);
+
+    g_opreturn_index->Interrupt();
+    g_opreturn_index->Stop();
+    g_opreturn_index.reset();
+}
+
+static OPReturnNews CreateNews(const std::string& strHeader, int64_t nTime, const CAmount& fees)
+{
+    OPReturnNews news;
+    news.txid = InsecureRand256();
+    news.n = 0;
+    news.fees = fees;
+    news.nTime = nTime;
+    news.nHeight = 1;
+    news.script = CScript() << OP_RETURN;
+    news.script.insert(news.script.end(), strHeader.begin(), strHeader.end());
+    return news;
+}
+
+static OPReturnData CreateData(const uint256& txid, const std::string& strPayload, const CAmount& fees)
+{
+    OPReturnData data;
+    data.txid = txid;
+    data.script = CScript() << OP_RETURN;
+    data.script.insert(data.script.end(), strPayload.begin(), strPayload.end());
+    data.nSize = 250;
+    data.fees = fees;
+    return data;
+}
+
+static CScript CreateHeader(const std::string& str)
+{
+    CScript header;
+    header.insert(header.end(), str.begin(), str.end());
+    return header;
+}
+
+static bool DataEqual(const std::vector<OPReturnData>& a, const std::vector<OPReturnData>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].txid != b[i].txid || a[i].script != b[i].script)
+            return false;
+        if (a[i].nSize != b[i].nSize || a[i].fees != b[i].fees)
+            return false;
+    }
+    return true;
+}
+
+BOOST_FIXTURE_TEST_CASE(opreturndb_block_columns, TestingSetup)
+{
+    uint256 txid1 = InsecureRand256();
+    uint256 txid2 = InsecureRand256();
+    uint256 txid3 = InsecureRand256();
+
+    // A transaction with two outputs, a repeated payload, payloads shorter
+    // and longer than the prefix kept with the columns
+    std::vector<OPReturnData> vData;
+    vData.push_back(CreateData(txid1, "aaaa first", 1000));
+    vData.push_back(CreateData(txid1, "bbbb", 1000));
+    vData.push_back(CreateData(txid2, "aaaa first", 0));
+    vData.push_back(CreateData(txid3, "aa", 5000000000));
+    vData.push_back(CreateData(txid3, "aaaa second payload", 5000000000));
+
+    // Enough payloads with one header for them to be stored together
+    std::vector<OPReturnData> vGroup;
+    for (int i = 0; i < 20; i++)
+        vGroup.push_back(CreateData(InsecureRand256(), "gggg " + std::to_string(i), i));
+    vData.insert(vData.end(), vGroup.begin(), vGroup.end());
+
+    uint256 hashBlock = InsecureRand256();
+    BOOST_CHECK(popreturndb->WriteBlockData(hashBlock, vData, {}, {}));
+    BOOST_CHECK(popreturndb->HaveBlockData(hashBlock));
+
+    std::vector<OPReturnData> vRead;
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, vRead));
+    BOOST_CHECK(DataEqual(vRead, vData));
+
+    // Reads by header, in block order
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("aaaa"), vRead));
+    BOOST_CHECK(DataEqual(vRead, {vData[0], vData[2], vData[4]}));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("aaaa second"), vRead));
+    BOOST_CHECK(DataEqual(vRead, {vData[4]}));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("aaa"), vRead));
+    BOOST_CHECK(DataEqual(vRead, {vData[0], vData[2], vData[4]}));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("aa"), vRead));
+    BOOST_CHECK(DataEqual(vRead, {vData[0], vData[2], vData[3], vData[4]}));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("gggg"), vRead));
+    BOOST_CHECK(DataEqual(vRead, vGroup));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("gggg 1"), vRead));
+    BOOST_CHECK(DataEqual(vRead, {vGroup[1], vGroup[10], vGroup[11], vGroup[12], vGroup[13],
+                vGroup[14], vGroup[15], vGroup[16], vGroup[17], vGroup[18], vGroup[19]}));
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CreateHeader("cccc"), vRead));
+    BOOST_CHECK(vRead.empty());
+
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock, CScript(), vRead));
+    BOOST_CHECK(DataEqual(vRead, vData));
+
+    // Erasing the block doesn't affect the payloads of other blocks
+    uint256 hashBlock2 = InsecureRand256();
+    std::vector<OPReturnData> vData2 = {CreateData(txid2, "cccc", 1)};
+    BOOST_CHECK(popreturndb->WriteBlockData(hashBlock2, vData2, {}, {}));
+    BOOST_CHECK(popreturndb->EraseBlockData(hashBlock, {}, {}));
+    BOOST_CHECK(!popreturndb->HaveBlockData(hashBlock));
+    BOOST_CHECK(!popreturndb->GetBlockData(hashBlock, vRead));
+    BOOST_CHECK(popreturndb->GetBlockData(hashBlock2, vRead));
+    BOOST_CHECK(DataEqual(vRead, vData2));
+}
+
+BOOST_FIXTURE_TEST_CASE(opreturndb_top_news, TestingSetup)
+{
+    const int64_t nDay = NEWS_INDEX_BUCKET;
+    const int64_t nTimeBegin = 1000 * nDay;
+
+    // Three days of news for header "aaaa", one for "aaab"
+    std::vector<OPReturnNews> vNews = {
+        CreateNews("aaaa", nTimeBegin - 1, 9000),
+        CreateNews("aaaa", nTimeBegin, 100),
+        CreateNews("aaaa", nTimeBegin + 10, 300),
+        CreateNews("aaaa", nTimeBegin + 20, 200),
+        CreateNews("aaaa", nTimeBegin + nDay, 50),
+        CreateNews("aaaa", nTimeBegin + nDay + 1, 500),
+        CreateNews("aaaa", nTimeBegin + 2 * nDay, 1000),
+        CreateNews("aaab", nTimeBegin, 5000),
+    };
+    BOOST_CHECK(popreturndb->WriteBlockData(uint256(), {}, vNews, {}));
+
+    std::vector<OPReturnNews> vTop;
+    const std::vector<unsigned char> vHeader = {'a', 'a', 'a', 'a'};
+    CScript header(vHeader.begin(), vHeader.end());
+    BOOST_CHECK(popreturndb->GetTopNews(header, nTimeBegin, 100, vTop));
+    BOOST_REQUIRE_EQUAL(vTop.size(), 6U);
+    std::vector<CAmount> vFee;
+    for (const OPReturnNews& news : vTop)
+        vFee.push_back(news.fees);
+    BOOST_CHECK(vFee == std::vector<CAmount>({1000, 500, 300, 200, 100, 50}));
+    BOOST_CHECK(vTop[0].txid == vNews[6].txid);
+    BOOST_CHECK(vTop[0].script == vNews[6].script);
+    BOOST_CHECK_EQUAL(vTop[0].nTime, vNews[6].nTime);
+
+    // Only the top two of each day are read
+    BOOST_CHECK(popreturndb->GetTopNews(header, nTimeBegin, 2, vTop));
+    BOOST_REQUIRE_EQUAL(vTop.size(), 2U);
+    BOOST_CHECK_EQUAL(vTop[0].fees, 1000);
+    BOOST_CHECK_EQUAL(vTop[1].fees, 500);
+
+    // The period can start within a day
+    BOOST_CHECK(popreturndb->GetTopNews(header, nTimeBegin + 15, 100, vTop));
+    BOOST_CHECK_EQUAL(vTop.size(), 4U);
+
+    // Erasing removes the news from the index
+    BOOST_CHECK(popreturndb->EraseBlockData(uint256(), {vNews[6]}, {}));
+    BOOST_CHECK(popreturndb->GetTopNews(header, nTimeBegin, 1, vTop));
+    BOOST_REQUIRE_EQUAL(vTop.size(), 1U);
+    BOOST_CHECK_EQUAL(vTop[0].fees, 500);
+
+    // Headers that are too short can't be looked up
+    BOOST_CHECK(!popreturndb->GetTopNews(CScript() << OP_RETURN, 0, 1, vTop));
+}
+
+BOOST_AUTO_TEST_CASE(opreturn_search_words)
+{
+    // Words are lowercase runs of letters and digits, short ones are left out
+    CScript script = CScript() << OP_RETURN << std::vector<unsigned char>{'H', 'e', 'l', 'l', 'o', ',', ' ', 'W', 'o', 'r', 'l', 'd', ' ', 'o', 'f', ' ', '2', '0', '2', '2', '!'};
+    std::vector<std::string> vWord = GetOPReturnSearchWords(script);
+    BOOST_REQUIRE_EQUAL(vWord.size(), 3U);
+    BOOST_CHECK_EQUAL(vWord[0], "hello");
+    BOOST_CHECK_EQUAL(vWord[1], "world");
+    BOOST_CHECK_EQUAL(vWord[2], "2022");
+
+    // Each push is split on its own, and words are only listed once
+    script = CScript() << OP_RETURN << std::vector<unsigned char>{'a', 'b', 'c'} << std::vector<unsigned char>{'d', 'e', 'f'} << std::vector<unsigned char>{'A', 'B', 'C'};
+    vWord = GetOPReturnSearchWords(script);
+    BOOST_REQUIRE_EQUAL(vWord.size(), 2U);
+    BOOST_CHECK_EQUAL(vWord[0], "abc");
+    BOOST_CHECK_EQUAL(vWord[1], "def");
+
+    // Data that doesn't parse as pushes is split as raw bytes
+    script = CScript() << OP_RETURN;
+    std::string strRaw = "raw text";
+    script.insert(script.end(), strRaw.begin(), strRaw.end());
+    vWord = GetOPReturnSearchWords(script);
+    BOOST_REQUIRE_EQUAL(vWord.size(), 2U);
+    BOOST_CHECK_EQUAL(vWord[0], "raw");
+    BOOST_CHECK_EQUAL(vWord[1], "text");
+
+    // Long words are truncated, and the number of words is limited
+    std::string strLong(OPRETURN_SEARCH_MAX_WORD + 10, 'x');
+    script = CScript() << OP_RETURN << std::vector<unsigned char>(strLong.begin(), strLong.end());
+    vWord = GetOPReturnSearchWords(script);
+    BOOST_REQUIRE_EQUAL(vWord.size(), 1U);
+    BOOST_CHECK_EQUAL(vWord[0].size(), OPRETURN_SEARCH_MAX_WORD);
+
+    std::string strMany;
+    for (size_t i = 0; i < OPRETURN_SEARCH_MAX_WORDS * 2; i++)
+        strMany += strprintf("w%03u ", i);
+    script = CScript() << OP_RETURN << std::vector<unsigned char>(strMany.begin(), strMany.end());
+    BOOST_CHECK_EQUAL(GetOPReturnSearchWords(script).size(), OPRETURN_SEARCH_MAX_WORDS);
+
+    // Without OP_RETURN there is nothing to index
+    BOOST_CHECK(GetOPReturnSearchWords(CScript() << std::vector<unsigned char>{'a', 'b', 'c'}).empty());
+
+    // Query words may be short, they are matched as prefixes
+    std::vector<std::string> vQuery = ParseOPReturnSearchQuery("  Bitcoin, to the MOON bitcoin ");
+    BOOST_REQUIRE_EQUAL(vQuery.size(), 4U);
+    BOOST_CHECK_EQUAL(vQuery[0], "bitcoin");
+    BOOST_CHECK_EQUAL(vQuery[1], "to");
+    BOOST_CHECK_EQUAL(vQuery[2], "the");
+    BOOST_CHECK_EQUAL(vQuery[3], "moon");
+    BOOST_CHECK(ParseOPReturnSearchQuery(" ,.! ").empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(opreturnindex_search, TestChain100Setup)
+{
+    gArgs.ForceSetArg("-opreturnsearch", "1");
+
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction mtx = CreateOPReturnTx(coinbaseTxns[0], coinbaseKey, 1000, "Drivechain news");
+    CBlock block = CreateAndProcessBlock({mtx}, scriptPubKey);
+
+    g_opreturn_index.reset(new OPReturnIndex());
+    BOOST_CHECK(g_opreturn_index->IsSearchEnabled());
+    g_opreturn_index->Start();
+    WaitForIndexSync();
+    BOOST_CHECK(popreturndb->HaveSearchIndex());
+
+    // Blocks connected after the sync are indexed too
+    CMutableTransaction mtx2 = CreateOPReturnTx(coinbaseTxns[1], coinbaseKey, 2000, "Sidechain news");
+    CBlock block2 = CreateAndProcessBlock({mtx2}, scriptPubKey);
+    BOOST_CHECK(g_opreturn_index->BlockUntilSyncedToCurrentChain());
+
+    // A prefix finds both, newest first
+    std::vector<OPReturnSearchEntry> vResult;
+    BOOST_CHECK(SearchOPReturn("NEW", 10, vResult));
+    BOOST_REQUIRE_EQUAL(vResult.size(), 2U);
+    BOOST_CHECK(vResult[0].txid == mtx2.GetHash());
+    BOOST_CHECK(vResult[0].hashBlock == block2.GetHash());
+    BOOST_CHECK_EQUAL(vResult[0].fees, 2000);
+    BOOST_CHECK_EQUAL(vResult[0].nTime, block2.GetBlockTime());
+    BOOST_CHECK(vResult[0].script == mtx2.vout[1].scriptPubKey);
+    BOOST_CHECK(vResult[1].txid == mtx.GetHash());
+
+    BOOST_CHECK(SearchOPReturn("news", 1, vResult));
+    BOOST_REQUIRE_EQUAL(vResult.size(), 1U);
+    BOOST_CHECK(vResult[0].txid == mtx2.GetHash());
+
+    // Every word of the query has to match
+    BOOST_CHECK(SearchOPReturn("news drive", 10, vResult));
+    BOOST_REQUIRE_EQUAL(vResult.size(), 1U);
+    BOOST_CHECK(vResult[0].txid == mtx.GetHash());
+
+    BOOST_CHECK(SearchOPReturn("newspaper", 10, vResult));
+    BOOST_CHECK(vResult.empty());
+
+    // A query without a word long enough to look up can't be searched
+    BOOST_CHECK(!SearchOPReturn("ne", 10, vResult));
+
+    // Disconnecting the block removes its words
+    {
+        CValidationState state;
+        CBlockIndex* pindex;
+        {
+            LOCK(cs_main);
+            pindex = chainActive.Tip();
+        }
+        BOOST_CHECK(InvalidateBlock(state, Params(), pindex));
+        BOOST_CHECK(ActivateBestChain(state, Params()));
+    }
+    BOOST_CHECK(g_opreturn_index->BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(SearchOPReturn("sidechain", 10, vResult));
+    BOOST_CHECK(vResult.empty());
+    std::vector<OPReturnSearchEntry> vEntry;
+    BOOST_CHECK(popreturndb->SearchWords("sidechain", 10, vEntry));
+    BOOST_CHECK(vEntry.empty());
+
+    g_opreturn_index->Interrupt();
+    g_opreturn_index->Stop();
+    g_opreturn_index.reset();
+
+    // Turning the search off wipes the words on the next start
+    gArgs.ForceSetArg("-opreturnsearch", "0");
+    g_opreturn_index.reset(new OPReturnIndex());
+    g_opreturn_index->Start();
+    WaitForIndexSync();
+    BOOST_CHECK(!popreturndb->HaveSearchIndex());
+    BOOST_CHECK(popreturndb->SearchWords("drivechain", 10, vEntry));
+    BOOST_CHECK(vEntry.empty());
+    CheckBlockData(block, mtx, 1000);
+
+    g_opreturn_index->Interrupt();
+    g_opreturn_index->Stop();
+    g_opreturn_index.reset();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,16 +4,23 @@
 
 #include <rpc/server.h>
 #include <rpc/client.h>
+#include <rpc/jsonstream.h>
+#include <rpc/stats.h>
 
 #include <base58.h>
 #include <core_io.h>
 #include <netbase.h>
+#include <txdb.h>
+#include <validation.h>
 
 #include <test/test_drivenet.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <future>
+#include <thread>
+
 #include <univalue.h>
 
 UniValue CallRPC(std::string args)
@@ -345,4 +352,164 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
     BOOST_CHECK_EQUAL(result[2].get_int(), 9);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_json_stream)
+{
+    // Structure written through the stream is identical to UniValue output
+    UniValue inner(UniValue::VARR);
+    inner.push_back(1);
+    inner.push_back("two\"\n");
+    inner.push_back(UniValue(UniValue::VOBJ));
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKV("a", inner);
+    expected.pushKV("b\\", NullUniValue);
+    expected.pushKV("c", UniValue(UniValue::VARR));
+
+    std::string strOut;
+    int nChunks = 0;
+    JSONStreamWriter stream([&strOut, &nChunks](const std::string& strChunk) {
+        strOut += strChunk;
+        nChunks++;
+        return true;
+    }, 4);
+    stream.BeginObject();
+    stream.Key("a");
+    stream.BeginArray();
+    stream.Value(1);
+    stream.MaybeFlush();
+    stream.Value("two\"\n");
+    stream.Value(UniValue(UniValue::VOBJ));
+    stream.EndArray();
+    stream.MaybeFlush();
+    stream.PushKV("b\\", NullUniValue);
+    stream.Key("c");
+    stream.BeginArray();
+    stream.EndArray();
+    stream.EndObject();
+    BOOST_CHECK(stream.IsComplete());
+    stream.Flush();
+    BOOST_CHECK_EQUAL(strOut, expected.write());
+    BOOST_CHECK_EQUAL(nChunks, 3);
+
+    // A sink that fails aborts the writer
+    JSONStreamWriter failStream([](const std::string&) { return false; }, 1);
+    failStream.BeginArray();
+    BOOST_CHECK_THROW(failStream.MaybeFlush(), std::runtime_error);
+
+    // Streamed getblock matches the regular result
+    std::string strHash;
+    {
+        LOCK(cs_main);
+        strHash = chainActive.Tip()->GetBlockHash().GetHex();
+    }
+    UniValue result = CallRPC("getblock " + strHash + " 2");
+    std::string strBlock;
+    JSONStreamWriter blockStream([&strBlock](const std::string& strChunk) {
+        strBlock += strChunk;
+        return true;
+    }, 16);
+    JSONRPCRequest request;
+    request.strMethod = "getblock";
+    request.params = RPCConvertValues("getblock", {strHash, "2"});
+    request.stream = &blockStream;
+    BOOST_CHECK(tableRPC["getblock"]->actor(request).isNull());
+    blockStream.Flush();
+    BOOST_CHECK_EQUAL(strBlock, result.write());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_stats)
+{
+    // Bucket limits are inclusive, anything slower than the last one overflows
+    LatencyHistogram hist;
+    hist.Add(0);
+    hist.Add(100);
+    hist.Add(101);
+    hist.Add(20000000);
+    BOOST_CHECK_EQUAL(hist.nCount, 4U);
+    BOOST_CHECK_EQUAL(hist.nTotalMicros, 20000201);
+    BOOST_CHECK_EQUAL(hist.vBuckets[0], 2U);
+    BOOST_CHECK_EQUAL(hist.vBuckets[1], 1U);
+    BOOST_CHECK_EQUAL(hist.vBuckets[LatencyHistogram::NUM_BUCKETS - 1], 1U);
+
+    g_rpc_stats.Reset();
+    g_rpc_stats.RecordQueue("getblockcount", 50);
+    g_rpc_stats.RecordExec("getblockcount", 300, 20, false);
+    g_rpc_stats.RecordReply("getblockcount", 10, 42);
+    g_rpc_stats.RecordExec("getblockcount", 7000, 0, true);
+
+    UniValue result = CallRPC("getrpcstats");
+    const UniValue& method = find_value(find_value(result, "methods"), "getblockcount");
+    BOOST_CHECK_EQUAL(find_value(method, "calls").get_int(), 2);
+    BOOST_CHECK_EQUAL(find_value(method, "errors").get_int(), 1);
+    BOOST_CHECK_EQUAL(find_value(method, "bytes_out").get_int(), 42);
+    BOOST_CHECK_EQUAL(find_value(method, "cs_main_wait_us").get_int(), 20);
+    const UniValue& exec = find_value(method, "exec");
+    BOOST_CHECK_EQUAL(find_value(exec, "count").get_int(), 2);
+    BOOST_CHECK_EQUAL(find_value(exec, "total_us").get_int(), 7300);
+    BOOST_CHECK_EQUAL(find_value(exec, "buckets").size(), LatencyHistogram::NUM_BUCKETS);
+    BOOST_CHECK_EQUAL(find_value(find_value(method, "queue"), "count").get_int(), 1);
+
+    std::string strMetrics = RPCStatsToPrometheus();
+    BOOST_CHECK(strMetrics.find("drivenet_rpc_calls_total{method=\"getblockcount\"} 2\n") != std::string::npos);
+    BOOST_CHECK(strMetrics.find("drivenet_rpc_exec_seconds_bucket{method=\"getblockcount\",le=\"0.000500\"} 1\n") != std::string::npos);
+    BOOST_CHECK(strMetrics.find("drivenet_rpc_exec_seconds_bucket{method=\"getblockcount\",le=\"+Inf\"} 2\n") != std::string::npos);
+    BOOST_CHECK(strMetrics.find("drivenet_rpc_exec_seconds_sum{method=\"getblockcount\"} 0.007300\n") != std::string::npos);
+
+    // Reading with reset clears the per-method counters
+    CallRPC("getrpcstats true");
+    BOOST_CHECK(find_value(CallRPC("getrpcstats"), "methods").empty());
+
+    // Waiting for cs_main held by another thread is accounted to this thread
+    uint64_t nContendedBefore, nContendedAfter;
+    int64_t nWaitBefore, nWaitAfter;
+    GetMainLockContention(nContendedBefore, nWaitBefore);
+    int64_t nThreadWaitBefore = GetThreadMainLockWait();
+    std::promise<void> locked;
+    std::thread holder([&locked] {
+        LOCK(cs_main);
+        locked.set_value();
+        MilliSleep(20);
+    });
+    locked.get_future().wait();
+    {
+        LOCK(cs_main);
+    }
+    holder.join();
+    GetMainLockContention(nContendedAfter, nWaitAfter);
+    BOOST_CHECK(nContendedAfter > nContendedBefore);
+    BOOST_CHECK(nWaitAfter > nWaitBefore);
+    BOOST_CHECK(GetThreadMainLockWait() > nThreadWaitBefore);
+}
+
+BOOST_FIXTURE_TEST_CASE(rpc_getblockstats, TestChain100Setup)
+{
+    // Percentiles are weighted: the heavy transaction covers most of them
+    BlockStats stats;
+    stats.SetFeeRatePercentiles({{50, 400}, {10, 400}, {20, 3000}});
+    BOOST_REQUIRE_EQUAL(stats.vFeeRatePercentiles.size(), BlockStats::NUM_FEERATE_PERCENTILES);
+    BOOST_CHECK_EQUAL(stats.vFeeRatePercentiles[0], 10);
+    BOOST_CHECK_EQUAL(stats.vFeeRatePercentiles[1], 20);
+    BOOST_CHECK_EQUAL(stats.vFeeRatePercentiles[2], 20);
+    BOOST_CHECK_EQUAL(stats.vFeeRatePercentiles[3], 20);
+    BOOST_CHECK_EQUAL(stats.vFeeRatePercentiles[4], 50);
+
+    // Statistics were recorded while the test chain was connected
+    int nHeight = chainActive.Height();
+    BOOST_REQUIRE(pblockstatsdb->ReadBlockStats(chainActive.Tip()->GetBlockHash(), stats));
+    BOOST_CHECK_EQUAL(stats.nHeight, nHeight);
+    BOOST_CHECK_EQUAL(stats.nTx, 1U);
+    BOOST_CHECK_EQUAL(stats.totalFees, 0);
+
+    UniValue result = CallRPC("getblockstats " + std::to_string(nHeight - 9) + " 10 true");
+    BOOST_CHECK_EQUAL(find_value(result, "endheight").get_int(), nHeight);
+    BOOST_CHECK_EQUAL(find_value(result, "txs").get_int(), 10);
+    BOOST_CHECK_EQUAL(find_value(result, "blockstats").size(), 10U);
+    BOOST_CHECK_EQUAL(find_value(find_value(result, "blockstats")[9], "hash").get_str(), chainActive.Tip()->GetBlockHash().GetHex());
+
+    BOOST_CHECK_THROW(CallRPC("getblockstats " + std::to_string(nHeight) + " 2"), std::runtime_error);
+    BOOST_CHECK_THROW(CallRPC("getblockstats -1"), std::runtime_error);
+
+    // getaveragefee is answered from the same statistics
+    BOOST_CHECK_EQUAL(find_value(CallRPC("getaveragefee 6"), "feeaverage").get_real(), 0.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
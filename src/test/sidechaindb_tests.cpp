@@ -7,11 +7,15 @@
 #include "core_io.h"
 #include "miner.h"
 #include "random.h"
+#include "rpc/blockchain.h"
+#include "rpc/client.h"
+#include "rpc/server.h"
 #include "script/script.h"
 #include "script/standard.h"
 #include "script/sigcache.h"
 #include "sidechain.h"
 #include "sidechaindb.h"
+#include "txdb.h"
 #include "uint256.h"
 #include "utilstrencodings.h"
 #include "validation.h"
@@ -20,6 +24,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <univalue.h>
+
 CScript EncodeWithdrawalFees(const CAmount& amount)
 {
     CDataStream s(SER_NETWORK, PROTOCOL_VERSION);
@@ -1678,4 +1684,219 @@ BOOST_AUTO_TEST_CASE(txn_to_deposit)
     BOOST_CHECK(scdbTest.TxnToDeposit(mtx, 0, {}, deposit));
 }
 
+BOOST_AUTO_TEST_CASE(sidechaindb_wait_rpc)
+{
+    // The RPC server is not running in unit tests, so the long-poll RPCs
+    // return right away with whatever they would have waited for.
+    auto CallWaitRPC = [](const std::string& strMethod, const std::vector<std::string>& vArgs) {
+        JSONRPCRequest request;
+        request.strMethod = strMethod;
+        request.params = RPCConvertValues(strMethod, vArgs);
+        return tableRPC[strMethod]->actor(request);
+    };
+
+    scdb.Reset();
+    RPCNotifySidechainChange(false, chainActive.Tip());
+
+    UniValue result = CallWaitRPC("waitforsidechainevent", {});
+    int64_t nSequence = find_value(result, "sequence").get_int64();
+    BOOST_CHECK(find_value(result, "changed").empty());
+
+    // Changes are picked up when the tip notification arrives
+    BOOST_CHECK(ActivateTestSidechain(scdb));
+    result = CallWaitRPC("waitforsidechainevent", {std::to_string(nSequence)});
+    BOOST_CHECK_EQUAL(find_value(result, "sequence").get_int64(), nSequence);
+
+    RPCNotifySidechainChange(false, chainActive.Tip());
+    result = CallWaitRPC("waitforsidechainevent", {std::to_string(nSequence)});
+    BOOST_CHECK_EQUAL(find_value(result, "sequence").get_int64(), nSequence + 1);
+    const UniValue& changed = find_value(result, "changed");
+    BOOST_REQUIRE_EQUAL(changed.size(), 1U);
+    BOOST_CHECK_EQUAL(changed[0].get_str(), "sidechain");
+
+    // Nothing new since the latest sequence number
+    result = CallWaitRPC("waitforsidechainevent", {std::to_string(nSequence + 1)});
+    BOOST_CHECK(find_value(result, "changed").empty());
+
+    // The sidechain has no CTIP yet
+    result = CallWaitRPC("waitforctipchange", {"0", ""});
+    BOOST_CHECK(!find_value(result, "changed").get_bool());
+    BOOST_CHECK(find_value(result, "txid").isNull());
+
+    result = CallWaitRPC("waitforctipchange", {"0", GetRandHash().GetHex() + ":0"});
+    BOOST_CHECK(find_value(result, "changed").get_bool());
+
+    BOOST_CHECK_THROW(CallWaitRPC("waitforctipchange", {"0", "nonsense"}), UniValue);
+
+    scdb.Reset();
+    RPCNotifySidechainChange(false, chainActive.Tip());
+}
+
+BOOST_AUTO_TEST_CASE(sidechaindb_paginate_rpc)
+{
+    auto CallPageRPC = [](const std::string& strMethod, const std::vector<std::string>& vArgs) {
+        JSONRPCRequest request;
+        request.strMethod = strMethod;
+        request.params = RPCConvertValues(strMethod, vArgs);
+        return tableRPC[strMethod]->actor(request);
+    };
+
+    scdb.Reset();
+    BOOST_CHECK(ActivateTestSidechain(scdb));
+
+    // Spent withdrawals in three blocks, failed withdrawals with random hashes
+    std::vector<SidechainSpentWithdrawal> vSpent;
+    std::vector<SidechainFailedWithdrawal> vFailed;
+    for (int i = 0; i < 3; i++) {
+        uint256 hashBlock = GetRandHash();
+        for (int j = 0; j < 3; j++) {
+            SidechainSpentWithdrawal spent;
+            spent.nSidechain = 0;
+            spent.hash = GetRandHash();
+            spent.hashBlock = hashBlock;
+            vSpent.push_back(spent);
+        }
+        SidechainFailedWithdrawal failed;
+        failed.nSidechain = 0;
+        failed.hash = GetRandHash();
+        vFailed.push_back(failed);
+    }
+    scdb.AddSpentWithdrawals(vSpent);
+    scdb.AddFailedWithdrawals(vFailed);
+
+    // Walking the pages returns every entry once, in cache order
+    std::vector<std::string> vHash;
+    std::string strCursor = "";
+    int nPages = 0;
+    do {
+        UniValue result = CallPageRPC("listspentwithdrawals", {"2", strCursor});
+        for (const UniValue& obj : find_value(result, "results").getValues())
+            vHash.push_back(find_value(obj, "hash").get_str());
+        const UniValue& cursor = find_value(result, "cursor");
+        strCursor = cursor.isNull() ? "" : cursor.get_str();
+        nPages++;
+    } while (!strCursor.empty());
+
+    BOOST_CHECK_EQUAL(nPages, 5);
+    std::vector<SidechainSpentWithdrawal> vSpentCache = scdb.GetSpentWithdrawalCache();
+    BOOST_REQUIRE_EQUAL(vHash.size(), vSpentCache.size());
+    for (size_t i = 0; i < vHash.size(); i++)
+        BOOST_CHECK_EQUAL(vHash[i], vSpentCache[i].hash.ToString());
+
+    vHash.clear();
+    nPages = 0;
+    do {
+        UniValue result = CallPageRPC("listfailedwithdrawals", {"2", strCursor});
+        for (const UniValue& obj : find_value(result, "results").getValues())
+            vHash.push_back(find_value(obj, "hash").get_str());
+        const UniValue& cursor = find_value(result, "cursor");
+        strCursor = cursor.isNull() ? "" : cursor.get_str();
+        nPages++;
+    } while (!strCursor.empty());
+
+    BOOST_CHECK_EQUAL(nPages, 2);
+    std::vector<SidechainFailedWithdrawal> vFailedCache = scdb.GetFailedWithdrawalCache();
+    BOOST_REQUIRE_EQUAL(vHash.size(), vFailedCache.size());
+    for (size_t i = 0; i < vHash.size(); i++)
+        BOOST_CHECK_EQUAL(vHash[i], vFailedCache[i].hash.ToString());
+
+    // Cursors are only accepted by the RPC that handed them out
+    UniValue result = CallPageRPC("listspentwithdrawals", {"1"});
+    std::string strSpentCursor = find_value(result, "cursor").get_str();
+    BOOST_CHECK_THROW(CallPageRPC("listfailedwithdrawals", {"1", strSpentCursor}), UniValue);
+    BOOST_CHECK_THROW(CallPageRPC("listspentwithdrawals", {"1", "nonsense"}), UniValue);
+    BOOST_CHECK_THROW(CallPageRPC("listspentwithdrawals", {"0"}), UniValue);
+
+    // Without paging arguments the whole cache is returned as before
+    BOOST_CHECK_EQUAL(CallPageRPC("listspentwithdrawals", {}).size(), vSpent.size());
+
+    scdb.Reset();
+}
+
+BOOST_AUTO_TEST_CASE(sidechaindb_change_sets)
+{
+    SidechainDB scdbTest;
+    uint64_t nSequence = scdbTest.GetChangeSequence();
+
+    // Activation takes more blocks than there are change sets kept
+    BOOST_CHECK(ActivateTestSidechain(scdbTest));
+
+    std::vector<SidechainDBChangeSet> vChangeSet;
+    uint64_t nSequenceOut;
+    BOOST_CHECK(!scdbTest.GetChangeSets(nSequence, vChangeSet, nSequenceOut));
+    BOOST_CHECK(nSequenceOut > nSequence + MAX_SCDB_CHANGE_SETS);
+
+    nSequence = nSequenceOut;
+    BOOST_CHECK(scdbTest.GetChangeSets(nSequence, vChangeSet, nSequenceOut));
+    BOOST_CHECK(vChangeSet.empty());
+    BOOST_CHECK_EQUAL(nSequenceOut, nSequence);
+
+    // A block adding a withdrawal
+    uint256 hash = GetRandHash();
+    CBlock block;
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.SetNull();
+    block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    GenerateWithdrawalHashCommitment(block, hash, 0, Params().GetConsensus());
+
+    BOOST_CHECK(scdbTest.Update(21, GetRandHash(), scdbTest.GetHashBlockLastSeen(), block.vtx[0]->vout));
+    BOOST_CHECK(scdbTest.GetChangeSets(nSequence, vChangeSet, nSequenceOut));
+    BOOST_CHECK_EQUAL(vChangeSet.size(), 1U);
+    BOOST_CHECK_EQUAL(nSequenceOut, nSequence + 1);
+    BOOST_CHECK(!vChangeSet[0].fSidechainsChanged);
+    BOOST_CHECK(vChangeSet[0].hashBlock == scdbTest.GetHashBlockLastSeen());
+    BOOST_CHECK(vChangeSet[0].vWithdrawalAdded.size() == 1 && vChangeSet[0].vWithdrawalAdded[0].hash == hash);
+    BOOST_CHECK(vChangeSet[0].vWithdrawalUpdated.empty());
+    BOOST_CHECK(vChangeSet[0].vWithdrawalRemoved.empty());
+
+    // A block without updates lowers the blocks left of the withdrawal
+    nSequence = nSequenceOut;
+    std::vector<CTxOut> vout{CTxOut(50 * CENT, CScript() << OP_RETURN)};
+    BOOST_CHECK(scdbTest.Update(22, GetRandHash(), scdbTest.GetHashBlockLastSeen(), vout));
+    BOOST_CHECK(scdbTest.GetChangeSets(nSequence, vChangeSet, nSequenceOut));
+    BOOST_CHECK_EQUAL(vChangeSet.size(), 1U);
+    BOOST_CHECK(vChangeSet[0].vWithdrawalAdded.empty());
+    BOOST_CHECK(vChangeSet[0].vWithdrawalUpdated.size() == 1 && vChangeSet[0].vWithdrawalUpdated[0].hash == hash);
+
+    // Checking a block doesn't publish anything
+    nSequence = nSequenceOut;
+    BOOST_CHECK(scdbTest.Update(23, GetRandHash(), scdbTest.GetHashBlockLastSeen(), vout, true /* fJustCheck */));
+    BOOST_CHECK_EQUAL(scdbTest.GetChangeSequence(), nSequence);
+
+    // Reset removes the sidechain and its withdrawal
+    scdbTest.Reset();
+    BOOST_CHECK(scdbTest.GetChangeSets(nSequence, vChangeSet, nSequenceOut));
+    BOOST_CHECK_EQUAL(vChangeSet.size(), 1U);
+    BOOST_CHECK(vChangeSet[0].fSidechainsChanged);
+    BOOST_CHECK(vChangeSet[0].vWithdrawalRemoved.size() == 1 && vChangeSet[0].vWithdrawalRemoved[0].hash == hash);
+}
+
+BOOST_AUTO_TEST_CASE(sidechaintree_flush)
+{
+    CSidechainTreeDB db(1 << 20, true);
+
+    // Block data is readable right away but only written by Flush
+    uint256 hashBlock = InsecureRand256();
+    SidechainBlockData data;
+    data.hashMT = InsecureRand256();
+    BOOST_CHECK(db.WriteSidechainBlockData(std::make_pair(hashBlock, data)));
+    BOOST_CHECK(db.HaveBlockData(hashBlock));
+    BOOST_CHECK(db.GetBufferedSize() > 0);
+    BOOST_CHECK(!db.Exists(std::make_pair(DB_SIDECHAIN_BLOCK_OP, hashBlock)));
+
+    uint256 hashBest;
+    BOOST_CHECK(!db.ReadBestBlock(hashBest));
+
+    BOOST_CHECK(db.Flush(hashBlock));
+    BOOST_CHECK_EQUAL(db.GetBufferedSize(), 0U);
+    BOOST_CHECK(db.Exists(std::make_pair(DB_SIDECHAIN_BLOCK_OP, hashBlock)));
+    BOOST_CHECK(db.ReadBestBlock(hashBest));
+    BOOST_CHECK(hashBest == hashBlock);
+
+    SidechainBlockData dataRead;
+    BOOST_CHECK(db.GetBlockData(hashBlock, dataRead));
+    BOOST_CHECK(dataRead.hashMT == data.hashMT);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -83,6 +83,7 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
         pblocktree.reset(new CBlockTreeDB(1 << 20, true));
         psidechaintree.reset(new CSidechainTreeDB(1 << 20, true));
         popreturndb.reset(new OPReturnDB(1 << 20, true));
+        pblockstatsdb.reset(new CBlockStatsDB(1 << 20, true));
         pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
         pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
         if (!LoadGenesisBlock(chainparams)) {
@@ -116,6 +117,7 @@ TestingSetup::~TestingSetup()
         pblocktree.reset();
         psidechaintree.reset();
         popreturndb.reset();
+        pblockstatsdb.reset();
         fs::remove_all(pathTemp);
         scdb.Reset();
 }
@@ -7,8 +7,11 @@
 #include <amount.h>
 #include <consensus/validation.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
 #include <test/test_drivenet.h>
+#include <chainparams.h>
+#include <chain.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -58,4 +61,59 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_coinbase, TestChain100Setup)
     BOOST_CHECK_EQUAL(nDoS, 100);
 }
 
+/**
+ * Ensure that blocks connected from disk, which are read and checked ahead
+ * on other threads, connect to the same chain state.
+ */
+BOOST_FIXTURE_TEST_CASE(reconnect_prefetched_blocks, TestChain100Setup)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    // Blocks spending the mature coinbases, so the script checks use the
+    // precomputed transaction data
+    for (int i = 0; i < 10; i++) {
+        CMutableTransaction spend;
+        spend.nVersion = 1;
+        spend.vin.resize(1);
+        spend.vin[0].prevout.hash = coinbaseTxns[i].GetHash();
+        spend.vin[0].prevout.n = 0;
+        spend.vout.resize(1);
+        spend.vout[0].nValue = 11 * CENT;
+        spend.vout[0].scriptPubKey = scriptPubKey;
+
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spend.vin[0].scriptSig << vchSig;
+
+        CBlock block = CreateAndProcessBlock({spend}, scriptPubKey);
+        BOOST_CHECK(chainActive.Tip()->GetBlockHash() == block.GetHash());
+    }
+
+    uint256 hashTip;
+    CBlockIndex* pindexInvalid;
+    {
+        LOCK(cs_main);
+        hashTip = chainActive.Tip()->GetBlockHash();
+        pindexInvalid = chainActive[chainActive.Height() - 14];
+    }
+
+    CValidationState state;
+    BOOST_CHECK(InvalidateBlock(state, Params(), pindexInvalid));
+    BOOST_CHECK(ActivateBestChain(state, Params()));
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(chainActive.Tip() == pindexInvalid->pprev);
+        BOOST_CHECK(ResetBlockFailureFlags(pindexInvalid));
+    }
+
+    // All 15 blocks are connected from disk in one go
+    BOOST_CHECK(ActivateBestChain(state, Params()));
+    BOOST_CHECK(state.IsValid());
+    LOCK(cs_main);
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == hashTip);
+    BOOST_CHECK(pcoinsTip->GetBestBlock() == hashTip);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
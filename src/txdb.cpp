@@ -6,7 +6,9 @@
 #include <txdb.h>
 
 #include <chainparams.h>
+#include <crypto/common.h>
 #include <hash.h>
+#include <memusage.h>
 #include <random.h>
 #include <pow.h>
 #include <sidechain.h>
@@ -20,6 +22,8 @@
 #include <script/standard.h>
 #include <base58.h>
 
+#include <algorithm>
+#include <limits>
 #include <stdint.h>
 
 #include <boost/thread.hpp>
@@ -35,9 +39,24 @@ static const char DB_HEAD_BLOCKS = 'H';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
+static const char DB_SNAPSHOT_BASE = 'S';
 
 static const char DB_OP_RETURN = 'x';
+static const char DB_OP_RETURN_PAYLOAD = 'y';
 static const char DB_OP_RETURN_TYPES = 'X';
+static const char DB_OP_RETURN_NEWS = 'n';
+static const char DB_OP_RETURN_VERSION = 'V';
+static const char DB_OP_RETURN_SEARCH = 'w';
+static const char DB_OP_RETURN_SEARCH_FLAG = 'W';
+
+static const char DB_BLOCK_STATS = 's';
+static const char DB_UTXO_SET_STATS = 'u';
+
+//! Size of the erase batches written by OPReturnDB::WipeIndex
+static const size_t OPRETURN_WIPE_BATCH_SIZE = 16 << 20;
+
+//! Fewest payloads of a block sharing a header that are stored as a group
+static const uint32_t OPRETURN_MIN_GROUP_SIZE = 16;
 
 namespace {
 
@@ -61,13 +80,428 @@ struct CoinEntry {
     }
 };
 
+/**
+ * Key of the news index. The day and the fee are written big endian, the
+ * fee inverted, so that LevelDB's bytewise order sorts news by header, then
+ * day, then highest fee first.
+ */
+struct NewsIndexKey {
+    char key;
+    unsigned char header[NEWS_HEADER_SIZE];
+    uint32_t nDay;
+    uint64_t nInvertedFee;
+    uint256 txid;
+    uint32_t n;
+
+    NewsIndexKey() : key(0), nDay(0), nInvertedFee(0), n(0) {}
+
+    /** The first key of a day */
+    NewsIndexKey(const unsigned char* pheader, uint32_t nDayIn) : key(DB_OP_RETURN_NEWS), nDay(nDayIn), nInvertedFee(0), n(0)
+    {
+        memcpy(header, pheader, NEWS_HEADER_SIZE);
+    }
+
+    explicit NewsIndexKey(const OPReturnNews& news) : key(DB_OP_RETURN_NEWS), txid(news.txid), n(news.n)
+    {
+        memcpy(header, &news.script[1], NEWS_HEADER_SIZE);
+        nDay = news.nTime / NEWS_INDEX_BUCKET;
+        nInvertedFee = std::numeric_limits<uint64_t>::max() - news.fees;
+    }
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        unsigned char buf[12];
+        WriteBE32(buf, nDay);
+        WriteBE64(buf + 4, nInvertedFee);
+
+        s << key;
+        s.write((const char*)header, NEWS_HEADER_SIZE);
+        s.write((const char*)buf, sizeof(buf));
+        s << txid;
+        s << n;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        unsigned char buf[12];
+
+        s >> key;
+        s.read((char*)header, NEWS_HEADER_SIZE);
+        s.read((char*)buf, sizeof(buf));
+        s >> txid;
+        s >> n;
+
+        nDay = ReadBE32(buf);
+        nInvertedFee = ReadBE64(buf + 4);
+    }
+};
+
+/** The rest of an OPReturnNews, stored as the value of its index key */
+struct NewsIndexValue {
+    int64_t nTime;
+    int nHeight;
+    CScript script;
+
+    NewsIndexValue() : nTime(0), nHeight(0) {}
+
+    explicit NewsIndexValue(const OPReturnNews& news) : nTime(news.nTime), nHeight(news.nHeight), script(news.script) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nTime);
+        READWRITE(nHeight);
+        READWRITE(script);
+    }
+};
+
+template<typename Stream, typename I>
+void SerializeVarIntColumn(Stream& s, const std::vector<I>& v)
+{
+    WriteCompactSize(s, v.size());
+    for (const I& n : v)
+        s << VARINT(n);
+}
+
+template<typename Stream, typename I>
+void UnserializeVarIntColumn(Stream& s, std::vector<I>& v)
+{
+    uint64_t nSize = ReadCompactSize(s);
+    v.clear();
+    for (uint64_t i = 0; i < nSize; i++) {
+        I n;
+        s >> VARINT(n);
+        v.push_back(n);
+    }
+}
+
+/** The first NEWS_HEADER_SIZE bytes after OP_RETURN, or fewer */
+std::vector<unsigned char> GetPayloadHeader(const CScript& script)
+{
+    CScript::const_iterator begin = script.begin() + std::min<size_t>(1, script.size());
+    CScript::const_iterator end = begin + std::min<size_t>(NEWS_HEADER_SIZE, script.end() - begin);
+    return std::vector<unsigned char>(begin, end);
+}
+
+/**
+ * The OP_RETURN data of a block, stored column by column. The txid, size and
+ * fees of a transaction are stored once however many OP_RETURN outputs it
+ * has, sizes and fees as varints. Identical payloads are stored once per
+ * block, in groups of payloads sharing a header, each group under its own
+ * OPReturnPayloadKey. A reader looking for one header only loads the groups
+ * which may have it. Payloads whose header fewer than OPRETURN_MIN_GROUP_SIZE
+ * payloads of the block have are all in a last group with an empty header,
+ * their headers being kept in a column of their own.
+ */
+struct OPReturnBlockColumns {
+    std::vector<uint256> vTxid;
+    std::vector<uint32_t> vSize;
+    std::vector<uint64_t> vFee;
+    //! Index in vTxid of the transaction of each output
+    std::vector<uint32_t> vOutTx;
+    //! Payload number of each output, payloads being numbered group by group
+    std::vector<uint32_t> vOutPayload;
+    //! Header and number of payloads of each group
+    std::vector<std::vector<unsigned char>> vGroupHeader;
+    std::vector<uint32_t> vGroupSize;
+    //! Header of each payload of the last group when its header is empty,
+    //! as its size followed by NEWS_HEADER_SIZE bytes
+    std::vector<unsigned char> vOtherHeader;
+
+    OPReturnBlockColumns() {}
+
+    /** Split vData into columns, and its distinct scripts into groups */
+    OPReturnBlockColumns(const std::vector<OPReturnData>& vData, std::vector<std::vector<CScript>>& vGroup)
+    {
+        // Distinct payloads in order of first appearance
+        std::map<CScript, uint32_t> mapPayload;
+        std::vector<CScript> vPayload;
+        std::vector<uint32_t> vOutDistinct;
+        for (const OPReturnData& data : vData) {
+            // The outputs of a transaction are next to each other
+            if (vTxid.empty() || vTxid.back() != data.txid) {
+                vTxid.push_back(data.txid);
+                vSize.push_back(data.nSize);
+                vFee.push_back(data.fees);
+            }
+            vOutTx.push_back(vTxid.size() - 1);
+
+            auto ret = mapPayload.emplace(data.script, vPayload.size());
+            if (ret.second)
+                vPayload.push_back(data.script);
+            vOutDistinct.push_back(ret.first->second);
+        }
+
+        std::map<std::vector<unsigned char>, uint32_t> mapHeaderCount;
+        for (const CScript& script : vPayload)
+            mapHeaderCount[GetPayloadHeader(script)]++;
+
+        std::map<std::vector<unsigned char>, size_t> mapGroup;
+        std::vector<std::pair<size_t, uint32_t>> vPosition;
+        std::vector<CScript> vOther;
+        for (const CScript& script : vPayload) {
+            std::vector<unsigned char> header = GetPayloadHeader(script);
+            if (mapHeaderCount[header] < OPRETURN_MIN_GROUP_SIZE) {
+                vPosition.emplace_back(std::numeric_limits<size_t>::max(), vOther.size());
+                vOther.push_back(script);
+                vOtherHeader.push_back(header.size());
+                header.resize(NEWS_HEADER_SIZE);
+                vOtherHeader.insert(vOtherHeader.end(), header.begin(), header.end());
+                continue;
+            }
+            auto ret = mapGroup.emplace(header, vGroup.size());
+            if (ret.second) {
+                vGroup.emplace_back();
+                vGroupHeader.push_back(header);
+            }
+            vPosition.emplace_back(ret.first->second, vGroup[ret.first->second].size());
+            vGroup[ret.first->second].push_back(script);
+        }
+        if (!vOther.empty()) {
+            vGroup.push_back(vOther);
+            vGroupHeader.emplace_back();
+        }
+
+        std::vector<uint32_t> vGroupBegin;
+        uint32_t nPayload = 0;
+        for (const std::vector<CScript>& vScript : vGroup) {
+            vGroupBegin.push_back(nPayload);
+            vGroupSize.push_back(vScript.size());
+            nPayload += vScript.size();
+        }
+        for (uint32_t nDistinct : vOutDistinct) {
+            size_t nGroup = std::min(vPosition[nDistinct].first, vGroup.size() - 1);
+            vOutPayload.push_back(vGroupBegin[nGroup] + vPosition[nDistinct].second);
+        }
+    }
+
+    bool IsValid() const
+    {
+        if (vSize.size() != vTxid.size() || vFee.size() != vTxid.size())
+            return false;
+        if (vOutPayload.size() != vOutTx.size() || vGroupSize.size() != vGroupHeader.size())
+            return false;
+        if (!vOtherHeader.empty()) {
+            if (!vGroupHeader.back().empty() || vOtherHeader.size() != vGroupSize.back() * (NEWS_HEADER_SIZE + 1))
+                return false;
+        }
+        uint64_t nPayload = 0;
+        for (uint32_t nSize : vGroupSize)
+            nPayload += nSize;
+        for (size_t i = 0; i < vOutTx.size(); i++) {
+            if (vOutTx[i] >= vTxid.size() || vOutPayload[i] >= nPayload)
+                return false;
+        }
+        return true;
+    }
+
+    /** Whether a payload of group g may start with header */
+    bool MayHaveHeader(size_t g, const CScript& header) const
+    {
+        if (!vGroupHeader[g].empty() || vOtherHeader.empty())
+            return MayHaveHeader(vGroupHeader[g].data(), vGroupHeader[g].size(), header);
+
+        for (size_t i = 0; i < vOtherHeader.size(); i += NEWS_HEADER_SIZE + 1) {
+            if (MayHaveHeader(&vOtherHeader[i + 1], vOtherHeader[i], header))
+                return true;
+        }
+        return false;
+    }
+
+    static bool MayHaveHeader(const unsigned char* pheader, size_t nSize, const CScript& header)
+    {
+        // A payload shorter than NEWS_HEADER_SIZE is all in its header
+        if (nSize < NEWS_HEADER_SIZE && nSize < header.size())
+            return false;
+        size_t nCompare = std::min<size_t>(nSize, header.size());
+        return std::equal(pheader, pheader + nCompare, header.begin());
+    }
+
+    void GetData(size_t nOut, const CScript& script, OPReturnData& data) const
+    {
+        data.txid = vTxid[vOutTx[nOut]];
+        data.script = script;
+        data.nSize = vSize[vOutTx[nOut]];
+        data.fees = vFee[vOutTx[nOut]];
+    }
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        s << vTxid;
+        SerializeVarIntColumn(s, vSize);
+        SerializeVarIntColumn(s, vFee);
+        SerializeVarIntColumn(s, vOutTx);
+        SerializeVarIntColumn(s, vOutPayload);
+        s << vGroupHeader;
+        SerializeVarIntColumn(s, vGroupSize);
+        s << vOtherHeader;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        s >> vTxid;
+        UnserializeVarIntColumn(s, vSize);
+        UnserializeVarIntColumn(s, vFee);
+        UnserializeVarIntColumn(s, vOutTx);
+        UnserializeVarIntColumn(s, vOutPayload);
+        s >> vGroupHeader;
+        UnserializeVarIntColumn(s, vGroupSize);
+        s >> vOtherHeader;
+    }
+};
+
+/**
+ * Key of a group of OP_RETURN payloads. The group number is written big
+ * endian so that the groups of a block are next to each other.
+ */
+struct OPReturnPayloadKey {
+    char key;
+    uint256 hashBlock;
+    uint32_t n;
+
+    OPReturnPayloadKey() : key(0), n(0) {}
+
+    OPReturnPayloadKey(const uint256& hashBlockIn, uint32_t nIn) : key(DB_OP_RETURN_PAYLOAD), hashBlock(hashBlockIn), n(nIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        unsigned char buf[4];
+        WriteBE32(buf, n);
+
+        s << key;
+        s << hashBlock;
+        s.write((const char*)buf, sizeof(buf));
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        unsigned char buf[4];
+
+        s >> key;
+        s >> hashBlock;
+        s.read((char*)buf, sizeof(buf));
+
+        n = ReadBE32(buf);
+    }
+};
+
+/**
+ * Key of the search index. The word is followed by a zero byte so that the
+ * words starting with a prefix are next to each other, and the height is
+ * written big endian and inverted so that the newest entries come first.
+ */
+struct OPReturnSearchKey {
+    char key;
+    std::string word;
+    uint32_t nInvertedHeight;
+    uint256 hashBlock;
+    uint32_t nData;
+
+    OPReturnSearchKey() : key(0), nInvertedHeight(0), nData(0) {}
+
+    /** The first key of the words starting with strPrefix */
+    explicit OPReturnSearchKey(const std::string& strPrefix) : key(DB_OP_RETURN_SEARCH), word(strPrefix), nInvertedHeight(0), nData(0) {}
+
+    explicit OPReturnSearchKey(const OPReturnSearchEntry& entry) : key(DB_OP_RETURN_SEARCH), word(entry.word), hashBlock(entry.hashBlock), nData(entry.nData)
+    {
+        nInvertedHeight = std::numeric_limits<uint32_t>::max() - entry.nHeight;
+    }
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        unsigned char buf[4];
+
+        s << key;
+        s.write(word.data(), word.size());
+        s << (char)0;
+        WriteBE32(buf, nInvertedHeight);
+        s.write((const char*)buf, sizeof(buf));
+        s << hashBlock;
+        WriteBE32(buf, nData);
+        s.write((const char*)buf, sizeof(buf));
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        unsigned char buf[4];
+
+        s >> key;
+        word.clear();
+        char c;
+        for (s >> c; c != 0; s >> c)
+            word += c;
+        s.read((char*)buf, sizeof(buf));
+        nInvertedHeight = ReadBE32(buf);
+        s >> hashBlock;
+        s.read((char*)buf, sizeof(buf));
+        nData = ReadBE32(buf);
+    }
+};
+
+/** The rest of an OPReturnSearchEntry, stored as the value of its key */
+struct OPReturnSearchValue {
+    uint256 txid;
+    CAmount fees;
+    int64_t nTime;
+    CScript script;
+
+    OPReturnSearchValue() : fees(0), nTime(0) {}
+
+    explicit OPReturnSearchValue(const OPReturnSearchEntry& entry) : txid(entry.txid), fees(entry.fees), nTime(entry.nTime), script(entry.script) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(fees);
+        READWRITE(nTime);
+        READWRITE(script);
+    }
+};
+
+void WriteOPReturnBlock(CDBBatch& batch, const uint256& hashBlock, const std::vector<OPReturnData>& vData)
+{
+    std::vector<std::vector<CScript>> vGroup;
+    OPReturnBlockColumns columns(vData, vGroup);
+
+    batch.Write(std::make_pair(DB_OP_RETURN, hashBlock), columns);
+    for (size_t i = 0; i < vGroup.size(); i++)
+        batch.Write(OPReturnPayloadKey(hashBlock, i), vGroup[i]);
 }
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize / 2, fMemory, fWipe, true)
+bool HasHeader(const CScript& script, const CScript& header)
 {
+    if (script.size() <= header.size())
+        return false;
+    return std::equal(header.begin(), header.end(), script.begin() + 1);
+}
+
+}
+
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize / 2, fMemory, fWipe, true),
+    fWriting(false), fWriteFailed(false), nWritingUsage(0)
+{
+}
+
+CCoinsViewDB::~CCoinsViewDB()
+{
+    WaitForWrite();
 }
 
 bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    if (fWriting) {
+        LOCK(cs_writing);
+        CCoinsMap::const_iterator it;
+        if (pmapWriting && (it = pmapWriting->find(outpoint)) != pmapWriting->end()) {
+            if (it->second.coin.IsSpent())
+                return false;
+            coin = it->second.coin;
+            return true;
+        }
+    }
+
     if (db.Read(CoinEntry(&outpoint), coin))
         return true;
 
@@ -75,6 +509,13 @@ bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
 }
 
 bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
+    if (fWriting) {
+        LOCK(cs_writing);
+        CCoinsMap::const_iterator it;
+        if (pmapWriting && (it = pmapWriting->find(outpoint)) != pmapWriting->end())
+            return !it->second.coin.IsSpent();
+    }
+
     if (db.Exists(CoinEntry(&outpoint)))
         return true;
 
@@ -82,6 +523,12 @@ bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
 }
 
 uint256 CCoinsViewDB::GetBestBlock() const {
+    if (fWriting) {
+        LOCK(cs_writing);
+        if (fWriting)
+            return hashWriting;
+    }
+
     uint256 hashBestChain;
     if (!db.Read(DB_BEST_BLOCK, hashBestChain))
         return uint256();
@@ -97,6 +544,70 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
 }
 
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    // Never write over a generation that did not make it to disk, the
+    // head blocks it left behind are needed to replay it
+    if (!WaitForWrite())
+        return false;
+
+    bool ret = WriteCoins(mapCoins, hashBlock);
+    mapCoins.clear();
+    return ret;
+}
+
+bool CCoinsViewDB::BatchWriteInBackground(CCoinsMap &mapCoins, const uint256 &hashBlock) {
+    LOCK(cs_writer);
+    if (threadWrite.joinable())
+        threadWrite.join();
+    if (fWriteFailed)
+        return false;
+
+    size_t nUsage = memusage::DynamicUsage(mapCoins);
+    for (const auto& entry : mapCoins)
+        nUsage += entry.second.coin.DynamicMemoryUsage();
+
+    {
+        LOCK(cs_writing);
+        pmapWriting.reset(new CCoinsMap(std::move(mapCoins)));
+        hashWriting = hashBlock;
+        nWritingUsage = nUsage;
+        fWriting = true;
+    }
+    mapCoins.clear();
+
+    threadWrite = std::thread(&CCoinsViewDB::ThreadWrite, this);
+    return true;
+}
+
+bool CCoinsViewDB::WaitForWrite() const {
+    LOCK(cs_writer);
+    if (threadWrite.joinable())
+        threadWrite.join();
+    return !fWriteFailed;
+}
+
+void CCoinsViewDB::ThreadWrite() {
+    RenameThread("drivenet-coinsdb");
+
+    // Nothing changes the generation while it is written
+    bool fOk = false;
+    try {
+        fOk = WriteCoins(*pmapWriting, hashWriting);
+    } catch (const std::exception& e) {
+        LogPrintf("%s: %s\n", __func__, e.what());
+    }
+    if (!fOk) {
+        LogPrintf("%s: Failed to write to coin database\n", __func__);
+        fWriteFailed = true;
+    }
+
+    // Readers fall through to the database from now on
+    LOCK(cs_writing);
+    fWriting = false;
+    pmapWriting.reset();
+    nWritingUsage = 0;
+}
+
+bool CCoinsViewDB::WriteCoins(const CCoinsMap &mapCoins, const uint256 &hashBlock) {
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
@@ -104,9 +615,11 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     int crash_simulate = gArgs.GetArg("-dbcrashratio", 0);
     assert(!hashBlock.IsNull());
 
-    uint256 old_tip = GetBestBlock();
-    if (old_tip.IsNull()) {
+    // GetBestBlock would return the generation being written
+    uint256 old_tip;
+    if (!db.Read(DB_BEST_BLOCK, old_tip)) {
         // We may be in the middle of replaying.
+        old_tip.SetNull();
         std::vector<uint256> old_heads = GetHeadBlocks();
         if (old_heads.size() == 2) {
             assert(old_heads[0] == hashBlock);
@@ -121,7 +634,7 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     batch.Erase(DB_BEST_BLOCK);
     batch.Write(DB_HEAD_BLOCKS, std::vector<uint256>{hashBlock, old_tip});
 
-    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); it++) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
             CoinEntry entry(&it->first);
             if (it->second.coin.IsSpent())
@@ -131,8 +644,6 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
         if (batch.SizeEstimate() > batch_size) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
             db.WriteBatch(batch);
@@ -185,8 +696,35 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
     return Read(DB_LAST_BLOCK, nFile);
 }
 
+bool CCoinsViewDB::BeginBulkWrite(const uint256 &hashBlock) {
+    if (!WaitForWrite())
+        return false;
+
+    CDBBatch batch(db);
+    batch.Erase(DB_BEST_BLOCK);
+    batch.Write(DB_HEAD_BLOCKS, std::vector<uint256>{hashBlock, GetBestBlock()});
+    return db.WriteBatch(batch, true);
+}
+
+bool CCoinsViewDB::BulkWrite(const std::vector<std::pair<COutPoint, Coin>> &vCoins) {
+    CDBBatch batch(db);
+    for (const std::pair<COutPoint, Coin>& coin : vCoins)
+        batch.Write(CoinEntry(&coin.first), coin.second);
+    return db.WriteBatch(batch);
+}
+
+bool CCoinsViewDB::EndBulkWrite(const uint256 &hashBlock) {
+    CDBBatch batch(db);
+    batch.Erase(DB_HEAD_BLOCKS);
+    batch.Write(DB_BEST_BLOCK, hashBlock);
+    return db.WriteBatch(batch, true);
+}
+
 CCoinsViewCursor *CCoinsViewDB::Cursor() const
 {
+    // Iterate over a complete generation
+    WaitForWrite();
+
     CCoinsViewDBCursor *i = new CCoinsViewDBCursor(const_cast<CDBWrapper&>(db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
@@ -239,6 +777,71 @@ void CCoinsViewDBCursor::Next()
     }
 }
 
+CCoinsBulkWriter::CCoinsBulkWriter(CCoinsViewDB& dbIn, int nThreads) : db(dbIn), nMaxQueued(2 * nThreads),
+    fStop(false), fFailed(false)
+{
+    for (int i = 0; i < nThreads; i++)
+        vThreads.emplace_back(&CCoinsBulkWriter::ThreadWrite, this);
+}
+
+CCoinsBulkWriter::~CCoinsBulkWriter()
+{
+    Finish();
+}
+
+void CCoinsBulkWriter::Add(std::vector<std::pair<COutPoint, Coin>>&& vCoins)
+{
+    std::unique_lock<std::mutex> lock(cs);
+    condSpace.wait(lock, [this]{ return queue.size() < nMaxQueued; });
+    queue.push_back(std::move(vCoins));
+    condWork.notify_one();
+}
+
+bool CCoinsBulkWriter::Finish()
+{
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        fStop = true;
+    }
+    condWork.notify_all();
+    for (std::thread& thread : vThreads)
+        thread.join();
+    vThreads.clear();
+
+    std::unique_lock<std::mutex> lock(cs);
+    return !fFailed;
+}
+
+void CCoinsBulkWriter::ThreadWrite()
+{
+    RenameThread("drivenet-coinswrite");
+
+    std::unique_lock<std::mutex> lock(cs);
+    while (true) {
+        condWork.wait(lock, [this]{ return fStop || !queue.empty(); });
+        if (queue.empty())
+            return;
+
+        std::vector<std::pair<COutPoint, Coin>> vCoins = std::move(queue.front());
+        queue.pop_front();
+        condSpace.notify_one();
+        if (fFailed)
+            continue;
+        lock.unlock();
+
+        bool fOk = false;
+        try {
+            fOk = db.BulkWrite(vCoins);
+        } catch (const std::exception& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+        }
+
+        lock.lock();
+        if (!fOk)
+            fFailed = true;
+    }
+}
+
 bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
@@ -274,6 +877,19 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+bool CBlockTreeDB::WriteSnapshotBase(const uint256 &hash, unsigned int nChainTx) {
+    return Write(DB_SNAPSHOT_BASE, std::make_pair(hash, nChainTx), true);
+}
+
+bool CBlockTreeDB::ReadSnapshotBase(uint256 &hash, unsigned int &nChainTx) {
+    std::pair<uint256, unsigned int> base;
+    if (!Read(DB_SNAPSHOT_BASE, base))
+        return false;
+    hash = base.first;
+    nChainTx = base.second;
+    return true;
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
@@ -322,32 +938,40 @@ CSidechainTreeDB::CSidechainTreeDB(size_t nCacheSize, bool fMemory, bool fWipe)
 
 bool CSidechainTreeDB::WriteSidechainIndex(const std::vector<std::pair<uint256, const SidechainObj *> > &list)
 {
-    CDBBatch batch(*this);
     for (std::vector<std::pair<uint256, const SidechainObj *> >::const_iterator it=list.begin(); it!=list.end(); it++) {
         const uint256 &objid = it->first;
         const SidechainObj *obj = it->second;
-        std::pair<char, uint256> key = std::make_pair(obj->sidechainop, objid);
 
         if (obj->sidechainop == DB_SIDECHAIN_BLOCK_OP) {
             const SidechainBlockData *ptr = (const SidechainBlockData *) obj;
-            batch.Write(key, *ptr);
+            if (!WriteSidechainBlockData(std::make_pair(objid, *ptr)))
+                return false;
         }
     }
-
-    return WriteBatch(batch, true);
+    return true;
 }
 
 bool CSidechainTreeDB::WriteSidechainBlockData(const std::pair<uint256, const SidechainBlockData>& data)
 {
-    CDBBatch batch(*this);
-    std::pair<char, uint256> key = std::make_pair(data.second.sidechainop, data.first);
-    batch.Write(key, data.second);
+    // Written to disk by the next Flush
+    auto ret = mapBuffered.insert(data);
+    if (!ret.second) {
+        nBufferedSize -= ::GetSerializeSize(ret.first->second, SER_DISK, CLIENT_VERSION);
+        ret.first->second = data.second;
+    }
+    nBufferedSize += ::GetSerializeSize(data.second, SER_DISK, CLIENT_VERSION);
 
-    return WriteBatch(batch, true);
+    return true;
 }
 
 bool CSidechainTreeDB::GetBlockData(const uint256& hashBlock, SidechainBlockData& data) const
 {
+    auto it = mapBuffered.find(hashBlock);
+    if (it != mapBuffered.end()) {
+        data = it->second;
+        return true;
+    }
+
     if (ReadSidechain(std::make_pair(DB_SIDECHAIN_BLOCK_OP, hashBlock), data))
         return true;
 
@@ -356,31 +980,371 @@ bool CSidechainTreeDB::GetBlockData(const uint256& hashBlock, SidechainBlockData
 
 bool CSidechainTreeDB::HaveBlockData(const uint256& hashBlock) const
 {
-    SidechainBlockData data;
-    return GetBlockData(hashBlock, data);
+    if (mapBuffered.count(hashBlock))
+        return true;
+
+    return Exists(std::make_pair(DB_SIDECHAIN_BLOCK_OP, hashBlock));
+}
+
+bool CSidechainTreeDB::Flush(const uint256& hashBestBlock)
+{
+    CDBBatch batch(*this);
+    for (const auto& entry : mapBuffered)
+        batch.Write(std::make_pair(entry.second.sidechainop, entry.first), entry.second);
+    batch.Write(DB_BEST_BLOCK, hashBestBlock);
+
+    if (!WriteBatch(batch, true))
+        return false;
+
+    LogPrint(BCLog::COINDB, "Wrote sidechain data of %u blocks (%u bytes)\n", mapBuffered.size(), nBufferedSize);
+
+    mapBuffered.clear();
+    nBufferedSize = 0;
+    return true;
+}
+
+bool CSidechainTreeDB::ReadBestBlock(uint256& hashBestBlock) const
+{
+    return Read(DB_BEST_BLOCK, hashBestBlock);
 }
 
 OPReturnDB::OPReturnDB(size_t nCacheSize, bool fMemory, bool fWipe)
     : CDBWrapper(GetDataDir() / "blocks" / "opreturn", nCacheSize, fMemory, fWipe) { }
 
-bool OPReturnDB::WriteBlockData(const std::pair<uint256, const std::vector<OPReturnData>>& data)
+bool OPReturnDB::WriteBlockData(const uint256& hashBlock, const std::vector<OPReturnData>& vData, const std::vector<OPReturnNews>& vNews, const std::vector<OPReturnSearchEntry>& vSearch)
 {
     CDBBatch batch(*this);
-    std::pair<char, uint256> key = std::make_pair(DB_OP_RETURN, data.first);
-    batch.Write(key, data.second);
+    WriteOPReturnBlock(batch, hashBlock, vData);
+    for (const OPReturnNews& news : vNews)
+        batch.Write(NewsIndexKey(news), NewsIndexValue(news));
+    for (const OPReturnSearchEntry& entry : vSearch)
+        batch.Write(OPReturnSearchKey(entry), OPReturnSearchValue(entry));
+
+    // Made durable by the next (synced) WriteBestBlock
+    return WriteBatch(batch);
+}
+
+bool OPReturnDB::EraseBlockData(const uint256& hashBlock, const std::vector<OPReturnNews>& vNews, const std::vector<OPReturnSearchEntry>& vSearch)
+{
+    CDBBatch batch(*this);
+    OPReturnBlockColumns columns;
+    if (Read(std::make_pair(DB_OP_RETURN, hashBlock), columns)) {
+        for (size_t i = 0; i < columns.vGroupSize.size(); i++)
+            batch.Erase(OPReturnPayloadKey(hashBlock, i));
+    }
+    batch.Erase(std::make_pair(DB_OP_RETURN, hashBlock));
+    for (const OPReturnNews& news : vNews)
+        batch.Erase(NewsIndexKey(news));
+    for (const OPReturnSearchEntry& entry : vSearch)
+        batch.Erase(OPReturnSearchKey(entry));
+
+    return WriteBatch(batch);
+}
+
+bool OPReturnDB::WriteBlocks(const std::vector<OPReturnBlock>& vBlock, const CBlockLocator& locator)
+{
+    CDBBatch batch(*this);
+    for (const OPReturnBlock& block : vBlock) {
+        if (!block.vData.empty())
+            WriteOPReturnBlock(batch, block.hashBlock, block.vData);
+        for (const OPReturnNews& news : block.vNews)
+            batch.Write(NewsIndexKey(news), NewsIndexValue(news));
+        for (const OPReturnSearchEntry& entry : block.vSearch)
+            batch.Write(OPReturnSearchKey(entry), OPReturnSearchValue(entry));
+    }
+    batch.Write(DB_BEST_BLOCK, locator);
 
     return WriteBatch(batch, true);
 }
 
-bool OPReturnDB::GetBlockData(const uint256& hashBlock, std::vector<OPReturnData>& vData) const
+bool OPReturnDB::WipeIndex(int nVersion, bool fSearch)
 {
-    return Read(std::make_pair(DB_OP_RETURN, hashBlock), vData);
+    // Forget the locator first so that a crash halfway doesn't leave an
+    // index that looks complete
+    if (!ResetBestBlock(nVersion, fSearch))
+        return false;
+
+    CDBBatch batch(*this);
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_OP_RETURN, uint256()));
+    while (pcursor->Valid()) {
+        std::pair<char, uint256> key;
+        if (!pcursor->GetKey(key) || key.first != DB_OP_RETURN)
+            break;
+
+        batch.Erase(key);
+        if (batch.SizeEstimate() > OPRETURN_WIPE_BATCH_SIZE) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+
+    pcursor->Seek(OPReturnPayloadKey(uint256(), 0));
+    while (pcursor->Valid()) {
+        OPReturnPayloadKey key;
+        if (!pcursor->GetKey(key) || key.key != DB_OP_RETURN_PAYLOAD)
+            break;
+
+        batch.Erase(key);
+        if (batch.SizeEstimate() > OPRETURN_WIPE_BATCH_SIZE) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+
+    pcursor->Seek(DB_OP_RETURN_NEWS);
+    while (pcursor->Valid()) {
+        NewsIndexKey key;
+        if (!pcursor->GetKey(key) || key.key != DB_OP_RETURN_NEWS)
+            break;
+
+        batch.Erase(key);
+        if (batch.SizeEstimate() > OPRETURN_WIPE_BATCH_SIZE) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+
+    pcursor->Seek(OPReturnSearchKey(std::string()));
+    while (pcursor->Valid()) {
+        OPReturnSearchKey key;
+        if (!pcursor->GetKey(key) || key.key != DB_OP_RETURN_SEARCH)
+            break;
+
+        batch.Erase(key);
+        if (batch.SizeEstimate() > OPRETURN_WIPE_BATCH_SIZE) {
+            if (!WriteBatch(batch))
+                return false;
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+
+    return WriteBatch(batch, true);
+}
+
+bool OPReturnDB::GetBlockData(const uint256& hashBlock, std::vector<OPReturnData>& vData)
+{
+    OPReturnBlockColumns columns;
+    if (!Read(std::make_pair(DB_OP_RETURN, hashBlock), columns) || !columns.IsValid())
+        return false;
+
+    std::vector<std::vector<CScript>> vGroup(columns.vGroupSize.size());
+    std::vector<CScript*> vPayload;
+    for (size_t g = 0; g < vGroup.size(); g++) {
+        if (!Read(OPReturnPayloadKey(hashBlock, g), vGroup[g]) || vGroup[g].size() != columns.vGroupSize[g])
+            return false;
+        for (CScript& script : vGroup[g])
+            vPayload.push_back(&script);
+    }
+
+    // Most payloads have a single output, which can take the script
+    std::vector<uint32_t> vUses(vPayload.size(), 0);
+    for (uint32_t p : columns.vOutPayload)
+        vUses[p]++;
+
+    vData.clear();
+    vData.resize(columns.vOutTx.size());
+    for (size_t i = 0; i < columns.vOutTx.size(); i++) {
+        uint32_t p = columns.vOutPayload[i];
+        if (--vUses[p] == 0) {
+            columns.GetData(i, CScript(), vData[i]);
+            vData[i].script = std::move(*vPayload[p]);
+        } else {
+            columns.GetData(i, *vPayload[p], vData[i]);
+        }
+    }
+
+    return true;
+}
+
+bool OPReturnDB::GetBlockData(const uint256& hashBlock, const CScript& header, std::vector<OPReturnData>& vData)
+{
+    if (header.empty())
+        return GetBlockData(hashBlock, vData);
+
+    OPReturnBlockColumns columns;
+    if (!Read(std::make_pair(DB_OP_RETURN, hashBlock), columns) || !columns.IsValid())
+        return false;
+
+    // Only read the groups which may have the header
+    std::vector<std::vector<CScript>> vGroup(columns.vGroupSize.size());
+    std::vector<const CScript*> vPayload;
+    for (size_t g = 0; g < vGroup.size(); g++) {
+        if (!columns.MayHaveHeader(g, header)) {
+            vPayload.resize(vPayload.size() + columns.vGroupSize[g], nullptr);
+            continue;
+        }
+        if (!Read(OPReturnPayloadKey(hashBlock, g), vGroup[g]) || vGroup[g].size() != columns.vGroupSize[g])
+            return false;
+        for (const CScript& script : vGroup[g])
+            vPayload.push_back(HasHeader(script, header) ? &script : nullptr);
+    }
+
+    vData.clear();
+    for (size_t i = 0; i < columns.vOutTx.size(); i++) {
+        const CScript* pscript = vPayload[columns.vOutPayload[i]];
+        if (pscript) {
+            vData.emplace_back();
+            columns.GetData(i, *pscript, vData.back());
+        }
+    }
+
+    return true;
 }
 
 bool OPReturnDB::HaveBlockData(const uint256& hashBlock) const
 {
-    std::vector<OPReturnData> vData;
-    return GetBlockData(hashBlock, vData);
+    return Exists(std::make_pair(DB_OP_RETURN, hashBlock));
+}
+
+bool OPReturnDB::ReadBestBlock(CBlockLocator& locator) const
+{
+    return Read(DB_BEST_BLOCK, locator);
+}
+
+bool OPReturnDB::WriteBestBlock(const CBlockLocator& locator)
+{
+    return Write(DB_BEST_BLOCK, locator, true);
+}
+
+bool OPReturnDB::ReadIndexVersion(int& nVersion) const
+{
+    return Read(DB_OP_RETURN_VERSION, nVersion);
+}
+
+bool OPReturnDB::ResetBestBlock(int nVersion, bool fSearch)
+{
+    CDBBatch batch(*this);
+    batch.Erase(DB_BEST_BLOCK);
+    batch.Write(DB_OP_RETURN_VERSION, nVersion);
+    batch.Write(DB_OP_RETURN_SEARCH_FLAG, fSearch);
+
+    return WriteBatch(batch, true);
+}
+
+bool OPReturnDB::HaveSearchIndex() const
+{
+    bool fSearch = false;
+    return Read(DB_OP_RETURN_SEARCH_FLAG, fSearch) && fSearch;
+}
+
+struct CompareNewsByFee
+{
+    bool operator()(const OPReturnNews& a, const OPReturnNews& b) const
+    {
+        if (a.fees != b.fees)
+            return a.fees > b.fees;
+        if (a.nTime != b.nTime)
+            return a.nTime > b.nTime;
+        return a.txid < b.txid;
+    }
+};
+
+bool OPReturnDB::GetTopNews(const CScript& header, int64_t nTimeBegin, size_t nMax, std::vector<OPReturnNews>& vNews)
+{
+    if (header.size() < NEWS_HEADER_SIZE)
+        return false;
+
+    vNews.clear();
+    if (!nMax)
+        return true;
+
+    const unsigned char* pheader = &header[0];
+    uint32_t nDay = std::max(nTimeBegin, (int64_t)0) / NEWS_INDEX_BUCKET;
+
+    // Every day is sorted by fee, so the top news of the period are among
+    // the top nMax of each day
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(NewsIndexKey(pheader, nDay));
+
+    size_t nDayCount = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+
+        NewsIndexKey key;
+        if (!pcursor->GetKey(key) || key.key != DB_OP_RETURN_NEWS)
+            break;
+        if (memcmp(key.header, pheader, NEWS_HEADER_SIZE) != 0)
+            break;
+
+        if (key.nDay != nDay) {
+            nDay = key.nDay;
+            nDayCount = 0;
+        }
+
+        if (nDayCount == nMax) {
+            // Skip the rest of the day
+            pcursor->Seek(NewsIndexKey(pheader, nDay + 1));
+            continue;
+        }
+
+        NewsIndexValue value;
+        if (!pcursor->GetValue(value))
+            return false;
+
+        // The first day may start before the period does
+        if (value.nTime >= nTimeBegin) {
+            OPReturnNews news;
+            news.txid = key.txid;
+            news.n = key.n;
+            news.fees = std::numeric_limits<uint64_t>::max() - key.nInvertedFee;
+            news.nTime = value.nTime;
+            news.nHeight = value.nHeight;
+            news.script = value.script;
+            vNews.push_back(news);
+
+            nDayCount++;
+        }
+
+        pcursor->Next();
+    }
+
+    std::sort(vNews.begin(), vNews.end(), CompareNewsByFee());
+    if (vNews.size() > nMax)
+        vNews.resize(nMax);
+
+    return true;
+}
+
+bool OPReturnDB::SearchWords(const std::string& strPrefix, size_t nMaxRead, std::vector<OPReturnSearchEntry>& vEntry)
+{
+    vEntry.clear();
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(OPReturnSearchKey(strPrefix));
+    while (pcursor->Valid() && vEntry.size() < nMaxRead) {
+        OPReturnSearchKey key;
+        if (!pcursor->GetKey(key) || key.key != DB_OP_RETURN_SEARCH)
+            break;
+        if (key.word.compare(0, strPrefix.size(), strPrefix) != 0)
+            break;
+
+        OPReturnSearchValue value;
+        if (!pcursor->GetValue(value))
+            return false;
+
+        OPReturnSearchEntry entry;
+        entry.word = key.word;
+        entry.nHeight = std::numeric_limits<uint32_t>::max() - key.nInvertedHeight;
+        entry.hashBlock = key.hashBlock;
+        entry.nData = key.nData;
+        entry.txid = value.txid;
+        entry.fees = value.fees;
+        entry.nTime = value.nTime;
+        entry.script = value.script;
+        vEntry.push_back(entry);
+
+        pcursor->Next();
+    }
+    return true;
 }
 
 void OPReturnDB::GetNewsTypes(std::vector<NewsType>& vType)
@@ -418,6 +1382,102 @@ void OPReturnDB::EraseNewsType(uint256 hash)
     Erase(std::make_pair(DB_OP_RETURN_TYPES, hash));
 }
 
+CBlockStatsDB::CBlockStatsDB(size_t nCacheSize, bool fMemory, bool fWipe)
+    : CDBWrapper(GetDataDir() / "blocks" / "stats", nCacheSize, fMemory, fWipe) { }
+
+bool CBlockStatsDB::WriteBlockStats(const uint256& hashBlock, const BlockStats& stats)
+{
+    // Not synced - stats lost in a crash are rebuilt by -reindex-chainstate
+    return Write(std::make_pair(DB_BLOCK_STATS, hashBlock), stats);
+}
+
+bool CBlockStatsDB::ReadBlockStats(const uint256& hashBlock, BlockStats& stats) const
+{
+    return Read(std::make_pair(DB_BLOCK_STATS, hashBlock), stats);
+}
+
+bool CBlockStatsDB::WriteUTXOSetStats(const uint256& hashBlock, const UTXOSetStats& stats)
+{
+    // Not synced either, the statistics of the tip are recomputed at startup
+    // when they are missing
+    return Write(std::make_pair(DB_UTXO_SET_STATS, hashBlock), stats);
+}
+
+bool CBlockStatsDB::ReadUTXOSetStats(const uint256& hashBlock, UTXOSetStats& stats) const
+{
+    return Read(std::make_pair(DB_UTXO_SET_STATS, hashBlock), stats);
+}
+
+const size_t BlockStats::NUM_FEERATE_PERCENTILES;
+
+void BlockStats::SetFeeRatePercentiles(std::vector<std::pair<CAmount, int64_t>> vFeeRate)
+{
+    vFeeRatePercentiles.assign(NUM_FEERATE_PERCENTILES, 0);
+    if (vFeeRate.empty())
+        return;
+
+    std::sort(vFeeRate.begin(), vFeeRate.end());
+
+    int64_t nTotalWeight = 0;
+    for (const auto& pair : vFeeRate)
+        nTotalWeight += pair.second;
+
+    const double vWeight[NUM_FEERATE_PERCENTILES] = {
+        nTotalWeight / 10.0, nTotalWeight / 4.0, nTotalWeight / 2.0,
+        (nTotalWeight * 3.0) / 4.0, (nTotalWeight * 9.0) / 10.0
+    };
+
+    // Each percentile is the fee rate of the transaction whose weight
+    // crosses that fraction of the total
+    size_t nPercentile = 0;
+    int64_t nCumulative = 0;
+    for (const auto& pair : vFeeRate) {
+        nCumulative += pair.second;
+        while (nPercentile < NUM_FEERATE_PERCENTILES && nCumulative >= vWeight[nPercentile]) {
+            vFeeRatePercentiles[nPercentile] = pair.first;
+            nPercentile++;
+        }
+    }
+
+    for (; nPercentile < NUM_FEERATE_PERCENTILES; nPercentile++)
+        vFeeRatePercentiles[nPercentile] = vFeeRate.back().first;
+}
+
+/** The serialization of a coin hashed into the set hash of the UTXO set */
+static CDataStream CoinMuHashData(const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << outpoint;
+    ss << (uint32_t)(coin.nHeight * 2 + coin.fCoinBase);
+    ss << coin.out;
+    return ss;
+}
+
+/** The size gettxoutsetinfo has always reported for a coin */
+static uint64_t GetBogoSize(const CScript& scriptPubKey)
+{
+    return 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+           2 /* scriptPubKey len */ + scriptPubKey.size() /* scriptPubKey */;
+}
+
+void UTXOSetStats::AddCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = CoinMuHashData(outpoint, coin);
+    muhash.Insert((const unsigned char*)ss.data(), ss.size());
+    nTransactionOutputs++;
+    nBogoSize += GetBogoSize(coin.out.scriptPubKey);
+    totalAmount += coin.out.nValue;
+}
+
+void UTXOSetStats::RemoveCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    CDataStream ss = CoinMuHashData(outpoint, coin);
+    muhash.Remove((const unsigned char*)ss.data(), ss.size());
+    nTransactionOutputs--;
+    nBogoSize -= GetBogoSize(coin.out.scriptPubKey);
+    totalAmount -= coin.out.nValue;
+}
+
 std::string NewsType::GetShareURL() const
 {
     std::string str =
@@ -598,3 +1658,4 @@ bool CCoinsViewDB::Upgrade() {
 }
 
 
+
@@ -7,11 +7,19 @@
 #define BITCOIN_TXDB_H
 
 #include <coins.h>
+#include <crypto/muhash.h>
 #include <dbwrapper.h>
 #include <chain.h>
+#include <sync.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -37,9 +45,19 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! -dbcompactinterval default (hours, 0 = disabled)
+static const int64_t DEFAULT_DB_COMPACT_INTERVAL = 0;
 
 static const int64_t nOPReturnCache = 500;
 
+//! Number of bytes after OP_RETURN that identify the type of news
+static const size_t NEWS_HEADER_SIZE = 4;
+//! Length in seconds of the time buckets of the news index
+static const int64_t NEWS_INDEX_BUCKET = 24 * 60 * 60;
+
+//! -dbcache for the block statistics database (bytes)
+static const int64_t nBlockStatsCache = 1 << 20;
+
 struct CDiskTxPos : public CDiskBlockPos
 {
     unsigned int nTxOffset; // after header
@@ -65,13 +83,22 @@ struct CDiskTxPos : public CDiskBlockPos
     }
 };
 
-/** CCoinsView backed by the coin database (chainstate/) */
+/**
+ * CCoinsView backed by the coin database (chainstate/)
+ *
+ * A generation of changes can be handed to BatchWriteInBackground, which
+ * writes it on its own thread. The generation is read before the database
+ * until it is written, so the view always shows the state of its best
+ * block. The database is marked with the head blocks while the generation
+ * is written, which lets ReplayBlocks finish the write after a crash.
+ */
 class CCoinsViewDB final : public CCoinsView
 {
 protected:
     CDBWrapper db;
 public:
     explicit CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    ~CCoinsViewDB();
 
     bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
@@ -80,9 +107,50 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
 
+    //! Take the entries of mapCoins and write them on the writer thread.
+    //! Waits for the previous generation first. Returns false if it failed.
+    bool BatchWriteInBackground(CCoinsMap &mapCoins, const uint256 &hashBlock);
+    //! Wait for the generation being written. Returns false if it failed.
+    bool WaitForWrite() const;
+    //! Whether a generation is being written
+    bool IsWriting() const { return fWriting; }
+    //! Whether writing a generation failed, after which nothing is written
+    bool HasWriteFailed() const { return fWriteFailed; }
+    //! Memory used by the generation being written
+    size_t WritingMemoryUsage() const { return nWritingUsage; }
+
+    //! Mark the database as being written up to hashBlock by BulkWrite. The
+    //! marker stays until EndBulkWrite, and ReplayBlocks can't finish such a
+    //! write, so a node stopped in between needs -reindex-chainstate.
+    bool BeginBulkWrite(const uint256 &hashBlock);
+    //! Write coins directly, without a cache. Safe to call from several threads.
+    bool BulkWrite(const std::vector<std::pair<COutPoint, Coin>> &vCoins);
+    //! Mark the database as being at hashBlock again
+    bool EndBulkWrite(const uint256 &hashBlock);
+
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+
+    //! The database, for its statistics and compaction
+    const CDBWrapper& GetDB() const { return db; }
+
+private:
+    //! Write the dirty entries of mapCoins and mark the database as being at hashBlock
+    bool WriteCoins(const CCoinsMap &mapCoins, const uint256 &hashBlock);
+    void ThreadWrite();
+
+    //! Serializes starting and joining the writer thread
+    mutable CCriticalSection cs_writer;
+    mutable std::thread threadWrite;
+
+    //! Guards releasing pmapWriting, which the writer thread only reads
+    mutable CCriticalSection cs_writing;
+    std::unique_ptr<const CCoinsMap> pmapWriting;
+    uint256 hashWriting;
+    std::atomic<bool> fWriting;
+    std::atomic<bool> fWriteFailed;
+    std::atomic<size_t> nWritingUsage;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -107,6 +175,37 @@ private:
     friend class CCoinsViewDB;
 };
 
+/**
+ * Writes chunks of coins to a CCoinsViewDB on several threads, used to load
+ * a UTXO snapshot. Each chunk is serialized into a batch of its own, and
+ * LevelDB commits the batches of threads writing at the same time together.
+ */
+class CCoinsBulkWriter
+{
+public:
+    CCoinsBulkWriter(CCoinsViewDB& dbIn, int nThreads);
+    ~CCoinsBulkWriter();
+
+    //! Queue a chunk. Waits while the threads are behind.
+    void Add(std::vector<std::pair<COutPoint, Coin>>&& vCoins);
+    //! Wait for the chunks queued. Returns false if writing one failed.
+    bool Finish();
+
+private:
+    void ThreadWrite();
+
+    CCoinsViewDB& db;
+    const size_t nMaxQueued;
+
+    std::mutex cs;
+    std::condition_variable condWork;
+    std::condition_variable condSpace;
+    std::deque<std::vector<std::pair<COutPoint, Coin>>> queue;
+    bool fStop;
+    bool fFailed;
+    std::vector<std::thread> vThreads;
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
@@ -125,10 +224,21 @@ public:
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
+    //! The base block of a loaded UTXO snapshot, and its nChainTx
+    bool WriteSnapshotBase(const uint256 &hash, unsigned int nChainTx);
+    bool ReadSnapshotBase(uint256 &hash, unsigned int &nChainTx);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
 };
 
-/** Access to the sidechain database (blocks/sidechain/) */
+/**
+ * Access to the sidechain database (blocks/sidechain/)
+ *
+ * Block data is buffered in memory and written by Flush, which
+ * FlushStateToDisk calls right before flushing the coins cache. The data of
+ * every block up to the best block of the coins database is therefore on
+ * disk; blocks after it are connected again on startup, which writes their
+ * data again. Requires cs_main.
+ */
 class CSidechainTreeDB : public CDBWrapper
 {
 public:
@@ -138,6 +248,17 @@ public:
 
     bool GetBlockData(const uint256& /* hashBlock */, SidechainBlockData& data) const;
     bool HaveBlockData(const uint256& hashBlock) const;
+
+    //! Write the buffered block data and hashBestBlock in one synced batch
+    bool Flush(const uint256& hashBestBlock);
+    //! Best block of the last Flush
+    bool ReadBestBlock(uint256& hashBestBlock) const;
+    //! Serialized size of the buffered block data
+    size_t GetBufferedSize() const { return nBufferedSize; }
+
+private:
+    std::map<uint256, SidechainBlockData> mapBuffered;
+    size_t nBufferedSize = 0;
 };
 
 struct OPReturnData
@@ -158,6 +279,40 @@ struct OPReturnData
     }
 };
 
+/** An OP_RETURN output found through the news index of OPReturnDB */
+struct OPReturnNews
+{
+    uint256 txid;
+    uint32_t n;
+    CAmount fees;
+    int64_t nTime;
+    int nHeight;
+    CScript script;
+};
+
+/** A word of an OP_RETURN output in the search index of OPReturnDB */
+struct OPReturnSearchEntry
+{
+    std::string word;
+    int nHeight;
+    uint256 hashBlock;
+    //! Position of the output in the OP_RETURN data of the block
+    uint32_t nData;
+    uint256 txid;
+    CAmount fees;
+    int64_t nTime;
+    CScript script;
+};
+
+/** The OP_RETURN data of a block as the OP_RETURN index writes it */
+struct OPReturnBlock
+{
+    uint256 hashBlock;
+    std::vector<OPReturnData> vData;
+    std::vector<OPReturnNews> vNews;
+    std::vector<OPReturnSearchEntry> vSearch;
+};
+
 struct NewsType
 {
     // A series of bytes to distinguish this news
@@ -192,14 +347,147 @@ class OPReturnDB : public CDBWrapper
 {
 public:
     OPReturnDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
-    bool WriteBlockData(const std::pair<uint256, const std::vector<OPReturnData>>& data);
-
-    bool GetBlockData(const uint256& /* hashBlock */, std::vector<OPReturnData>& vData) const;
+    /** Write the OP_RETURN data of a block, vNews being the outputs of it
+     * that carry a news header (see GetTopNews) and vSearch the words of
+     * its outputs (see SearchWords) */
+    bool WriteBlockData(const uint256& hashBlock, const std::vector<OPReturnData>& vData, const std::vector<OPReturnNews>& vNews, const std::vector<OPReturnSearchEntry>& vSearch);
+    bool EraseBlockData(const uint256& hashBlock, const std::vector<OPReturnNews>& vNews, const std::vector<OPReturnSearchEntry>& vSearch);
+
+    /** Write the data of consecutive blocks together with the locator of the
+     * last one, in a single synced batch */
+    bool WriteBlocks(const std::vector<OPReturnBlock>& vBlock, const CBlockLocator& locator);
+
+    /** Erase the block data, the news index and the search index, keeping
+     * the news types, and forget the locator so that the index is built
+     * again with nVersion, with or without the search index */
+    bool WipeIndex(int nVersion, bool fSearch);
+
+    bool GetBlockData(const uint256& hashBlock, std::vector<OPReturnData>& vData);
+    /** Get the OP_RETURN data of a block whose script starts with header
+     * after OP_RETURN, reading only the payloads that may match */
+    bool GetBlockData(const uint256& hashBlock, const CScript& header, std::vector<OPReturnData>& vData);
     bool HaveBlockData(const uint256& hashBlock) const;
 
+    /** Locator of the last block the OP_RETURN index has written */
+    bool ReadBestBlock(CBlockLocator& locator) const;
+    bool WriteBestBlock(const CBlockLocator& locator);
+
+    /** Version of the data written by the OP_RETURN index */
+    bool ReadIndexVersion(int& nVersion) const;
+    /** Forget the locator so that the index is built again, recording the
+     * version it will be built with */
+    bool ResetBestBlock(int nVersion, bool fSearch);
+    /** Whether the index has been built with the search index */
+    bool HaveSearchIndex() const;
+
+    /**
+     * Get up to nMax news with the header of a news type from blocks with
+     * a time of at least nTimeBegin, highest fees first. News are keyed by
+     * header, day and fee, so this reads at most nMax entries per day.
+     */
+    bool GetTopNews(const CScript& header, int64_t nTimeBegin, size_t nMax, std::vector<OPReturnNews>& vNews);
+
+    /**
+     * Get the search index entries of the words starting with strPrefix,
+     * reading at most nMaxRead of them. Entries are keyed by word, then
+     * height, so the newest entries of each word come first.
+     */
+    bool SearchWords(const std::string& strPrefix, size_t nMaxRead, std::vector<OPReturnSearchEntry>& vEntry);
+
     void GetNewsTypes(std::vector<NewsType>& vType);
     void WriteNewsType(NewsType type);
     void EraseNewsType(uint256 hash);
 };
 
+/** Statistics of a connected block, recorded so that fee and volume
+ * queries do not have to read blocks back from disk */
+struct BlockStats
+{
+    //! Fee rate percentiles recorded: 10th, 25th, 50th, 75th and 90th
+    static const size_t NUM_FEERATE_PERCENTILES = 5;
+
+    int nHeight;
+    int64_t nTime;
+    unsigned int nTx;
+    unsigned int nSize;
+    unsigned int nWeight;
+    //! Weight of the transactions that pay fees (all but the coinbase)
+    int64_t nFeeWeight;
+    CAmount totalFees;
+    //! Fee rates in satoshi per virtual byte, weighted by transaction weight
+    std::vector<CAmount> vFeeRatePercentiles;
+    unsigned int nOPReturn;
+    //! Amount paid into sidechains by deposits
+    CAmount depositVolume;
+    //! Amount paid out of sidechains by withdrawal bundles
+    CAmount withdrawalVolume;
+
+    BlockStats() : nHeight(0), nTime(0), nTx(0), nSize(0), nWeight(0),
+        nFeeWeight(0), totalFees(0), nOPReturn(0), depositVolume(0),
+        withdrawalVolume(0) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nHeight);
+        READWRITE(nTime);
+        READWRITE(nTx);
+        READWRITE(nSize);
+        READWRITE(nWeight);
+        READWRITE(nFeeWeight);
+        READWRITE(totalFees);
+        READWRITE(vFeeRatePercentiles);
+        READWRITE(nOPReturn);
+        READWRITE(depositVolume);
+        READWRITE(withdrawalVolume);
+    }
+
+    /** Set the fee rate percentiles from the (fee rate, weight) pairs of
+     * the block's non-coinbase transactions */
+    void SetFeeRatePercentiles(std::vector<std::pair<CAmount, int64_t>> vFeeRate);
+};
+
+/** Statistics of the UTXO set as of a connected block. Each block's are
+ * those of its parent updated with the coins it creates and spends, so they
+ * can be answered for any height without scanning the set. */
+struct UTXOSetStats
+{
+    uint64_t nTransactionOutputs;
+    uint64_t nBogoSize;
+    CAmount totalAmount;
+    //! Amount held by the sidechains' CTIPs
+    CAmount escrowAmount;
+    //! Set hash of the serialized coins
+    MuHash3072 muhash;
+
+    UTXOSetStats() : nTransactionOutputs(0), nBogoSize(0), totalAmount(0),
+        escrowAmount(0) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nTransactionOutputs);
+        READWRITE(nBogoSize);
+        READWRITE(totalAmount);
+        READWRITE(escrowAmount);
+        READWRITE(muhash);
+    }
+
+    void AddCoin(const COutPoint& outpoint, const Coin& coin);
+    void RemoveCoin(const COutPoint& outpoint, const Coin& coin);
+};
+
+/** Access to the block statistics index (blocks/stats/) */
+class CBlockStatsDB : public CDBWrapper
+{
+public:
+    CBlockStatsDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    bool WriteBlockStats(const uint256& hashBlock, const BlockStats& stats);
+    bool ReadBlockStats(const uint256& hashBlock, BlockStats& stats) const;
+    bool WriteUTXOSetStats(const uint256& hashBlock, const UTXOSetStats& stats);
+    bool ReadUTXOSetStats(const uint256& hashBlock, UTXOSetStats& stats) const;
+};
+
 #endif // BITCOIN_TXDB_H
@@ -334,7 +334,7 @@ void CTxMemPoolEntry::UpdateAncestorState(int64_t modifySize, CAmount modifyFee,
 
 CTxMemPool::CTxMemPool(CBlockPolicyEstimator* estimator) :
     nTransactionsUpdated(0), fCriticalTxnAddedSinceBlock(false),
-    minerPolicyEstimator(estimator)
+    minerPolicyEstimator(estimator), nDeltaSequence(0)
 {
     _clear(); //lock free clear
 
@@ -368,6 +368,58 @@ void CTxMemPool::AddTransactionsUpdated(unsigned int n)
     nTransactionsUpdated += n;
 }
 
+static TxMempoolInfo GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
+    return TxMempoolInfo{it->GetSharedTx(), it->GetTime(), CFeeRate(it->GetFee(), it->GetTxSize()), it->GetModifiedFee() - it->GetFee(), it->GetFee(), it->GetTxWeight()};
+}
+
+std::string RemovalReasonToString(MemPoolRemovalReason reason)
+{
+    switch (reason) {
+    case MemPoolRemovalReason::UNKNOWN: return "unknown";
+    case MemPoolRemovalReason::EXPIRY: return "expiry";
+    case MemPoolRemovalReason::SIZELIMIT: return "sizelimit";
+    case MemPoolRemovalReason::REORG: return "reorg";
+    case MemPoolRemovalReason::BLOCK: return "block";
+    case MemPoolRemovalReason::CONFLICT: return "conflict";
+    case MemPoolRemovalReason::REPLACED: return "replaced";
+    }
+    return "unknown";
+}
+
+void CTxMemPool::AddDelta(TxMempoolDelta&& delta)
+{
+    AssertLockHeld(cs);
+    delta.nSequence = ++nDeltaSequence;
+    vDeltas.push_back(std::move(delta));
+    if (vDeltas.size() > MAX_MEMPOOL_DELTAS)
+        vDeltas.pop_front();
+}
+
+uint64_t CTxMemPool::GetDeltaSequence() const
+{
+    LOCK(cs);
+    return nDeltaSequence;
+}
+
+bool CTxMemPool::GetDeltas(uint64_t nSequence, std::vector<TxMempoolDelta>& vDeltaOut, uint64_t& nSequenceOut) const
+{
+    LOCK(cs);
+    vDeltaOut.clear();
+    nSequenceOut = nDeltaSequence;
+
+    if (nSequence > nDeltaSequence)
+        return false;
+    if (nSequence == nDeltaSequence)
+        return true;
+
+    // The deltas are numbered without gaps
+    if (vDeltas.empty() || vDeltas.front().nSequence > nSequence + 1)
+        return false;
+
+    vDeltaOut.assign(vDeltas.begin() + (nSequence + 1 - vDeltas.front().nSequence), vDeltas.end());
+    return true;
+}
+
 bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry, setEntries &setAncestors, bool validFeeEstimate)
 {
     NotifyEntryAdded(entry.GetSharedTx());
@@ -428,6 +480,16 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     if (!tx.criticalData.IsNull())
         fCriticalTxnAddedSinceBlock = true;
 
+    TxMempoolDelta delta;
+    delta.txid = hash;
+    delta.fAdded = true;
+    delta.nTime = newit->GetTime();
+    delta.nFee = newit->GetFee();
+    delta.nVsize = newit->GetTxSize();
+    delta.nValueOut = tx.GetValueOut();
+    delta.reason = MemPoolRemovalReason::UNKNOWN;
+    AddDelta(std::move(delta));
+
     return true;
 }
 
@@ -435,6 +497,17 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 {
     NotifyEntryRemoved(it->GetSharedTx(), reason);
     const uint256 hash = it->GetTx().GetHash();
+
+    TxMempoolDelta delta;
+    delta.txid = hash;
+    delta.fAdded = false;
+    delta.nTime = 0;
+    delta.nFee = 0;
+    delta.nVsize = 0;
+    delta.nValueOut = 0;
+    delta.reason = reason;
+    AddDelta(std::move(delta));
+
     for (const CTxIn& txin : it->GetTx().vin)
         mapNextTx.erase(txin.prevout);
 
@@ -616,6 +689,10 @@ void CTxMemPool::_clear()
     rollingMinimumFeeRate = 0;
     ++nTransactionsUpdated;
     fCriticalTxnAddedSinceBlock = false;
+
+    // Skip a sequence number so that subscribers start over
+    vDeltas.clear();
+    nDeltaSequence++;
 }
 
 void CTxMemPool::clear()
@@ -800,36 +877,6 @@ std::vector<CTxMemPool::indexed_transaction_set::const_iterator> CTxMemPool::Get
     return iters;
 }
 
-namespace {
-class TimeThenScoreComparator
-{
-public:
-    bool operator()(const CTxMemPool::indexed_transaction_set::const_iterator& a, const CTxMemPool::indexed_transaction_set::const_iterator& b)
-    {
-        int64_t timea = a->GetTime();
-        int64_t timeb = b->GetTime();
-        if (timea == timeb) {
-            return CompareTxMemPoolEntryByScore()(*a, *b);
-        }
-        return timea < timeb;
-    }
-};
-} // namespace
-
-std::vector<CTxMemPool::indexed_transaction_set::const_iterator> CTxMemPool::GetSortedTimeThenScore() const
-{
-    std::vector<indexed_transaction_set::const_iterator> iters;
-    AssertLockHeld(cs);
-
-    iters.reserve(mapTx.size());
-
-    for (indexed_transaction_set::iterator mi = mapTx.begin(); mi != mapTx.end(); ++mi) {
-        iters.push_back(mi);
-    }
-    std::sort(iters.begin(), iters.end(), TimeThenScoreComparator());
-    return iters;
-}
-
 void CTxMemPool::queryHashes(std::vector<uint256>& vtxid)
 {
     LOCK(cs);
@@ -843,10 +890,6 @@ void CTxMemPool::queryHashes(std::vector<uint256>& vtxid)
     }
 }
 
-static TxMempoolInfo GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
-    return TxMempoolInfo{it->GetSharedTx(), it->GetTime(), CFeeRate(it->GetFee(), it->GetTxSize()), it->GetModifiedFee() - it->GetFee(), it->GetFee(), it->GetTxWeight()};
-}
-
 std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
 {
     LOCK(cs);
@@ -865,19 +908,12 @@ std::vector<TxMempoolInfo> CTxMemPool::InfoRecent(int nTx) const
 {
     LOCK(cs);
 
-    std::vector<indexed_transaction_set::const_iterator> vIter;
-    vIter = GetSortedTimeThenScore();
-
-    // Get info for nTx latest transactions that were added to vTxHashes
     std::vector<TxMempoolInfo> vInfo;
-    int nCount = 0;
-    for (auto rit = vIter.rbegin(); rit != vIter.rend(); rit++) {
-        if (nCount >= nTx)
-            break;
-
-        TxMempoolInfo info = GetInfo(*rit);
-        vInfo.push_back(GetInfo(*rit));
-        nCount++;
+    const auto& index = mapTx.get<insertion_order>();
+    auto it = index.end();
+    while (it != index.begin() && (int)vInfo.size() < nTx) {
+        it--;
+        vInfo.push_back(GetInfo(mapTx.project<0>(it)));
     }
 
     return vInfo;
@@ -975,8 +1011,8 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
 
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    // Estimate the overhead of mapTx to be 14 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 14 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPoolRemovalReason reason) {
@@ -6,6 +6,7 @@
 #ifndef BITCOIN_TXMEMPOOL_H
 #define BITCOIN_TXMEMPOOL_H
 
+#include <deque>
 #include <memory>
 #include <set>
 #include <map>
@@ -330,6 +331,7 @@ public:
 struct descendant_score {};
 struct entry_time {};
 struct ancestor_score {};
+struct insertion_order {};
 
 class CBlockPolicyEstimator;
 
@@ -370,6 +372,30 @@ enum class MemPoolRemovalReason {
     REPLACED     //! Removed for replacement
 };
 
+std::string RemovalReasonToString(MemPoolRemovalReason reason);
+
+/** Number of mempool additions and removals kept for CTxMemPool::GetDeltas */
+static const size_t MAX_MEMPOOL_DELTAS = 5000;
+
+/**
+ * A transaction added to or removed from the mempool. Deltas are numbered
+ * by a sequence number that increases by one with every delta.
+ */
+struct TxMempoolDelta
+{
+    uint64_t nSequence;
+    uint256 txid;
+    bool fAdded;
+    /** Time, fee, virtual size and value out of an added transaction. The
+     * transaction itself isn't kept so that removed ones can be freed. */
+    int64_t nTime;
+    CAmount nFee;
+    int64_t nVsize;
+    CAmount nValueOut;
+    /** Reason of a removed transaction */
+    MemPoolRemovalReason reason;
+};
+
 class SaltedTxidHasher
 {
 private:
@@ -464,6 +490,9 @@ private:
     bool fCriticalTxnAddedSinceBlock;
     CBlockPolicyEstimator* minerPolicyEstimator;
 
+    uint64_t nDeltaSequence; //!< Sequence number of the latest delta
+    std::deque<TxMempoolDelta> vDeltas; //!< The latest MAX_MEMPOOL_DELTAS deltas, oldest first
+
     uint64_t totalTxSize;      //!< sum of all mempool tx's virtual sizes. Differs from serialized tx size since witness data is discounted. Defined in BIP 141.
     uint64_t cachedInnerUsage; //!< sum of dynamic memory usage of all the map elements (NOT the maps themselves)
 
@@ -473,6 +502,8 @@ private:
 
     void trackPackageRemoved(const CFeeRate& rate);
 
+    void AddDelta(TxMempoolDelta&& delta);
+
 public:
 
     static const int ROLLING_FEE_HALFLIFE = 60 * 60 * 12; // public only for testing
@@ -499,6 +530,10 @@ public:
                 boost::multi_index::tag<ancestor_score>,
                 boost::multi_index::identity<CTxMemPoolEntry>,
                 CompareTxMemPoolEntryByAncestorFee
+            >,
+            // in the order the transactions were added
+            boost::multi_index::sequenced<
+                boost::multi_index::tag<insertion_order>
             >
         >
     > indexed_transaction_set;
@@ -548,7 +583,6 @@ private:
     void UpdateChild(txiter entry, txiter child, bool add);
 
     std::vector<indexed_transaction_set::const_iterator> GetSortedDepthAndScore() const;
-    std::vector<indexed_transaction_set::const_iterator> GetSortedTimeThenScore() const;
 
 public:
     indirectmap<COutPoint, const CTransaction*> mapNextTx;
@@ -684,8 +718,20 @@ public:
     TxMempoolInfo info(const uint256& hash) const;
     std::vector<TxMempoolInfo> infoAll() const;
 
+    /** Get the info of the nTx transactions added last, newest first */
     std::vector<TxMempoolInfo> InfoRecent(int nTx) const;
 
+    /** Sequence number of the latest addition or removal */
+    uint64_t GetDeltaSequence() const;
+
+    /**
+     * Get the additions and removals after nSequence, oldest first, and the
+     * sequence number to pass in next time. Returns false if some of them
+     * are no longer kept, in which case the caller has to start over from
+     * InfoRecent or infoAll.
+     */
+    bool GetDeltas(uint64_t nSequence, std::vector<TxMempoolDelta>& vDeltaOut, uint64_t& nSequenceOut) const;
+
     size_t DynamicMemoryUsage() const;
 
     boost::signals2::signal<void (CTransactionRef)> NotifyEntryAdded;
@@ -768,7 +814,6 @@ public:
 
 // multi_index tag names
 struct txid_index {};
-struct insertion_order {};
 
 struct DisconnectedBlockTransactions {
     typedef boost::multi_index_container<
@@ -18,6 +18,7 @@
 #include <hash.h>
 #include <init.h>
 #include <merkleblock.h>
+#include <opreturnindex.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
@@ -44,8 +45,11 @@
 #include <versionbits.h>
 #include <warnings.h>
 
+#include <condition_variable>
+#include <deque>
 #include <future>
 #include <sstream>
+#include <thread>
 #include <tuple>
 
 #include <boost/algorithm/string/replace.hpp>
@@ -93,6 +97,32 @@ enum DisconnectResult
 };
 
 class ConnectTrace;
+class CBlockPrefetcher;
+
+/** The data of a block's transactions that doesn't depend on the UTXO set */
+struct PrecomputedBlockData
+{
+    std::vector<PrecomputedTransactionData> txdata;
+    std::vector<int64_t> vTxWeight;
+    unsigned int nOPReturn;
+
+    explicit PrecomputedBlockData(const CBlock& block) : nOPReturn(0)
+    {
+        txdata.reserve(block.vtx.size()); // Required so that pointers to individual PrecomputedTransactionData don't get invalidated
+        vTxWeight.reserve(block.vtx.size());
+        for (const auto& tx : block.vtx) {
+            txdata.emplace_back(*tx);
+            vTxWeight.push_back(GetTransactionWeight(*tx));
+
+            // Count OP_RETURN outputs. Their data is indexed in the background
+            // by the OP_RETURN index.
+            for (const CTxOut& o : tx->vout) {
+                if (!o.scriptPubKey.empty() && o.scriptPubKey[0] == OP_RETURN)
+                    nOPReturn++;
+            }
+        }
+    }
+};
 
 /**
  * CChainState stores and provides an API to update our local knowledge of the
@@ -161,11 +191,13 @@ public:
 
     bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex);
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fRequested,  const CDiskBlockPos* dbp, bool* fNewBlock, bool fFromDisk = false);
+    bool AcceptIndexedBlock(const CBlockHeader& header, unsigned int nTx, const CDiskBlockPos& pos, unsigned int nSize, CValidationState& state, const CChainParams& chainparams);
 
     // Block (dis)connection on a given view:
     DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view);
     bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false);
+                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false,
+                    PrecomputedBlockData* pprecomputed = nullptr);
 
     // Block disconnection on our pcoinsTip:
     bool DisconnectTip(CValidationState& state, const CChainParams& chainparams, DisconnectedBlockTransactions *disconnectpool);
@@ -181,11 +213,14 @@ public:
 
     void PruneBlockIndexCandidates();
 
+    /** Make the base block of a loaded UTXO snapshot the tip */
+    void ActivateSnapshot(CBlockIndex* pindexBase, unsigned int nChainTx);
+
     void UnloadBlockIndex();
 
 private:
-    bool ActivateBestChainStep(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace);
-    bool ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool);
+    bool ActivateBestChainStep(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace, CBlockPrefetcher* pprefetcher);
+    bool ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool, CBlockPrefetcher* pprefetcher);
 
     CBlockIndex* AddToBlockIndex(const CBlockHeader& block);
     /** Create a new block index entry for a given block hash */
@@ -194,7 +229,7 @@ private:
 
     void InvalidBlockFound(CBlockIndex *pindex, const CValidationState &state);
     CBlockIndex* FindMostWorkChain();
-    bool ReceivedBlockTransactions(const CBlock &block, CValidationState& state, CBlockIndex *pindexNew, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
+    bool ReceivedBlockTransactions(unsigned int nTx, CValidationState& state, CBlockIndex *pindexNew, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 
 
     bool RollforwardBlock(const CBlockIndex* pindex, CCoinsViewCache& inputs, const CChainParams& params);
@@ -207,6 +242,7 @@ CCriticalSection cs_main;
 BlockMap& mapBlockIndex = g_chainstate.mapBlockIndex;
 CChain& chainActive = g_chainstate.chainActive;
 CBlockIndex *pindexBestHeader = nullptr;
+CBlockIndex *pindexSnapshotBase = nullptr;
 CWaitableCriticalSection csBestBlock;
 CConditionVariable cvBlockChange;
 int nScriptCheckThreads = 0;
@@ -288,6 +324,7 @@ std::unique_ptr<CCoinsViewCache> pcoinsTip;
 std::unique_ptr<CBlockTreeDB> pblocktree;
 std::unique_ptr<CSidechainTreeDB> psidechaintree;
 std::unique_ptr<OPReturnDB> popreturndb;
+std::unique_ptr<CBlockStatsDB> pblockstatsdb;
 
 enum FlushStateMode {
     FLUSH_STATE_NONE,
@@ -302,6 +339,7 @@ static void FindFilesToPruneManual(std::set<int>& setFilesToPrune, int nManualPr
 static void FindFilesToPrune(std::set<int>& setFilesToPrune, uint64_t nPruneAfterHeight);
 bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsViewCache &inputs, bool fScriptChecks, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata, std::vector<CScriptCheck> *pvChecks = nullptr);
 static FILE* OpenUndoFile(const CDiskBlockPos &pos, bool fReadOnly = false);
+static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev, bool fFromDisk = false);
 
 bool CheckFinalTx(const CTransaction &tx, int flags)
 {
@@ -1635,38 +1673,13 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
     return true;
 }
 
-namespace {
-
-bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
 {
-    // Open history file to append
-    CAutoFile fileout(OpenUndoFile(pos), SER_DISK, CLIENT_VERSION);
-    if (fileout.IsNull())
-        return error("%s: OpenUndoFile failed", __func__);
-
-    // Write index header
-    unsigned int nSize = GetSerializeSize(fileout, blockundo);
-    fileout << FLATDATA(messageStart) << nSize;
-
-    // Write undo data
-    long fileOutPos = ftell(fileout.Get());
-    if (fileOutPos < 0)
-        return error("%s: ftell failed", __func__);
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << blockundo;
-
-    // calculate & write checksum
-    CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
-    hasher << hashBlock;
-    hasher << blockundo;
-    fileout << hasher.GetHash();
-
-    return true;
+    return UndoReadFromDisk(blockundo, pindex->GetUndoPos(), pindex->pprev->GetBlockHash());
 }
 
-static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashPrevBlock)
 {
-    CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
         return error("%s: no undo data available", __func__);
     }
@@ -1680,7 +1693,7 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     uint256 hashChecksum;
     CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
     try {
-        verifier << pindex->pprev->GetBlockHash();
+        verifier << hashPrevBlock;
         verifier >> blockundo;
         filein >> hashChecksum;
     }
@@ -1695,6 +1708,35 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     return true;
 }
 
+namespace {
+
+bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
+{
+    // Open history file to append
+    CAutoFile fileout(OpenUndoFile(pos), SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull())
+        return error("%s: OpenUndoFile failed", __func__);
+
+    // Write index header
+    unsigned int nSize = GetSerializeSize(fileout, blockundo);
+    fileout << FLATDATA(messageStart) << nSize;
+
+    // Write undo data
+    long fileOutPos = ftell(fileout.Get());
+    if (fileOutPos < 0)
+        return error("%s: ftell failed", __func__);
+    pos.nPos = (unsigned int)fileOutPos;
+    fileout << blockundo;
+
+    // calculate & write checksum
+    CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
+    hasher << hashBlock;
+    hasher << blockundo;
+    fileout << hasher.GetHash();
+
+    return true;
+}
+
 /** Abort with a message */
 bool AbortNode(const std::string& strMessage, const std::string& userMessage="")
 {
@@ -1987,11 +2029,32 @@ static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
 static int64_t nBlocksTotal = 0;
 
+/** Fill in the statistics that only depend on the block itself */
+static void SetBlockStatsHeader(BlockStats& stats, const CBlock& block, const CBlockIndex* pindex)
+{
+    stats.nHeight = pindex->nHeight;
+    stats.nTime = block.GetBlockTime();
+    stats.nTx = block.vtx.size();
+    stats.nSize = ::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+    stats.nWeight = ::GetBlockWeight(block);
+}
+
+/** Amount held by the CTIPs of the sidechains, as SCDB has them */
+static CAmount GetEscrowAmount()
+{
+    CAmount amount = 0;
+    for (const std::pair<uint8_t, SidechainCTIP>& ctip : scdb.GetCTIP())
+        amount += ctip.second.amount;
+    return amount;
+}
+
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
- *  can fail if those validity checks fail (among other reasons). */
+ *  can fail if those validity checks fail (among other reasons).
+ *  pprecomputed may hold the block's PrecomputedBlockData, prepared ahead of time. */
 bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck)
+                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck,
+                  PrecomputedBlockData* pprecomputed)
 {
     AssertLockHeld(cs_main);
     assert(pindex);
@@ -2023,13 +2086,28 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     // Special case for the genesis block, skipping connection of its transactions
     // (its coinbase is unspendable)
     if (block.GetHash() == chainparams.GetConsensus().hashGenesisBlock) {
-        if (!fJustCheck)
+        if (!fJustCheck) {
             view.SetBestBlock(pindex->GetBlockHash());
+
+            BlockStats stats;
+            SetBlockStatsHeader(stats, block, pindex);
+            stats.SetFeeRatePercentiles({});
+            if (!pblockstatsdb->WriteBlockStats(block.GetHash(), stats))
+                return state.Error("Failed to write block statistics!");
+            if (!pblockstatsdb->WriteUTXOSetStats(block.GetHash(), UTXOSetStats()))
+                return state.Error("Failed to write UTXO set statistics!");
+        }
         return true;
     }
 
     nBlocksTotal++;
 
+    // ReindexBlockFiles indexed the block without the checks of AcceptBlock,
+    // CheckBlock ran above
+    if ((pindex->nStatus & BLOCK_UNCHECKED) &&
+            !ContextualCheckBlock(block, state, chainparams.GetConsensus(), pindex->pprev, true /* fFromDisk */))
+        return error("%s: Consensus::ContextualCheckBlock: %s", __func__, FormatStateMessage(state));
+
     bool fScriptChecks = true;
     if (!hashAssumeValid.IsNull()) {
         // We've been configured with the hash of a block which has been externally verified to have a valid history.
@@ -2120,39 +2198,24 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     int nInputs = 0;
     int64_t nSigOpsCost = 0;
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
-    std::vector<PrecomputedTransactionData> txdata;
-    txdata.reserve(block.vtx.size()); // Required so that pointers to individual PrecomputedTransactionData don't get invalidated
+    std::unique_ptr<PrecomputedBlockData> pprecomputedHere;
+    if (!pprecomputed || pprecomputed->txdata.size() != block.vtx.size()) {
+        pprecomputedHere.reset(new PrecomputedBlockData(block));
+        pprecomputed = pprecomputedHere.get();
+    }
+    std::vector<PrecomputedTransactionData>& txdata = pprecomputed->txdata;
     std::vector<std::tuple<CTransaction, int, uint256>> vDepositTx;
     std::vector<std::tuple<uint8_t, CTransaction, int>> vWithdrawalToSpend;
-    std::vector<OPReturnData> vOPReturnData;
+    std::vector<CAmount> vTxFee(block.vtx.size(), CAmount(0));
+    BlockStats stats;
+    stats.nOPReturn = pprecomputed->nOPReturn;
+    std::vector<std::pair<CAmount, int64_t>> vFeeRate;
     for (unsigned int i = 0; i < block.vtx.size(); i++)
     {
         const CTransaction &tx = *(block.vtx[i]);
 
         nInputs += tx.vin.size();
 
-        // Search for OP_RETURN outputs
-        for (const CTxOut& o : tx.vout) {
-            const CScript scriptPubKey = o.scriptPubKey;
-            if (!scriptPubKey.size())
-                continue;
-            if (scriptPubKey[0] != OP_RETURN)
-                continue;
-
-            OPReturnData data;
-            data.txid = tx.GetHash();
-            data.script = scriptPubKey;
-            data.nSize = ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
-
-            // Using CheckTxInputs to calculate fees and copy to OP_RETURN data
-            data.fees = CAmount(0);
-            if (!tx.IsCoinBase() && !Consensus::CheckTxInputs(tx, state, view, pindex->nHeight, data.fees)) {
-                return error("%s: OP_RETURN DB fee calculation CheckTxInputs: %s, %s", __func__, tx.GetHash().ToString(), FormatStateMessage(state));
-            }
-
-            vOPReturnData.push_back(data);
-        }
-
         bool fSidechainInputs = false;
         uint8_t nSidechain = 0;
         if (!tx.IsCoinBase())
@@ -2162,11 +2225,17 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
                 return error("%s: Consensus::CheckTxInputs: %s, %s", __func__, tx.GetHash().ToString(), FormatStateMessage(state));
             }
             nFees += txfee;
+            vTxFee[i] = txfee;
             if (!MoneyRange(nFees)) {
                 return state.DoS(100, error("%s: accumulated fee in the block out of range.", __func__),
                                  REJECT_INVALID, "bad-txns-accumulated-fee-outofrange");
             }
 
+            int64_t nTxWeight = pprecomputed->vTxWeight[i];
+            int64_t nTxVSize = (nTxWeight + WITNESS_SCALE_FACTOR - 1) / WITNESS_SCALE_FACTOR;
+            vFeeRate.emplace_back(txfee / nTxVSize, nTxWeight);
+            stats.nFeeWeight += nTxWeight;
+
             if (!view.HaveInputs(tx))
                 return state.DoS(100, error("ConnectBlock(): inputs missing/spent"),
                                  REJECT_INVALID, "bad-txns-inputs-missingorspent");
@@ -2205,7 +2274,6 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             return state.DoS(100, error("ConnectBlock(): too many sigops"),
                              REJECT_INVALID, "bad-blk-sigops");
 
-        txdata.emplace_back(tx);
         if (!tx.IsCoinBase())
         {
             std::vector<CScriptCheck> vChecks;
@@ -2252,6 +2320,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
                 // and then tracking it to spend later in the function
                 if (scdb.SpendWithdrawal(nSidechain, block.GetHash(), tx, i, true /* fJustCheck */, true /* fDebug */)) {
                     vWithdrawalToSpend.push_back(std::make_tuple(nSidechain, tx, i));
+                    stats.withdrawalVolume += amtSidechainUTXO - amtReturning;
                 } else {
                     return error("ConnectBlock(): Spend Withdrawal failed (blind Withdrawal hash : txid): %s : %s", hashBlind.ToString(), tx.GetHash().ToString());
                 }
@@ -2269,8 +2338,18 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
                     break;
                 }
             }
-            if (fSidechainOutput)
+            if (fSidechainOutput) {
                 vDepositTx.push_back(std::make_tuple(tx, i, block.GetHash()));
+
+                // Withdrawal change paid back to the sidechain is not counted
+                CAmount amtSidechainUTXO = CAmount(0);
+                CAmount amtUserInput = CAmount(0);
+                CAmount amtReturning = CAmount(0);
+                CAmount amtWithdrawn = CAmount(0);
+                GetSidechainValues(view, tx, amtSidechainUTXO, amtUserInput, amtReturning, amtWithdrawn);
+                if (amtReturning > amtSidechainUTXO)
+                    stats.depositVolume += amtReturning - amtSidechainUTXO;
+            }
         }
 
         CTxUndo undoDummy;
@@ -2349,6 +2428,10 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         pindex->RaiseValidity(BLOCK_VALID_SCRIPTS);
         setDirtyBlockIndex.insert(pindex);
     }
+    if (pindex->nStatus & BLOCK_UNCHECKED) {
+        pindex->nStatus &= ~BLOCK_UNCHECKED;
+        setDirtyBlockIndex.insert(pindex);
+    }
 
     if (!WriteTxIndexDataForBlock(block, state, pindex))
         return false;
@@ -2377,11 +2460,37 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         return state.Error("Failed to write sidechain block data!");
     }
 
-    if (vOPReturnData.size() && !popreturndb->HaveBlockData(block.GetHash()) &&
-            !popreturndb->WriteBlockData(
-                std::make_pair(block.GetHash(), vOPReturnData)))
-    {
-        return state.Error("Failed to write block OP_RETURN data!");
+    // Hand the fees to the OP_RETURN index, which picks them up when the
+    // block connected notification arrives
+    if (g_opreturn_index)
+        g_opreturn_index->CacheBlockFees(block.GetHash(), std::move(vTxFee));
+
+    SetBlockStatsHeader(stats, block, pindex);
+    stats.totalFees = nFees;
+    stats.SetFeeRatePercentiles(std::move(vFeeRate));
+    if (!pblockstatsdb->WriteBlockStats(block.GetHash(), stats))
+        return state.Error("Failed to write block statistics!");
+
+    // Update the parent's UTXO set statistics with the coins of this block.
+    // Without them (the block connects below where InitUTXOSetStats started
+    // or below a snapshot) there is nothing to update.
+    UTXOSetStats utxostats;
+    if (pblockstatsdb->ReadUTXOSetStats(hashPrevBlock, utxostats)) {
+        for (size_t i = 0; i < block.vtx.size(); i++) {
+            const CTransaction& tx = *block.vtx[i];
+            for (size_t j = 0; j < tx.vout.size(); j++) {
+                if (!tx.vout[j].scriptPubKey.IsUnspendable())
+                    utxostats.AddCoin(COutPoint(tx.GetHash(), j), Coin(tx.vout[j], pindex->nHeight, tx.IsCoinBase()));
+            }
+            if (i > 0) {
+                const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+                for (size_t j = 0; j < tx.vin.size(); j++)
+                    utxostats.RemoveCoin(tx.vin[j].prevout, txundo.vprevout[j]);
+            }
+        }
+        utxostats.escrowAmount = GetEscrowAmount();
+        if (!pblockstatsdb->WriteUTXOSetStats(block.GetHash(), utxostats))
+            return state.Error("Failed to write UTXO set statistics!");
     }
 
     assert(pindex->phashBlock);
@@ -2443,18 +2552,28 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             nLastSetChain = nNow;
         }
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
+        // A failed background write of the coins is reported by the next call
+        if (pcoinsdbview->HasWriteFailed())
+            return AbortNode(state, "Failed to write to coin database");
+        // The generation of coins still being written counts as cache.
+        // Block data of the sidechain tree is buffered until the coins flush
+        bool fWriting = pcoinsdbview->IsWriting();
+        int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() + pcoinsdbview->WritingMemoryUsage() + psidechaintree->GetBufferedSize();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
-        bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
+        // Nothing is gained by waiting for the generation being written.
+        bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && !fWriting && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
         // The cache is over the limit, we have to write now.
         bool fCacheCritical = mode == FLUSH_STATE_IF_NEEDED && cacheSize > nTotalSpace;
         // It's been a while since we wrote the block index to disk. Do this frequently, so we don't need to redownload after a crash.
         bool fPeriodicWrite = mode == FLUSH_STATE_PERIODIC && nNow > nLastWrite + (int64_t)DATABASE_WRITE_INTERVAL * 1000000;
         // It's been very long since we flushed the cache. Do this infrequently, to optimize cache usage.
-        bool fPeriodicFlush = mode == FLUSH_STATE_PERIODIC && nNow > nLastFlush + (int64_t)DATABASE_FLUSH_INTERVAL * 1000000;
+        bool fPeriodicFlush = mode == FLUSH_STATE_PERIODIC && !fWriting && nNow > nLastFlush + (int64_t)DATABASE_FLUSH_INTERVAL * 1000000;
         // Combine all conditions that result in a full cache flush.
         fDoFullFlush = (mode == FLUSH_STATE_ALWAYS) || fCacheLarge || fCacheCritical || fPeriodicFlush || fFlushForPrune;
+        // Only shutdown, RPC callers and pruning need the coins on disk
+        // when this returns, the rest is written in the background.
+        bool fBackgroundFlush = fDoFullFlush && mode != FLUSH_STATE_ALWAYS && !fFlushForPrune;
         // Write blocks and block index to disk.
         if (fDoFullFlush || fPeriodicWrite) {
             // Depend on nMinDiskSpace to ensure we can write block index
@@ -2494,9 +2613,22 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // overwrite one. Still, use a conservative safety factor of 2.
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
+            // Write the sidechain data of the blocks the chainstate is about
+            // to include, so it is on disk for every block up to the best
+            // block of the coins database.
+            if (!psidechaintree->Flush(pcoinsTip->GetBestBlock()))
+                return AbortNode(state, "Failed to write to sidechain database");
             // Flush the chainstate (which may refer to block index entries).
-            if (!pcoinsTip->Flush())
+            if (fBackgroundFlush) {
+                // Hand the modified coins to the writer thread and keep
+                // the unmodified ones warm in up to half of the cache.
+                CCoinsMap mapDirty;
+                pcoinsTip->ExtractDirty(mapDirty, nTotalSpace / 2);
+                if (!pcoinsdbview->BatchWriteInBackground(mapDirty, pcoinsTip->GetBestBlock()))
+                    return AbortNode(state, "Failed to write to coin database");
+            } else if (!pcoinsTip->Flush()) {
                 return AbortNode(state, "Failed to write to coin database");
+            }
             nLastFlush = nNow;
         }
     }
@@ -2642,6 +2774,150 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
     return true;
 }
 
+/**
+ * Reads the blocks ActivateBestChainStep is about to connect on worker
+ * threads, while the blocks before them are connected. The threads also do
+ * the checks and hashing that don't need the UTXO set: deserialization and
+ * txids, CheckBlock with the merkle root, and the PrecomputedBlockData. The
+ * thread holding cs_main is left with the UTXO lookups and updates.
+ */
+class CBlockPrefetcher
+{
+private:
+    struct Entry {
+        CDiskBlockPos pos;
+        uint256 hash;
+        bool fStarted = false;
+        bool fDone = false;
+        std::shared_ptr<CBlock> pblock;
+        std::unique_ptr<PrecomputedBlockData> pdata;
+    };
+
+    const Consensus::Params& consensusParams;
+
+    //! How many blocks to prepare ahead
+    const size_t nMaxBlocks;
+
+    std::mutex cs;
+    std::condition_variable condWork;
+    std::condition_variable condDone;
+
+    //! The blocks being prepared, and the order to start them in
+    std::map<const CBlockIndex*, Entry> mapEntries;
+    std::deque<const CBlockIndex*> queue;
+
+    bool fStop;
+    std::vector<std::thread> vThreads;
+
+    void ThreadPrefetch()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        while (true) {
+            condWork.wait(lock, [this]{ return fStop || !queue.empty(); });
+            if (fStop)
+                return;
+
+            const CBlockIndex* pindex = queue.front();
+            queue.pop_front();
+            auto it = mapEntries.find(pindex);
+            if (it == mapEntries.end() || it->second.fStarted)
+                continue;
+            it->second.fStarted = true;
+            const CDiskBlockPos pos = it->second.pos;
+            const uint256 hash = it->second.hash;
+            lock.unlock();
+
+            std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+            std::unique_ptr<PrecomputedBlockData> pdata;
+            if (ReadBlockFromDisk(*pblock, pos, consensusParams) && pblock->GetHash() == hash) {
+                // A block failing the checks is checked again by
+                // ConnectBlock, which reports why
+                CValidationState state;
+                CheckBlock(*pblock, state, consensusParams);
+                pdata.reset(new PrecomputedBlockData(*pblock));
+            } else {
+                pblock.reset();
+            }
+
+            // Entries being prepared are left in the map until taken
+            lock.lock();
+            it->second.pblock = std::move(pblock);
+            it->second.pdata = std::move(pdata);
+            it->second.fDone = true;
+            condDone.notify_all();
+        }
+    }
+
+public:
+    CBlockPrefetcher(const Consensus::Params& consensusParamsIn, size_t nMaxBlocksIn, int nThreads) :
+        consensusParams(consensusParamsIn), nMaxBlocks(nMaxBlocksIn), fStop(false)
+    {
+        for (int i = 0; i < nThreads; i++)
+            vThreads.emplace_back(&CBlockPrefetcher::ThreadPrefetch, this);
+    }
+
+    ~CBlockPrefetcher()
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            fStop = true;
+        }
+        condWork.notify_all();
+        for (std::thread& thread : vThreads)
+            thread.join();
+    }
+
+    //! Prepare the first blocks of vpindex, given in the order they are to
+    //! be connected, and forget the blocks that are no longer among them
+    void Schedule(const std::vector<const CBlockIndex*>& vpindex)
+    {
+        AssertLockHeld(cs_main);
+        std::set<const CBlockIndex*> setAhead;
+
+        std::unique_lock<std::mutex> lock(cs);
+        for (const CBlockIndex* pindex : vpindex) {
+            if (setAhead.size() >= nMaxBlocks || !(pindex->nStatus & BLOCK_HAVE_DATA))
+                break;
+            setAhead.insert(pindex);
+            if (mapEntries.count(pindex))
+                continue;
+
+            Entry& entry = mapEntries[pindex];
+            entry.pos = pindex->GetBlockPos();
+            entry.hash = pindex->GetBlockHash();
+            queue.push_back(pindex);
+        }
+
+        for (auto it = mapEntries.begin(); it != mapEntries.end(); ) {
+            if (!setAhead.count(it->first) && (!it->second.fStarted || it->second.fDone))
+                it = mapEntries.erase(it);
+            else
+                it++;
+        }
+        condWork.notify_all();
+    }
+
+    /**
+     * Get the block of pindex and its PrecomputedBlockData, waiting for them
+     * if a thread is preparing them. Returns nullptr if the block wasn't
+     * scheduled, no thread got to it yet or it couldn't be read; the caller
+     * reads it itself then.
+     */
+    std::shared_ptr<const CBlock> Take(const CBlockIndex* pindex, std::unique_ptr<PrecomputedBlockData>& pdata)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        auto it = mapEntries.find(pindex);
+        if (it == mapEntries.end())
+            return nullptr;
+
+        condDone.wait(lock, [&it]{ return !it->second.fStarted || it->second.fDone; });
+        std::shared_ptr<const CBlock> pblock = std::move(it->second.pblock);
+        pdata = std::move(it->second.pdata);
+        mapEntries.erase(it);
+        return pblock;
+    }
+};
+
 static int64_t nTimeReadFromDisk = 0;
 static int64_t nTimeConnectTotal = 0;
 static int64_t nTimeFlush = 0;
@@ -2719,17 +2995,22 @@ public:
  *
  * The block is added to connectTrace if connection succeeds.
  */
-bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool)
+bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions &disconnectpool, CBlockPrefetcher* pprefetcher)
 {
     assert(pindexNew->pprev == chainActive.Tip());
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
     std::shared_ptr<const CBlock> pthisBlock;
+    std::unique_ptr<PrecomputedBlockData> pprecomputed;
     if (!pblock) {
-        std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
-        if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
-            return AbortNode(state, "Failed to read block");
-        pthisBlock = pblockNew;
+        if (pprefetcher)
+            pthisBlock = pprefetcher->Take(pindexNew, pprecomputed);
+        if (!pthisBlock) {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
+                return AbortNode(state, "Failed to read block");
+            pthisBlock = pblockNew;
+        }
     } else {
         pthisBlock = pblock;
     }
@@ -2740,7 +3021,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
     {
         CCoinsViewCache view(pcoinsTip.get());
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams, false, pprecomputed.get());
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -2855,7 +3136,7 @@ void CChainState::PruneBlockIndexCandidates() {
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to pindexMostWork.
  */
-bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace)
+bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace, CBlockPrefetcher* pprefetcher)
 {
     AssertLockHeld(cs_main);
     const CBlockIndex *pindexOldTip = chainActive.Tip();
@@ -2891,9 +3172,13 @@ bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainPar
         }
         nHeight = nTargetHeight;
 
+        // Have the next blocks read while these connect
+        if (pprefetcher)
+            pprefetcher->Schedule(std::vector<const CBlockIndex*>(vpindexToConnect.rbegin(), vpindexToConnect.rend()));
+
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
-            if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
+            if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool, pprefetcher)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (!state.CorruptionPossible())
@@ -2972,6 +3257,9 @@ bool CChainState::ActivateBestChain(CValidationState &state, const CChainParams&
     CBlockIndex *pindexMostWork = nullptr;
     CBlockIndex *pindexNewTip = nullptr;
     int nStopAtHeight = gArgs.GetArg("-stopatheight", DEFAULT_STOPATHEIGHT);
+    int nPrefetchBlocks = gArgs.GetArg("-prefetchblocks", DEFAULT_PREFETCH_BLOCKS);
+    // Prepares the blocks read from disk when we connect more than one
+    std::unique_ptr<CBlockPrefetcher> prefetcher;
     do {
         boost::this_thread::interruption_point();
 
@@ -2997,9 +3285,14 @@ bool CChainState::ActivateBestChain(CValidationState &state, const CChainParams&
             if (pindexMostWork == nullptr || pindexMostWork == chainActive.Tip())
                 return true;
 
+            if (!prefetcher && nPrefetchBlocks > 0 && pindexMostWork->nHeight > chainActive.Height() + 1) {
+                int nThreads = std::max(1, std::min(GetNumCores() / 2, MAX_PREFETCH_THREADS));
+                prefetcher.reset(new CBlockPrefetcher(chainparams.GetConsensus(), nPrefetchBlocks, nThreads));
+            }
+
             bool fInvalidFound = false;
             std::shared_ptr<const CBlock> nullBlockPtr;
-            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace))
+            if (!ActivateBestChainStep(state, chainparams, pindexMostWork, pblock && pblock->GetHash() == pindexMostWork->GetBlockHash() ? pblock : nullBlockPtr, fInvalidFound, connectTrace, prefetcher.get()))
                 return false;
 
             if (fInvalidFound) {
@@ -3216,9 +3509,9 @@ CBlockIndex* CChainState::AddToBlockIndex(const CBlockHeader& block)
 }
 
 /** Mark a block as having its data received and checked (up to BLOCK_VALID_TRANSACTIONS). */
-bool CChainState::ReceivedBlockTransactions(const CBlock &block, CValidationState& state, CBlockIndex *pindexNew, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+bool CChainState::ReceivedBlockTransactions(unsigned int nTx, CValidationState& state, CBlockIndex *pindexNew, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
 {
-    pindexNew->nTx = block.vtx.size();
+    pindexNew->nTx = nTx;
     pindexNew->nChainTx = 0;
     pindexNew->nFile = pos.nFile;
     pindexNew->nDataPos = pos.nPos;
@@ -3822,7 +4115,7 @@ bool ContextualCheckBlockHeader(const CBlockHeader& block, CValidationState& sta
  *  in ConnectBlock().
  *  Note that -reindex-chainstate skips the validation that happens here!
  */
-static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev, bool fFromDisk = false)
+static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev, bool fFromDisk)
 {
     const int nHeight = pindexPrev == nullptr ? 0 : pindexPrev->nHeight + 1;
 
@@ -4134,7 +4427,7 @@ bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CVali
             state.Error(strprintf("%s: Failed to find position to write new block to disk", __func__));
             return false;
         }
-        if (!ReceivedBlockTransactions(block, state, pindex, blockPos, chainparams.GetConsensus()))
+        if (!ReceivedBlockTransactions(block.vtx.size(), state, pindex, blockPos, chainparams.GetConsensus()))
             return error("AcceptBlock(): ReceivedBlockTransactions failed");
     } catch (const std::runtime_error& e) {
         return AbortNode(state, std::string("System error: ") + e.what());
@@ -4148,6 +4441,26 @@ bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CVali
     return true;
 }
 
+/** Add a block of the block files to the index from its header, see ReindexBlockFiles */
+bool CChainState::AcceptIndexedBlock(const CBlockHeader& header, unsigned int nTx, const CDiskBlockPos& pos, unsigned int nSize, CValidationState& state, const CChainParams& chainparams)
+{
+    AssertLockHeld(cs_main);
+
+    CBlockIndex* pindex = nullptr;
+    if (!AcceptBlockHeader(header, state, chainparams, &pindex))
+        return false;
+    if (pindex->nStatus & BLOCK_HAVE_DATA)
+        return true;
+
+    // The checks of the block's transactions are left to ConnectBlock
+    if (pindex->pprev)
+        pindex->nStatus |= BLOCK_UNCHECKED;
+    CDiskBlockPos blockPos = pos;
+    if (!FindBlockPos(blockPos, nSize + 8, pindex->nHeight, header.GetBlockTime(), true))
+        return error("%s: FindBlockPos failed", __func__);
+    return ReceivedBlockTransactions(nTx, state, pindex, blockPos, chainparams.GetConsensus());
+}
+
 bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<const CBlock> pblock, bool fForceProcessing, bool *fNewBlock)
 {
     AssertLockNotHeld(cs_main);
@@ -4430,6 +4743,12 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
 
     boost::this_thread::interruption_point();
 
+    // The blocks below a loaded UTXO snapshot have no data to count their
+    // transactions with
+    uint256 hashSnapshotBase;
+    unsigned int nSnapshotChainTx = 0;
+    blocktree.ReadSnapshotBase(hashSnapshotBase, nSnapshotChainTx);
+
     // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
     vSortedByHeight.reserve(mapBlockIndex.size());
@@ -4446,7 +4765,10 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
-        if (pindex->nTx > 0) {
+        if (!hashSnapshotBase.IsNull() && pindex->GetBlockHash() == hashSnapshotBase) {
+            pindex->nChainTx = nSnapshotChainTx;
+            pindexSnapshotBase = pindex;
+        } else if (pindex->nTx > 0) {
             if (pindex->pprev) {
                 if (pindex->pprev->nChainTx) {
                     pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
@@ -4606,6 +4928,10 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             LogPrintf("%s: block verification stopping at height %d (pruning, no data)\n", __func__, pindex->nHeight);
             break;
         }
+        if (pindexSnapshotBase && pindex->nHeight <= pindexSnapshotBase->nHeight) {
+            LogPrintf("%s: block verification stopping at height %d (UTXO snapshot base)\n", __func__, pindex->nHeight);
+            break;
+        }
         CBlock block;
         // check level 0: read from disk
         if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
@@ -4762,7 +5088,10 @@ bool CChainState::RewindBlockIndex(const CChainParams& params)
 
     // Note that during -reindex-chainstate we are called with an empty chainActive!
 
+    // A loaded UTXO snapshot covers the blocks up to its base
     int nHeight = 1;
+    if (pindexSnapshotBase && chainActive.Contains(pindexSnapshotBase))
+        nHeight = pindexSnapshotBase->nHeight + 1;
     while (nHeight <= chainActive.Height()) {
         if (IsWitnessEnabled(chainActive[nHeight - 1], params.GetConsensus()) && !(chainActive[nHeight]->nStatus & BLOCK_OPT_WITNESS)) {
             break;
@@ -4875,6 +5204,7 @@ void UnloadBlockIndex()
     chainActive.SetTip(nullptr);
     pindexBestInvalid = nullptr;
     pindexBestHeader = nullptr;
+    pindexSnapshotBase = nullptr;
     mempool.clear();
     mapBlocksUnlinked.clear();
     vinfoBlockFile.clear();
@@ -4938,7 +5268,7 @@ bool CChainState::LoadGenesisBlock(const CChainParams& chainparams)
             return error("%s: writing genesis block to disk failed", __func__);
         CBlockIndex *pindex = AddToBlockIndex(block);
         CValidationState state;
-        if (!ReceivedBlockTransactions(block, state, pindex, blockPos, chainparams.GetConsensus()))
+        if (!ReceivedBlockTransactions(block.vtx.size(), state, pindex, blockPos, chainparams.GetConsensus()))
             return error("%s: genesis block not accepted", __func__);
     } catch (const std::runtime_error& e) {
         return error("%s: failed to write genesis block: %s", __func__, e.what());
@@ -5069,6 +5399,222 @@ bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskB
     return nLoaded > 0;
 }
 
+namespace {
+
+/** What the block index needs of a block in a block file */
+struct ScannedBlock
+{
+    CBlockHeader header;
+    uint256 hash;
+    CDiskBlockPos pos;
+    unsigned int nSize;
+    unsigned int nTx;
+};
+
+/**
+ * Scans the block files for ReindexBlockFiles on several threads. Only the
+ * header and the transaction count of each block are read, the rest of the
+ * block is skipped.
+ */
+class CBlockFileScanner
+{
+private:
+    const CChainParams& chainparams;
+    const int nFiles;
+
+    std::mutex cs;
+    std::condition_variable condDone;
+    int nNextFile;
+    std::map<int, std::vector<ScannedBlock>> mapScanned;
+    bool fStop;
+    std::vector<std::thread> vThreads;
+
+    /** Read the block at nPos of file, false if there is none there */
+    bool ReadBlockAt(FILE* file, int nFile, unsigned int nPos, ScannedBlock& block)
+    {
+        unsigned char buf[CMessageHeader::MESSAGE_START_SIZE + 4 + 80 + 9];
+        if (fseek(file, nPos, SEEK_SET) != 0)
+            return false;
+        size_t nRead = fread(buf, 1, sizeof(buf), file);
+        if (nRead < CMessageHeader::MESSAGE_START_SIZE + 4 + 80 + 1 ||
+                memcmp(buf, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
+            return false;
+
+        try {
+            CDataStream ss((const char*)buf + CMessageHeader::MESSAGE_START_SIZE, (const char*)buf + nRead, SER_DISK, CLIENT_VERSION);
+            ss >> block.nSize;
+            if (block.nSize < 80 || block.nSize > MAX_BLOCK_SERIALIZED_SIZE)
+                return false;
+            ss >> block.header;
+            uint64_t nTx = ReadCompactSize(ss);
+            if (nTx == 0 || nTx > block.nSize)
+                return false;
+            block.nTx = nTx;
+        } catch (const std::exception&) {
+            return false;
+        }
+        block.hash = block.header.GetHash();
+        block.pos = CDiskBlockPos(nFile, nPos + CMessageHeader::MESSAGE_START_SIZE + 4);
+        return true;
+    }
+
+    /** Find the next message start at or after nPos, like LoadExternalBlockFile does */
+    bool FindMessageStart(FILE* file, unsigned int& nPos)
+    {
+        unsigned char buf[1 << 16];
+        while (true) {
+            if (fseek(file, nPos, SEEK_SET) != 0)
+                return false;
+            size_t nRead = fread(buf, 1, sizeof(buf), file);
+            if (nRead < CMessageHeader::MESSAGE_START_SIZE)
+                return false;
+            for (size_t i = 0; i + CMessageHeader::MESSAGE_START_SIZE <= nRead; i++) {
+                if (!memcmp(buf + i, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE)) {
+                    nPos += i;
+                    return true;
+                }
+            }
+            nPos += nRead - CMessageHeader::MESSAGE_START_SIZE + 1;
+        }
+    }
+
+    void ScanFile(int nFile, std::vector<ScannedBlock>& vBlocks)
+    {
+        FILE* file = OpenBlockFile(CDiskBlockPos(nFile, 0), true);
+        if (!file)
+            return; // This error is logged in OpenBlockFile
+
+        unsigned int nPos = 0;
+        while (!ShutdownRequested()) {
+            ScannedBlock block;
+            if (ReadBlockAt(file, nFile, nPos, block)) {
+                vBlocks.push_back(block);
+                nPos = block.pos.nPos + block.nSize;
+            } else if (!FindMessageStart(file, ++nPos)) {
+                break;
+            }
+        }
+        fclose(file);
+    }
+
+    void ThreadScan()
+    {
+        RenameThread("drivenet-reindex");
+        std::unique_lock<std::mutex> lock(cs);
+        while (!fStop && nNextFile < nFiles) {
+            int nFile = nNextFile++;
+            lock.unlock();
+
+            std::vector<ScannedBlock> vBlocks;
+            ScanFile(nFile, vBlocks);
+
+            lock.lock();
+            mapScanned[nFile] = std::move(vBlocks);
+            condDone.notify_all();
+        }
+    }
+
+public:
+    CBlockFileScanner(const CChainParams& chainparamsIn, int nFilesIn, int nThreads) :
+        chainparams(chainparamsIn), nFiles(nFilesIn), nNextFile(0), fStop(false)
+    {
+        for (int i = 0; i < nThreads; i++)
+            vThreads.emplace_back(&CBlockFileScanner::ThreadScan, this);
+    }
+
+    ~CBlockFileScanner()
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            fStop = true;
+        }
+        for (std::thread& thread : vThreads)
+            thread.join();
+    }
+
+    /** Wait for the blocks of file nFile, in the order they are in the file */
+    std::vector<ScannedBlock> Take(int nFile)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        condDone.wait(lock, [this, nFile]{ return mapScanned.count(nFile) != 0; });
+        std::vector<ScannedBlock> vBlocks = std::move(mapScanned[nFile]);
+        mapScanned.erase(nFile);
+        return vBlocks;
+    }
+};
+
+} // namespace
+
+bool ReindexBlockFiles(const CChainParams& chainparams)
+{
+    int64_t nStart = GetTimeMillis();
+    int nFiles = 0;
+    while (fs::exists(GetBlockPosFilename(CDiskBlockPos(nFiles, 0), "blk")))
+        nFiles++;
+    if (nFiles == 0)
+        return false;
+
+    int nThreads = std::max(1, std::min(GetNumCores(), MAX_REINDEX_SCAN_THREADS));
+    LogPrintf("Reindexing %d block files on %d threads\n", nFiles, nThreads);
+    CBlockFileScanner scanner(chainparams, nFiles, nThreads);
+
+    // Blocks whose parent isn't indexed yet, by parent hash
+    std::multimap<uint256, ScannedBlock> mapBlocksUnknownParent;
+    const uint256& hashGenesis = chainparams.GetConsensus().hashGenesisBlock;
+    int nLoaded = 0;
+    for (int nFile = 0; nFile < nFiles; nFile++) {
+        std::vector<ScannedBlock> vBlocks = scanner.Take(nFile);
+        boost::this_thread::interruption_point();
+        LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
+
+        for (const ScannedBlock& scanned : vBlocks) {
+            bool fGenesis = false;
+            {
+                LOCK(cs_main);
+                if (scanned.hash != hashGenesis && mapBlockIndex.find(scanned.header.hashPrevBlock) == mapBlockIndex.end()) {
+                    LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, scanned.hash.ToString(),
+                            scanned.header.hashPrevBlock.ToString());
+                    mapBlocksUnknownParent.insert(std::make_pair(scanned.header.hashPrevBlock, scanned));
+                    continue;
+                }
+
+                // Index the block, then the blocks found earlier that build on it
+                std::deque<ScannedBlock> queue;
+                queue.push_back(scanned);
+                while (!queue.empty()) {
+                    const ScannedBlock block = queue.front();
+                    queue.pop_front();
+
+                    CValidationState state;
+                    if (!g_chainstate.AcceptIndexedBlock(block.header, block.nTx, block.pos, block.nSize, state, chainparams)) {
+                        if (state.IsError())
+                            return AbortNode(state.GetRejectReason());
+                        continue;
+                    }
+                    nLoaded++;
+                    fGenesis |= block.hash == hashGenesis;
+
+                    auto range = mapBlocksUnknownParent.equal_range(block.hash);
+                    for (auto it = range.first; it != range.second; it++)
+                        queue.push_back(it->second);
+                    mapBlocksUnknownParent.erase(range.first, range.second);
+                }
+            }
+
+            // Activate the genesis block so normal node progress can continue
+            if (fGenesis) {
+                CValidationState state;
+                if (!ActivateBestChain(state, chainparams))
+                    break;
+            }
+        }
+        NotifyHeaderTip();
+    }
+
+    LogPrintf("Indexed %d blocks from %d block files in %dms\n", nLoaded, nFiles, GetTimeMillis() - nStart);
+    return nLoaded > 0;
+}
+
 void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
 {
     if (!fCheckBlockIndex) {
@@ -5085,6 +5631,12 @@ void CChainState::CheckBlockIndex(const Consensus::Params& consensusParams)
         return;
     }
 
+    // The blocks below a loaded UTXO snapshot are in the active chain
+    // without their data, which the checks below don't allow for
+    if (pindexSnapshotBase) {
+        return;
+    }
+
     // Build forward-pointing map of the entire block tree.
     std::multimap<CBlockIndex*,CBlockIndex*> forward;
     for (auto& entry : mapBlockIndex) {
@@ -5985,6 +6537,399 @@ bool ResyncSCDB(const CBlockIndex* pindex)
     return true;
 }
 
+namespace {
+
+/** Serializes to a file and hashes what it writes, the counterpart of
+ * CHashVerifier */
+class CHashedFileWriter
+{
+private:
+    CAutoFile& file;
+    CHashWriter hasher;
+
+public:
+    explicit CHashedFileWriter(CAutoFile& fileIn) : file(fileIn), hasher(fileIn.GetType(), fileIn.GetVersion()) {}
+
+    int GetType() const { return file.GetType(); }
+    int GetVersion() const { return file.GetVersion(); }
+
+    void write(const char* pch, size_t nSize)
+    {
+        file.write(pch, nSize);
+        hasher.write(pch, nSize);
+    }
+
+    template<typename T>
+    CHashedFileWriter& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return (*this);
+    }
+
+    uint256 GetHash() { return hasher.GetHash(); }
+};
+
+/** The hash of the snapshot at nHeight from -assumeutxo or the chain params */
+bool GetTrustedSnapshotHash(const CChainParams& chainparams, int nHeight, uint256& hash)
+{
+    for (const std::string& strArg : gArgs.GetArgs("-assumeutxo")) {
+        size_t nPos = strArg.find(':');
+        int32_t nArgHeight;
+        if (nPos == std::string::npos || !ParseInt32(strArg.substr(0, nPos), &nArgHeight) ||
+                strArg.size() - nPos - 1 != 64 || !IsHex(strArg.substr(nPos + 1))) {
+            LogPrintf("%s: Ignoring invalid -assumeutxo=%s\n", __func__, strArg);
+            continue;
+        }
+        if (nArgHeight == nHeight) {
+            hash = uint256S(strArg.substr(nPos + 1));
+            return true;
+        }
+    }
+
+    const MapAssumeutxo& mapAssumeutxo = chainparams.Assumeutxo();
+    MapAssumeutxo::const_iterator it = mapAssumeutxo.find(nHeight);
+    if (it == mapAssumeutxo.end())
+        return false;
+    hash = it->second;
+    return true;
+}
+
+} // namespace
+
+void CChainState::ActivateSnapshot(CBlockIndex* pindexBase, unsigned int nChainTx)
+{
+    AssertLockHeld(cs_main);
+
+    pindexBase->nChainTx = nChainTx;
+    pindexBase->RaiseValidity(BLOCK_VALID_SCRIPTS);
+    setDirtyBlockIndex.insert(pindexBase);
+    pindexSnapshotBase = pindexBase;
+
+    chainActive.SetTip(pindexBase);
+    setBlockIndexCandidates.insert(pindexBase);
+    PruneBlockIndexCandidates();
+}
+
+bool DumpUTXOSnapshot(const fs::path& path, SnapshotMetadata& metadata, uint64_t& nCoins, uint256& hashSnapshot, std::string& strError)
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    std::vector<CBlockHeader> vHeaders;
+    SidechainBlockData data;
+    std::vector<SidechainDeposit> vDeposit;
+    std::vector<SidechainSpentWithdrawal> vSpent;
+    std::vector<SidechainFailedWithdrawal> vFailed;
+    std::map<uint8_t, SidechainCTIP> mapCTIP;
+    {
+        LOCK(cs_main);
+        // The cursor reads the coins database as of this flush, SCDB is
+        // taken at the same block
+        FlushStateToDisk();
+        pcursor.reset(pcoinsdbview->Cursor());
+
+        const CBlockIndex* pindex = chainActive.Tip();
+        if (!pindex || pindex->GetBlockHash() != pcursor->GetBestBlock()) {
+            strError = "The coins database is not at the tip";
+            return false;
+        }
+        if (pindex->nHeight == 0) {
+            strError = "Nothing to write at the genesis block";
+            return false;
+        }
+        if (!psidechaintree->GetBlockData(pindex->GetBlockHash(), data)) {
+            strError = "Failed to read the sidechain data of the tip";
+            return false;
+        }
+
+        metadata.hashBase = pindex->GetBlockHash();
+        metadata.nHeight = pindex->nHeight;
+        metadata.nChainTx = pindex->nChainTx;
+
+        vHeaders.resize(pindex->nHeight);
+        for (const CBlockIndex* pindexWalk = pindex; pindexWalk->pprev; pindexWalk = pindexWalk->pprev)
+            vHeaders[pindexWalk->nHeight - 1] = pindexWalk->GetBlockHeader();
+
+        for (const Sidechain& s : scdb.GetActiveSidechains()) {
+            std::vector<SidechainDeposit> vSidechainDeposit = scdb.GetDeposits(s.nSidechain);
+            vDeposit.insert(vDeposit.end(), vSidechainDeposit.begin(), vSidechainDeposit.end());
+        }
+        vSpent = scdb.GetSpentWithdrawalCache();
+        vFailed = scdb.GetFailedWithdrawalCache();
+        mapCTIP = scdb.GetCTIP();
+    }
+
+    // The coins are read from the snapshot of the database the cursor
+    // holds, the node keeps going meanwhile
+    fs::path pathTmp = path;
+    pathTmp += ".incomplete";
+    CAutoFile file(fsbridge::fopen(pathTmp, "wb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        strError = strprintf("Failed to create %s", pathTmp.string());
+        return false;
+    }
+
+    nCoins = 0;
+    try {
+        CHashedFileWriter writer(file);
+        writer << UTXO_SNAPSHOT_VERSION << metadata;
+        for (const CBlockHeader& header : vHeaders)
+            writer << header;
+        writer << data << vDeposit << vSpent << vFailed << mapCTIP;
+
+        // The coins follow in chunks, the last one empty
+        std::vector<std::pair<COutPoint, Coin>> vChunk;
+        for (; pcursor->Valid(); pcursor->Next()) {
+            boost::this_thread::interruption_point();
+            std::pair<COutPoint, Coin> coin;
+            if (!pcursor->GetKey(coin.first) || !pcursor->GetValue(coin.second))
+                throw std::runtime_error("Failed to read the coins database");
+            vChunk.push_back(std::move(coin));
+            if (vChunk.size() == UTXO_SNAPSHOT_CHUNK_SIZE) {
+                writer << vChunk;
+                nCoins += vChunk.size();
+                vChunk.clear();
+            }
+        }
+        if (!vChunk.empty()) {
+            writer << vChunk;
+            nCoins += vChunk.size();
+            vChunk.clear();
+        }
+        writer << vChunk;
+
+        hashSnapshot = writer.GetHash();
+    } catch (const std::exception& e) {
+        file.fclose();
+        fs::remove(pathTmp);
+        strError = strprintf("Failed to write the snapshot: %s", e.what());
+        return false;
+    }
+
+    FileCommit(file.Get());
+    file.fclose();
+    if (!RenameOver(pathTmp, path)) {
+        strError = strprintf("Failed to rename %s", pathTmp.string());
+        return false;
+    }
+
+    LogPrintf("%s: Wrote %u coins at block %s (height %d), snapshot hash %s\n", __func__,
+            nCoins, metadata.hashBase.ToString(), metadata.nHeight, hashSnapshot.ToString());
+    return true;
+}
+
+bool LoadUTXOSnapshot(const CChainParams& chainparams, const fs::path& path, SnapshotMetadata& metadata, uint64_t& nCoins, std::string& strError)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        strError = strprintf("Failed to open %s", path.string());
+        return false;
+    }
+
+    // Nothing of the snapshot is used before the whole file is known to
+    // have the trusted hash
+    uint256 hashTrusted;
+    try {
+        CHashVerifier<CAutoFile> verifier(&file);
+        int nVersion;
+        verifier >> nVersion;
+        if (nVersion != UTXO_SNAPSHOT_VERSION) {
+            strError = strprintf("Unknown snapshot version %d", nVersion);
+            return false;
+        }
+        verifier >> metadata;
+        if (!GetTrustedSnapshotHash(chainparams, metadata.nHeight, hashTrusted)) {
+            strError = strprintf("No trusted hash for a snapshot at height %d, see -assumeutxo", metadata.nHeight);
+            return false;
+        }
+
+        std::vector<char> vBuffer(1 << 20);
+        size_t nRead;
+        while ((nRead = fread(vBuffer.data(), 1, vBuffer.size(), file.Get())) > 0)
+            verifier.write(vBuffer.data(), nRead);
+        if (ferror(file.Get())) {
+            strError = strprintf("Failed to read %s", path.string());
+            return false;
+        }
+
+        uint256 hashSnapshot = verifier.GetHash();
+        if (hashSnapshot != hashTrusted) {
+            strError = strprintf("Snapshot hash %s does not match the trusted hash %s", hashSnapshot.ToString(), hashTrusted.ToString());
+            return false;
+        }
+    } catch (const std::exception& e) {
+        strError = strprintf("Failed to read the snapshot: %s", e.what());
+        return false;
+    }
+
+    // Blocks can't be connected while the coins are written
+    LOCK(cs_main);
+    if (fReindex || chainActive.Height() != 0) {
+        strError = "A snapshot can only be loaded before any block after genesis is connected, start the node with -connect=0";
+        return false;
+    }
+    {
+        std::unique_ptr<CCoinsViewCursor> pcursor(pcoinsdbview->Cursor());
+        if (pcursor->Valid() || !pcoinsdbview->GetHeadBlocks().empty()) {
+            strError = "The coins database is not empty";
+            return false;
+        }
+    }
+
+    if (fseek(file.Get(), 0, SEEK_SET) != 0) {
+        strError = strprintf("Failed to read %s", path.string());
+        return false;
+    }
+
+    CBlockIndex* pindexBase = nullptr;
+    SidechainBlockData data;
+    std::vector<SidechainDeposit> vDeposit;
+    std::vector<SidechainSpentWithdrawal> vSpent;
+    std::vector<SidechainFailedWithdrawal> vFailed;
+    std::map<uint8_t, SidechainCTIP> mapCTIP;
+    UTXOSetStats utxostats;
+    nCoins = 0;
+    try {
+        // The file is read again, and hashed again in case it was changed
+        CHashVerifier<CAutoFile> verifier(&file);
+        int nVersion;
+        verifier >> nVersion >> metadata;
+
+        // The headers are validated like those of a peer
+        std::vector<CBlockHeader> vHeaders;
+        const CBlockIndex* pindexLast = nullptr;
+        for (int nHeight = 1; nHeight <= metadata.nHeight; nHeight++) {
+            CBlockHeader header;
+            verifier >> header;
+            vHeaders.push_back(header);
+            if (vHeaders.size() == MAX_HEADERS_RESULTS || nHeight == metadata.nHeight) {
+                CValidationState state;
+                if (!ProcessNewBlockHeaders(vHeaders, state, chainparams, &pindexLast)) {
+                    strError = strprintf("Invalid header at height %d: %s", nHeight, FormatStateMessage(state));
+                    return false;
+                }
+                vHeaders.clear();
+            }
+        }
+        BlockMap::iterator mi = mapBlockIndex.find(metadata.hashBase);
+        if (mi == mapBlockIndex.end() || mi->second != pindexLast || pindexLast->nHeight != metadata.nHeight) {
+            strError = "The headers do not lead to the base block of the snapshot";
+            return false;
+        }
+        pindexBase = mi->second;
+
+        verifier >> data >> vDeposit >> vSpent >> vFailed >> mapCTIP;
+
+        // Take the cache out of the way, it is empty at genesis
+        pcoinsTip->Flush();
+        if (!pcoinsdbview->BeginBulkWrite(metadata.hashBase)) {
+            strError = "Failed to write to the coins database";
+            return false;
+        }
+
+        int nThreads = std::max(1, std::min(GetNumCores(), MAX_SNAPSHOT_WRITE_THREADS));
+        CCoinsBulkWriter writer(*pcoinsdbview, nThreads);
+        std::vector<std::pair<COutPoint, Coin>> vChunk;
+        while (true) {
+            boost::this_thread::interruption_point();
+            verifier >> vChunk;
+            if (vChunk.empty())
+                break;
+            for (const std::pair<COutPoint, Coin>& coin : vChunk) {
+                if (coin.second.IsSpent() || (int)coin.second.nHeight > metadata.nHeight)
+                    throw std::runtime_error("Invalid coin");
+                utxostats.AddCoin(coin.first, coin.second);
+            }
+            nCoins += vChunk.size();
+            writer.Add(std::move(vChunk));
+            vChunk.clear();
+        }
+        if (!writer.Finish())
+            throw std::runtime_error("Failed to write to the coins database");
+
+        if (fgetc(file.Get()) != EOF || verifier.GetHash() != hashTrusted)
+            throw std::runtime_error("The file changed while it was loaded");
+        if (!pcoinsdbview->EndBulkWrite(metadata.hashBase))
+            throw std::runtime_error("Failed to write to the coins database");
+    } catch (const std::exception& e) {
+        strError = strprintf("Failed to load the snapshot: %s", e.what());
+        if (pindexBase)
+            strError += ". The coins database is incomplete, restart with -reindex-chainstate";
+        return false;
+    }
+    pcoinsTip->SetBestBlock(metadata.hashBase);
+
+    // SCDB as it was at the base block, as ResyncSCDB and the deposit and
+    // withdrawal caches would load it
+    if (!psidechaintree->WriteSidechainBlockData(std::make_pair(metadata.hashBase, data)) ||
+            !psidechaintree->Flush(metadata.hashBase)) {
+        strError = "Failed to write the sidechain data of the base block";
+        return false;
+    }
+    scdb.ApplyLDBData(metadata.hashBase, data);
+    scdb.AddDeposits(vDeposit);
+    scdb.AddSpentWithdrawals(vSpent);
+    scdb.AddFailedWithdrawals(vFailed);
+
+    // The CTIPs follow from the deposits
+    std::map<uint8_t, SidechainCTIP> mapCTIPLoaded = scdb.GetCTIP();
+    bool fCTIPMatch = mapCTIPLoaded.size() == mapCTIP.size();
+    for (const std::pair<uint8_t, SidechainCTIP>& ctip : mapCTIP) {
+        std::map<uint8_t, SidechainCTIP>::const_iterator it = mapCTIPLoaded.find(ctip.first);
+        if (it == mapCTIPLoaded.end() || it->second.out != ctip.second.out || it->second.amount != ctip.second.amount)
+            fCTIPMatch = false;
+    }
+    if (!fCTIPMatch)
+        LogPrintf("%s: WARNING: The CTIPs of the snapshot differ from those of its deposits\n", __func__);
+    mempool.UpdateCTIPFromBlock(mapCTIPLoaded, false /* fDisconnect */);
+
+    g_chainstate.ActivateSnapshot(pindexBase, metadata.nChainTx);
+    if (!pblocktree->WriteSnapshotBase(metadata.hashBase, metadata.nChainTx)) {
+        strError = "Failed to write to the block index";
+        return false;
+    }
+    utxostats.escrowAmount = GetEscrowAmount();
+    if (!pblockstatsdb->WriteUTXOSetStats(metadata.hashBase, utxostats)) {
+        strError = "Failed to write the UTXO set statistics";
+        return false;
+    }
+    FlushStateToDisk();
+    DumpSCDBCache();
+
+    LogPrintf("%s: Loaded %u coins at block %s (height %d)\n", __func__,
+            nCoins, metadata.hashBase.ToString(), metadata.nHeight);
+    return true;
+}
+
+bool InitUTXOSetStats()
+{
+    LOCK(cs_main);
+    CBlockIndex* pindex = chainActive.Tip();
+    UTXOSetStats stats;
+    if (!pindex || pblockstatsdb->ReadUTXOSetStats(pindex->GetBlockHash(), stats))
+        return true;
+
+    LogPrintf("%s: Computing the UTXO set statistics of block %s, this may take a while\n", __func__,
+            pindex->GetBlockHash().ToString());
+    FlushStateToDisk();
+    std::unique_ptr<CCoinsViewCursor> pcursor(pcoinsdbview->Cursor());
+    if (pcursor->GetBestBlock() != pindex->GetBlockHash())
+        return error("%s: The coins database is not at the tip", __func__);
+    while (pcursor->Valid()) {
+        if (ShutdownRequested())
+            return true;
+        COutPoint key;
+        Coin coin;
+        if (!pcursor->GetKey(key) || !pcursor->GetValue(coin))
+            return error("%s: unable to read value", __func__);
+        stats.AddCoin(key, coin);
+        pcursor->Next();
+    }
+    stats.escrowAmount = GetEscrowAmount();
+    if (!pblockstatsdb->WriteUTXOSetStats(pindex->GetBlockHash(), stats))
+        return error("%s: Failed to write the UTXO set statistics", __func__);
+    LogPrintf("%s: Done, %u coins\n", __func__, stats.nTransactionOutputs);
+    return true;
+}
+
 double GetNetworkHashPerSecond(int nLookup, int nHeight)
 {
     CBlockIndex *pb = chainActive.Tip();
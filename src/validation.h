@@ -44,6 +44,8 @@ class SidechainDB;
 class SidechainWithdrawalState;
 class CSidechainTreeDB;
 class OPReturnDB;
+class CBlockStatsDB;
+class CBlockUndo;
 struct ChainTxData;
 
 struct PrecomputedTransactionData;
@@ -81,9 +83,23 @@ static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 
 /** Maximum number of script-checking threads allowed */
-static const int MAX_SCRIPTCHECK_THREADS = 16;
+static const int MAX_SCRIPTCHECK_THREADS = 64;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Default for -prefetchblocks, the number of blocks read and checked ahead of connecting them */
+static const int DEFAULT_PREFETCH_BLOCKS = 16;
+/** Maximum number of threads preparing blocks ahead of connecting them */
+static const int MAX_PREFETCH_THREADS = 4;
+/** Version of the UTXO snapshots written by DumpUTXOSnapshot */
+static const int UTXO_SNAPSHOT_VERSION = 1;
+/** Number of coins in a chunk of a UTXO snapshot */
+static const unsigned int UTXO_SNAPSHOT_CHUNK_SIZE = 50000;
+/** Maximum number of threads writing the coins of a UTXO snapshot */
+static const int MAX_SNAPSHOT_WRITE_THREADS = 4;
+/** Default for -fastreindex */
+static const bool DEFAULT_FAST_REINDEX = true;
+/** Maximum number of threads scanning block files during -fastreindex */
+static const int MAX_REINDEX_SCAN_THREADS = 4;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -201,6 +217,10 @@ extern arith_uint256 nMinimumChainWork;
 /** Best header we've seen so far (used for getheaders queries' starting points). */
 extern CBlockIndex *pindexBestHeader;
 
+/** Base block of the UTXO snapshot the chain state was loaded from, or
+ * nullptr. Its ancestors have no block data. */
+extern CBlockIndex *pindexSnapshotBase;
+
 /** Minimum disk space required - used in CheckDiskSpace() */
 static const uint64_t nMinDiskSpace = 52428800;
 
@@ -271,6 +291,9 @@ FILE* OpenBlockFile(const CDiskBlockPos &pos, bool fReadOnly = false);
 fs::path GetBlockPosFilename(const CDiskBlockPos &pos, const char *prefix);
 /** Import blocks from an external file */
 bool LoadExternalBlockFile(const CChainParams& chainparams, FILE* fileIn, CDiskBlockPos *dbp = nullptr);
+/** Rebuild the block index from the headers of the blk*.dat files, which are
+ * scanned on several threads. The blocks are checked when they are connected. */
+bool ReindexBlockFiles(const CChainParams& chainparams);
 /** Ensures we have a genesis block in the block tree, possibly writing one to disk. */
 bool LoadGenesisBlock(const CChainParams& chainparams);
 /** Load the block tree and coins database from disk,
@@ -414,6 +437,9 @@ void InitScriptExecutionCache();
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
+/** Read undo data without cs_main, given the position and previous block hash taken under it */
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashPrevBlock);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -503,6 +529,8 @@ extern std::unique_ptr<CSidechainTreeDB> psidechaintree;
 
 extern std::unique_ptr<OPReturnDB> popreturndb;
 
+extern std::unique_ptr<CBlockStatsDB> pblockstatsdb;
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
@@ -592,4 +620,36 @@ bool ResyncSCDB(const CBlockIndex* pindex);
 
 double GetNetworkHashPerSecond(int nLookup, int nHeight);
 
+/** The block a UTXO snapshot was made at */
+struct SnapshotMetadata
+{
+    uint256 hashBase;
+    int nHeight;
+    unsigned int nChainTx;
+
+    SnapshotMetadata() : nHeight(0), nChainTx(0) {}
+
+    ADD_SERIALIZE_METHODS
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(hashBase);
+        READWRITE(nHeight);
+        READWRITE(nChainTx);
+    }
+};
+
+/** Write the headers, the SCDB state and the UTXO set at the tip to a
+ * snapshot file. hashSnapshot is the hash of the file, which nodes loading
+ * it must trust through -assumeutxo or the chain params. */
+bool DumpUTXOSnapshot(const fs::path& path, SnapshotMetadata& metadata, uint64_t& nCoins, uint256& hashSnapshot, std::string& strError);
+
+/** Load a snapshot written by DumpUTXOSnapshot and make its base block the
+ * tip. Only possible before any block after genesis was connected. */
+bool LoadUTXOSnapshot(const CChainParams& chainparams, const fs::path& path, SnapshotMetadata& metadata, uint64_t& nCoins, std::string& strError);
+
+/** Compute the UTXO set statistics of the tip from the coins database when
+ * there are none for it, so that the following blocks can update them */
+bool InitUTXOSetStats();
+
 #endif // BITCOIN_VALIDATION_H